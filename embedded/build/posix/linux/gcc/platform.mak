@@ -0,0 +1,38 @@
+# Platform-specific options
+
+USES_CXX=1
+
+CC=gcc
+CPP=g++
+
+### Generic compiler flags. ###
+CXFLAGS=-O2                 \
+        -g3                 \
+        -Wall               \
+        -c                  \
+        -fdata-sections     \
+        -ffunction-sections \
+        -DK_ADDR=uintptr_t  \
+        -DK_WORD=uintptr_t
+
+### Native host build - the kernel runs as a regular Linux process ###
+POSIX_C_FLAGS=-DPOSIX                   \
+              -D_GNU_SOURCE             \
+              -fmessage-length=0
+
+CFLAGS=$(CXFLAGS) $(POSIX_C_FLAGS)
+CPPFLAGS=$(CXFLAGS) $(POSIX_C_FLAGS) -fno-rtti -fno-exceptions
+
+LINK=g++
+LFLAGS=-Wl,--gc-sections
+LFLAGS_DBG=
+
+AR=ar
+ARFLAGS=rcs
+
+ASM=as
+ASMFLAGS=
+
+OBJCOPY=objcopy
+OBJCOPY_FLAGS=-O ihex
+OBJCOPY_DBG_FLAGS=--only-section=.logger -O binary --set-section-flags .logger=alloc --change-section-address .logger=0
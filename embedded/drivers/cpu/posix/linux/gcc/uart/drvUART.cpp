@@ -0,0 +1,137 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+
+    \file   drvUART.cpp
+
+    \brief  POSIX host serial port driver
+*/
+
+#include "kerneltypes.h"
+#include "drvUART.h"
+#include "driver.h"
+#include "thread.h"
+#include "threadport.h"
+
+#include <poll.h>
+#include <unistd.h>
+
+//---------------------------------------------------------------------------
+void PosixUART::Init(void)
+{    
+    m_bRxEnabled = true;
+    m_bEcho = false;
+    m_u32BaudRate = UART_DEFAULT_BAUD;
+}
+
+//---------------------------------------------------------------------------
+uint8_t PosixUART::Open()
+{
+    return 0;
+}
+
+//---------------------------------------------------------------------------
+uint8_t PosixUART::Close(void)
+{
+    return 0;
+}
+
+//---------------------------------------------------------------------------
+uint16_t PosixUART::Read( uint16_t u16SizeIn_, uint8_t *pvData_ )
+{
+    struct pollfd stPoll;
+    ssize_t sRead = 0;
+
+    if (!m_bRxEnabled || !u16SizeIn_)
+    {
+        return 0;
+    }
+
+    // Don't block the whole process - only read what's already there.  The
+    // system calls are made with interrupts disabled, so that they are never
+    // interrupted by a context switch.
+    CS_ENTER();
+    stPoll.fd = STDIN_FILENO;
+    stPoll.events = POLLIN;
+    stPoll.revents = 0;
+    if ((poll(&stPoll, 1, 0) == 1) && (stPoll.revents & POLLIN))
+    {
+        sRead = read(STDIN_FILENO, pvData_, u16SizeIn_);
+    }
+    CS_EXIT();
+
+    if (sRead <= 0)
+    {
+        return 0;
+    }
+
+    if (m_bEcho)
+    {
+        Write((uint16_t)sRead, pvData_);
+    }
+    return (uint16_t)sRead;
+}
+
+//---------------------------------------------------------------------------
+uint16_t PosixUART::Write(uint16_t u16SizeOut_, uint8_t *pvData_)
+{
+    ssize_t sWritten;
+
+    CS_ENTER();
+    sWritten = write(STDOUT_FILENO, pvData_, u16SizeOut_);
+    CS_EXIT();
+
+    if (sWritten <= 0)
+    {
+        return 0;
+    }
+    return (uint16_t)sWritten;
+}
+
+//---------------------------------------------------------------------------
+uint16_t PosixUART::Control( uint16_t u16Event_, 
+                                void *pvIn_, 
+                                uint16_t u16SizeIn_, 
+                                void *pvOut_, 
+                                uint16_t u16SizeOut_)
+{
+    switch ((CMD_UART)u16Event_)
+    {
+        case CMD_SET_BAUDRATE:
+        {
+            m_u32BaudRate = *((uint32_t*)pvIn_);
+        }
+            break;
+        case CMD_SET_RX_ECHO:
+        {
+            m_bEcho = *((uint8_t*)pvIn_);
+        }
+            break;
+        case CMD_SET_RX_ENABLE:
+        {
+            m_bRxEnabled = true;
+        }
+            break;
+        case CMD_SET_RX_DISABLE:
+        {
+            m_bRxEnabled = false;
+        }
+            break;
+        // Buffers, escape characters and callbacks are not used, as data is
+        // passed straight to/from the host.
+        default:
+            break;
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   drvUART.h
+
+    \brief  POSIX host serial port driver
+
+    The "UART" is mapped onto the host process' standard input and output
+    streams.
+*/
+#ifndef __DRVUART_H_
+#define __DRVUART_H_
+
+#include "kerneltypes.h"
+#include "driver.h"
+
+//---------------------------------------------------------------------------
+#define UART_DEFAULT_BAUD       ((uint32_t)57600)
+
+//---------------------------------------------------------------------------
+typedef enum
+{
+    CMD_SET_BAUDRATE = 0x80,
+    CMD_SET_BUFFERS,    
+    CMD_SET_RX_ESCAPE,
+    CMD_SET_RX_CALLBACK,
+    CMD_SET_RX_ECHO,
+    CMD_SET_RX_ENABLE,
+    CMD_SET_RX_DISABLE
+} CMD_UART;
+
+//---------------------------------------------------------------------------
+/*!
+ *   Implements a UART driver on top of the host's stdin/stdout.  Writes are
+ *   performed synchronously; reads return only the data that is immediately
+ *   available.
+ */
+class PosixUART : public Driver
+{
+    
+public:        
+    virtual void Init();
+    virtual uint8_t Open();
+    virtual uint8_t Close();
+    virtual uint16_t Read( uint16_t u16Bytes_, 
+                                 uint8_t *pu8Data_ );
+                                 
+    virtual uint16_t Write( uint16_t u16Bytes_, 
+                                  uint8_t *pu8Data_ );
+                                  
+    virtual uint16_t Control( uint16_t u16Event_, 
+                                    void *pvIn_, 
+                                    uint16_t u16SizeIn_, 
+                                    void *pvOut_, 
+                                    uint16_t u16SizeOut_ );
+
+private:
+    
+    bool m_bRxEnabled;                 //!< Whether or not to read from stdin
+    bool m_bEcho;                      //!< Whether or not to echo RX characters to TX
+    
+    uint32_t m_u32BaudRate;            //!< Baud rate (informational only)
+};
+
+#endif
@@ -27,16 +27,210 @@ See license.txt for more information
 #if KERNEL_USE_AUTO_ALLOC
 
 // Align to nearest word boundary
-#define ALLOC_ALIGN(x)  ( ((x) + (sizeof(K_ADDR)-1)) & (sizeof(K_ADDR) - 1) )
+#define ALLOC_ALIGN(x)  ( ((x) + (sizeof(K_ADDR)-1)) & ~(sizeof(K_ADDR) - 1) )
+
+// Storage for a pool of objects, in K_ADDR-sized words
+#define POOL_WORDS(type, count) \
+    (((sizeof(type) + sizeof(K_ADDR) - 1) / sizeof(K_ADDR)) * (count))
 
 //---------------------------------------------------------------------------
 uint8_t AutoAlloc::m_au8AutoHeap[ AUTO_ALLOC_SIZE ];
 K_ADDR  AutoAlloc::m_aHeapTop;
+AutoAllocPool AutoAlloc::m_aclPools[ AUTO_ALLOC_TYPE_COUNT ];
+AutoAllocPool AutoAlloc::m_aclStackPools[ AUTO_ALLOC_STACK_CLASSES ];
+
+// Largest stack held in the stack pools
+#define STACK_POOL_MAX  ((uint16_t)(AUTO_ALLOC_STACK_MIN << (AUTO_ALLOC_STACK_CLASSES - 1)))
+
+// Words at the bottom of a pooled stack overwritten by the free-list link
+#define STACK_LINK_WORDS    ((sizeof(void*) + sizeof(K_WORD) - 1) / sizeof(K_WORD))
+
+//---------------------------------------------------------------------------
+// Reserved storage for each typed object pool
+#if KERNEL_USE_SEMAPHORE && AUTO_ALLOC_SEMAPHORES
+static K_ADDR s_aSemaphorePool[ POOL_WORDS(Semaphore, AUTO_ALLOC_SEMAPHORES) ];
+#endif
+#if KERNEL_USE_MUTEX && AUTO_ALLOC_MUTEXES
+static K_ADDR s_aMutexPool[ POOL_WORDS(Mutex, AUTO_ALLOC_MUTEXES) ];
+#endif
+#if KERNEL_USE_EVENTFLAG && AUTO_ALLOC_EVENTFLAGS
+static K_ADDR s_aEventFlagPool[ POOL_WORDS(EventFlag, AUTO_ALLOC_EVENTFLAGS) ];
+#endif
+#if KERNEL_USE_MESSAGE && AUTO_ALLOC_MESSAGES
+static K_ADDR s_aMessagePool[ POOL_WORDS(Message, AUTO_ALLOC_MESSAGES) ];
+#endif
+#if KERNEL_USE_MESSAGE && AUTO_ALLOC_MESSAGEQUEUES
+static K_ADDR s_aMessageQueuePool[ POOL_WORDS(MessageQueue, AUTO_ALLOC_MESSAGEQUEUES) ];
+#endif
+#if KERNEL_USE_NOTIFY && AUTO_ALLOC_NOTIFIES
+static K_ADDR s_aNotifyPool[ POOL_WORDS(Notify, AUTO_ALLOC_NOTIFIES) ];
+#endif
+#if KERNEL_USE_MAILBOX && AUTO_ALLOC_MAILBOXES
+static K_ADDR s_aMailboxPool[ POOL_WORDS(Mailbox, AUTO_ALLOC_MAILBOXES) ];
+#endif
+#if AUTO_ALLOC_THREADS
+static K_ADDR s_aThreadPool[ POOL_WORDS(Thread, AUTO_ALLOC_THREADS) ];
+#endif
+#if KERNEL_USE_TIMERS && AUTO_ALLOC_TIMERS
+static K_ADDR s_aTimerPool[ POOL_WORDS(Timer, AUTO_ALLOC_TIMERS) ];
+#endif
+
+//---------------------------------------------------------------------------
+void AutoAllocPool::Init( void *pvBuffer_, uint16_t u16Size_, uint16_t u16Reserved_ )
+{
+    m_pvFree = 0;
+    m_aReserved = (K_ADDR)pvBuffer_;
+    m_u16Size = ALLOC_ALIGN(u16Size_);
+    m_u16Reserved = pvBuffer_ ? u16Reserved_ : 0;
+
+    m_stStats.u16Reserved = m_u16Reserved;
+    m_stStats.u16Objects = 0;
+    m_stStats.u16InUse = 0;
+    m_stStats.u16Peak = 0;
+    m_stStats.u32Allocs = 0;
+    m_stStats.u32Frees = 0;
+}
+
+//---------------------------------------------------------------------------
+void *AutoAllocPool::Alloc( void )
+{
+    void *pvRet;
+    bool bNew = false;
+
+    CS_ENTER();
+    // Recycle a destroyed object if there is one, otherwise use the next
+    // object in the reserved storage.
+    pvRet = m_pvFree;
+    if (pvRet)
+    {
+        m_pvFree = *(void**)pvRet;
+    }
+    else if (m_u16Reserved)
+    {
+        pvRet = (void*)m_aReserved;
+        m_aReserved += m_u16Size;
+        m_u16Reserved--;
+        bNew = true;
+    }
+    CS_EXIT();
+
+    // Pool's empty - carve a new object from the heap.  That panics on
+    // failure, but a panic handler may return, so check for it.
+    if (!pvRet)
+    {
+        pvRet = AutoAlloc::Allocate(m_u16Size);
+        if (!pvRet)
+        {
+            return 0;
+        }
+        bNew = true;
+    }
+
+    CS_ENTER();
+    if (bNew)
+    {
+        m_stStats.u16Objects++;
+    }
+    m_stStats.u32Allocs++;
+    m_stStats.u16InUse++;
+    if (m_stStats.u16InUse > m_stStats.u16Peak)
+    {
+        m_stStats.u16Peak = m_stStats.u16InUse;
+    }
+    CS_EXIT();
+
+    return pvRet;
+}
+
+//---------------------------------------------------------------------------
+void AutoAllocPool::Free( void *pvObj_ )
+{
+    CS_ENTER();
+    *(void**)pvObj_ = m_pvFree;
+    m_pvFree = pvObj_;
+
+    m_stStats.u32Frees++;
+    m_stStats.u16InUse--;
+    CS_EXIT();
+}
+
+//---------------------------------------------------------------------------
+void AutoAllocPool::GetStats( AutoAllocStats_t *pstStats_ )
+{
+    CS_ENTER();
+    *pstStats_ = m_stStats;
+    CS_EXIT();
+}
 
 //---------------------------------------------------------------------------
 void AutoAlloc::Init(void)
 {
     m_aHeapTop = (K_ADDR)(m_au8AutoHeap);
+
+#if KERNEL_USE_SEMAPHORE
+  #if AUTO_ALLOC_SEMAPHORES
+    m_aclPools[AUTO_ALLOC_TYPE_SEMAPHORE].Init(s_aSemaphorePool, sizeof(Semaphore), AUTO_ALLOC_SEMAPHORES);
+  #else
+    m_aclPools[AUTO_ALLOC_TYPE_SEMAPHORE].Init(0, sizeof(Semaphore), 0);
+  #endif
+#endif
+#if KERNEL_USE_MUTEX
+  #if AUTO_ALLOC_MUTEXES
+    m_aclPools[AUTO_ALLOC_TYPE_MUTEX].Init(s_aMutexPool, sizeof(Mutex), AUTO_ALLOC_MUTEXES);
+  #else
+    m_aclPools[AUTO_ALLOC_TYPE_MUTEX].Init(0, sizeof(Mutex), 0);
+  #endif
+#endif
+#if KERNEL_USE_EVENTFLAG
+  #if AUTO_ALLOC_EVENTFLAGS
+    m_aclPools[AUTO_ALLOC_TYPE_EVENTFLAG].Init(s_aEventFlagPool, sizeof(EventFlag), AUTO_ALLOC_EVENTFLAGS);
+  #else
+    m_aclPools[AUTO_ALLOC_TYPE_EVENTFLAG].Init(0, sizeof(EventFlag), 0);
+  #endif
+#endif
+#if KERNEL_USE_MESSAGE
+  #if AUTO_ALLOC_MESSAGES
+    m_aclPools[AUTO_ALLOC_TYPE_MESSAGE].Init(s_aMessagePool, sizeof(Message), AUTO_ALLOC_MESSAGES);
+  #else
+    m_aclPools[AUTO_ALLOC_TYPE_MESSAGE].Init(0, sizeof(Message), 0);
+  #endif
+  #if AUTO_ALLOC_MESSAGEQUEUES
+    m_aclPools[AUTO_ALLOC_TYPE_MESSAGEQUEUE].Init(s_aMessageQueuePool, sizeof(MessageQueue), AUTO_ALLOC_MESSAGEQUEUES);
+  #else
+    m_aclPools[AUTO_ALLOC_TYPE_MESSAGEQUEUE].Init(0, sizeof(MessageQueue), 0);
+  #endif
+#endif
+#if KERNEL_USE_NOTIFY
+  #if AUTO_ALLOC_NOTIFIES
+    m_aclPools[AUTO_ALLOC_TYPE_NOTIFY].Init(s_aNotifyPool, sizeof(Notify), AUTO_ALLOC_NOTIFIES);
+  #else
+    m_aclPools[AUTO_ALLOC_TYPE_NOTIFY].Init(0, sizeof(Notify), 0);
+  #endif
+#endif
+#if KERNEL_USE_MAILBOX
+  #if AUTO_ALLOC_MAILBOXES
+    m_aclPools[AUTO_ALLOC_TYPE_MAILBOX].Init(s_aMailboxPool, sizeof(Mailbox), AUTO_ALLOC_MAILBOXES);
+  #else
+    m_aclPools[AUTO_ALLOC_TYPE_MAILBOX].Init(0, sizeof(Mailbox), 0);
+  #endif
+#endif
+#if AUTO_ALLOC_THREADS
+    m_aclPools[AUTO_ALLOC_TYPE_THREAD].Init(s_aThreadPool, sizeof(Thread), AUTO_ALLOC_THREADS);
+#else
+    m_aclPools[AUTO_ALLOC_TYPE_THREAD].Init(0, sizeof(Thread), 0);
+#endif
+#if KERNEL_USE_TIMERS
+  #if AUTO_ALLOC_TIMERS
+    m_aclPools[AUTO_ALLOC_TYPE_TIMER].Init(s_aTimerPool, sizeof(Timer), AUTO_ALLOC_TIMERS);
+  #else
+    m_aclPools[AUTO_ALLOC_TYPE_TIMER].Init(0, sizeof(Timer), 0);
+  #endif
+#endif
+
+    for (uint8_t i = 0; i < AUTO_ALLOC_STACK_CLASSES; i++)
+    {
+        m_aclStackPools[i].Init(0, AUTO_ALLOC_STACK_MIN << i, 0);
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -46,7 +240,7 @@ void *AutoAlloc::Allocate( uint16_t u16Size_ )
 
     CS_ENTER();
     uint16_t u16AllocSize = ALLOC_ALIGN(u16Size_);
-    if ((((K_ADDR)m_aHeapTop - (K_ADDR)&m_au8AutoHeap[0]) + u16AllocSize) < AUTO_ALLOC_SIZE)
+    if ((((K_ADDR)m_aHeapTop - (K_ADDR)&m_au8AutoHeap[0]) + u16AllocSize) <= AUTO_ALLOC_SIZE)
     {
         pvRet = (void*)m_aHeapTop;
         m_aHeapTop += u16AllocSize;
@@ -61,61 +255,184 @@ void *AutoAlloc::Allocate( uint16_t u16Size_ )
     return pvRet;
 }
 
+//---------------------------------------------------------------------------
+uint16_t AutoAlloc::GetHeapFree(void)
+{
+    uint16_t u16Free;
+
+    CS_ENTER();
+    u16Free = AUTO_ALLOC_SIZE - (uint16_t)(m_aHeapTop - (K_ADDR)&m_au8AutoHeap[0]);
+    CS_EXIT();
+
+    return u16Free;
+}
+
+//---------------------------------------------------------------------------
+void AutoAlloc::GetPoolStats( AutoAllocType_t eType_, AutoAllocStats_t *pstStats_ )
+{
+    m_aclPools[eType_].GetStats(pstStats_);
+}
+
+//---------------------------------------------------------------------------
+K_WORD *AutoAlloc::NewStack( uint16_t *pu16Size_, uint16_t *pu16Clean_ )
+{
+    K_WORD *pwStack;
+    uint16_t u16Words;
+    uint16_t i;
+    uint8_t u8Class = 0;
+
+    *pu16Clean_ = 0;
+
+    // Oversize stacks come straight from the heap, and aren't recycled.
+    if (*pu16Size_ > STACK_POOL_MAX)
+    {
+        return (K_WORD*)Allocate(*pu16Size_);
+    }
+
+    while ((AUTO_ALLOC_STACK_MIN << u8Class) < *pu16Size_)
+    {
+        u8Class++;
+    }
+    *pu16Size_ = AUTO_ALLOC_STACK_MIN << u8Class;
+
+    pwStack = (K_WORD*)m_aclStackPools[u8Class].Alloc();
+    if (!pwStack)
+    {
+        return 0;
+    }
+
+    // Put back the fill pattern under the free-list link.  A new stack is
+    // all zeroes past that point, so only those words are found clean.
+    for (i = 0; i < STACK_LINK_WORDS; i++)
+    {
+        pwStack[i] = (K_WORD)(-1);
+    }
+
+    // Stacks grow down, so the previous thread left the fill pattern intact
+    // below the deepest point it reached.  Scan up to the first word it
+    // touched - everything below that is known to be clean.  Bisecting for
+    // it instead could be fooled by a dirty word that happens to match the
+    // pattern, which is likely with byte-wide words.
+    u16Words = *pu16Size_ / sizeof(K_WORD);
+    while ((i < u16Words) && (pwStack[i] == (K_WORD)(-1)))
+    {
+        i++;
+    }
+
+    *pu16Clean_ = i * sizeof(K_WORD);
+    return pwStack;
+}
+
+//---------------------------------------------------------------------------
+void AutoAlloc::DestroyStack( K_WORD *pwStack_, uint16_t u16Size_ )
+{
+    uint8_t u8Class = 0;
+
+    if (u16Size_ > STACK_POOL_MAX)
+    {
+        return;
+    }
+    while ((AUTO_ALLOC_STACK_MIN << u8Class) < u16Size_)
+    {
+        u8Class++;
+    }
+    m_aclStackPools[u8Class].Free(pwStack_);
+}
+
+//---------------------------------------------------------------------------
+bool AutoAlloc::GetStackPoolStats( uint8_t u8Class_, AutoAllocStats_t *pstStats_ )
+{
+    if (u8Class_ >= AUTO_ALLOC_STACK_CLASSES)
+    {
+        return false;
+    }
+    m_aclStackPools[u8Class_].GetStats(pstStats_);
+    return true;
+}
+
 #if KERNEL_USE_SEMAPHORE
 //---------------------------------------------------------------------------
 Semaphore *AutoAlloc::NewSemaphore(void)
 {
-    void *pvObj = Allocate(sizeof(Semaphore));
+    void *pvObj = m_aclPools[AUTO_ALLOC_TYPE_SEMAPHORE].Alloc();
     if (pvObj)
     {
         return new(pvObj) Semaphore();
     }
     return 0;
 }
-#endif
 
+//---------------------------------------------------------------------------
+void AutoAlloc::DestroySemaphore( Semaphore *pclSemaphore_ )
+{
+    pclSemaphore_->~Semaphore();
+    m_aclPools[AUTO_ALLOC_TYPE_SEMAPHORE].Free(pclSemaphore_);
+}
+#endif
 
 #if KERNEL_USE_MUTEX
 //---------------------------------------------------------------------------
 Mutex *AutoAlloc::NewMutex(void)
 {
-    void *pvObj = Allocate(sizeof(Mutex));
+    void *pvObj = m_aclPools[AUTO_ALLOC_TYPE_MUTEX].Alloc();
     if (pvObj)
     {
         return new(pvObj) Mutex();
     }
     return 0;
 }
+
+//---------------------------------------------------------------------------
+void AutoAlloc::DestroyMutex( Mutex *pclMutex_ )
+{
+    pclMutex_->~Mutex();
+    m_aclPools[AUTO_ALLOC_TYPE_MUTEX].Free(pclMutex_);
+}
 #endif
 
 #if KERNEL_USE_EVENTFLAG
 //---------------------------------------------------------------------------
 EventFlag *AutoAlloc::NewEventFlag(void)
 {
-    void *pvObj = Allocate(sizeof(EventFlag));
+    void *pvObj = m_aclPools[AUTO_ALLOC_TYPE_EVENTFLAG].Alloc();
     if (pvObj)
     {
         return new(pvObj) EventFlag();
     }
     return 0;
 }
+
+//---------------------------------------------------------------------------
+void AutoAlloc::DestroyEventFlag( EventFlag *pclEventFlag_ )
+{
+    pclEventFlag_->~EventFlag();
+    m_aclPools[AUTO_ALLOC_TYPE_EVENTFLAG].Free(pclEventFlag_);
+}
 #endif
 
 #if KERNEL_USE_MESSAGE
 //---------------------------------------------------------------------------
 Message *AutoAlloc::NewMessage(void)
 {
-    void *pvObj = Allocate(sizeof(Message));
+    void *pvObj = m_aclPools[AUTO_ALLOC_TYPE_MESSAGE].Alloc();
     if (pvObj)
     {
         return new(pvObj) Message();
     }
     return 0;
 }
+
+//---------------------------------------------------------------------------
+void AutoAlloc::DestroyMessage( Message *pclMessage_ )
+{
+    pclMessage_->~Message();
+    m_aclPools[AUTO_ALLOC_TYPE_MESSAGE].Free(pclMessage_);
+}
+
 //---------------------------------------------------------------------------
 MessageQueue *AutoAlloc::NewMessageQueue(void)
 {
-    void *pvObj = Allocate(sizeof(MessageQueue));
+    void *pvObj = m_aclPools[AUTO_ALLOC_TYPE_MESSAGEQUEUE].Alloc();
     if (pvObj)
     {
         return new(pvObj) MessageQueue();
@@ -123,38 +440,58 @@ MessageQueue *AutoAlloc::NewMessageQueue(void)
     return 0;
 }
 
+//---------------------------------------------------------------------------
+void AutoAlloc::DestroyMessageQueue( MessageQueue *pclMessageQueue_ )
+{
+    pclMessageQueue_->~MessageQueue();
+    m_aclPools[AUTO_ALLOC_TYPE_MESSAGEQUEUE].Free(pclMessageQueue_);
+}
 #endif
 
 #if KERNEL_USE_NOTIFY
 //---------------------------------------------------------------------------
 Notify *AutoAlloc::NewNotify(void)
 {
-    void *pvObj = Allocate(sizeof(Notify));
+    void *pvObj = m_aclPools[AUTO_ALLOC_TYPE_NOTIFY].Alloc();
     if (pvObj)
     {
         return new(pvObj) Notify();
     }
     return 0;
 }
+
+//---------------------------------------------------------------------------
+void AutoAlloc::DestroyNotify( Notify *pclNotify_ )
+{
+    pclNotify_->~Notify();
+    m_aclPools[AUTO_ALLOC_TYPE_NOTIFY].Free(pclNotify_);
+}
 #endif
 
 #if KERNEL_USE_MAILBOX
 //---------------------------------------------------------------------------
 Mailbox *AutoAlloc::NewMailbox(void)
 {
-    void *pvObj = Allocate(sizeof(Mailbox));
+    void *pvObj = m_aclPools[AUTO_ALLOC_TYPE_MAILBOX].Alloc();
     if (pvObj)
     {
         return new(pvObj) Mailbox();
     }
     return 0;
 }
+
+//---------------------------------------------------------------------------
+void AutoAlloc::DestroyMailbox( Mailbox *pclMailbox_ )
+{
+    pclMailbox_->~Mailbox();
+    m_aclPools[AUTO_ALLOC_TYPE_MAILBOX].Free(pclMailbox_);
+}
 #endif
 
 //---------------------------------------------------------------------------
 Thread *AutoAlloc::NewThread(void)
 {
-    void *pvObj = Allocate(sizeof(Thread));
+    void *pvObj = m_aclPools[AUTO_ALLOC_TYPE_THREAD].Alloc();
     if (pvObj)
     {
         return new(pvObj) Thread();
@@ -162,17 +499,31 @@ Thread *AutoAlloc::NewThread(void)
     return 0;
 }
 
+//---------------------------------------------------------------------------
+void AutoAlloc::DestroyThread( Thread *pclThread_ )
+{
+    pclThread_->~Thread();
+    m_aclPools[AUTO_ALLOC_TYPE_THREAD].Free(pclThread_);
+}
+
 #if KERNEL_USE_TIMERS
 //---------------------------------------------------------------------------
 Timer *AutoAlloc::NewTimer(void)
 {
-    void *pvObj = Allocate(sizeof(Timer));
+    void *pvObj = m_aclPools[AUTO_ALLOC_TYPE_TIMER].Alloc();
     if (pvObj)
     {
         return new(pvObj) Timer();
     }
     return 0;
 }
+
+//---------------------------------------------------------------------------
+void AutoAlloc::DestroyTimer( Timer *pclTimer_ )
+{
+    pclTimer_->Stop();
+    m_aclPools[AUTO_ALLOC_TYPE_TIMER].Free(pclTimer_);
+}
 #endif
 
 #endif
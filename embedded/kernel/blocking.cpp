@@ -23,6 +23,7 @@ See license.txt for more information
 
 #include "blocking.h"
 #include "thread.h"
+#include "waitset.h"
 
 #define _CAN_HAS_DEBUG
 //--[Autogenerated - Do Not Modify]------------------------------------------
@@ -87,4 +88,15 @@ void BlockingObject::UnBlock(Thread *pclThread_)
     pclThread_->SetState(THREAD_STATE_READY);
 }
 
+#if KERNEL_USE_WAITSET
+//---------------------------------------------------------------------------
+void BlockingObject::SignalWaitSet()
+{
+    if (m_pclWaitSet)
+    {
+        m_pclWaitSet->Signal(this);
+    }
+}
+#endif
+
 #endif
@@ -0,0 +1,235 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   condvar.cpp
+
+    \brief  Condition variable implementation
+
+*/
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#include "blocking.h"
+#include "kernel.h"
+#include "thread.h"
+#include "condvar.h"
+
+#define _CAN_HAS_DEBUG
+//--[Autogenerated - Do Not Modify]------------------------------------------
+#include "dbg_file_list.h"
+#include "buffalogger.h"
+#if defined(DBG_FILE)
+# error "Debug logging file token already defined!  Bailing."
+#else
+# define DBG_FILE _DBG___KERNEL_CONDVAR_CPP
+#endif
+//--[End Autogenerated content]----------------------------------------------
+#include "kerneldebug.h"
+
+#if KERNEL_USE_CONDVAR
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+/*!
+ * \brief TimedCondVar_Callback
+ *
+ * This function is called from the timer-expired context to trigger a timeout
+ * on this condition variable.  This results in the waking of the thread that
+ * was waiting on it.
+ *
+ * \param pclOwner_ Pointer to the thread to wake
+ * \param pvData_   Pointer to the condition variable the thread is waiting on
+ */
+void TimedCondVar_Callback(Thread *pclOwner_, void *pvData_)
+{
+    ConditionVariable *pclCondVar = static_cast<ConditionVariable*>(pvData_);
+
+    if (pclCondVar->WakeMe(pclOwner_))
+    {
+        Thread::Yield();
+    }
+}
+
+//---------------------------------------------------------------------------
+bool ConditionVariable::WakeMe(Thread *pclOwner_)
+{
+    bool bSchedule = false;
+
+    CS_ENTER();
+
+    // If the thread has already been signalled, it's waiting on the mutex
+    // now, and the timeout no longer applies.
+    if (pclOwner_->GetCurrent() == &m_clBlockList)
+    {
+        pclOwner_->SetExpired(true);
+        UnBlock(pclOwner_);
+        if (pclOwner_->GetCurPriority() >= Scheduler::GetCurrentThread()->GetCurPriority())
+        {
+            bSchedule = true;
+        }
+    }
+
+    CS_EXIT();
+
+    return bSchedule;
+}
+#endif
+
+//---------------------------------------------------------------------------
+ConditionVariable::~ConditionVariable()
+{
+    // If there are any threads waiting on this object when it goes out
+    // of scope, set a kernel panic.
+    if (m_clBlockList.GetHead())
+    {
+        Kernel::Panic(PANIC_ACTIVE_CONDVAR_DESCOPED);
+    }
+}
+
+//---------------------------------------------------------------------------
+void ConditionVariable::Init()
+{
+    m_clBlockList.Init();
+#if KERNEL_USE_WAITSET
+    m_pclWaitSet = NULL;
+#endif
+    m_pclMutex = NULL;
+}
+
+//---------------------------------------------------------------------------
+#if KERNEL_USE_TIMEOUTS
+bool ConditionVariable::Wait_i( Mutex *pclMutex_, uint32_t u32WaitTimeMS_ )
+#else
+void ConditionVariable::Wait_i( Mutex *pclMutex_ )
+#endif
+{
+    KERNEL_TRACE_1( "Waiting on CondVar, Thread %d", (uint16_t)g_pclCurrent->GetID() );
+
+    Thread *pclThis = g_pclCurrent;
+#if KERNEL_USE_TIMEOUTS
+    bool bUseTimer = false;
+#endif
+
+    CS_ENTER();
+
+    // The caller must hold the mutex, exactly once - the mutex is released
+    // in full while we wait.
+    KERNEL_ASSERT( (pclMutex_->m_pclOwner == pclThis) );
+    KERNEL_ASSERT( (pclMutex_->m_u8Recurse == 0) );
+
+    // All threads waiting at once must use the same mutex
+    KERNEL_ASSERT( (!m_clBlockList.GetHead() || (m_pclMutex == pclMutex_)) );
+    m_pclMutex = pclMutex_;
+
+#if KERNEL_USE_TIMEOUTS
+    if (u32WaitTimeMS_)
+    {
+        pclThis->StartTimeout(u32WaitTimeMS_, (TimerCallback_t)TimedCondVar_Callback, (void*)this);
+        bUseTimer = true;
+    }
+#endif
+
+    // Release the mutex (dropping any priority inherited through it) and
+    // block, all within the same critical section - a signal can't be lost
+    // between the two.
+    pclMutex_->Unlock_i();
+    BlockPriority(pclThis);
+
+    // By the time we run again, we've been handed the mutex (or timed out)
+    Thread::Yield();
+
+    CS_EXIT();
+
+#if KERNEL_USE_TIMEOUTS
+    if (bUseTimer)
+    {
+        if (!pclThis->StopTimeout())
+        {
+            // Timed out - claim the mutex back the hard way.
+            pclMutex_->Claim();
+            return false;
+        }
+    }
+    return true;
+#endif
+}
+
+//---------------------------------------------------------------------------
+void ConditionVariable::Wait( Mutex *pclMutex_ )
+{
+#if KERNEL_USE_TIMEOUTS
+    Wait_i(pclMutex_, 0);
+#else
+    Wait_i(pclMutex_);
+#endif
+}
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+bool ConditionVariable::Wait( Mutex *pclMutex_, uint32_t u32WaitTimeMS_ )
+{
+    return Wait_i(pclMutex_, u32WaitTimeMS_);
+}
+#endif
+
+//---------------------------------------------------------------------------
+bool ConditionVariable::Signal_i()
+{
+    Thread *pclChosenOne = m_clBlockList.HighestWaiter();
+
+    return m_pclMutex->Handoff_i(pclChosenOne);
+}
+
+//---------------------------------------------------------------------------
+void ConditionVariable::Signal()
+{
+    bool bSchedule = false;
+
+    CS_ENTER();
+    if (m_clBlockList.GetHead())
+    {
+        bSchedule = Signal_i();
+    }
+    CS_EXIT();
+
+    if (bSchedule)
+    {
+        Thread::Yield();
+    }
+}
+
+//---------------------------------------------------------------------------
+void ConditionVariable::Broadcast()
+{
+    bool bSchedule = false;
+
+    CS_ENTER();
+    while (m_clBlockList.GetHead())
+    {
+        if (Signal_i())
+        {
+            bSchedule = true;
+        }
+    }
+    CS_EXIT();
+
+    if (bSchedule)
+    {
+        Thread::Yield();
+    }
+}
+
+#endif // KERNEL_USE_CONDVAR
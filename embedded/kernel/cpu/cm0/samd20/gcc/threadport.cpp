@@ -103,9 +103,10 @@ void ThreadPort::InitStack(Thread *pclThread_)
     // Get the top-of-stack pointer for the thread
     pu32Stack = (uint32_t*)pclThread_->m_pwStackTop;
 
-    // Initialize the stack to all FF's to aid in stack depth checking
+    // Initialize the stack to all FF's to aid in stack depth checking -
+    // skipping the part of a recycled stack its last thread never used.
     pu32Temp = (uint32_t*)pclThread_->m_pwStack;
-    for (i = 0; i < pclThread_->m_u16StackSize / sizeof(uint32_t); i++)
+    for (i = pclThread_->GetStackClean() / sizeof(uint32_t); i < pclThread_->m_u16StackSize / sizeof(uint32_t); i++)
     {
         pu32Temp[i] = 0xFFFFFFFF;
     }
@@ -139,6 +140,9 @@ void ThreadPort::InitStack(Thread *pclThread_)
 //---------------------------------------------------------------------------
 void Thread_Switch(void)
 {
+#if KERNEL_USE_THREAD_STATS
+    ThreadStats::Switch((Thread*)g_pclNext);
+#endif
     g_pclCurrent = (Thread*)g_pclNext;
 }
 
@@ -26,29 +26,55 @@ See license.txt for more information
 #include "m3_core_cm3.h"
 
 #if KERNEL_USE_PROFILER
+//---------------------------------------------------------------------------
+/*
+    The profiler uses the DWT cycle counter, which runs at the core clock and
+    has no overflow interrupt.  The low 16 bits of the counter are returned
+    as the timer count, and the upper bits (extended in software to 32 bits)
+    as the epoch.  Overflows are detected when the counter is read, so it
+    must be read at least once per 2^32 cycles.
+*/
+#define DEMCR                   (*((volatile uint32_t*)0xE000EDFCUL))  //!< Debug Exception and Monitor Control
+#define DEMCR_TRCENA            (1UL << 24)                             //!< Enable DWT and ITM
+
+//---------------------------------------------------------------------------
 uint32_t Profiler::m_u32Epoch;
 
 //---------------------------------------------------------------------------
 void Profiler::Init()
 {
-
+    DEMCR |= DEMCR_TRCENA;
+    DWT->CTRL &= ~DWT_CTRL_CYCCNTENA_Msk;
+    DWT->CYCCNT = 0;
+    m_u32Epoch = 0;
 }
 
 //---------------------------------------------------------------------------
 void Profiler::Start()
 {
-
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 }    
 
 //---------------------------------------------------------------------------
 void Profiler::Stop()
 {
-
+    DWT->CTRL &= ~DWT_CTRL_CYCCNTENA_Msk;
 }    
 //---------------------------------------------------------------------------
 uint16_t Profiler::Read()
 {
-    return 0;
+    uint32_t u32Count;
+    CS_ENTER();
+    u32Count = DWT->CYCCNT;
+
+    // Counter wrapped since the last read - bump the software-extended bits
+    if ((u32Count >> 16) < (m_u32Epoch & 0xFFFF))
+    {
+        m_u32Epoch += 0x10000;
+    }
+    m_u32Epoch = (m_u32Epoch & 0xFFFF0000) | (u32Count >> 16);
+    CS_EXIT();
+    return (uint16_t)u32Count;
 }
 
 //---------------------------------------------------------------------------
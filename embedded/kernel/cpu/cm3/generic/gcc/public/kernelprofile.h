@@ -27,8 +27,8 @@ See license.txt for more information
 #if KERNEL_USE_PROFILER
 
 //---------------------------------------------------------------------------
-#define TICKS_PER_OVERFLOW              (256)
-#define CLOCK_DIVIDE                    (8)
+#define TICKS_PER_OVERFLOW              (65536)
+#define CLOCK_DIVIDE                    (1)
 
 //---------------------------------------------------------------------------
 /*!
@@ -76,7 +76,8 @@ public:
     /*!
      *  \brief GetEpoch
      *
-     *  Return the current timer epoch    
+     *  Return the current timer epoch.  The epoch is derived from the
+     *  cycle counter value sampled by the most recent call to Read().
      */
     static uint32_t GetEpoch(){ return m_u32Epoch; }
 private:
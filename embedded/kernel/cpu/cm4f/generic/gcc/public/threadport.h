@@ -35,6 +35,40 @@ See license.txt for more information
 #define PUSH_TO_STACK(x, y)        *x = y; x--;
 #define STACK_GROWS_DOWN           (1)
 
+//---------------------------------------------------------------------------
+//! Use the hardware count-leading-zeros instruction for priority lookups
+#define HW_CLZ                     (1)
+//! Count leading zeros in a 32-bit word (yields 32 for a zero input)
+#define CLZ(x)                     \
+({                                 \
+    uint32_t __clz;                \
+    ASM (" clz %0, %1 \n" : "=r" (__clz) : "r" (x)); \
+    __clz;                         \
+})
+
+//---------------------------------------------------------------------------
+//! Use the exclusive-access instructions for lock-free updates.  Exception
+//! entry and return clear the exclusive monitor, so a STREX() fails if the
+//! code was interrupted or switched out since its LDREX().
+#define HW_LDREX                   (1)
+//! Load a 32-bit word, and tag its address for exclusive access
+#define LDREX(p)                   \
+({                                 \
+    uint32_t __val;                \
+    ASM (" ldrex %0, [%1] \n" : "=r" (__val) : "r" (p) : "memory"); \
+    __val;                         \
+})
+//! Store a 32-bit word to an address tagged by LDREX(), yielding 0 on
+//! success, or 1 if the tag was lost and the store didn't happen.
+#define STREX(v, p)                \
+({                                 \
+    uint32_t __fail;               \
+    ASM (" strex %0, %1, [%2] \n" : "=&r" (__fail) : "r" (v), "r" (p) : "memory"); \
+    __fail;                        \
+})
+//! Drop the tag left by an LDREX() that isn't followed by a STREX()
+#define CLREX()                    ASM (" clrex \n" ::: "memory")
+
 //------------------------------------------------------------------------
 //! These macros *must* be used in matched-pairs !
 //! Nesting *is* supported !
@@ -51,8 +51,9 @@ void ThreadPort::InitStack(Thread *pclThread_)
     pu16Stack = (uint16_t*)pclThread_->m_pwStackTop;
 
     // clear the stack, and initialize it to a known-default value (easier
-    // to debug when things go sour with stack corruption or overflow)
-    for (i = 0; i < pclThread_->m_u16StackSize / sizeof(uint16_t); i++)
+    // to debug when things go sour with stack corruption or overflow).  A
+    // recycled stack is still filled below the depth its last thread used.
+    for (i = pclThread_->GetStackClean() / sizeof(uint16_t); i < pclThread_->m_u16StackSize / sizeof(uint16_t); i++)
     {
         pclThread_->m_pwStack[i] = 0xFFFF;
     }
@@ -93,6 +94,9 @@ static void Thread_Switch(void)
     // If there's no next-thread-to-run...
     if (g_pclNext == Kernel::GetIdleThread())
     {
+#if KERNEL_USE_THREAD_STATS
+        ThreadStats::Switch(Kernel::GetIdleThread());
+#endif
         g_pclCurrent = Kernel::GetIdleThread();
 
         // Disable the SWI, and re-enable interrupts -- enter nested interrupt
@@ -120,6 +124,9 @@ static void Thread_Switch(void)
     }
 #endif
     KernelSWI::Clear();
+#if KERNEL_USE_THREAD_STATS
+    ThreadStats::Switch((Thread*)g_pclNext);
+#endif
     g_pclCurrent = (Thread*)g_pclNext;
 }
 
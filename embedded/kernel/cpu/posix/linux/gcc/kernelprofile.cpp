@@ -0,0 +1,102 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+    \file kernelprofile.cpp
+    
+    \brief POSIX Profiling timer implementation
+
+    The profiling counter runs at SYSTEM_FREQ / CLOCK_DIVIDE, and is derived
+    from CLOCK_MONOTONIC.  As it never overflows, there is no overflow
+    interrupt to process - the epoch is simply the upper bits of the counter.
+*/
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+#include "profile.h"
+#include "kernelprofile.h"
+#include "kerneltimer.h"
+#include "threadport.h"
+
+#include <time.h>
+
+#if KERNEL_USE_PROFILER
+
+//---------------------------------------------------------------------------
+#define PROFILE_NS_PER_TICK     (1000000000ULL / (SYSTEM_FREQ / CLOCK_DIVIDE))
+
+//---------------------------------------------------------------------------
+static uint64_t u64Sample;      //!< Counter value shared by Read()/GetEpoch()
+static bool bSampled;           //!< Whether u64Sample is pending consumption
+
+//---------------------------------------------------------------------------
+static uint64_t Profiler_Sample(void)
+{
+    if (bSampled)
+    {
+        bSampled = false;
+        return u64Sample;
+    }
+
+    struct timespec stNow;
+    clock_gettime(CLOCK_MONOTONIC, &stNow);
+    u64Sample = (((uint64_t)stNow.tv_sec * 1000000000ULL) + stNow.tv_nsec) / PROFILE_NS_PER_TICK;
+    bSampled = true;
+    return u64Sample;
+}
+
+//---------------------------------------------------------------------------
+void Profiler::Init()
+{
+    bSampled = false;
+}
+
+//---------------------------------------------------------------------------
+void Profiler::Start()
+{
+    bSampled = false;
+}    
+
+//---------------------------------------------------------------------------
+void Profiler::Stop()
+{
+    bSampled = false;
+}    
+
+//---------------------------------------------------------------------------
+uint16_t Profiler::Read()
+{
+    uint16_t u16Ret;
+    CS_ENTER();
+    u16Ret = (uint16_t)(Profiler_Sample() % TICKS_PER_OVERFLOW);
+    CS_EXIT();
+    return u16Ret;
+}
+
+//---------------------------------------------------------------------------
+void Profiler::Process()
+{
+    // Nothing to do - the epoch is derived from the counter
+}
+
+//---------------------------------------------------------------------------
+uint32_t Profiler::GetEpoch()
+{
+    uint32_t u32Ret;
+    CS_ENTER();
+    u32Ret = (uint32_t)(Profiler_Sample() / TICKS_PER_OVERFLOW);
+    CS_EXIT();
+    return u32Ret;
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+
+    \file   kernelswi.cpp
+
+    \brief  Kernel Software interrupt implementation for POSIX hosts
+
+    The SWI is a pending flag serviced by the port's interrupt dispatcher
+    (see ThreadPort::EnableInts()) as soon as interrupts are enabled.
+*/
+
+#include "kerneltypes.h"
+#include "kernelswi.h"
+#include "threadport.h"
+
+//---------------------------------------------------------------------------
+volatile bool KernelSWI::m_bEnabled;
+volatile bool KernelSWI::m_bPending;
+
+//---------------------------------------------------------------------------
+void KernelSWI::Config(void)
+{
+    m_bEnabled = false;
+    m_bPending = false;
+}
+
+//---------------------------------------------------------------------------
+void KernelSWI::Start(void)
+{
+    m_bPending = false;
+    m_bEnabled = true;
+}
+
+//---------------------------------------------------------------------------
+void KernelSWI::Stop(void)
+{
+    m_bEnabled = false;
+}
+
+//---------------------------------------------------------------------------
+uint8_t KernelSWI::DI()
+{
+    bool bEnabled = m_bEnabled;
+    m_bEnabled = false;
+    return bEnabled;
+}
+
+//---------------------------------------------------------------------------
+void KernelSWI::RI(bool bEnable_)
+{
+    m_bEnabled = bEnable_;
+}
+
+//---------------------------------------------------------------------------
+void KernelSWI::Clear(void)
+{
+    m_bPending = false;
+}
+
+//---------------------------------------------------------------------------
+void KernelSWI::Trigger(void)
+{
+    // Raise the interrupt - if interrupts are enabled, it is taken as soon
+    // as the critical section is exited.
+    CS_ENTER();
+    m_bPending = true;
+    CS_EXIT();
+}
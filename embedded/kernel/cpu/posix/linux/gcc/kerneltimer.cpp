@@ -0,0 +1,308 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+
+    \file   kerneltimer.cpp
+
+    \brief  Kernel Timer Implementation for POSIX hosts
+
+    The timer counter is derived from CLOCK_MONOTONIC, and runs in clear-on-
+    compare mode - the counter is reduced by the compare value each time the
+    match is acknowledged.
+    The compare-match interrupt is raised by arming the process' real-time
+    interval timer to deliver SIGALRM at the time of the next match.  Every
+    change to the timer state re-arms the interval timer, so a SIGALRM may
+    arrive after the timer was reprogrammed - such signals are discarded by
+    Acknowledge().
+*/
+
+#include "kerneltypes.h"
+#include "kerneltimer.h"
+#include "mark3cfg.h"
+#include "timer.h"
+#include "threadport.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+//---------------------------------------------------------------------------
+#define TIMER_NS_PER_TICK       (1000000000ULL / TIMER_FREQ)
+
+//---------------------------------------------------------------------------
+static bool bInstalled;             //!< SIGALRM handler has been installed
+static bool bRunning;               //!< Counter enabled
+static bool bIntEnabled;            //!< Compare-match interrupt enabled
+static volatile bool bSignalled;    //!< SIGALRM received, not acknowledged
+static uint64_t u64Base;            //!< Host time (ns) at which the counter was 0
+static uint32_t u32Compare;         //!< Compare register
+
+//---------------------------------------------------------------------------
+static uint64_t KernelTimer_Now(void)
+{
+    struct timespec stNow;
+    clock_gettime(CLOCK_MONOTONIC, &stNow);
+    return ((uint64_t)stNow.tv_sec * 1000000000ULL) + stNow.tv_nsec;
+}
+
+//---------------------------------------------------------------------------
+/*!
+ *  \brief KernelTimer_Signal
+ *   SIGALRM handler - raises the timer interrupt, and services it right away
+ *   if interrupts are enabled.
+ */
+static void KernelTimer_Signal(int iSignal_)
+{
+    int iErrno = errno;
+
+    bSignalled = true;
+    if (ThreadPort::DisableInts())
+    {
+        ThreadPort::EnableInts();
+    }
+
+    errno = iErrno;
+}
+
+//---------------------------------------------------------------------------
+static void KernelTimer_Install(void)
+{
+    struct sigaction stAction;
+
+    // Handlers run on the stack of the interrupted thread, and may switch
+    // threads before returning.  SA_NODEFER keeps SIGALRM unblocked in that
+    // case; nesting is prevented by the virtual interrupt enable instead.
+    memset(&stAction, 0, sizeof(stAction));
+    stAction.sa_handler = KernelTimer_Signal;
+    stAction.sa_flags = SA_NODEFER | SA_RESTART;
+    sigemptyset(&stAction.sa_mask);
+    sigaction(SIGALRM, &stAction, NULL);
+
+    bInstalled = true;
+}
+
+//---------------------------------------------------------------------------
+static void KernelTimer_Arm(void)
+{
+    struct itimerval stTimer;
+    memset(&stTimer, 0, sizeof(stTimer));
+
+    if (!bInstalled)
+    {
+        KernelTimer_Install();
+    }
+
+    if (bRunning && bIntEnabled)
+    {
+        uint64_t u64Expiry = u64Base + ((uint64_t)u32Compare * TIMER_NS_PER_TICK);
+        uint64_t u64Now = KernelTimer_Now();
+        uint64_t u64Delay = 1;
+
+        if (u64Expiry > u64Now)
+        {
+            u64Delay = ((u64Expiry - u64Now) + 999) / 1000;
+        }
+
+        stTimer.it_value.tv_sec = u64Delay / 1000000;
+        stTimer.it_value.tv_usec = u64Delay % 1000000;
+    }
+
+    // A zero it_value disarms the timer
+    setitimer(ITIMER_REAL, &stTimer, NULL);
+}
+
+//---------------------------------------------------------------------------
+void KernelTimer::Config(void)
+{
+    if (!bInstalled)
+    {
+        KernelTimer_Install();
+    }
+}
+
+//---------------------------------------------------------------------------
+void KernelTimer::Start(void)
+{
+#if !KERNEL_TIMERS_TICKLESS
+    u32Compare = 1;
+#endif
+    u64Base = KernelTimer_Now();
+    bRunning = true;
+    bIntEnabled = true;
+    KernelTimer_Arm();
+}
+
+//---------------------------------------------------------------------------
+void KernelTimer::Stop(void)
+{
+#if KERNEL_TIMERS_TICKLESS
+    bRunning = false;
+    bIntEnabled = false;
+    u32Compare = 0;
+    KernelTimer_Arm();
+#endif
+}
+
+//---------------------------------------------------------------------------
+uint32_t KernelTimer::Read(void)
+{
+#if KERNEL_TIMERS_TICKLESS
+    if (!bRunning)
+    {
+        return 0;
+    }
+
+    uint64_t u64Ticks = (KernelTimer_Now() - u64Base) / TIMER_NS_PER_TICK;
+    if (u64Ticks > 0xFFFFFFFF)
+    {
+        u64Ticks = 0xFFFFFFFF;
+    }
+    return (uint32_t)u64Ticks;
+#else
+    return 0;
+#endif
+}
+
+//---------------------------------------------------------------------------
+uint32_t KernelTimer::SubtractExpiry(uint32_t u32Interval_)
+{
+#if KERNEL_TIMERS_TICKLESS
+    u32Compare -= u32Interval_;
+    KernelTimer_Arm();
+    return u32Compare;
+#else
+    return 0;
+#endif
+}
+
+//---------------------------------------------------------------------------
+uint32_t KernelTimer::TimeToExpiry(void)
+{
+#if KERNEL_TIMERS_TICKLESS
+    uint32_t u32Read = KernelTimer::Read();
+    if (u32Read >= u32Compare)
+    {
+        return 0;
+    }
+    return u32Compare - u32Read;
+#else
+    return 0;
+#endif
+}
+
+//---------------------------------------------------------------------------
+uint32_t KernelTimer::GetOvertime(void)
+{
+    return KernelTimer::Read();
+}
+
+//---------------------------------------------------------------------------
+uint32_t KernelTimer::SetExpiry(uint32_t u32Interval_)
+{
+#if KERNEL_TIMERS_TICKLESS
+    if (u32Interval_ > MAX_TIMER_TICKS)
+    {
+        u32Interval_ = MAX_TIMER_TICKS;
+    }
+    else if (!u32Interval_)
+    {
+        u32Interval_ = 1;
+    }
+    u32Compare = u32Interval_;
+    KernelTimer_Arm();
+    return u32Interval_;
+#else
+    return 0;
+#endif
+}
+
+//---------------------------------------------------------------------------
+void KernelTimer::ClearExpiry(void)
+{
+#if KERNEL_TIMERS_TICKLESS
+    u32Compare = MAX_TIMER_TICKS;
+    KernelTimer_Arm();
+#endif
+}
+
+//---------------------------------------------------------------------------
+uint8_t KernelTimer::DI(void)
+{
+    bool bEnabled = bIntEnabled;
+    bIntEnabled = false;
+    return bEnabled;
+}
+
+//---------------------------------------------------------------------------
+void KernelTimer::EI(void)
+{
+    KernelTimer::RI(1);
+}
+
+//---------------------------------------------------------------------------
+void KernelTimer::RI(bool bEnable_)
+{
+    bIntEnabled = bEnable_;
+    if (bEnable_)
+    {
+        // Re-arm, so that a match which occurred while the interrupt was
+        // disabled is raised right away.
+        KernelTimer_Arm();
+    }
+}
+
+//---------------------------------------------------------------------------
+bool KernelTimer::IsPending(void)
+{
+    return bSignalled;
+}
+
+//---------------------------------------------------------------------------
+bool KernelTimer::Acknowledge(void)
+{
+    if (!__atomic_exchange_n(&bSignalled, false, __ATOMIC_SEQ_CST))
+    {
+        return false;
+    }
+
+    if (!bRunning || !bIntEnabled || !u32Compare)
+    {
+        return false;
+    }
+
+    uint64_t u64Period = (uint64_t)u32Compare * TIMER_NS_PER_TICK;
+    uint64_t u64Now = KernelTimer_Now();
+    if (u64Now < (u64Base + u64Period))
+    {
+        // Stale signal, from before the timer was last reprogrammed.
+        KernelTimer_Arm();
+        return false;
+    }
+
+    // Compare-match: the counter is cleared and keeps counting from there.
+    // If the host kept us from servicing the match in time, the counter keeps
+    // the overshoot (read as overtime) rather than wrapping and losing it.
+    u64Base += u64Period;
+#if !KERNEL_TIMERS_TICKLESS
+    // Each missed tick remains pending until it has been serviced.
+    if (u64Now >= (u64Base + u64Period))
+    {
+        bSignalled = true;
+    }
+#endif
+    KernelTimer_Arm();
+    return true;
+}
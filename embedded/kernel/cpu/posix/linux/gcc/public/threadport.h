@@ -0,0 +1,169 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   threadport.h
+
+    \brief  POSIX (Linux host) multithreading support.
+
+    This port runs the kernel as a single native process.  Each Mark3 thread
+    is backed by a ucontext_t and a host-allocated stack, the kernel timer is
+    driven by SIGALRM, and the "interrupt enable" state is a software flag
+    owned by the port, which services pending timer and software interrupts
+    whenever interrupts are re-enabled.
+ */
+
+#ifndef __THREADPORT_H_
+#define __THREADPORT_H_
+
+#include "kerneltypes.h"
+#include "thread.h"
+
+//---------------------------------------------------------------------------
+//! ASM Macro - simplify the use of ASM directive in C
+#define ASM(x)      asm volatile(x);
+
+//---------------------------------------------------------------------------
+//! Macro to find the top of a stack given its size and top address
+#define TOP_OF_STACK(x, y)        (K_WORD*) ( ((K_ADDR)x) + (y - sizeof(K_WORD)) )
+//! Push a value y to the stack pointer x and decrement the stack pointer
+#define PUSH_TO_STACK(x, y)        *x = y; x--;
+#define STACK_GROWS_DOWN           (1)
+
+//---------------------------------------------------------------------------
+/*!
+ *  Size (in bytes) of the host stack backing each Mark3 thread.  The stack
+ *  passed to Thread::Init() is retained for bookkeeping only - native code
+ *  (and libc) needs far more stack than a typical embedded thread provides.
+ */
+#if !defined(POSIX_THREAD_STACK_SIZE)
+# define POSIX_THREAD_STACK_SIZE   (65536)
+#endif
+
+//------------------------------------------------------------------------
+//! These macros *must* be used in pairs !
+//------------------------------------------------------------------------
+//! Enter critical section (copy interrupt state, disable interrupts)
+#define CS_ENTER()    \
+{ \
+bool __x = ThreadPort::DisableInts();
+//------------------------------------------------------------------------
+//! Exit critical section (restore interrupt state)
+#define CS_EXIT() \
+ThreadPort::RestoreInts(__x); \
+}
+
+//------------------------------------------------------------------------
+//! Initiate a contex switch without using the SWI
+#define ENABLE_INTS()        ThreadPort::EnableInts();
+#define DISABLE_INTS()       ThreadPort::DisableInts();
+
+//------------------------------------------------------------------------
+class Thread;
+/*!
+ *  Class defining the architecture specific functions required by the 
+ *  kernel.  
+ *  
+ *  In addition to starting the scheduler and initializing a thread's
+ *  context, the POSIX port implements the processor's interrupt enable
+ *  state, and the dispatch of pending (virtual) interrupts.
+ */
+class ThreadPort
+{
+public:
+    /*!        
+     *  \brief StartThreads
+     *
+     *  Function to start the scheduler, initial threads, etc.
+     */
+    static void StartThreads();
+
+    /*!
+     *  \brief DisableInts
+     *
+     *  Disable interrupts.
+     *
+     *  \return true if interrupts were enabled prior to the call
+     */
+    static bool DisableInts(void)
+    {
+        return __atomic_exchange_n(&m_bIntEnabled, false, __ATOMIC_SEQ_CST);
+    }
+
+    /*!
+     *  \brief EnableInts
+     *
+     *  Enable interrupts, servicing any interrupts that became pending while
+     *  interrupts were disabled.  Must be called with interrupts disabled.
+     */
+    static void EnableInts(void);
+
+    /*!
+     *  \brief RestoreInts
+     *
+     *  Restore the interrupt state returned from a previous call to
+     *  DisableInts().
+     *
+     *  \param bEnable_ true - enable interrupts, false - leave disabled
+     */
+    static void RestoreInts(bool bEnable_)
+    {
+        if (bEnable_)
+        {
+            EnableInts();
+        }
+    }
+
+    /*!
+     *  \brief WaitForInterrupt
+     *
+     *  Suspend the host process until the next interrupt is raised, the
+     *  equivalent of putting the CPU into its idle sleep mode.  Intended to
+     *  be called from the kernel's idle function/thread, or from a tickless
+     *  idle state (with interrupts disabled).
+     */
+    static void WaitForInterrupt(void);
+
+    friend class Thread;
+private:
+
+    /*!
+     *  \brief InitStack
+     *
+     *  Initialize the thread's stack.
+     *  
+     *  \param pstThread_ Pointer to the thread to initialize
+     */
+    static void InitStack(Thread *pstThread_);
+
+    /*!
+     *  \brief ThreadEntry
+     *
+     *  Entry point for all newly-created thread contexts.  Enables
+     *  interrupts and calls the thread's entry function.
+     */
+    static void ThreadEntry(void);
+
+    /*!
+     *  \brief ContextSwitch
+     *
+     *  SWI handler - switch to the next thread, saving the host context of
+     *  the current thread.
+     */
+    static void ContextSwitch(void);
+
+    static volatile bool m_bIntEnabled;     //!< Global interrupt enable
+};
+
+#endif //__ThreadPORT_H_
@@ -0,0 +1,322 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+
+    \file   threadport.cpp   
+
+    \brief  POSIX (Linux host) Multithreading
+
+    Each thread runs on its own host stack, with its context held in a
+    ucontext_t.  Interrupts are virtual: the interrupt enable is a flag owned
+    by ThreadPort, while the kernel timer (SIGALRM) and the context switch SWI
+    each set a pending flag.  Pending interrupts are serviced in
+    ThreadPort::EnableInts(), which is called on leaving a critical section,
+    and directly from the SIGALRM handler if interrupts were enabled when the
+    signal arrived.
+
+    Context switches may therefore happen from within a signal handler.  This
+    is why the handler runs on the interrupted thread's stack (rather than on
+    an alternate signal stack, which can't be shared between threads), and
+    with SA_NODEFER (so SIGALRM isn't left blocked in the thread we switch to).
+*/
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+#include "thread.h"
+#include "threadport.h"
+#include "kernelswi.h"
+#include "kerneltimer.h"
+#include "timerlist.h"
+#include "quantum.h"
+#include "kernel.h"
+#include "kernelaware.h"
+
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+//---------------------------------------------------------------------------
+Thread *g_pclCurrentThread;
+
+volatile bool ThreadPort::m_bIntEnabled;
+
+//---------------------------------------------------------------------------
+/*!
+ *  Host execution context for a thread.  Contexts are allocated the first
+ *  time a Thread object is initialized, and are reused if it is initialized
+ *  again (i.e. threads that exit and are restarted).
+ */
+typedef struct _PosixContext_t
+{
+    struct _PosixContext_t *pstNext;    //!< Next context in the list
+    Thread      *pclThread;             //!< Thread that owns the context
+    ucontext_t  stContext;              //!< Saved host context
+    void        *pvStack;               //!< Host stack (above the guard page)
+    size_t      sStack;                 //!< Size of the host stack
+} PosixContext_t;
+
+static PosixContext_t *pstContextList;
+
+//---------------------------------------------------------------------------
+static PosixContext_t *ThreadPort_GetContext(Thread *pclThread_)
+{
+    PosixContext_t *pstContext = pstContextList;
+    while (pstContext)
+    {
+        if (pstContext->pclThread == pclThread_)
+        {
+            return pstContext;
+        }
+        pstContext = pstContext->pstNext;
+    }
+
+    // Allocate the stack, with an inaccessible guard page beneath it to trap
+    // overflows, and the context itself in the page above it.
+    size_t sPage = (size_t)sysconf(_SC_PAGESIZE);
+    size_t sStack = ((POSIX_THREAD_STACK_SIZE + sPage - 1) / sPage) * sPage;
+    uint8_t *pu8Map = (uint8_t*)mmap(NULL, sStack + (2 * sPage), PROT_READ | PROT_WRITE,
+                                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pu8Map == (uint8_t*)MAP_FAILED)
+    {
+        return NULL;
+    }
+    mprotect(pu8Map, sPage, PROT_NONE);
+
+    pstContext = (PosixContext_t*)(pu8Map + sPage + sStack);
+    pstContext->pclThread = pclThread_;
+    pstContext->pvStack = (void*)(pu8Map + sPage);
+    pstContext->sStack = sStack;
+    pstContext->pstNext = pstContextList;
+    pstContextList = pstContext;
+
+    return pstContext;
+}
+
+//---------------------------------------------------------------------------
+void ThreadPort::InitStack(Thread *pclThread_)
+{
+    PosixContext_t *pstContext;
+    uint16_t i;
+
+    // clear the stack, and initialize it to a known-default value.  The
+    // thread actually runs on a host stack, so this is only used for
+    // bookkeeping.  A recycled stack is still filled below the depth its
+    // last thread used.
+    for (i = pclThread_->GetStackClean() / sizeof(K_WORD); i < (pclThread_->m_u16StackSize / sizeof(K_WORD)); i++)
+    {
+        pclThread_->m_pwStack[i] = (K_WORD)(-1);
+    }
+
+    CS_ENTER();
+    pstContext = ThreadPort_GetContext(pclThread_);
+    CS_EXIT();
+
+    if (!pstContext)
+    {
+        // Host is out of memory
+        Kernel::Panic(PANIC_AUTO_HEAP_EXHAUSTED);
+    }
+
+    // The thread's context starts at the entry trampoline
+    getcontext(&pstContext->stContext);
+    pstContext->stContext.uc_stack.ss_sp = pstContext->pvStack;
+    pstContext->stContext.uc_stack.ss_size = pstContext->sStack;
+    pstContext->stContext.uc_link = NULL;
+    sigemptyset(&pstContext->stContext.uc_sigmask);
+    makecontext(&pstContext->stContext, ThreadPort::ThreadEntry, 0);
+
+    // The "top of stack" holds the thread's host context
+    pclThread_->m_pwStackTop = (K_WORD*)pstContext;
+}
+
+//---------------------------------------------------------------------------
+void ThreadPort::ThreadEntry(void)
+{
+    Thread *pclThread = g_pclCurrent;
+
+    // Threads are switched-in with interrupts disabled - enable them, as
+    // returning from the SWI would.
+    ThreadPort::EnableInts();
+
+    pclThread->m_pfEntryPoint(pclThread->m_pvArg);
+
+#if KERNEL_USE_DYNAMIC_THREADS
+    pclThread->Exit();
+#endif
+    while(1) {}
+}
+
+//---------------------------------------------------------------------------
+static void Thread_Switch(void)
+{
+#if KERNEL_USE_IDLE_FUNC
+    // If there's no next-thread-to-run...
+    if (g_pclNext == Kernel::GetIdleThread())
+    {
+#if KERNEL_USE_THREAD_STATS
+        ThreadStats::Switch(Kernel::GetIdleThread());
+#endif
+        g_pclCurrent = Kernel::GetIdleThread();
+
+        // Disable the SWI, and re-enable interrupts -- enter nested interrupt
+        // mode.
+        KernelSWI::DI();
+
+        // So long as there's no "next-to-run" thread, keep executing the Idle
+        // function to conclusion...
+
+        while (g_pclNext == Kernel::GetIdleThread())
+        {
+           // Ensure that we run this block in an interrupt enabled context (but
+           // with the rest of the checks being performed in an interrupt disabled
+           // context).
+           ENABLE_INTS();
+           Kernel::IdleFunc();
+           DISABLE_INTS();
+        }
+
+        // Progress has been achieved -- an interrupt-triggered event has caused
+        // the scheduler to run, and choose a new thread.  Since we've already
+        // saved the context of the thread we've hijacked to run idle, we can
+        // proceed to disable the nested interrupt context and switch to the
+        // new thread.
+
+        KernelSWI::RI( true );
+    }
+#endif
+#if KERNEL_USE_THREAD_STATS
+    ThreadStats::Switch((Thread*)g_pclNext);
+#endif
+    g_pclCurrent = (Thread*)g_pclNext;
+}
+
+//---------------------------------------------------------------------------
+void ThreadPort::ContextSwitch(void)
+{
+    Thread *pclPrevious = g_pclCurrent;
+
+    Thread_Switch();
+
+    if (pclPrevious != g_pclCurrent)
+    {
+        swapcontext(&((PosixContext_t*)pclPrevious->m_pwStackTop)->stContext,
+                    &((PosixContext_t*)g_pclCurrent->m_pwStackTop)->stContext);
+    }
+}
+
+//---------------------------------------------------------------------------
+/*!
+ *  \brief ThreadPort_TimerISR
+ *   Timer interrupt ISR - causes a tick, which may cause a context switch
+ */
+static void ThreadPort_TimerISR(void)
+{
+#if KERNEL_USE_TIMERS    
+    TimerScheduler::Process();
+#endif    
+#if KERNEL_USE_QUANTUM    
+    Quantum::UpdateTimer();
+#endif
+}
+
+//---------------------------------------------------------------------------
+void ThreadPort::EnableInts(void)
+{
+    do
+    {
+        // Service pending interrupts in priority order, with interrupts
+        // disabled (no nesting).
+        while (1)
+        {
+            if (KernelTimer::Acknowledge())
+            {
+                ThreadPort_TimerISR();
+            }
+            else if (KernelSWI::IsPending())
+            {
+                KernelSWI::Clear();
+                ContextSwitch();
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        __atomic_store_n(&m_bIntEnabled, true, __ATOMIC_SEQ_CST);
+
+        // Anything raised between the last check and enabling interrupts must
+        // be serviced before returning.
+    } while ((KernelTimer::IsPending() || KernelSWI::IsPending()) && DisableInts());
+}
+
+//---------------------------------------------------------------------------
+void ThreadPort::WaitForInterrupt(void)
+{
+    sigset_t stBlock;
+    sigset_t stPrevious;
+
+    sigemptyset(&stBlock);
+    sigaddset(&stBlock, SIGALRM);
+    sigprocmask(SIG_BLOCK, &stBlock, &stPrevious);
+
+    // A timer interrupt may already be pending if we were called with
+    // interrupts disabled (i.e. from a tickless idle state) - its signal has
+    // been and gone, so don't wait for another.
+    if (!KernelTimer::IsPending()
+#if KERNEL_USE_IDLE_FUNC
+        // When running the idle function, an interrupt may have been
+        // serviced before SIGALRM was blocked - only sleep if it didn't
+        // produce any work.  (An idle thread would have been switched out.)
+        && ((g_pclCurrent != Kernel::GetIdleThread()) ||
+            (g_pclNext == Kernel::GetIdleThread()))
+#endif
+        )
+    {
+        sigsuspend(&stPrevious);
+    }
+
+    sigprocmask(SIG_SETMASK, &stPrevious, NULL);
+}
+
+//---------------------------------------------------------------------------
+void ThreadPort::StartThreads()
+{
+    KernelSWI::Config();                 // configure the task switch SWI
+    KernelTimer::Config();               // configure the kernel timer
+    
+    Scheduler::SetScheduler(1);          // enable the scheduler
+    Scheduler::Schedule();               // run the scheduler - determine the first thread to run
+
+    Thread_Switch();                     // Set the next scheduled thread to the current thread
+
+    KernelTimer::Start();                // enable the kernel timer
+    KernelSWI::Start();                  // enable the task switch SWI
+
+#if KERNEL_USE_QUANTUM
+    // Restart the thread quantum timer, as any value held prior to starting
+    // the kernel will be invalid.  This fixes a bug where multiple threads
+    // started with the highest priority before starting the kernel causes problems
+    // until the running thread voluntarily blocks.
+    Quantum::RemoveThread();
+    Quantum::AddThread(g_pclCurrent);
+#endif
+
+    // Restore the context of the first running thread - interrupts are
+    // enabled once it starts.
+    m_bIntEnabled = false;
+    setcontext(&((PosixContext_t*)g_pclCurrent->m_pwStackTop)->stContext);
+}
@@ -36,6 +36,22 @@ See license.txt for more information
 
 #if KERNEL_USE_EVENTFLAG
 
+#if KERNEL_USE_EVENTFLAG_INDEX
+#include "bitscan.h"
+
+//---------------------------------------------------------------------------
+/*!
+ * \brief flag_index
+ *
+ * \param uXMask_ Bitmask to scan (non-zero)
+ * \return Index of the most-significant flag set
+ */
+static inline uint8_t flag_index(FLAG_TYPE uXMask_)
+{
+    return bitscan_msb(uXMask_) - 1;
+}
+#endif // KERNEL_USE_EVENTFLAG_INDEX
+
 #if KERNEL_USE_TIMEOUTS
 #include "timerlist.h"
 //---------------------------------------------------------------------------
@@ -72,6 +88,15 @@ EventFlag::~EventFlag()
     {
         Kernel::Panic(PANIC_ACTIVE_EVENTFLAG_DESCOPED);
     }
+#if KERNEL_USE_EVENTFLAG_INDEX
+    for (uint8_t i = 0; i < FLAG_BITS; i++)
+    {
+        if (m_aclWaitLists[i].GetHead())
+        {
+            Kernel::Panic(PANIC_ACTIVE_EVENTFLAG_DESCOPED);
+        }
+    }
+#endif
 }
 
 //---------------------------------------------------------------------------
@@ -83,16 +108,15 @@ void EventFlag::WakeMe(Thread *pclChosenOne_)
 
 //---------------------------------------------------------------------------
 #if KERNEL_USE_TIMEOUTS
-    uint16_t EventFlag::Wait_i(uint16_t u16Mask_, EventFlagOperation_t eMode_, uint32_t u32TimeMS_)
+    FLAG_TYPE EventFlag::Wait_i(FLAG_TYPE uXMask_, EventFlagOperation_t eMode_, uint32_t u32TimeMS_)
 #else
-    uint16_t EventFlag::Wait_i(uint16_t u16Mask_, EventFlagOperation_t eMode_)
+    FLAG_TYPE EventFlag::Wait_i(FLAG_TYPE uXMask_, EventFlagOperation_t eMode_)
 #endif
 {
     bool bThreadYield = false;
     bool bMatch = false;
 
 #if KERNEL_USE_TIMEOUTS
-    Timer clEventTimer;
     bool bUseTimer = false;
 #endif
 
@@ -102,26 +126,26 @@ void EventFlag::WakeMe(Thread *pclChosenOne_)
 
     // Check to see whether or not the current mask matches any of the
     // desired bits.
-    g_pclCurrent->SetEventFlagMask(u16Mask_);
+    g_pclCurrent->SetEventFlagMask(uXMask_);
 
     if ((eMode_ == EVENT_FLAG_ALL) || (eMode_ == EVENT_FLAG_ALL_CLEAR))
     {
         // Check to see if the flags in their current state match all of
         // the set flags in the event flag group, with this mask.
-        if ((m_u16SetMask & u16Mask_) == u16Mask_)
+        if ((m_uXSetMask & uXMask_) == uXMask_)
         {
             bMatch = true;
-            g_pclCurrent->SetEventFlagMask(u16Mask_);
+            g_pclCurrent->SetEventFlagMask(uXMask_);
         }
     }
     else if ((eMode_ == EVENT_FLAG_ANY) || (eMode_ == EVENT_FLAG_ANY_CLEAR))
     {
         // Check to see if the existing flags match any of the set flags in
         // the event flag group  with this mask
-        if (m_u16SetMask & u16Mask_)
+        if (m_uXSetMask & uXMask_)
         {
             bMatch = true;
-            g_pclCurrent->SetEventFlagMask(m_u16SetMask & u16Mask_);
+            g_pclCurrent->SetEventFlagMask(m_uXSetMask & uXMask_);
         }
     }
 
@@ -129,21 +153,23 @@ void EventFlag::WakeMe(Thread *pclChosenOne_)
     if (!bMatch)
     {
         // Reset the current thread's event flag mask & mode
-        g_pclCurrent->SetEventFlagMask(u16Mask_);
+        g_pclCurrent->SetEventFlagMask(uXMask_);
         g_pclCurrent->SetEventFlagMode(eMode_);
 
 #if KERNEL_USE_TIMEOUTS
         if (u32TimeMS_)
         {
-            g_pclCurrent->SetExpired(false);
-            clEventTimer.Init();
-            clEventTimer.Start(0, u32TimeMS_, TimedEventFlag_Callback, (void*)this);
+            g_pclCurrent->StartTimeout(u32TimeMS_, TimedEventFlag_Callback, (void*)this);
             bUseTimer = true;
         }
 #endif
 
         // Add the thread to the object's block-list.
+#if KERNEL_USE_EVENTFLAG_INDEX
+        BlockOn(g_pclCurrent, GetWaitList(uXMask_, eMode_));
+#else
         BlockPriority(g_pclCurrent);
+#endif
 
         // Trigger that
         bThreadYield = true;
@@ -168,7 +194,7 @@ void EventFlag::WakeMe(Thread *pclChosenOne_)
 #if KERNEL_USE_TIMEOUTS
     if (bUseTimer && bThreadYield)
     {
-        clEventTimer.Stop();
+        g_pclCurrent->StopTimeout();
     }
 #endif
 
@@ -176,161 +202,229 @@ void EventFlag::WakeMe(Thread *pclChosenOne_)
 }
 
 //---------------------------------------------------------------------------
-uint16_t EventFlag::Wait(uint16_t u16Mask_, EventFlagOperation_t eMode_)
+FLAG_TYPE EventFlag::Wait(FLAG_TYPE uXMask_, EventFlagOperation_t eMode_)
 {
 #if KERNEL_USE_TIMEOUTS
-    return Wait_i(u16Mask_, eMode_, 0);
+    return Wait_i(uXMask_, eMode_, 0);
 #else
-    return Wait_i(u16Mask_, eMode_);
+    return Wait_i(uXMask_, eMode_);
 #endif
 }
 
 #if KERNEL_USE_TIMEOUTS
 //---------------------------------------------------------------------------
-uint16_t EventFlag::Wait(uint16_t u16Mask_, EventFlagOperation_t eMode_, uint32_t u32TimeMS_)
+FLAG_TYPE EventFlag::Wait(FLAG_TYPE uXMask_, EventFlagOperation_t eMode_, uint32_t u32TimeMS_)
 {
-    return Wait_i(u16Mask_, eMode_, u32TimeMS_);
+    return Wait_i(uXMask_, eMode_, u32TimeMS_);
 }
 #endif
 
 //---------------------------------------------------------------------------
-void EventFlag::Set(uint16_t u16Mask_)
+void EventFlag::Set(FLAG_TYPE uXMask_)
 {
-    Thread *pclPrev;
-    Thread *pclCurrent;
     bool bReschedule = false;
-    uint16_t u16NewMask;
+    FLAG_TYPE uXNewMask;
 
     CS_ENTER();
 
-    // Walk through the whole block list, checking to see whether or not
-    // the current flag set now matches any/all of the masks and modes of
-    // the threads involved.
+    // Check the blocked threads against the new flag set, waking the threads
+    // whose conditions are met.
 
-    m_u16SetMask |= u16Mask_;
-    u16NewMask = m_u16SetMask;
+    m_uXSetMask |= uXMask_;
+    uXNewMask = m_uXSetMask;
 
-    // Start at the head of the list, and iterate through until we hit the
-    // "head" element in the list again.  Ensure that we handle the case where
-    // we remove the first or last elements in the list, or if there's only
-    // one element in the list.
-    pclCurrent = static_cast<Thread*>(m_clBlockList.GetHead());
+#if KERNEL_USE_EVENTFLAG_INDEX
+    // Only threads listed under one of the flags being set can be woken by
+    // them - skip the lists for all of the other flags.
+    FLAG_TYPE uXPending = uXMask_;
+    while (uXPending)
+    {
+        uint8_t u8Flag = flag_index(uXPending);
+        uXPending &= ~((FLAG_TYPE)1 << u8Flag);
+        if (WakeList(&m_aclWaitLists[u8Flag], uXMask_, &uXNewMask))
+        {
+            bReschedule = true;
+        }
+    }
+#endif
+
+    if (WakeList(&m_clBlockList, uXMask_, &uXNewMask))
+    {
+        bReschedule = true;
+    }
+
+    // If we awoke any threads, re-run the scheduler
+    if (bReschedule)
+    {
+        Thread::Yield();
+    }
+
+    // Update the bitmask based on any "clear" operations performed along
+    // the way
+    m_uXSetMask = uXNewMask;
+
+#if KERNEL_USE_WAITSET
+    // Let a wait-set containing this object check the remaining flags
+    if (m_uXSetMask)
+    {
+        SignalWaitSet();
+    }
+#endif
+
+    // Restore interrupts - will potentially cause a context switch if a
+    // thread is unblocked.
+    CS_EXIT();
+}
+
+//---------------------------------------------------------------------------
+bool EventFlag::WakeList(ThreadList *pclList_, FLAG_TYPE uXMask_, FLAG_TYPE *puXNewMask_)
+{
+    Thread *pclPrev;
+    Thread *pclCurrent;
+    Thread *pclTail;
+    bool bIsTail = false;
+    bool bWoken = false;
 
     // Do nothing when there are no objects blocking.
-    if (pclCurrent)
+    pclCurrent = static_cast<Thread*>(pclList_->GetHead());
+    if (!pclCurrent)
+    {
+        return false;
+    }
+
+    // Threads are only ever removed from this list as we go, so the tail
+    // captured here marks the end of the walk.  Every thread is checked
+    // against the same flag set - bits consumed by the "clear" variants are
+    // only removed from the object once all threads have been checked.
+    pclTail = static_cast<Thread*>(pclList_->GetTail());
+    do
     {
-        // First loop - process every thread in the block-list and check to
-        // see whether or not the current flags match the event-flag conditions
-        // on the thread.
-        do
+        pclPrev = pclCurrent;
+        pclCurrent = static_cast<Thread*>(pclCurrent->GetNext());
+        if (pclPrev == pclTail)
         {
-            pclPrev = pclCurrent;
-            pclCurrent = static_cast<Thread*>(pclCurrent->GetNext());
+            bIsTail = true;
+        }
 
-            // Read the thread's event mask/mode
-            uint16_t u16ThreadMask = pclPrev->GetEventFlagMask();
-            EventFlagOperation_t eThreadMode = pclPrev->GetEventFlagMode();
+        // Read the thread's event mask/mode
+        FLAG_TYPE uXThreadMask = pclPrev->GetEventFlagMask();
+        EventFlagOperation_t eThreadMode = pclPrev->GetEventFlagMode();
+        bool bMatch = false;
 
-            // For the "any" mode - unblock the blocked threads if one or more bits
-            // in the thread's bitmask match the object's bitmask
-            if ((EVENT_FLAG_ANY == eThreadMode) || (EVENT_FLAG_ANY_CLEAR == eThreadMode))
+        // For the "any" mode - unblock the blocked threads if one or more bits
+        // in the thread's bitmask match the object's bitmask
+        if ((EVENT_FLAG_ANY == eThreadMode) || (EVENT_FLAG_ANY_CLEAR == eThreadMode))
+        {
+            if (uXThreadMask & m_uXSetMask)
             {
-                if (u16ThreadMask & m_u16SetMask)
-                {
-                    pclPrev->SetEventFlagMode(EVENT_FLAG_PENDING_UNBLOCK);
-                    pclPrev->SetEventFlagMask(m_u16SetMask & u16ThreadMask);
-                    bReschedule = true;
-
-                    // If the "clear" variant is set, then clear the bits in the mask
-                    // that caused the thread to unblock.
-                    if (EVENT_FLAG_ANY_CLEAR == eThreadMode)
-                    {
-                        u16NewMask &=~ (u16ThreadMask & u16Mask_);
-                    }
-                }
+                bMatch = true;
+                pclPrev->SetEventFlagMask(m_uXSetMask & uXThreadMask);
+            }
+        }
+        // For the "all" mode, every set bit in the thread's requested bitmask must
+        // match the object's flag mask.
+        else if ((EVENT_FLAG_ALL == eThreadMode) || (EVENT_FLAG_ALL_CLEAR == eThreadMode))
+        {
+            if ((uXThreadMask & m_uXSetMask) == uXThreadMask)
+            {
+                bMatch = true;
             }
-            // For the "all" mode, every set bit in the thread's requested bitmask must
-            // match the object's flag mask.
-            else if ((EVENT_FLAG_ALL == eThreadMode) || (EVENT_FLAG_ALL_CLEAR == eThreadMode))
+#if KERNEL_USE_EVENTFLAG_INDEX
+            else
             {
-                if ((u16ThreadMask & m_u16SetMask) == u16ThreadMask)
+                // Still waiting on other flags - re-list the thread under one
+                // of those instead.
+                ThreadList *pclList = GetWaitList(uXThreadMask, eThreadMode);
+                if (pclList != pclList_)
                 {
-                    pclPrev->SetEventFlagMode(EVENT_FLAG_PENDING_UNBLOCK);
-                    pclPrev->SetEventFlagMask(u16ThreadMask);
-                    bReschedule = true;
-
-                    // If the "clear" variant is set, then clear the bits in the mask
-                    // that caused the thread to unblock.
-                    if (EVENT_FLAG_ALL_CLEAR == eThreadMode)
-                    {
-                        u16NewMask &=~ (u16ThreadMask & u16Mask_);
-                    }
+                    pclList_->Remove(pclPrev);
+                    pclList->Add(pclPrev);
+                    pclPrev->SetCurrent(pclList);
                 }
             }
+#endif
         }
-        // To keep looping, ensure that there's something in the list, and
-        // that the next item isn't the head of the list.
-        while (pclPrev != m_clBlockList.GetTail());
-
-        // Second loop - go through and unblock all of the threads that
-        // were tagged for unblocking.
-        pclCurrent = static_cast<Thread*>(m_clBlockList.GetHead());
-        bool bIsTail = false;
-        do
-        {
-            pclPrev = pclCurrent;
-            pclCurrent = static_cast<Thread*>(pclCurrent->GetNext());
 
-            // Check to see if this is the condition to terminate the loop
-            if (pclPrev == m_clBlockList.GetTail())
-            {
-                bIsTail = true;
-            }
-
-            // If the first pass indicated that this thread should be
-            // unblocked, then unblock the thread
-            if (pclPrev->GetEventFlagMode() == EVENT_FLAG_PENDING_UNBLOCK)
+        if (bMatch)
+        {
+            // If the "clear" variant is set, then clear the bits in the mask
+            // that caused the thread to unblock.
+            if ((EVENT_FLAG_ANY_CLEAR == eThreadMode) || (EVENT_FLAG_ALL_CLEAR == eThreadMode))
             {
-                UnBlock(pclPrev);
+                *puXNewMask_ &= ~(uXThreadMask & uXMask_);
             }
+            pclPrev->SetEventFlagMode(EVENT_FLAG_PENDING_UNBLOCK);
+            UnBlock(pclPrev);
+            bWoken = true;
         }
-        while (!bIsTail);
     }
+    while (!bIsTail);
 
-    // If we awoke any threads, re-run the scheduler
-    if (bReschedule)
+    return bWoken;
+}
+
+#if KERNEL_USE_EVENTFLAG_INDEX
+//---------------------------------------------------------------------------
+ThreadList *EventFlag::GetWaitList(FLAG_TYPE uXMask_, EventFlagOperation_t eMode_)
+{
+    FLAG_TYPE uXKey = 0;
+
+    if ((EVENT_FLAG_ALL == eMode_) || (EVENT_FLAG_ALL_CLEAR == eMode_))
     {
-        Thread::Yield();
+        // Can't be woken until all of the flags not yet set are set - any
+        // one of them will do as the key.
+        uXKey = uXMask_ & ~m_uXSetMask;
+    }
+    else if (uXMask_ && !(uXMask_ & (uXMask_ - 1)))
+    {
+        // Waiting on a single flag
+        uXKey = uXMask_;
     }
 
-    // Update the bitmask based on any "clear" operations performed along
-    // the way
-    m_u16SetMask = u16NewMask;
+    if (uXKey)
+    {
+        return &m_aclWaitLists[flag_index(uXKey)];
+    }
+    return &m_clBlockList;
+}
 
-    // Restore interrupts - will potentially cause a context switch if a
-    // thread is unblocked.
-    CS_EXIT();
+//---------------------------------------------------------------------------
+void EventFlag::BlockOn(Thread *pclThread_, ThreadList *pclList_)
+{
+    if (pclList_ == &m_clBlockList)
+    {
+        BlockPriority(pclThread_);
+        return;
+    }
+
+    // All matching threads are woken at once, so there's no need to keep
+    // the indexed lists in priority order.
+    Scheduler::Remove(pclThread_);
+    pclList_->Add(pclThread_);
+    pclThread_->SetCurrent(pclList_);
+    pclThread_->SetState(THREAD_STATE_BLOCKED);
 }
+#endif
 
 //---------------------------------------------------------------------------
-void EventFlag::Clear(uint16_t u16Mask_)
+void EventFlag::Clear(FLAG_TYPE uXMask_)
 {
     // Just clear the bitfields in the local object.
     CS_ENTER();
-    m_u16SetMask &= ~u16Mask_;
+    m_uXSetMask &= ~uXMask_;
     CS_EXIT();
 }
 
 //---------------------------------------------------------------------------
-uint16_t EventFlag::GetMask()
+FLAG_TYPE EventFlag::GetMask()
 {
     // Return the presently held event flag values in this object.  Ensure
     // we get this within a critical section to guarantee atomicity.
-    uint16_t u16Return;
+    FLAG_TYPE uXReturn;
     CS_ENTER();
-    u16Return = m_u16SetMask;
+    uXReturn = m_uXSetMask;
     CS_EXIT();
-    return u16Return;
+    return uXReturn;
 }
 
 #endif // KERNEL_USE_EVENTFLAG
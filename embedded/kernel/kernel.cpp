@@ -31,6 +31,9 @@ See license.txt for more information
 #include "profile.h"
 #include "kernelprofile.h"
 #include "autoalloc.h"
+#include "timerthread.h"
+#include "threadstats.h"
+#include "ticklessidle.h"
 
 #define _CAN_HAS_DEBUG
 //--[Autogenerated - Do Not Modify]------------------------------------------
@@ -86,12 +89,21 @@ void Kernel::Init(void)
 #if KERNEL_USE_TIMERS    
     TimerScheduler::Init();
 #endif
+#if KERNEL_USE_TIMER_THREAD
+    TimerThread::Init();
+#endif
 #if KERNEL_USE_MESSAGE    
     GlobalMessagePool::Init();
 #endif
 #if KERNEL_USE_PROFILER
 	Profiler::Init();
 #endif
+#if KERNEL_USE_THREAD_STATS
+    ThreadStats::Init();
+#endif
+#if KERNEL_USE_TICKLESS_IDLE
+    TicklessIdle::Init();
+#endif
 #if KERNEL_USE_STACK_GUARD
     m_u16GuardThreshold = KERNEL_STACK_GUARD_DEFAULT;
 #endif
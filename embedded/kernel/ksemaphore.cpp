@@ -119,6 +119,9 @@ void Semaphore::Init(uint16_t u16InitVal_, uint16_t u16MaxVal_)
     m_u16MaxValue = u16MaxVal_;    
 
     m_clBlockList.Init();
+#if KERNEL_USE_WAITSET
+    m_pclWaitSet = NULL;
+#endif
 }
 
 //---------------------------------------------------------------------------
@@ -141,6 +144,10 @@ bool Semaphore::Post()
         {
             // Increment the count value
             m_u16Value++;
+#if KERNEL_USE_WAITSET
+            // Wake a thread waiting on a wait-set containing this object
+            SignalWaitSet();
+#endif
         }
         else
         {
@@ -173,6 +180,54 @@ bool Semaphore::Post()
     return true;
 }
 
+//---------------------------------------------------------------------------
+bool Semaphore::PostN(uint16_t u16Count_)
+{
+    KERNEL_TRACE_2( "Posting semaphore %d times, Thread %d", u16Count_, (uint16_t)g_pclCurrent->GetID() );
+
+    bool bThreadWake = false;
+    bool bBail = false;
+
+    CS_ENTER();
+
+    // Hand counts directly to blocked threads first, highest priority first.
+    while (u16Count_ && m_clBlockList.GetHead())
+    {
+        if (WakeNext())
+        {
+            bThreadWake = true;
+        }
+        u16Count_--;
+    }
+
+    // Any remaining counts are added to the semaphore value, up to the max.
+    if (u16Count_)
+    {
+        if (u16Count_ > (m_u16MaxValue - m_u16Value))
+        {
+            u16Count_ = m_u16MaxValue - m_u16Value;
+            bBail = true;
+        }
+        m_u16Value += u16Count_;
+#if KERNEL_USE_WAITSET
+        if (u16Count_)
+        {
+            // Wake a thread waiting on a wait-set containing this object
+            SignalWaitSet();
+        }
+#endif
+    }
+
+    CS_EXIT();
+
+    // Switch once, after every count has been handed out.
+    if (bThreadWake)
+    {
+        Thread::Yield();
+    }
+    return !bBail;
+}
+
 //---------------------------------------------------------------------------
 #if KERNEL_USE_TIMEOUTS
 bool Semaphore::Pend_i( uint32_t u32WaitTimeMS_ )
@@ -183,7 +238,6 @@ void Semaphore::Pend_i( void )
     KERNEL_TRACE_1( "Pending semaphore, Thread %d", (uint16_t)g_pclCurrent->GetID() );
 
 #if KERNEL_USE_TIMEOUTS
-    Timer clSemTimer;
     bool bUseTimer = false;
 #endif
 
@@ -205,9 +259,7 @@ void Semaphore::Pend_i( void )
 #if KERNEL_USE_TIMEOUTS        
         if (u32WaitTimeMS_)
         {
-            g_pclCurrent->SetExpired(false);
-            clSemTimer.Init();
-            clSemTimer.Start(0, u32WaitTimeMS_, TimedSemaphore_Callback, (void*)this);
+            g_pclCurrent->StartTimeout(u32WaitTimeMS_, TimedSemaphore_Callback, (void*)this);
             bUseTimer = true;
         }
 #endif
@@ -222,8 +274,7 @@ void Semaphore::Pend_i( void )
 #if KERNEL_USE_TIMEOUTS
     if (bUseTimer)
     {
-        clSemTimer.Stop();
-        return (g_pclCurrent->GetExpired() == 0);
+        return g_pclCurrent->StopTimeout();
     }
     return true;
 #endif
@@ -258,4 +309,15 @@ uint16_t Semaphore::GetCount()
 	return u16Ret;
 }
 
+//---------------------------------------------------------------------------
+uint16_t Semaphore::TryPendN(uint16_t u16Max_)
+{
+    uint16_t u16Ret;
+    CS_ENTER();
+    u16Ret = (m_u16Value < u16Max_) ? m_u16Value : u16Max_;
+    m_u16Value -= u16Ret;
+    CS_EXIT();
+    return u16Ret;
+}
+
 #endif
@@ -171,15 +171,94 @@ bool Mailbox::SendTail( void *pvData_, uint32_t u32TimeoutMS_ )
 #endif
 
 //---------------------------------------------------------------------------
+void *Mailbox::ClaimSendSlot( MailboxSlot_t *pstSlot_ )
+{
+    KERNEL_ASSERT( pstSlot_ );
+
 #if KERNEL_USE_TIMEOUTS
-bool Mailbox::Send_i( const void *pvData_, bool bTail_, uint32_t u32TimeoutMS_)
+    return Claim_i( pstSlot_, false, 0 );
 #else
-bool Mailbox::Send_i( const void *pvData_, bool bTail_)
+    return Claim_i( pstSlot_, false );
+#endif
+}
+
+//---------------------------------------------------------------------------
+void *Mailbox::ClaimSendSlotTail( MailboxSlot_t *pstSlot_ )
+{
+    KERNEL_ASSERT( pstSlot_ );
+
+#if KERNEL_USE_TIMEOUTS
+    return Claim_i( pstSlot_, true, 0 );
+#else
+    return Claim_i( pstSlot_, true );
+#endif
+}
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+void *Mailbox::ClaimSendSlot( MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_ )
+{
+    KERNEL_ASSERT( pstSlot_ );
+    return Claim_i( pstSlot_, false, u32TimeoutMS_ );
+}
+
+//---------------------------------------------------------------------------
+void *Mailbox::ClaimSendSlotTail( MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_ )
+{
+    KERNEL_ASSERT( pstSlot_ );
+    return Claim_i( pstSlot_, true, u32TimeoutMS_ );
+}
+#endif
+
+//---------------------------------------------------------------------------
+void *Mailbox::PeekReceive( MailboxSlot_t *pstSlot_ )
+{
+    KERNEL_ASSERT( pstSlot_ );
+
+#if KERNEL_USE_TIMEOUTS
+    return Peek_i( pstSlot_, false, 0 );
+#else
+    return Peek_i( pstSlot_, false );
+#endif
+}
+
+//---------------------------------------------------------------------------
+void *Mailbox::PeekReceiveTail( MailboxSlot_t *pstSlot_ )
+{
+    KERNEL_ASSERT( pstSlot_ );
+
+#if KERNEL_USE_TIMEOUTS
+    return Peek_i( pstSlot_, true, 0 );
+#else
+    return Peek_i( pstSlot_, true );
+#endif
+}
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+void *Mailbox::PeekReceive( MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_ )
+{
+    KERNEL_ASSERT( pstSlot_ );
+    return Peek_i( pstSlot_, false, u32TimeoutMS_ );
+}
+
+//---------------------------------------------------------------------------
+void *Mailbox::PeekReceiveTail( MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_ )
+{
+    KERNEL_ASSERT( pstSlot_ );
+    return Peek_i( pstSlot_, true, u32TimeoutMS_ );
+}
+#endif
+
+//---------------------------------------------------------------------------
+#if KERNEL_USE_TIMEOUTS
+void *Mailbox::Claim_i( MailboxSlot_t *pstSlot_, bool bTail_, uint32_t u32TimeoutMS_)
+#else
+void *Mailbox::Claim_i( MailboxSlot_t *pstSlot_, bool bTail_)
 #endif
 {
-    const void *pvDst;
+    void *pvDst = NULL;
 
-    bool bRet = false;
     bool bSchedState = Scheduler::SetScheduler( false );
 
 #if KERNEL_USE_TIMEOUTS
@@ -213,7 +292,6 @@ bool Mailbox::Send_i( const void *pvData_, bool bTail_)
                 MoveHeadForward();
                 pvDst = GetHeadPointer();
             }
-            bRet = true;
 #if KERNEL_USE_TIMEOUTS
             bDone = true;
 #endif
@@ -236,37 +314,77 @@ bool Mailbox::Send_i( const void *pvData_, bool bTail_)
     }
 #endif
 
-    // Copy data to the claimed slot, and post the counting semaphore
-    if (bRet)
+    pstSlot_->pvData = pvDst;
+    if (!pvDst)
     {
-        CopyData( pvData_, pvDst, m_u16ElementSize );
+        Scheduler::SetScheduler( bSchedState );
+        return NULL;
     }
 
-    Scheduler::SetScheduler( bSchedState );
+    // Leave the scheduler disabled until the slot has been filled and
+    // committed, so no other thread can read from an incomplete envelope.
+    // The state to restore goes back to the caller rather than into the
+    // mailbox, as an ISR may claim (and commit) a slot of its own first.
+    pstSlot_->bSchedState = bSchedState;
+    return pvDst;
+}
+
+//---------------------------------------------------------------------------
+void Mailbox::CommitSend( MailboxSlot_t *pstSlot_ )
+{
+    KERNEL_ASSERT( pstSlot_ );
+    KERNEL_ASSERT( pstSlot_->pvData );
+
+    Scheduler::SetScheduler( pstSlot_->bSchedState );
+
+    // Post the counting semaphore to deliver the envelope
+    m_clRecvSem.Post();
+}
+
+//---------------------------------------------------------------------------
+#if KERNEL_USE_TIMEOUTS
+bool Mailbox::Send_i( const void *pvData_, bool bTail_, uint32_t u32TimeoutMS_)
+#else
+bool Mailbox::Send_i( const void *pvData_, bool bTail_)
+#endif
+{
+    MailboxSlot_t stSlot;
+    void *pvDst;
+
+#if KERNEL_USE_TIMEOUTS
+    pvDst = Claim_i( &stSlot, bTail_, u32TimeoutMS_ );
+#else
+    pvDst = Claim_i( &stSlot, bTail_ );
+#endif
 
-    if (bRet)
+    if (!pvDst)
     {
-        m_clRecvSem.Post();
+        return false;
     }
 
-    return bRet;
+    // Copy data to the claimed slot, and post the counting semaphore
+    CopyData( pvData_, pvDst, m_u16ElementSize );
+    CommitSend( &stSlot );
+
+    return true;
 }
 
 //---------------------------------------------------------------------------
 #if KERNEL_USE_TIMEOUTS
-bool Mailbox::Receive_i( const void *pvData_, bool bTail_, uint32_t u32WaitTimeMS_ )
+void *Mailbox::Peek_i( MailboxSlot_t *pstSlot_, bool bTail_, uint32_t u32WaitTimeMS_ )
 #else
-void Mailbox::Receive_i( const void *pvData_, bool bTail_ )
+void *Mailbox::Peek_i( MailboxSlot_t *pstSlot_, bool bTail_ )
 #endif
 {
-    const void *pvSrc;
+    void *pvSrc;
 
 #if KERNEL_USE_TIMEOUTS
     if (!m_clRecvSem.Pend( u32WaitTimeMS_ ))
     {
         // Failed to get the notification from the counting semaphore in the
         // time allotted.  Bail.
-        return false;
+        pstSlot_->pvData = NULL;
+        return NULL;
     }    
 #else
     m_clRecvSem.Pend();
@@ -274,14 +392,15 @@ void Mailbox::Receive_i( const void *pvData_, bool bTail_ )
 
     // Disable the scheduler while we do this -- this ensures we don't have
     // multiple concurrent readers off the same queue, which could be problematic
-    // if multiple writes occur during reads, etc.
-    bool bSchedState = Scheduler::SetScheduler( false );
+    // if multiple writes occur during reads, etc.  The scheduler remains
+    // disabled until the envelope is released.
+    pstSlot_->bSchedState = Scheduler::SetScheduler( false );
 
     // Update the head/tail indexes, and get the associated data pointer for
-    // the read operation.
+    // the read operation.  The slot isn't returned to the free count until
+    // it's released, so it can't be claimed by a sender in the meantime.
     CS_ENTER();
 
-    m_u16Free++;
     if (bTail_)
     {
         MoveTailForward();
@@ -295,14 +414,52 @@ void Mailbox::Receive_i( const void *pvData_, bool bTail_ )
 
     CS_EXIT();
 
-    CopyData( pvSrc, pvData_, m_u16ElementSize );
+    pstSlot_->pvData = pvSrc;
+    return pvSrc;
+}
+
+//---------------------------------------------------------------------------
+void Mailbox::ReleaseReceive( MailboxSlot_t *pstSlot_ )
+{
+    KERNEL_ASSERT( pstSlot_ );
+    KERNEL_ASSERT( pstSlot_->pvData );
+
+    CS_ENTER();
+    m_u16Free++;
+    CS_EXIT();
 
-    Scheduler::SetScheduler( bSchedState );
+    Scheduler::SetScheduler( pstSlot_->bSchedState );
 
 #if KERNEL_USE_TIMEOUTS
     // Unblock a thread waiting for a free slot to send to
     m_clSendSem.Post();
+#endif
+}
+
+//---------------------------------------------------------------------------
+#if KERNEL_USE_TIMEOUTS
+bool Mailbox::Receive_i( const void *pvData_, bool bTail_, uint32_t u32WaitTimeMS_ )
+#else
+void Mailbox::Receive_i( const void *pvData_, bool bTail_ )
+#endif
+{
+    MailboxSlot_t stSlot;
+    void *pvSrc;
+
+#if KERNEL_USE_TIMEOUTS
+    pvSrc = Peek_i( &stSlot, bTail_, u32WaitTimeMS_ );
+    if (!pvSrc)
+    {
+        return false;
+    }
+#else
+    pvSrc = Peek_i( &stSlot, bTail_ );
+#endif
 
+    CopyData( pvSrc, pvData_, m_u16ElementSize );
+    ReleaseReceive( &stSlot );
+
+#if KERNEL_USE_TIMEOUTS
     return true;
 #endif
 }
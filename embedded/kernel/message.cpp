@@ -43,6 +43,22 @@ See license.txt for more information
 	#include "timerlist.h"
 #endif
 
+#if KERNEL_USE_MESSAGE_PRIORITY
+#include "bitscan.h"
+
+//---------------------------------------------------------------------------
+/*!
+ * \brief class_index
+ *
+ * \param u8Map_ Class bitmap to scan (non-zero)
+ * \return Index of the highest non-empty class
+ */
+static inline uint8_t class_index(uint8_t u8Map_)
+{
+    return bitscan_msb(u8Map_) - 1;
+}
+#endif // KERNEL_USE_MESSAGE_PRIORITY
+
 Message GlobalMessagePool::m_aclMessagePool[GLOBAL_MESSAGE_POOL_SIZE];
 MessagePool GlobalMessagePool::m_clPool;
 
@@ -80,6 +96,47 @@ Message *MessagePool::Pop()
     return pclRet;
 }
 
+//---------------------------------------------------------------------------
+void MessagePool::PushN( Message **apclMessages_, uint16_t u16Count_ )
+{
+    uint16_t i;
+    KERNEL_ASSERT( apclMessages_ );
+
+    CS_ENTER();
+
+    for (i = 0; i < u16Count_; i++)
+    {
+        KERNEL_ASSERT( apclMessages_[i] );
+        m_clList.Add(apclMessages_[i]);
+    }
+
+    CS_EXIT();
+}
+
+//---------------------------------------------------------------------------
+uint16_t MessagePool::PopN( Message **apclMessages_, uint16_t u16Max_ )
+{
+    Message *pclMsg;
+    uint16_t u16Count = 0;
+    KERNEL_ASSERT( apclMessages_ );
+
+    CS_ENTER();
+
+    while (u16Count < u16Max_)
+    {
+        pclMsg = static_cast<Message*>( m_clList.GetHead() );
+        if (0 == pclMsg)
+        {
+            break;
+        }
+        m_clList.Remove( static_cast<LinkListNode*>( pclMsg ) );
+        apclMessages_[u16Count++] = pclMsg;
+    }
+
+    CS_EXIT();
+    return u16Count;
+}
+
 //------------------------------------------------------------------------
 Message *MessagePool::GetHead()
 {
@@ -110,6 +167,18 @@ Message *GlobalMessagePool::Pop()
     return m_clPool.Pop();
 }
 
+//---------------------------------------------------------------------------
+void GlobalMessagePool::PushN( Message **apclMessages_, uint16_t u16Count_ )
+{
+    m_clPool.PushN( apclMessages_, u16Count_ );
+}
+
+//---------------------------------------------------------------------------
+uint16_t GlobalMessagePool::PopN( Message **apclMessages_, uint16_t u16Max_ )
+{
+    return m_clPool.PopN( apclMessages_, u16Max_ );
+}
+
 //------------------------------------------------------------------------
 Message *GlobalMessagePool::GetHead()
 {
@@ -126,6 +195,47 @@ MessagePool *GlobalMessagePool::GetPool()
 void MessageQueue::Init() 
 { 
     m_clSemaphore.Init(0, GLOBAL_MESSAGE_POOL_SIZE);
+#if KERNEL_USE_MESSAGE_PRIORITY
+    for (uint8_t i = 0; i < KERNEL_MESSAGE_PRIORITY_CLASSES; i++)
+    {
+        m_aclLinkLists[i].Init();
+    }
+    m_u8ClassMap = 0;
+#endif
+}
+
+//---------------------------------------------------------------------------
+void MessageQueue::Enqueue_i( Message *pclMessage_ )
+{
+#if KERNEL_USE_MESSAGE_PRIORITY
+    uint8_t u8Class = pclMessage_->GetPriority();
+    KERNEL_ASSERT( u8Class < KERNEL_MESSAGE_PRIORITY_CLASSES );
+
+    m_aclLinkLists[u8Class].Add( pclMessage_ );
+    m_u8ClassMap |= (1 << u8Class);
+#else
+    m_clLinkList.Add( pclMessage_ );
+#endif
+}
+
+//---------------------------------------------------------------------------
+Message *MessageQueue::Dequeue_i()
+{
+    Message *pclRet;
+#if KERNEL_USE_MESSAGE_PRIORITY
+    uint8_t u8Class = class_index( m_u8ClassMap );
+
+    pclRet = static_cast<Message*>( m_aclLinkLists[u8Class].GetHead() );
+    m_aclLinkLists[u8Class].Remove( pclRet );
+    if (!m_aclLinkLists[u8Class].GetHead())
+    {
+        m_u8ClassMap &= ~(1 << u8Class);
+    }
+#else
+    pclRet = static_cast<Message*>( m_clLinkList.GetHead() );
+    m_clLinkList.Remove( pclRet );
+#endif
+    return pclRet;
 }
 
 //---------------------------------------------------------------------------
@@ -168,14 +278,69 @@ Message *MessageQueue::Receive_i( void )
 	CS_ENTER();
 	
 	// Pop the head of the message queue and return it
-	pclRet = static_cast<Message*>( m_clLinkList.GetHead() );
-	m_clLinkList.Remove(static_cast<Message*>(pclRet));
+	pclRet = Dequeue_i();
 	
 	CS_EXIT();
 	
 	return pclRet;	
 }
 
+//---------------------------------------------------------------------------
+uint16_t MessageQueue::ReceiveBatch( Message **apclDst_, uint16_t u16Max_ )
+{
+#if KERNEL_USE_TIMEOUTS
+    return ReceiveBatch_i( apclDst_, u16Max_, 0 );
+#else
+    return ReceiveBatch_i( apclDst_, u16Max_ );
+#endif
+}
+
+//---------------------------------------------------------------------------
+#if KERNEL_USE_TIMEOUTS
+uint16_t MessageQueue::ReceiveBatch( Message **apclDst_, uint16_t u16Max_, uint32_t u32TimeWaitMS_ )
+{
+    return ReceiveBatch_i( apclDst_, u16Max_, u32TimeWaitMS_ );
+}
+#endif
+
+//---------------------------------------------------------------------------
+#if KERNEL_USE_TIMEOUTS
+uint16_t MessageQueue::ReceiveBatch_i( Message **apclDst_, uint16_t u16Max_, uint32_t u32TimeWaitMS_ )
+#else
+uint16_t MessageQueue::ReceiveBatch_i( Message **apclDst_, uint16_t u16Max_ )
+#endif
+{
+    uint16_t u16Count;
+    uint16_t i;
+
+    KERNEL_ASSERT( apclDst_ );
+    KERNEL_ASSERT( u16Max_ );
+
+    // Block on the counting semaphore for the first message only
+#if KERNEL_USE_TIMEOUTS
+    if (!m_clSemaphore.Pend(u32TimeWaitMS_))
+    {
+        return 0;
+    }
+#else
+    m_clSemaphore.Pend();
+#endif
+
+    CS_ENTER();
+
+    // Claim whatever else is already queued, up to the caller's limit, and
+    // pop that many messages from the head of the queue.
+    u16Count = 1 + m_clSemaphore.TryPendN(u16Max_ - 1);
+    for (i = 0; i < u16Count; i++)
+    {
+        apclDst_[i] = Dequeue_i();
+    }
+
+    CS_EXIT();
+
+    return u16Count;
+}
+
 //---------------------------------------------------------------------------
 void MessageQueue::Send( Message *pclSrc_ )
 {
@@ -183,8 +348,8 @@ void MessageQueue::Send( Message *pclSrc_ )
 	
 	CS_ENTER();
 	
-	// Add the message to the head of the linked list
-	m_clLinkList.Add( pclSrc_ );
+	// Add the message to the tail of the linked list
+	Enqueue_i( pclSrc_ );
 		
 	// Post the semaphore, waking the blocking thread for the queue.
 	m_clSemaphore.Post();
@@ -192,6 +357,27 @@ void MessageQueue::Send( Message *pclSrc_ )
 	CS_EXIT();
 }
 
+//---------------------------------------------------------------------------
+void MessageQueue::SendBatch( Message **apclSrc_, uint16_t u16Count_ )
+{
+    uint16_t i;
+    KERNEL_ASSERT( apclSrc_ );
+
+    CS_ENTER();
+
+    // Queue the whole batch, in order
+    for (i = 0; i < u16Count_; i++)
+    {
+        KERNEL_ASSERT( apclSrc_[i] );
+        Enqueue_i( apclSrc_[i] );
+    }
+
+    // Account for every message with a single semaphore adjustment
+    m_clSemaphore.PostN( u16Count_ );
+
+    CS_EXIT();
+}
+
 //---------------------------------------------------------------------------
 uint16_t MessageQueue::GetCount()
 {
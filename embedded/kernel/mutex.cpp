@@ -22,6 +22,7 @@ See license.txt for more information
 
 #include "blocking.h"
 #include "mutex.h"
+#include "rwlock.h"
 
 #define _CAN_HAS_DEBUG
 //--[Autogenerated - Do Not Modify]------------------------------------------
@@ -55,10 +56,7 @@ void TimedMutex_Calback(Thread *pclOwner_, void *pvData_)
 {
 	Mutex *pclMutex = static_cast<Mutex*>(pvData_);
 		
-	// Indicate that the semaphore has expired on the thread
-	pclOwner_->SetExpired(true);
-		
-	// Wake up the thread that was blocked on this semaphore.
+	// Wake up the thread that was blocked on this mutex.
 	pclMutex->WakeMe(pclOwner_);
 		
     if (pclOwner_->GetCurPriority() >= Scheduler::GetCurrentThread()->GetCurPriority())
@@ -75,13 +73,37 @@ Mutex::~Mutex()
     {
         Kernel::Panic(PANIC_ACTIVE_MUTEX_DESCOPED);
     }
+
+    // A mutex can go out of scope while it's still held - make sure its
+    // owner isn't left pointing at it.
+    if (!m_bReady && m_pclOwner)
+    {
+        CS_ENTER();
+        Disown_i();
+        CS_EXIT();
+    }
 }
 
 //---------------------------------------------------------------------------
 void Mutex::WakeMe(Thread *pclOwner_)
 {
-	// Remove from the semaphore waitlist and back to its ready list.
-	UnBlock(pclOwner_);
+    CS_ENTER();
+
+    // The thread may have been handed the mutex just ahead of the timeout
+    if (pclOwner_->GetCurrent() == &m_clBlockList)
+    {
+        // Indicate that the mutex has expired on the thread
+        pclOwner_->SetExpired(true);
+
+        // Remove from the mutex waitlist and back to its ready list.
+        UnBlock(pclOwner_);
+        pclOwner_->m_pclWaitMutex = NULL;
+
+        // The owner may no longer need to run at this thread's priority
+        Update_i();
+    }
+
+    CS_EXIT();
 }
 
 #endif
@@ -96,9 +118,10 @@ uint8_t Mutex::WakeNext()
     
     // Unblock the thread
     UnBlock(pclChosenOne);
+    pclChosenOne->m_pclWaitMutex = NULL;
     
     // The chosen one now owns the mutex
-    m_pclOwner = pclChosenOne;
+    Own_i(pclChosenOne);
 
     // Signal a context switch if it's a greater than or equal to the current priority
     if (pclChosenOne->GetCurPriority() >= Scheduler::GetCurrentThread()->GetCurPriority())
@@ -108,16 +131,211 @@ uint8_t Mutex::WakeNext()
     return 0;
 }
 
+//---------------------------------------------------------------------------
+void Mutex::RecalcMax_i()
+{
+#if KERNEL_USE_MUTEX_CEILING
+    if (m_uXCeiling)
+    {
+        m_uXMaxPri = m_uXCeiling;
+        return;
+    }
+#endif
+
+    // The block list is kept in priority order - the head is the highest
+    // priority waiter.
+    Thread *pclWaiter = m_clBlockList.HighestWaiter();
+    if (pclWaiter)
+    {
+        m_uXMaxPri = pclWaiter->GetCurPriority();
+    }
+    else
+    {
+        m_uXMaxPri = 0;
+    }
+}
+
+//---------------------------------------------------------------------------
+void Mutex::Own_i(Thread *pclThread_)
+{
+    m_bReady = 0;
+    m_u8Recurse = 0;
+    m_pclOwner = pclThread_;
+
+    // Add the mutex to the thread's list of held mutexes
+    m_pclNextHeld = pclThread_->m_pclHeldMutex;
+    pclThread_->m_pclHeldMutex = this;
+
+    // Raise the new owner to the priority of the remaining waiters (or the
+    // mutex's ceiling).
+    RecalcMax_i();
+    if (m_uXMaxPri > pclThread_->GetCurPriority())
+    {
+        pclThread_->InheritPriority(m_uXMaxPri);
+    }
+}
+
+//---------------------------------------------------------------------------
+void Mutex::Disown_i()
+{
+    Mutex **ppclMutex = &m_pclOwner->m_pclHeldMutex;
+
+    // Mutexes are usually released in the reverse order they were claimed,
+    // so this is typically found at the head of the list.
+    while (*ppclMutex != this)
+    {
+        ppclMutex = &((*ppclMutex)->m_pclNextHeld);
+    }
+    *ppclMutex = m_pclNextHeld;
+    m_pclNextHeld = NULL;
+}
+
+//---------------------------------------------------------------------------
+PRIO_TYPE Mutex::InheritedPriority(Thread *pclThread_)
+{
+    PRIO_TYPE uXPriority = pclThread_->GetPriority();
+    Mutex *pclMutex = pclThread_->m_pclHeldMutex;
+
+    while (pclMutex)
+    {
+        if (pclMutex->m_uXMaxPri > uXPriority)
+        {
+            uXPriority = pclMutex->m_uXMaxPri;
+        }
+        pclMutex = pclMutex->m_pclNextHeld;
+    }
+#if KERNEL_USE_RWLOCK
+    uXPriority = RWLock::InheritedPriority(pclThread_, uXPriority);
+#endif
+    return uXPriority;
+}
+
+//---------------------------------------------------------------------------
+void Mutex::Update_i()
+{
+    Mutex *pclMutex = this;
+    Thread *pclOwner;
+    PRIO_TYPE uXPriority;
+    uint8_t u8Depth = 0;
+
+    // Follow the chain of owners that are themselves blocked on a mutex,
+    // adjusting each one's priority in turn.  The walk is bounded so that
+    // its cost is deterministic - and so that a deadlock can't spin here.
+    while (pclMutex && (u8Depth++ < KERNEL_MUTEX_INHERIT_DEPTH))
+    {
+        pclMutex->RecalcMax_i();
+
+        pclOwner = pclMutex->m_pclOwner;
+        uXPriority = InheritedPriority(pclOwner);
+        if (uXPriority == pclOwner->GetCurPriority())
+        {
+            break;
+        }
+
+        pclMutex = pclOwner->m_pclWaitMutex;
+        if (pclMutex)
+        {
+            // Keep the owner's place in the next mutex's block list in
+            // priority order.
+            pclMutex->m_clBlockList.Remove(pclOwner);
+            pclOwner->InheritPriority(uXPriority);
+            pclMutex->m_clBlockList.AddPriority(pclOwner);
+        }
+        else
+        {
+            pclOwner->InheritPriority(uXPriority);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+bool Mutex::Unlock_i()
+{
+    Thread *pclOwner = m_pclOwner;
+    PRIO_TYPE uXPriority;
+    bool bSchedule = false;
+
+    // Restore the thread's original priority - or whatever it has inherited
+    // through the other mutexes it still holds.
+    Disown_i();
+    uXPriority = InheritedPriority(pclOwner);
+    if (pclOwner->GetCurPriority() != uXPriority)
+    {
+        pclOwner->InheritPriority(uXPriority);
+
+        // In this case, we want to reschedule
+        bSchedule = true;
+    }
+
+    // No threads are waiting on this mutex?
+    if (m_clBlockList.GetHead() == NULL)
+    {
+        // Re-initialize the mutex to its default values
+        m_bReady = 1;
+        m_uXMaxPri = 0;
+        m_pclOwner = NULL;
+    }
+    // Wake the highest priority Thread pending on the mutex
+    else if (WakeNext())
+    {
+        bSchedule = true;
+    }
+    return bSchedule;
+}
+
+#if KERNEL_USE_CONDVAR
+//---------------------------------------------------------------------------
+bool Mutex::Handoff_i(Thread *pclThread_)
+{
+    if (m_bReady != 0)
+    {
+        // Mutex is free - wake the thread, and claim it on the thread's behalf.
+        UnBlock(pclThread_);
+        Own_i(pclThread_);
+        return (pclThread_->GetCurPriority() >= Scheduler::GetCurrentThread()->GetCurPriority());
+    }
+
+    // Mutex is claimed - move the (already blocked) thread straight from the
+    // list it's waiting on to this mutex's block list.
+    pclThread_->GetCurrent()->Remove(pclThread_);
+    m_clBlockList.AddPriority(pclThread_);
+    pclThread_->SetCurrent(&m_clBlockList);
+    pclThread_->m_pclWaitMutex = this;
+
+#if KERNEL_USE_MUTEX_CEILING
+    if (!m_uXCeiling)
+#endif
+    {
+        Update_i();
+    }
+    return false;
+}
+#endif
+
 //---------------------------------------------------------------------------
 void Mutex::Init()
 {
     // Reset the data in the mutex
+    m_clBlockList.Init();
     m_bReady = 1;             // The mutex is free.
-    m_u8MaxPri = 0;           // Set the maximum priority inheritence state
+    m_uXMaxPri = 0;           // Set the maximum priority inheritence state
     m_pclOwner = NULL;        // Clear the mutex owner
     m_u8Recurse = 0;          // Reset recurse count
+    m_pclNextHeld = NULL;
+#if KERNEL_USE_MUTEX_CEILING
+    m_uXCeiling = 0;          // Use priority inheritence
+#endif
 }
 
+#if KERNEL_USE_MUTEX_CEILING
+//---------------------------------------------------------------------------
+void Mutex::Init(PRIO_TYPE uXCeiling_)
+{
+    Init();
+    m_uXCeiling = uXCeiling_;
+}
+#endif
+
 //---------------------------------------------------------------------------
 #if KERNEL_USE_TIMEOUTS
 bool Mutex::Claim_i(uint32_t u32WaitTimeMS_)
@@ -127,95 +345,76 @@ void Mutex::Claim_i(void)
 {
     KERNEL_TRACE_1( "Claiming Mutex, Thread %d", (uint16_t)g_pclCurrent->GetID() );
 
+    bool bBlock = false;
 #if KERNEL_USE_TIMEOUTS
-    Timer clTimer;
     bool bUseTimer = false;
 #endif
 
-    // Disable the scheduler while claiming the mutex - we're dealing with all
-    // sorts of private thread data, can't have a thread switch while messing
-    // with internal data structures.
-    Scheduler::SetScheduler(0);
+    // We're dealing with all sorts of private thread data (including that of
+    // other threads, when inheriting priority), can't have a thread switch
+    // or a timeout while messing with internal data structures.
+    CS_ENTER();
+
+#if KERNEL_USE_MUTEX_CEILING
+    // Threads claiming a ceiling mutex must not have a higher priority than
+    // the ceiling itself
+    KERNEL_ASSERT( (!m_uXCeiling || (g_pclCurrent->GetPriority() <= m_uXCeiling)) );
+#endif
 
     // Check to see if the mutex is claimed or not
     if (m_bReady != 0)
     {
-        // Mutex isn't claimed, claim it.
-        m_bReady = 0;
-        m_u8Recurse = 0;
-        m_u8MaxPri = g_pclCurrent->GetPriority();
-        m_pclOwner = g_pclCurrent;
-
-        Scheduler::SetScheduler(1);
-
-#if KERNEL_USE_TIMEOUTS
-        return true;
-#else
-        return;
-#endif
+        // Mutex isn't claimed, claim it.  In ceiling mode, this immediately
+        // raises us to the ceiling priority.
+        Own_i(g_pclCurrent);
     }
-
     // If the mutex is already claimed, check to see if this is the owner thread,
     // since we allow the mutex to be claimed recursively.
-    if (g_pclCurrent == m_pclOwner)
+    else if (g_pclCurrent == m_pclOwner)
     {
         // Ensure that we haven't exceeded the maximum recursive-lock count
         KERNEL_ASSERT( (m_u8Recurse < 255) );
         m_u8Recurse++;
-
-        // Increment the lock count and bail
-        Scheduler::SetScheduler(1);
-#if KERNEL_USE_TIMEOUTS
-        return true;
-#else
-        return;
-#endif
     }
-
-    // The mutex is claimed already - we have to block now.  Move the
-    // current thread to the list of threads waiting on the mutex.
-#if KERNEL_USE_TIMEOUTS
-    if (u32WaitTimeMS_)
+    else
     {
-        g_pclCurrent->SetExpired(false);
-        clTimer.Init();
-        clTimer.Start(0, u32WaitTimeMS_, (TimerCallback_t)TimedMutex_Calback, (void*)this);
-        bUseTimer = true;
-    }
+        // The mutex is claimed already - we have to block now.  Move the
+        // current thread to the list of threads waiting on the mutex.
+#if KERNEL_USE_TIMEOUTS
+        if (u32WaitTimeMS_)
+        {
+            g_pclCurrent->StartTimeout(u32WaitTimeMS_, (TimerCallback_t)TimedMutex_Calback, (void*)this);
+            bUseTimer = true;
+        }
+#endif
+        BlockPriority(g_pclCurrent);
+        g_pclCurrent->m_pclWaitMutex = this;
+
+        // Check if priority inheritence is necessary.  We do this in order
+        // to ensure that we don't end up with priority inversions in case
+        // multiple threads are waiting on the same resource.  Ceiling mutexes
+        // never need to - the owner is already running at the ceiling.
+#if KERNEL_USE_MUTEX_CEILING
+        if (!m_uXCeiling)
 #endif
-    BlockPriority(g_pclCurrent);
-
-    // Check if priority inheritence is necessary.  We do this in order
-    // to ensure that we don't end up with priority inversions in case
-    // multiple threads are waiting on the same resource.
-    if(m_u8MaxPri <= g_pclCurrent->GetPriority())
-    {
-        m_u8MaxPri = g_pclCurrent->GetPriority();
-
-        Thread *pclTemp = static_cast<Thread*>(m_clBlockList.GetHead());
-        while(pclTemp)
         {
-            pclTemp->InheritPriority(m_u8MaxPri);
-            if(pclTemp == static_cast<Thread*>(m_clBlockList.GetTail()) )
-            {
-                break;
-            }
-            pclTemp = static_cast<Thread*>(pclTemp->GetNext());
+            Update_i();
         }
-        m_pclOwner->InheritPriority(m_u8MaxPri);
+        bBlock = true;
     }
 
-    // Done with thread data -reenable the scheduler
-    Scheduler::SetScheduler(1);
+    CS_EXIT();
 
-    // Switch threads if this thread acquired the mutex
-    Thread::Yield();
+    if (bBlock)
+    {
+        // Switch threads if this thread acquired the mutex
+        Thread::Yield();
+    }
 
 #if KERNEL_USE_TIMEOUTS
     if (bUseTimer)
     {
-        clTimer.Stop();
-        return (g_pclCurrent->GetExpired() == 0);
+        return g_pclCurrent->StopTimeout();
     }
     return true;
 #endif
@@ -246,8 +445,7 @@ void Mutex::Release()
 
     bool bSchedule = 0;
 
-    // Disable the scheduler while we deal with internal data structures.
-    Scheduler::SetScheduler(0);
+    CS_ENTER();
 
     // This thread had better be the one that owns the mutex currently...
     KERNEL_ASSERT( (g_pclCurrent == m_pclOwner) );
@@ -257,39 +455,16 @@ void Mutex::Release()
     if (m_u8Recurse)
     {
         m_u8Recurse--;
-        Scheduler::SetScheduler(1);
-        return;
     }
-
-    // Restore the thread's original priority
-    if (g_pclCurrent->GetCurPriority() != g_pclCurrent->GetPriority())
+    // Drop any inherited priority, and hand the mutex to the next waiter
+    else if (Unlock_i())
     {
-        g_pclCurrent->SetPriority(g_pclCurrent->GetPriority());
-        
-        // In this case, we want to reschedule
+        // Switch threads if it's higher or equal priority than the current thread
         bSchedule = 1;
     }
 
-    // No threads are waiting on this semaphore?
-    if (m_clBlockList.GetHead() == NULL)
-    {
-        // Re-initialize the mutex to its default values
-        m_bReady = 1;
-        m_u8MaxPri = 0;
-        m_pclOwner = NULL;
-    }
-    else
-    {
-        // Wake the highest priority Thread pending on the mutex
-        if(WakeNext())
-        {
-            // Switch threads if it's higher or equal priority than the current thread
-            bSchedule = 1;
-        }
-    }
+    CS_EXIT();
 
-    // Must enable the scheduler again in order to switch threads.
-    Scheduler::SetScheduler(1);
     if(bSchedule)
     {
         // Switch threads if a higher-priority thread was woken
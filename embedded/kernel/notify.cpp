@@ -70,6 +70,9 @@ Notify::~Notify()
 void Notify::Init(void)
 {
     m_clBlockList.Init();
+#if KERNEL_USE_WAITSET
+    m_pclWaitSet = NULL;
+#endif
 }
 
 //---------------------------------------------------------------------------
@@ -89,6 +92,10 @@ void Notify::Signal(void)
         }
         pclCurrent = (Thread*)m_clBlockList.GetHead();
     }
+#if KERNEL_USE_WAITSET
+    // Latch the signal in a wait-set containing this object
+    SignalWaitSet();
+#endif
     CS_EXIT();
 
     if (bReschedule)
@@ -120,16 +127,12 @@ void Notify::Wait( bool *pbFlag_ )
 bool Notify::Wait( uint32_t u32WaitTimeMS_, bool *pbFlag_ )
 {
     bool bUseTimer = false;
-    Timer clNotifyTimer;
 
     CS_ENTER();
     if (u32WaitTimeMS_)
     {
         bUseTimer = true;
-        g_pclCurrent->SetExpired(false);
-
-        clNotifyTimer.Init();
-        clNotifyTimer.Start(0, u32WaitTimeMS_, TimedNotify_Callback, (void*)this);
+        g_pclCurrent->StartTimeout(u32WaitTimeMS_, TimedNotify_Callback, (void*)this);
     }
 
     Block(g_pclCurrent);
@@ -144,8 +147,7 @@ bool Notify::Wait( uint32_t u32WaitTimeMS_, bool *pbFlag_ )
 
     if (bUseTimer)
     {
-        clNotifyTimer.Stop();
-        return (g_pclCurrent->GetExpired() == 0);
+        return g_pclCurrent->StopTimeout();
     }
 
     if (pbFlag_)
@@ -0,0 +1,122 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   periodictimer.cpp
+
+    \brief  Drift-free periodic wakeup object implementation
+*/
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#include "thread.h"
+#include "timer.h"
+#include "timerscheduler.h"
+#include "ksemaphore.h"
+#include "periodictimer.h"
+#include "threadport.h"
+
+#define _CAN_HAS_DEBUG
+//--[Autogenerated - Do Not Modify]------------------------------------------
+#include "dbg_file_list.h"
+#include "buffalogger.h"
+#if defined(DBG_FILE)
+# error "Debug logging file token already defined!  Bailing."
+#else
+# define DBG_FILE _DBG___KERNEL_PERIODICTIMER_CPP
+#endif
+//--[End Autogenerated content]----------------------------------------------
+#include "kerneldebug.h"
+
+#if KERNEL_USE_MONOTONIC_TIME
+
+//---------------------------------------------------------------------------
+void PeriodicTimer::Init()
+{
+    m_clTimer.Init();
+    m_clSemaphore.Init(0, 1);
+    m_u32Pending = 0;
+    m_u32Total = 0;
+}
+
+//---------------------------------------------------------------------------
+void PeriodicTimer::Start(uint32_t u32PeriodMs_)
+{
+    Stop();
+
+    m_clTimer.Init();
+    m_clTimer.Start(true, u32PeriodMs_, 0, TimerCallback, (void*)this);
+}
+
+//---------------------------------------------------------------------------
+void PeriodicTimer::StartTicks(uint32_t u32Ticks_)
+{
+    Stop();
+
+    m_clTimer.Init();
+    m_clTimer.SetIntervalTicks(u32Ticks_);
+    m_clTimer.SetCallback(TimerCallback);
+    m_clTimer.SetData((void*)this);
+    m_clTimer.Start();
+}
+
+//---------------------------------------------------------------------------
+void PeriodicTimer::Stop()
+{
+    m_clTimer.Stop();
+
+    CS_ENTER();
+    m_u32Pending = 0;
+    m_u32Total = 0;
+    CS_EXIT();
+
+    // Drain any wakeup posted before the timer was stopped
+    while (m_clSemaphore.GetCount())
+    {
+        m_clSemaphore.Pend();
+    }
+}
+
+//---------------------------------------------------------------------------
+uint32_t PeriodicTimer::Wait()
+{
+    uint32_t u32Elapsed = 0;
+
+    while (!u32Elapsed)
+    {
+        CS_ENTER();
+        u32Elapsed = m_u32Pending;
+        m_u32Pending = 0;
+        CS_EXIT();
+
+        if (!u32Elapsed)
+        {
+            m_clSemaphore.Pend();
+        }
+    }
+    return u32Elapsed;
+}
+
+//---------------------------------------------------------------------------
+void PeriodicTimer::TimerCallback(Thread *pclOwner_, void *pvData_)
+{
+    PeriodicTimer *pclThis = static_cast<PeriodicTimer*>(pvData_);
+
+    pclThis->m_u32Pending++;
+    pclThis->m_u32Total++;
+    pclThis->m_clSemaphore.Post();
+}
+
+#endif // KERNEL_USE_MONOTONIC_TIME
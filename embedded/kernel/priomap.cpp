@@ -18,27 +18,29 @@ See license.txt for more information
 
 #include "mark3.h"
 #include "priomap.h"
+#include "bitscan.h"
 
 #include <stdint.h>
 #include <stdbool.h>
 
+#if !(defined(HW_CLZ) && HW_CLZ) && \
+    (defined(__AVR__) || defined(__MSP430__) || defined(__ARM_ARCH_6M__))
 //---------------------------------------------------------------------------
-static uint8_t priority_from_bitmap( PRIO_TYPE uXPrio_ )
+// Nibble lookup table used by bitscan_msb() on targets without a CLZ
+const uint8_t g_au8BitscanLUT[16] =
 {
-    PRIO_TYPE uXMask =  (1 << (PRIO_MAP_BITS - 1));
-    uint8_t u8Zeros = 0;
-
-    while (uXMask)
-    {
-        if (uXMask & uXPrio_)
-        {
-            return (PRIO_MAP_BITS - u8Zeros);
-        }
+    0, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4
+};
+#endif
 
-        uXMask >>= 1;
-        u8Zeros++;
-    }
-    return 0;
+//---------------------------------------------------------------------------
+/*
+    priority_from_bitmap() returns the 1-based index of the most significant
+    bit set in a priority map word, or 0 if no bits are set.
+*/
+static inline uint8_t priority_from_bitmap( PRIO_MAP_WORD_TYPE uXPrio_ )
+{
+    return bitscan_msb( uXPrio_ );
 }
 
 //---------------------------------------------------------------------------
@@ -62,10 +64,10 @@ void PriorityMap::Set( PRIO_TYPE uXPrio_ )
 #if PRIO_MAP_MULTI_LEVEL
     PRIO_TYPE uXWordIdx = PRIO_MAP_WORD_INDEX( uXPrio_ );
 
-    m_auXPriorityMap[ uXWordIdx ] |= (1 << uXPrioBit);
-    m_uXPriorityMapL2 |= (1 << uXWordIdx);
+    m_auXPriorityMap[ uXWordIdx ] |= ((PRIO_MAP_WORD_TYPE)1 << uXPrioBit);
+    m_uXPriorityMapL2 |= ((PRIO_MAP_WORD_TYPE)1 << uXWordIdx);
 #else
-    m_uXPriorityMap   |= (1 << uXPrioBit);
+    m_uXPriorityMap   |= ((PRIO_MAP_WORD_TYPE)1 << uXPrioBit);
 #endif
 }
 
@@ -76,13 +78,13 @@ void PriorityMap::Clear( PRIO_TYPE uXPrio_ )
 #if PRIO_MAP_MULTI_LEVEL
     PRIO_TYPE uXWordIdx = PRIO_MAP_WORD_INDEX( uXPrio_ );
 
-    m_auXPriorityMap[ uXWordIdx ] &= ~(1 << uXPrioBit);
+    m_auXPriorityMap[ uXWordIdx ] &= ~((PRIO_MAP_WORD_TYPE)1 << uXPrioBit);
     if (!m_auXPriorityMap[ uXWordIdx ])
     {
-        m_uXPriorityMapL2 &= ~(1 << uXWordIdx);
+        m_uXPriorityMapL2 &= ~((PRIO_MAP_WORD_TYPE)1 << uXWordIdx);
     }
 #else
-    m_uXPriorityMap   &= ~(1 << uXPrioBit);
+    m_uXPriorityMap   &= ~((PRIO_MAP_WORD_TYPE)1 << uXPrioBit);
 #endif
 }
 
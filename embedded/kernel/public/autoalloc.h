@@ -23,6 +23,7 @@ See license.txt for more information
 #include <stdint.h>
 #include <stdbool.h>
 #include "mark3cfg.h"
+#include "kerneltypes.h"
 
 #if KERNEL_USE_AUTO_ALLOC
 // Forward declaration of kernel objects that can be auotomatically allocated.
@@ -58,6 +59,99 @@ class Thread;
 class Timer;
 #endif
 
+//---------------------------------------------------------------------------
+/*!
+ *  Types of kernel object with their own pool in the auto allocator.
+ */
+typedef enum
+{
+    AUTO_ALLOC_TYPE_SEMAPHORE,
+    AUTO_ALLOC_TYPE_MUTEX,
+    AUTO_ALLOC_TYPE_EVENTFLAG,
+    AUTO_ALLOC_TYPE_MESSAGE,
+    AUTO_ALLOC_TYPE_MESSAGEQUEUE,
+    AUTO_ALLOC_TYPE_NOTIFY,
+    AUTO_ALLOC_TYPE_MAILBOX,
+    AUTO_ALLOC_TYPE_THREAD,
+    AUTO_ALLOC_TYPE_TIMER,
+//---
+    AUTO_ALLOC_TYPE_COUNT
+} AutoAllocType_t;
+
+//---------------------------------------------------------------------------
+/*!
+ *  Snapshot of the usage of a typed object pool, as returned by
+ *  AutoAlloc::GetPoolStats().
+ */
+typedef struct
+{
+    uint16_t u16Reserved;   //!< Objects reserved for the type in mark3cfg.h
+    uint16_t u16Objects;    //!< Objects created so far, reserved or from the heap
+    uint16_t u16InUse;      //!< Objects currently allocated
+    uint16_t u16Peak;       //!< Largest number of objects allocated at once
+    uint32_t u32Allocs;     //!< Number of objects allocated
+    uint32_t u32Frees;      //!< Number of objects destroyed
+} AutoAllocStats_t;
+
+//---------------------------------------------------------------------------
+/*!
+ *  A pool of fixed-size objects of a single type.  Destroyed objects are
+ *  kept on a free list, and handed out again before any new memory is
+ *  used - first from the type's reserved storage, then from the auto
+ *  allocator's heap.
+ */
+class AutoAllocPool
+{
+public:
+    /*!
+     * \brief Init
+     *
+     * Initialize the pool prior to use.
+     *
+     * \param pvBuffer_ Storage reserved for the pool's objects, or 0
+     * \param u16Size_ Size of each object, in bytes
+     * \param u16Reserved_ Number of objects that fit in pvBuffer_
+     */
+    void Init( void *pvBuffer_, uint16_t u16Size_, uint16_t u16Reserved_ );
+
+    /*!
+     * \brief Alloc
+     *
+     * Take an object from the pool.  Panics with PANIC_AUTO_HEAP_EXHAUSTED
+     * if there are no free objects, and no room in the heap for another.
+     *
+     * \return Pointer to the object's (uninitialized) memory, or 0 if the
+     *         heap is exhausted
+     */
+    void *Alloc( void );
+
+    /*!
+     * \brief Free
+     *
+     * Return an object, previously taken from this pool, to the pool.
+     *
+     * \param pvObj_ Pointer to the object
+     */
+    void Free( void *pvObj_ );
+
+    /*!
+     * \brief GetStats
+     *
+     * Take a snapshot of the pool's usage.
+     *
+     * \param pstStats_ [out] Pool usage
+     */
+    void GetStats( AutoAllocStats_t *pstStats_ );
+
+private:
+    void        *m_pvFree;      //!< Free list, linked through each free object's first word
+    K_ADDR      m_aReserved;    //!< Next unused object in the reserved storage
+    uint16_t    m_u16Size;      //!< Size of each object
+    uint16_t    m_u16Reserved;  //!< Number of objects still in the reserved storage
+    AutoAllocStats_t m_stStats; //!< Usage counters
+};
+
+//---------------------------------------------------------------------------
 class AutoAlloc
 {
 public:
@@ -81,40 +175,134 @@ public:
      */
     static void *Allocate( uint16_t u16Size_ );
 
+    /*!
+     * \brief GetHeapFree
+     *
+     * Return the number of bytes left in the auto allocator's heap.
+     *
+     * \return Bytes available for new objects/allocations
+     */
+    static uint16_t GetHeapFree(void);
+
+    /*!
+     * \brief GetPoolStats
+     *
+     * Take a snapshot of the usage of one of the typed object pools.
+     *
+     * \param eType_ Type of object
+     * \param pstStats_ [out] Pool usage
+     */
+    static void GetPoolStats( AutoAllocType_t eType_, AutoAllocStats_t *pstStats_ );
+
+    /*!
+     * \brief NewStack
+     *
+     * Take a thread stack from the stack pool for its size class.  The size
+     * is rounded up to the class size, which the stack should be used at.
+     * A stack recycled from an exited thread is still filled with 0xFF
+     * below the deepest point its last thread reached, which is reported
+     * so that ThreadPort::InitStack() needn't fill that part again.
+     *
+     * \param pu16Size_ [in/out] Requested stack size, rounded up to the
+     *                  size of the stack returned
+     * \param pu16Clean_ [out] Bytes at the bottom of the stack that are
+     *                  known to hold the 0xFF fill pattern
+     * \return Pointer to the stack, or 0 if the heap is exhausted
+     */
+    static K_WORD *NewStack( uint16_t *pu16Size_, uint16_t *pu16Clean_ );
+
+    /*!
+     * \brief DestroyStack
+     *
+     * Return a stack taken from NewStack() to its pool.  Stacks larger
+     * than the largest size class aren't pooled, and are ignored.
+     *
+     * \param pwStack_ Stack to return
+     * \param u16Size_ Size of the stack, as returned by NewStack()
+     */
+    static void DestroyStack( K_WORD *pwStack_, uint16_t u16Size_ );
+
+    /*!
+     * \brief GetStackPoolStats
+     *
+     * Take a snapshot of the usage of one of the stack pools.
+     *
+     * \param u8Class_ Index of the size class, from 0 (AUTO_ALLOC_STACK_MIN
+     *                 bytes) to AUTO_ALLOC_STACK_CLASSES - 1
+     * \param pstStats_ [out] Pool usage
+     * \return true on success, false if the class doesn't exist
+     */
+    static bool GetStackPoolStats( uint8_t u8Class_, AutoAllocStats_t *pstStats_ );
+
+    /*
+     * Each New*() call returns a constructed object from its type's pool.
+     * Destroy*() runs the object's destructor (which panics if the object
+     * is still in use, as for any other object going out of scope), and
+     * returns it to the pool.  Both are constant-time.
+     */
 #if KERNEL_USE_SEMAPHORE
     static Semaphore *NewSemaphore(void);
+    static void DestroySemaphore( Semaphore *pclSemaphore_ );
 #endif
 
 #if KERNEL_USE_MUTEX
     static Mutex *NewMutex(void);
+    static void DestroyMutex( Mutex *pclMutex_ );
 #endif
 
 #if KERNEL_USE_EVENTFLAG
     static EventFlag *NewEventFlag(void);
+    static void DestroyEventFlag( EventFlag *pclEventFlag_ );
 #endif
 
 #if KERNEL_USE_MESSAGE
     static Message *NewMessage(void);
+    static void DestroyMessage( Message *pclMessage_ );
     static MessageQueue* NewMessageQueue(void);
+    static void DestroyMessageQueue( MessageQueue *pclMessageQueue_ );
 #endif
 
 #if KERNEL_USE_NOTIFY
     static Notify *NewNotify(void);
+    static void DestroyNotify( Notify *pclNotify_ );
 #endif
 
 #if KERNEL_USE_MAILBOX
     static Mailbox *NewMailbox(void);
+    static void DestroyMailbox( Mailbox *pclMailbox_ );
 #endif
 
     static Thread *NewThread(void);
 
+    /*!
+     * \brief DestroyThread
+     *
+     * Return a thread object to its pool.  The thread must have exited, or
+     * never been started.
+     *
+     * \param pclThread_ Thread to destroy
+     */
+    static void DestroyThread( Thread *pclThread_ );
+
 #if KERNEL_USE_TIMERS
     static Timer *NewTimer(void);
+
+    /*!
+     * \brief DestroyTimer
+     *
+     * Stop a timer, and return it to its pool.
+     *
+     * \param pclTimer_ Timer to destroy
+     */
+    static void DestroyTimer( Timer *pclTimer_ );
 #endif
 
 private:
     static uint8_t m_au8AutoHeap[ AUTO_ALLOC_SIZE ];    // Heap memory
     static K_ADDR  m_aHeapTop;                          // Top of the heap
+
+    static AutoAllocPool m_aclPools[ AUTO_ALLOC_TYPE_COUNT ];   // Typed object pools
+    static AutoAllocPool m_aclStackPools[ AUTO_ALLOC_STACK_CLASSES ];   // Thread stack pools
 };
 #endif
 
@@ -0,0 +1,116 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+    \file bitscan.h
+    \brief Bit-scan helpers used by the kernel's bitmap lookups
+
+    bitscan_msb() returns the 1-based index of the most significant bit set
+    in a word, or 0 if no bits are set.  The implementation is selected at
+    compile-time:
+
+    - Ports that provide a hardware count-leading-zeros instruction
+      (HW_CLZ/CLZ() in threadport.h) use that directly.
+    - Targets without one (AVR, MSP430, Cortex-M0) use a nibble lookup table,
+      resolving each byte with at most one compare and one table lookup.
+    - Everything else uses the compiler's __builtin_clz().
+
+    There are overloads for 8, 16 and 32-bit words, so that small targets
+    never test bits that can't be set.
+*/
+
+#ifndef __BITSCAN_H__
+#define __BITSCAN_H__
+
+#include "kerneltypes.h"
+#include "threadport.h"
+
+#if defined(HW_CLZ) && HW_CLZ
+//---------------------------------------------------------------------------
+inline uint8_t bitscan_msb( uint32_t u32Word_ )
+{
+    // CLZ yields 32 for a zero input, resulting in a 0 return value.
+    return (uint8_t)(32 - CLZ(u32Word_));
+}
+
+#elif defined(__AVR__) || defined(__MSP430__) || defined(__ARM_ARCH_6M__)
+//---------------------------------------------------------------------------
+//! 1-based index of the most significant bit set in each nibble value
+extern const uint8_t g_au8BitscanLUT[16];
+
+//---------------------------------------------------------------------------
+inline uint8_t bitscan_msb( uint8_t u8Word_ )
+{
+    if (u8Word_ & 0xF0)
+    {
+        return 4 + g_au8BitscanLUT[ u8Word_ >> 4 ];
+    }
+    return g_au8BitscanLUT[ u8Word_ ];
+}
+
+//---------------------------------------------------------------------------
+inline uint8_t bitscan_msb( uint16_t u16Word_ )
+{
+    if (u16Word_ & 0xFF00)
+    {
+        return 8 + bitscan_msb( (uint8_t)(u16Word_ >> 8) );
+    }
+    return bitscan_msb( (uint8_t)u16Word_ );
+}
+
+//---------------------------------------------------------------------------
+inline uint8_t bitscan_msb( uint32_t u32Word_ )
+{
+    if (u32Word_ & 0xFFFF0000)
+    {
+        return 16 + bitscan_msb( (uint16_t)(u32Word_ >> 16) );
+    }
+    return bitscan_msb( (uint16_t)u32Word_ );
+}
+
+#else
+//---------------------------------------------------------------------------
+inline uint8_t bitscan_msb( uint32_t u32Word_ )
+{
+    // __builtin_clz() is undefined for a zero input.
+    if (!u32Word_)
+    {
+        return 0;
+    }
+    return (uint8_t)(32 - __builtin_clz(u32Word_));
+}
+#endif
+
+#if (defined(HW_CLZ) && HW_CLZ) || \
+    !(defined(__AVR__) || defined(__MSP430__) || defined(__ARM_ARCH_6M__))
+//---------------------------------------------------------------------------
+// A single scan covers any word size.
+inline uint8_t bitscan_msb( uint16_t u16Word_ ) { return bitscan_msb( (uint32_t)u16Word_ ); }
+inline uint8_t bitscan_msb( uint8_t u8Word_ )   { return bitscan_msb( (uint32_t)u8Word_ ); }
+#endif
+
+//---------------------------------------------------------------------------
+/*!
+ * \brief bitscan_lsb
+ *
+ * \param u32Word_ Word to scan
+ * \return 1-based index of the least significant bit set in the word, or 0
+ *         if no bits are set
+ */
+inline uint8_t bitscan_lsb( uint32_t u32Word_ )
+{
+    // Isolate the lowest set bit, and find that.
+    return bitscan_msb( (uint32_t)(u32Word_ & (0 - u32Word_)) );
+}
+
+#endif // __BITSCAN_H__
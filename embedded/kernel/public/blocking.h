@@ -56,6 +56,10 @@ See license.txt for more information
 
 #if KERNEL_USE_MUTEX || KERNEL_USE_SEMAPHORE || KERNEL_USE_EVENTFLAG
 
+#if KERNEL_USE_WAITSET
+class WaitSet;
+#endif
+
 //---------------------------------------------------------------------------
 /*!
  *  Class implementing thread-blocking primatives.  used for implementing 
@@ -115,6 +119,24 @@ protected:
      *  on a given object.
      */
     ThreadList m_clBlockList;
+
+#if KERNEL_USE_WAITSET
+    friend class WaitSet;
+
+    /*!
+     *  \brief SignalWaitSet
+     *
+     *  Wake the thread waiting on the wait-set this object belongs to (if
+     *  any), allowing it to check whether the object can now be acquired.
+     *  Called from within a critical section by derived objects whenever
+     *  they become signalled without waking a thread blocked on them
+     *  directly.
+     */
+    void SignalWaitSet();
+
+    //! Wait-set this object belongs to, or NULL
+    WaitSet *m_pclWaitSet;
+#endif
 };
 
 #endif
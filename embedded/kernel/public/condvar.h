@@ -0,0 +1,187 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   condvar.h
+
+    \brief  Condition variables, for use with Mutex
+
+    A condition variable lets a thread holding a mutex wait for the state
+    protected by that mutex to change, without the lost-wakeup races of a
+    hand-rolled mutex + semaphore pair.
+
+    Wait() releases the mutex and blocks the calling thread in a single
+    operation, so no Signal() can slip in between the two.  Signal() and
+    Broadcast() hand the mutex directly to the woken thread(s): if the mutex
+    is free, the waiter is given ownership and made ready immediately; if it
+    is held (typically by the signalling thread), the waiter is moved straight
+    onto the mutex's block list, and takes ownership when it is released.  A
+    woken thread therefore never has to re-contend for the mutex.
+
+    \section CVUsage Example
+
+    \code
+    // Consumer
+    clMutex.Claim();
+    while (!u8Count)
+    {
+        clCondVar.Wait(&clMutex);
+    }
+    u8Count--;
+    clMutex.Release();
+
+    // Producer
+    clMutex.Claim();
+    u8Count++;
+    clCondVar.Signal();
+    clMutex.Release();
+    \endcode
+
+    As in other implementations, a waiter should re-check its condition once
+    it wakes up.  All threads waiting on a condition variable at once must use
+    the same mutex, and the mutex must not be claimed recursively when Wait()
+    is called.
+*/
+
+#ifndef __CONDVAR_H__
+#define __CONDVAR_H__
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#include "blocking.h"
+#include "mutex.h"
+
+#if KERNEL_USE_CONDVAR
+
+#if KERNEL_USE_TIMEOUTS
+#include "timerlist.h"
+#endif
+
+//---------------------------------------------------------------------------
+/*!
+ *  Condition variables, based on BlockingObject and bound to a Mutex.
+ */
+class ConditionVariable : public BlockingObject
+{
+public:
+    void* operator new (size_t sz, void* pv) { return (ConditionVariable*)pv; };
+
+    ~ConditionVariable();
+
+    /*!
+     *  \brief Init
+     *
+     *  Initialize the condition variable prior to use.
+     */
+    void Init();
+
+    /*!
+     *  \brief Wait
+     *
+     *  Atomically release a mutex held by the calling thread and block until
+     *  the condition variable is signalled.  The mutex is held again when
+     *  this function returns.
+     *
+     *  \param pclMutex_ Mutex held by the calling thread
+     */
+    void Wait( Mutex *pclMutex_ );
+
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     *  \brief Wait
+     *
+     *  Atomically release a mutex held by the calling thread and block until
+     *  the condition variable is signalled, or the timeout expires.  The mutex
+     *  is held again when this function returns, in either case.
+     *
+     *  \param pclMutex_ Mutex held by the calling thread
+     *  \param u32WaitTimeMS_ Time in ms to wait for a signal
+     *  \return true - the condition variable was signalled
+     *          false - the wait timed out
+     */
+    bool Wait( Mutex *pclMutex_, uint32_t u32WaitTimeMS_ );
+
+    /*!
+     *  \brief WakeMe
+     *
+     *  Wake a thread blocked on the condition variable.  This is an internal
+     *  function used for implementing timed waits relying on timer callbacks.
+     *  Since these do not have access to the private data of the object and
+     *  its base classes, we have to wrap this as a public method - do not use
+     *  this for any other purposes.
+     *
+     *  \param pclOwner_ Thread to unblock from this object.
+     *  \return true if the thread was woken, and should be scheduled
+     */
+    bool WakeMe( Thread *pclOwner_ );
+#endif
+
+    /*!
+     *  \brief Signal
+     *
+     *  Wake the highest-priority thread waiting on the condition variable,
+     *  handing it the mutex.  Does nothing if no threads are waiting.
+     */
+    void Signal();
+
+    /*!
+     *  \brief Broadcast
+     *
+     *  Wake all threads waiting on the condition variable.  The highest-
+     *  priority waiter is handed the mutex first, and the rest take it in
+     *  priority order as it is released.
+     */
+    void Broadcast();
+
+private:
+
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     * \brief Wait_i
+     *
+     * Abstracts out timed/non-timed wait operations.
+     *
+     * \param pclMutex_ Mutex held by the calling thread
+     * \param u32WaitTimeMS_ Time in MS to wait, 0 for infinite
+     * \return true if signalled, false on timeout
+     */
+    bool Wait_i( Mutex *pclMutex_, uint32_t u32WaitTimeMS_ );
+#else
+    /*!
+     * \brief Wait_i
+     *
+     * Abstraction for wait operations.
+     *
+     * \param pclMutex_ Mutex held by the calling thread
+     */
+    void Wait_i( Mutex *pclMutex_ );
+#endif
+
+    /*!
+     * \brief Signal_i
+     *
+     * Hand the mutex to the highest-priority waiter.  Must be called from a
+     * critical section, with at least one thread waiting.
+     *
+     * \return true if the woken thread should be scheduled
+     */
+    bool Signal_i();
+
+    Mutex *m_pclMutex;      //!< Mutex used by the threads currently waiting
+};
+
+#endif // KERNEL_USE_CONDVAR
+
+#endif
@@ -22,4 +22,12 @@
 #define _DBG___KERNEL_BLOCKING_CPP     (19)
 #define _DBG___EXAMPLES_AVR_BUFFALOGGER_MAIN_CPP     (20)
 #define _DBG___LIBS_MEMUTIL_MEMUTIL_CPP     (21)
+#define _DBG___KERNEL_TIMERTHREAD_CPP     (22)
+#define _DBG___KERNEL_THREADSTATS_CPP     (23)
+#define _DBG___KERNEL_TICKLESSIDLE_CPP     (24)
+#define _DBG___KERNEL_PERIODICTIMER_CPP     (25)
+#define _DBG___KERNEL_WAITSET_CPP     (26)
+#define _DBG___KERNEL_STREAMBUFFER_CPP     (27)
+#define _DBG___KERNEL_RWLOCK_CPP     (28)
+#define _DBG___KERNEL_CONDVAR_CPP     (29)
 
@@ -33,10 +33,10 @@ See license.txt for more information
  * mutex, commonly used for synchronizing thread execution based on events
  * occurring within the system.
  *
- * Each EventFlag object contains a 16-bit bitmask, which is used to trigger
- * events on associated threads.  Threads wishing to block, waiting for
- * a specific event to occur can wait on any pattern within this 16-bit bitmask
- * to be set.  Here, we provide the ability for a thread to block, waiting
+ * Each EventFlag object contains a 16-bit bitmask (32-bit, where
+ * KERNEL_EVENTFLAG_32BIT is set), which is used to trigger events on
+ * associated threads.  Threads wishing to block, waiting for a specific event
+ * to occur can wait on any pattern within this bitmask to be set.  Here, we provide the ability for a thread to block, waiting
  * for ANY bits in a specified mask to be set, or for ALL bits within a
  * specific mask to be set.  Depending on how the object is configured, the
  * bits that triggered the wakeup can be automatically cleared once a match
@@ -53,27 +53,40 @@ public:
     /*!
      * \brief Init Initializes the EventFlag object prior to use.
      */
-    void Init() { m_u16SetMask = 0; m_clBlockList.Init(); }
+    void Init()
+    {
+        m_uXSetMask = 0;
+        m_clBlockList.Init();
+#if KERNEL_USE_EVENTFLAG_INDEX
+        for (uint8_t i = 0; i < FLAG_BITS; i++)
+        {
+            m_aclWaitLists[i].Init();
+        }
+#endif
+#if KERNEL_USE_WAITSET
+        m_pclWaitSet = NULL;
+#endif
+    }
 
     /*!
      * \brief Wait - Block a thread on the specific flags in this event flag group
-     * \param u16Mask_ - 16-bit bitmask to block on
+     * \param uXMask_ - Bitmask to block on
      * \param eMode_ - EVENT_FLAG_ANY:  Thread will block on any of the bits in the mask
      *               - EVENT_FLAG_ALL:  Thread will block on all of the bits in the mask
      * \return Bitmask condition that caused the thread to unblock, or 0 on error or timeout
      */
-    uint16_t Wait(uint16_t u16Mask_, EventFlagOperation_t eMode_);
+    FLAG_TYPE Wait(FLAG_TYPE uXMask_, EventFlagOperation_t eMode_);
 
 #if KERNEL_USE_TIMEOUTS
     /*!
      * \brief Wait - Block a thread on the specific flags in this event flag group
-     * \param u16Mask_ - 16-bit bitmask to block on
+     * \param uXMask_ - Bitmask to block on
      * \param eMode_ - EVENT_FLAG_ANY:  Thread will block on any of the bits in the mask
      *               - EVENT_FLAG_ALL:  Thread will block on all of the bits in the mask
      * \param u32TimeMS_ - Time to block (in ms)
      * \return Bitmask condition that caused the thread to unblock, or 0 on error or timeout
      */
-    uint16_t Wait(uint16_t u16Mask_, EventFlagOperation_t eMode_, uint32_t u32TimeMS_);
+    FLAG_TYPE Wait(FLAG_TYPE uXMask_, EventFlagOperation_t eMode_, uint32_t u32TimeMS_);
 
     /*!
      * \brief WakeMe
@@ -89,21 +102,21 @@ public:
     /*!
      * \brief Set - Set additional flags in this object (logical OR).  This API can potentially
      *              result in threads blocked on Wait() to be unblocked.
-     * \param u16Mask_ - Bitmask of flags to set.
+     * \param uXMask_ - Bitmask of flags to set.
      */
-    void Set(uint16_t u16Mask_);
+    void Set(FLAG_TYPE uXMask_);
 
     /*!
      * \brief ClearFlags - Clear a specific set of flags within this object, specific by bitmask
-     * \param u16Mask_ - Bitmask of flags to clear
+     * \param uXMask_ - Bitmask of flags to clear
      */
-    void Clear(uint16_t u16Mask_);
+    void Clear(FLAG_TYPE uXMask_);
 
     /*!
-     * \brief GetMask Returns the state of the 16-bit bitmask within this object
-     * \return The state of the 16-bit bitmask
+     * \brief GetMask Returns the state of the bitmask within this object
+     * \return The state of the bitmask
      */
-    uint16_t GetMask();
+    FLAG_TYPE GetMask();
 
 private:
 
@@ -113,29 +126,81 @@ private:
      *
      * Interal abstraction used to manage both timed and untimed wait operations
      *
-     * \param u16Mask_ - 16-bit bitmask to block on
+     * \param uXMask_ - Bitmask to block on
      * \param eMode_ - EVENT_FLAG_ANY:  Thread will block on any of the bits in the mask
      *               - EVENT_FLAG_ALL:  Thread will block on all of the bits in the mask
      * \param u32TimeMS_ - Time to block (in ms)
      *
      * \return Bitmask condition that caused the thread to unblock, or 0 on error or timeout
      */
-    uint16_t Wait_i(uint16_t u16Mask_, EventFlagOperation_t eMode_, uint32_t u32TimeMS_);
+    FLAG_TYPE Wait_i(FLAG_TYPE uXMask_, EventFlagOperation_t eMode_, uint32_t u32TimeMS_);
 #else
     /*!
      * \brief Wait_i
      * Interal abstraction used to manage wait operations
      *
-     * \param u16Mask_ - 16-bit bitmask to block on
+     * \param uXMask_ - Bitmask to block on
      * \param eMode_ - EVENT_FLAG_ANY:  Thread will block on any of the bits in the mask
      *               - EVENT_FLAG_ALL:  Thread will block on all of the bits in the mask
      *
      * \return Bitmask condition that caused the thread to unblock.
      */
-    uint16_t Wait_i(uint16_t u16Mask_, EventFlagOperation_t eMode_);
+    FLAG_TYPE Wait_i(FLAG_TYPE uXMask_, EventFlagOperation_t eMode_);
+#endif
+
+    /*!
+     * \brief WakeList
+     *
+     * Wake all threads in a list whose conditions are met by the flags
+     * currently set in the object.  Must be called from within a critical
+     * section.
+     *
+     * \param pclList_ - List of blocked threads to check
+     * \param uXMask_ - Flags being set by the current Set() operation
+     * \param puXNewMask_ - Flag mask to be applied once all threads have been
+     *                      checked, updated with any flags to be cleared
+     * \return true if any threads were woken
+     */
+    bool WakeList(ThreadList *pclList_, FLAG_TYPE uXMask_, FLAG_TYPE *puXNewMask_);
+
+#if KERNEL_USE_EVENTFLAG_INDEX
+    /*!
+     * \brief GetWaitList
+     *
+     * Select the list a thread blocks on, based on the condition it's waiting
+     * for.  Threads waiting on all of a set of flags are listed under one of
+     * the flags not yet set - they can't be woken until that flag is set.
+     * Threads waiting on a single flag are listed under that flag.  Threads
+     * waiting on any one of several flags are kept on the object's main
+     * block list.
+     *
+     * \param uXMask_ - Bitmask the thread is waiting on
+     * \param eMode_ - Event flag operation the thread is waiting on
+     * \return Pointer to the list to block on
+     */
+    ThreadList *GetWaitList(FLAG_TYPE uXMask_, EventFlagOperation_t eMode_);
+
+    /*!
+     * \brief BlockOn
+     *
+     * Block a thread on one of the object's thread lists.
+     *
+     * \param pclThread_ - Thread to block
+     * \param pclList_ - List to block the thread on
+     */
+    void BlockOn(Thread *pclThread_, ThreadList *pclList_);
+#endif
+
+#if KERNEL_USE_WAITSET
+    friend class WaitSet;
 #endif
 
-    uint16_t m_u16SetMask;       //!< Event flags currently set in this object
+    FLAG_TYPE m_uXSetMask;      //!< Event flags currently set in this object
+
+#if KERNEL_USE_EVENTFLAG_INDEX
+    //! Threads blocked on the object, indexed by flag (see GetWaitList())
+    ThreadList m_aclWaitLists[FLAG_BITS];
+#endif
 };
 
 #endif //KERNEL_USE_EVENTFLAG
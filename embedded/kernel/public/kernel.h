@@ -36,6 +36,7 @@ See license.txt for more information
 #include "kerneltypes.h"
 #include "paniccodes.h"
 #include "thread.h"
+#include "ticklessidle.h"
 
 //---------------------------------------------------------------------------
 /*!
@@ -107,9 +108,22 @@ public:
 
     /*!
      * \brief IdleFunc Call the low-priority idle function when no active
-     *        threads are available to be scheduled.
+     *        threads are available to be scheduled.  With the tickless idle
+     *        mode enabled, enter it if no idle function has been set.
      */
-    static void IdleFunc(void) { if (m_pfIdle != 0 ){ m_pfIdle(); } }
+    static void IdleFunc(void)
+    {
+        if (m_pfIdle != 0 )
+        {
+            m_pfIdle();
+        }
+#if KERNEL_USE_TICKLESS_IDLE
+        else
+        {
+            TicklessIdle::Enter();
+        }
+#endif
+    }
 
     /*!
      * \brief GetIdleThread Return a pointer to the Kernel's idle thread
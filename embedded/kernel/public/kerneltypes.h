@@ -66,6 +66,20 @@ typedef enum
     EVENT_FLAG_PENDING_UNBLOCK  //!< Special code.  Not used by user
 } EventFlagOperation_t;
 
+//---------------------------------------------------------------------------
+/*!
+ *   Enumeration representing the ways in which a thread's notification word
+ *   can be updated
+ */
+typedef enum
+{
+    NOTIFY_SET_BITS = 0,        //!< OR the value into the notification word
+    NOTIFY_INCREMENT,           //!< Increment the notification word (value ignored)
+    NOTIFY_OVERWRITE,           //!< Replace the notification word with the value
+//---
+    NOTIFY_ACTIONS              //!< Count of notification actions.  Not used by user
+} NotifyAction_t;
+
 //---------------------------------------------------------------------------
 /*!
  *   Enumeration representing the different states a thread can exist in
@@ -80,4 +94,19 @@ typedef enum
     THREAD_STATES
 } ThreadState_t;
 
+//---------------------------------------------------------------------------
+/*!
+ *   Handle to a mailbox envelope claimed by Mailbox::ClaimSendSlot(), or
+ *   peeked by Mailbox::PeekReceive(), and passed back to the matching
+ *   CommitSend()/ReleaseReceive() call.  The scheduler state to restore is
+ *   kept here, by the caller, so that claims made from different contexts 
+ *   on the same mailbox - such as a thread, and an ISR interrupting it - 
+ *   can't overwrite each other's saved state.
+ */
+typedef struct
+{
+    void *pvData;               //!< Pointer to the envelope, NULL if none was claimed
+    bool bSchedState;           //!< Scheduler state to restore on commit/release
+} MailboxSlot_t;
+
 #endif
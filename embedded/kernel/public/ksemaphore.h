@@ -79,6 +79,22 @@ public:
      *          is already maxed out.
      */
     bool Post();
+
+    /*!
+     *  \brief
+     *
+     *  Post the semaphore u16Count_ times within a single critical section.
+     *  Blocked threads are woken first (highest priority first), one per
+     *  count; any remaining counts are added to the semaphore value.
+     *
+     *  At most one context switch is taken, after all counts have been
+     *  applied.
+     *
+     *  \param u16Count_ Number of counts to post
+     *  \return true if all counts were posted, false if the maximum value
+     *          was reached before all counts could be added.
+     */
+    bool PostN(uint16_t u16Count_);
     
     /*!
      *  \brief
@@ -101,6 +117,16 @@ public:
      *  \return The current semaphore counter value.
      */
     uint16_t GetCount();
+
+    /*!
+     *  \brief
+     *
+     *  Take up to u16Max_ counts from the semaphore without blocking.
+     *
+     *  \param u16Max_ Maximum number of counts to take
+     *  \return The number of counts actually taken, which may be zero.
+     */
+    uint16_t TryPendN(uint16_t u16Max_);
     
 #if KERNEL_USE_TIMEOUTS
     /*!
@@ -158,6 +184,10 @@ private:
     void Pend_i( void );
 #endif
     
+#if KERNEL_USE_WAITSET
+    friend class WaitSet;
+#endif
+
     uint16_t m_u16Value;         //!< Current count held by the semaphore
     uint16_t m_u16MaxValue;      //!< Maximum count that can be held by this semaphore
     
@@ -185,6 +185,136 @@ public:
     bool ReceiveTail( void *pvData_, uint32_t u32TimeoutMS_ );
 #endif
 
+    /*!
+     * \brief ClaimSendSlot
+     *
+     * Claim a free envelope at the head of the mailbox, and return a pointer to
+     * it within the mailbox's buffer, so that the envelope can be filled in-place
+     * rather than copied in.  The envelope is delivered by calling CommitSend().
+     *
+     * The scheduler is disabled between the claim and the commit, exactly as it
+     * is while Send() copies data.  Nothing may block between the two calls -
+     * no Sleep(), no pend on any object, no blocking Send()/Receive() - as no
+     * other thread can run to unblock the caller until CommitSend() restores
+     * the scheduler.  Fill the envelope quickly, and commit it.
+     *
+     * \param pstSlot_ [out] Handle to the claimed envelope, to be passed to
+     *                 CommitSend()
+     * \return Pointer to the claimed envelope, or NULL if the mailbox is full.
+     */
+    void *ClaimSendSlot( MailboxSlot_t *pstSlot_ );
+
+    /*!
+     * \brief ClaimSendSlotTail
+     *
+     * Claim a free envelope at the tail of the mailbox, as per ClaimSendSlot().
+     *
+     * \param pstSlot_ [out] Handle to the claimed envelope
+     * \return Pointer to the claimed envelope, or NULL if the mailbox is full.
+     */
+    void *ClaimSendSlotTail( MailboxSlot_t *pstSlot_ );
+
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     * \brief ClaimSendSlot
+     *
+     * Claim a free envelope at the head of the mailbox, as per ClaimSendSlot(),
+     * waiting up to the specified time for an envelope to become free.
+     *
+     * \param pstSlot_ [out] Handle to the claimed envelope
+     * \param u32TimeoutMS_     Maximum time to wait for a free transmit slot
+     * \return Pointer to the claimed envelope, or NULL on timeout.
+     */
+    void *ClaimSendSlot( MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_ );
+
+    /*!
+     * \brief ClaimSendSlotTail
+     *
+     * Claim a free envelope at the tail of the mailbox, as per ClaimSendSlot(),
+     * waiting up to the specified time for an envelope to become free.
+     *
+     * \param pstSlot_ [out] Handle to the claimed envelope
+     * \param u32TimeoutMS_     Maximum time to wait for a free transmit slot
+     * \return Pointer to the claimed envelope, or NULL on timeout.
+     */
+    void *ClaimSendSlotTail( MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_ );
+#endif
+
+    /*!
+     * \brief CommitSend
+     *
+     * Deliver an envelope previously claimed by ClaimSendSlot() or
+     * ClaimSendSlotTail(), waking a thread blocked on receive if there is one.
+     *
+     * \param pstSlot_ Handle returned by the claim
+     */
+    void CommitSend( MailboxSlot_t *pstSlot_ );
+
+    /*!
+     * \brief PeekReceive
+     *
+     * Wait for an envelope at the head of the mailbox, and return a pointer to it
+     * within the mailbox's buffer, so that it can be read in-place rather than
+     * copied out.  The envelope is returned to the mailbox by calling
+     * ReleaseReceive().
+     *
+     * The scheduler is disabled between the peek and the release, exactly as it
+     * is while Receive() copies data.  As with ClaimSendSlot(), nothing may
+     * block between the two calls - consume the envelope quickly, and release
+     * it.
+     *
+     * \param pstSlot_ [out] Handle to the envelope, to be passed to
+     *                 ReleaseReceive()
+     * \return Pointer to the received envelope.
+     */
+    void *PeekReceive( MailboxSlot_t *pstSlot_ );
+
+    /*!
+     * \brief PeekReceiveTail
+     *
+     * Wait for an envelope at the tail of the mailbox, as per PeekReceive().
+     *
+     * \param pstSlot_ [out] Handle to the envelope
+     * \return Pointer to the received envelope.
+     */
+    void *PeekReceiveTail( MailboxSlot_t *pstSlot_ );
+
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     * \brief PeekReceive
+     *
+     * Wait for an envelope at the head of the mailbox, as per PeekReceive(),
+     * for up to the specified time.
+     *
+     * \param pstSlot_ [out] Handle to the envelope
+     * \param u32TimeoutMS_ Maximum time to wait for delivery.
+     * \return Pointer to the received envelope, or NULL on timeout.
+     */
+    void *PeekReceive( MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_ );
+
+    /*!
+     * \brief PeekReceiveTail
+     *
+     * Wait for an envelope at the tail of the mailbox, as per PeekReceive(),
+     * for up to the specified time.
+     *
+     * \param pstSlot_ [out] Handle to the envelope
+     * \param u32TimeoutMS_ Maximum time to wait for delivery.
+     * \return Pointer to the received envelope, or NULL on timeout.
+     */
+    void *PeekReceiveTail( MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_ );
+#endif
+
+    /*!
+     * \brief ReleaseReceive
+     *
+     * Free an envelope previously returned by PeekReceive() or
+     * PeekReceiveTail(), waking a thread blocked on send if there is one.
+     *
+     * \param pstSlot_ Handle returned by the peek
+     */
+    void ReleaseReceive( MailboxSlot_t *pstSlot_ );
+
     uint16_t GetFreeSlots( void )
     {
         uint16_t rc;
@@ -239,7 +369,9 @@ private:
     /*!
      * \brief CopyData
      *
-     * Perform a direct byte-copy from a source to a destination object.
+     * Perform a direct copy from a source to a destination object.  The copy
+     * is performed a word at a time when both objects and the length are
+     * word-aligned, and a byte at a time otherwise.
      *
      * \param src_  Pointer to an object to read from
      * \param dst_  Pointer to an object to write to
@@ -247,6 +379,18 @@ private:
      */
     void CopyData( const void *src_, const void *dst_, uint16_t len_ )
     {
+        if (0 == (((K_ADDR)src_ | (K_ADDR)dst_ | (K_ADDR)len_) & (sizeof(K_WORD) - 1)))
+        {
+            K_WORD *pwSrc = (K_WORD*)src_;
+            K_WORD *pwDst = (K_WORD*)dst_;
+            len_ /= sizeof(K_WORD);
+            while (len_--)
+            {
+                *pwDst++ = *pwSrc++;
+            }
+            return;
+        }
+
         uint8_t *u8Src = (uint8_t*)src_;
         uint8_t *u8Dst = (uint8_t*)dst_;
         while (len_--)
@@ -311,6 +455,62 @@ private:
         m_u16Head--;
     }
 
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     * \brief Claim_i
+     *
+     * Internal method which implements all ClaimSendSlot() methods in the
+     * class.  On success, the scheduler is left disabled until CommitSend().
+     *
+     * \param pstSlot_  [out] Handle to the claimed slot
+     * \param bTail_    true - claim at tail, false - claim at head
+     * \param u32WaitTimeMS_ Time to wait before timeout (in ms).
+     * \return          Pointer to the claimed slot, NULL - buffer full
+     */
+    void *Claim_i( MailboxSlot_t *pstSlot_, bool bTail_, uint32_t u32WaitTimeMS_ );
+#else
+    /*!
+     * \brief Claim_i
+     *
+     * Internal method which implements all ClaimSendSlot() methods in the
+     * class.  On success, the scheduler is left disabled until CommitSend().
+     *
+     * \param pstSlot_  [out] Handle to the claimed slot
+     * \param bTail_    true - claim at tail, false - claim at head
+     * \return          Pointer to the claimed slot, NULL - buffer full
+     */
+    void *Claim_i( MailboxSlot_t *pstSlot_, bool bTail_ );
+#endif
+
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     * \brief Peek_i
+     *
+     * Internal method which implements all PeekReceive() methods in the
+     * class.  On success, the scheduler is left disabled until
+     * ReleaseReceive().
+     *
+     * \param pstSlot_      [out] Handle to the received slot
+     * \param bTail_        true - read from tail, false - read from head
+     * \param u32WaitTimeMS_ Time to wait before timeout (in ms).
+     * \return              Pointer to the received slot, NULL - timeout.
+     */
+    void *Peek_i( MailboxSlot_t *pstSlot_, bool bTail_, uint32_t u32WaitTimeMS_ );
+#else
+    /*!
+     * \brief Peek_i
+     *
+     * Internal method which implements all PeekReceive() methods in the
+     * class.  On return, the scheduler is left disabled until
+     * ReleaseReceive().
+     *
+     * \param pstSlot_      [out] Handle to the received slot
+     * \param bTail_        true - read from tail, false - read from head
+     * \return              Pointer to the received slot
+     */
+    void *Peek_i( MailboxSlot_t *pstSlot_, bool bTail_ );
+#endif
+
 #if KERNEL_USE_TIMEOUTS
     /*!
      * \brief Send_i
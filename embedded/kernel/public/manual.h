@@ -332,14 +332,32 @@ See license.txt for more information
 
     This feature enables an additional set of APIs that allow for objects
     to be created on-the-fly out of a special heap, without having to
-    explicitly allocate them (from stack, heap, or static memory). Note
-    that auto-alloc memory cannot be reclaimed.
+    explicitly allocate them (from stack, heap, or static memory). Kernel
+    objects created with AutoAlloc::New*() can be returned with the matching
+    AutoAlloc::Destroy*() call, and are recycled for the next object of the
+    same type.  Memory from AutoAlloc::Allocate() cannot be reclaimed.
 
     <b>AUTO_ALLOC_SIZE</b>
 
     Size (in bytes) of the static pool of memory reserved from RAM for use by
     the auto allocator (if enabled).
 
+    <b>AUTO_ALLOC_SEMAPHORES, AUTO_ALLOC_THREADS, AUTO_ALLOC_TIMERS, ...</b>
+
+    Number of objects of each type reserved for AutoAlloc's typed object 
+    pools.  Once a type's reserved objects are in use, new objects of that
+    type are taken from the AUTO_ALLOC_SIZE heap.  AutoAlloc::GetPoolStats()
+    reports each pool's peak usage.
+
+    <b>AUTO_ALLOC_STACK_MIN, AUTO_ALLOC_STACK_CLASSES</b>
+
+    Size of the smallest thread stack pool, and the number of pools (each
+    twice the size of the last) used for the stacks of threads created with
+    Thread::Init(u16StackSize_, ...).  These threads give their stack and 
+    thread object back to the pools when they exit, and a recycled stack is
+    only refilled as deep as its last thread used it.
+    AutoAlloc::GetStackPoolStats() reports each pool's peak usage.
+
 */
 /*!
     \page BUILD0 Building Mark3
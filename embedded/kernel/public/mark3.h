@@ -32,13 +32,21 @@ See license.txt for more information
 #include "kernel.h"
 #include "thread.h"
 #include "timerlist.h"
+#include "timerthread.h"
+#include "periodictimer.h"
+#include "threadstats.h"
+#include "ticklessidle.h"
 
 #include "ksemaphore.h"
 #include "mutex.h"
+#include "rwlock.h"
+#include "condvar.h"
 #include "eventflag.h"
 #include "message.h"
 #include "notify.h"
 #include "mailbox.h"
+#include "waitset.h"
+#include "streambuffer.h"
 
 #include "atomic.h"
 #include "driver.h"
@@ -83,6 +83,35 @@ See license.txt for more information
     #define KERNEL_TIMERS_TICKLESS       (1)
 #endif
 
+/*!
+    Select the data structure used by the timer scheduler to track active
+    timers.
+
+    By default, all active timers are kept in a single unsorted list, which
+    is walked in its entirety every time the timer interrupt fires.  This is
+    small and simple, but the cost of the timer interrupt grows linearly with
+    the number of active timers (every sleeping thread, every pending
+    timeout, etc.).
+
+    Enabling this option replaces the list with a hierarchical timing wheel,
+    where timer insertion and removal are constant-time operations, and the
+    timer interrupt only touches timers that are actually expiring (plus an
+    occasional "cascade" of long-running timers from one level of the wheel
+    to the next).  Works with both tick-based and tick-less timers.
+
+    The wheel consists of KERNEL_TIMERS_WHEEL_LEVELS levels of
+    (1 << KERNEL_TIMERS_WHEEL_BITS) slots each, with each slot costing one
+    linked-list head/tail pair of RAM.  Timers that expire further out than
+    the range of the wheel (1 << (BITS * LEVELS) ticks) are parked in the
+    outermost level, and cost one extra wakeup per revolution of the wheel.
+*/
+#define KERNEL_TIMERS_WHEEL              (0)
+
+#if KERNEL_USE_TIMERS && KERNEL_TIMERS_WHEEL
+    #define KERNEL_TIMERS_WHEEL_BITS     (3)
+    #define KERNEL_TIMERS_WHEEL_LEVELS   (4)
+#endif
+
 /*!
     By default, if you opt to enable kernel timers, you also get timeout-
     enabled versions of the blocking object APIs along with it.  This
@@ -127,6 +156,16 @@ See license.txt for more information
 */
 #define KERNEL_USE_NOTIFY                (1)
 
+/*!
+    Enable direct-to-thread notifications.  Each thread carries a 32-bit
+    notification word that other threads (or interrupts) can update by
+    setting bits, incrementing, or overwriting it (Thread::SendNotification()).
+    The thread waits on the word with Thread::WaitNotification(), without a
+    separate kernel object or block list.  Suited to the common case of a
+    single producer signalling a single consumer thread.
+*/
+#define KERNEL_USE_THREAD_NOTIFICATION   (0)
+
 /*!
     Do you want the ability to use counting/binary semaphores for thread 
     synchronization?  Enabling this features provides fully-blocking semaphores
@@ -142,6 +181,55 @@ See license.txt for more information
  */
 #define KERNEL_USE_MUTEX                 (1)
 
+#if KERNEL_USE_MUTEX
+    /*!
+        Mutex priority inheritence is transitive - when a thread blocks on a
+        mutex whose owner is itself blocked on another mutex, the owner of
+        that mutex inherits the priority as well.  This sets the maximum number
+        of mutexes followed along such a chain, bounding the cost of a claim.
+     */
+    #define KERNEL_MUTEX_INHERIT_DEPTH   (4)
+#endif
+
+/*!
+    Allow mutexes to use the immediate priority-ceiling protocol, as an
+    alternative to priority inheritence - see Mutex::Init(PRIO_TYPE).  A
+    ceiling mutex raises its owner to the ceiling priority as soon as it is
+    claimed, which makes the cost of claiming and releasing it deterministic.
+ */
+#define KERNEL_USE_MUTEX_CEILING         (0)
+
+#if KERNEL_USE_MUTEX_CEILING && !KERNEL_USE_MUTEX
+    #error "Mutex priority ceilings require KERNEL_USE_MUTEX"
+#endif
+
+/*!
+    Do you want reader-writer locks?  These allow any number of threads (up
+    to KERNEL_RWLOCK_MAX_READERS) to hold a lock for reading concurrently,
+    while writers get exclusive access.  Waiting writers are given preference
+    over new readers, and lock owners inherit the priority of their waiters,
+    as with mutexes.  See rwlock.h.
+ */
+#define KERNEL_USE_RWLOCK                (0)
+
+#if KERNEL_USE_RWLOCK
+    #if !KERNEL_USE_MUTEX
+        #error "Reader-writer locks require KERNEL_USE_MUTEX"
+    #endif
+    #define KERNEL_RWLOCK_MAX_READERS    (4)    //!< Maximum number of concurrent readers per lock
+#endif
+
+/*!
+    Do you want condition variables?  These let a thread atomically release
+    a mutex and wait to be signalled, and hand the mutex straight back to the
+    woken thread.  See condvar.h.
+ */
+#define KERNEL_USE_CONDVAR               (0)
+
+#if KERNEL_USE_CONDVAR && !KERNEL_USE_MUTEX
+    #error "Condition variables require KERNEL_USE_MUTEX"
+#endif
+
 /*!
     Provides additional event-flag based blocking.  This relies on an
     additional per-thread flag-mask to be allocated, which adds 2 bytes
@@ -149,6 +237,36 @@ See license.txt for more information
 */
 #define KERNEL_USE_EVENTFLAG             (1)
 
+/*!
+    Use 32-bit event flag groups, rather than the default 16-bit groups.
+    Adds 2 bytes to each thread and event flag object.
+*/
+#define KERNEL_EVENTFLAG_32BIT           (0)
+
+#if KERNEL_EVENTFLAG_32BIT
+# define FLAG_TYPE           uint32_t
+# define FLAG_BITS           (32)
+#else
+# define FLAG_TYPE           uint16_t
+# define FLAG_BITS           (16)
+#endif
+
+/*!
+    Index the threads blocked on each event flag object by the flags they're
+    waiting on, so that EventFlag::Set() only examines threads that could be
+    woken by the flags being set, rather than every blocked thread.  This
+    keeps the time spent in the critical section independent of the number
+    of unrelated waiters.  Threads waiting on any one of several flags are
+    still kept in a single list, and examined on every Set().
+
+    Costs one thread list per flag (FLAG_BITS) in each event flag object.
+*/
+#define KERNEL_USE_EVENTFLAG_INDEX       (0)
+
+#if KERNEL_USE_EVENTFLAG_INDEX && !KERNEL_USE_EVENTFLAG
+    #error "The event flag index requires KERNEL_USE_EVENTFLAG"
+#endif
+
 /*!
     Enable inter-thread messaging using message queues.  This is the preferred
     mechanism for IPC for serious multi-threaded communications; generally
@@ -171,6 +289,26 @@ See license.txt for more information
     #define GLOBAL_MESSAGE_POOL_SIZE     (8)
 #endif
 
+/*!
+    Enable message priority classes.  Each message carries a small priority
+    class (Message::SetPriority()), and message queues keep one FIFO per
+    class, along with a bitmap of the non-empty classes.  Receivers always
+    get the oldest message of the highest class queued, and both sending
+    and receiving remain O(1).  When disabled, message queues are a single
+    FIFO, as before.
+*/
+#define KERNEL_USE_MESSAGE_PRIORITY      (0)
+
+#if KERNEL_USE_MESSAGE_PRIORITY
+    #if !KERNEL_USE_MESSAGE
+        #error "Message priority classes require KERNEL_USE_MESSAGE"
+    #endif
+    #define KERNEL_MESSAGE_PRIORITY_CLASSES  (4)    //!< Number of message priority classes (max 8)
+    #if (KERNEL_MESSAGE_PRIORITY_CLASSES > 8)
+        #error "KERNEL_MESSAGE_PRIORITY_CLASSES must be 8 or fewer"
+    #endif
+#endif
+
 /*!
     Enable inter-thread messaging using mailboxes.  A mailbox manages a blob
     of data provided by the user, that is partitioned into fixed-size blocks
@@ -186,6 +324,35 @@ See license.txt for more information
     #define KERNEL_USE_MAILBOX           (0)
 #endif
 
+/*!
+    Enable byte stream buffers.  A stream buffer is a circular byte buffer
+    used to pass data from a single producer (typically a driver's interrupt)
+    to a single consumer thread, with a lock-free write path.  A blocked
+    reader is only woken once a trigger level of data is buffered, or once
+    data stops arriving, rather than on every byte.
+*/
+#define KERNEL_USE_STREAMBUFFER          (0)
+
+#if KERNEL_USE_STREAMBUFFER && !KERNEL_USE_SEMAPHORE
+    #error "Stream buffers require KERNEL_USE_SEMAPHORE"
+#endif
+
+/*!
+    Enable wait-sets, allowing a single thread to block on several objects
+    (semaphores, event flags, notification objects and message queues) at
+    once, waking when any one of them is signalled.  This lets one thread
+    service several event sources, rather than dedicating a thread (and its
+    stack) to each.  Adds a pointer to each blocking object.
+*/
+#define KERNEL_USE_WAITSET               (0)
+
+#if KERNEL_USE_WAITSET
+    #if !KERNEL_USE_SEMAPHORE
+        #error "Wait-sets require KERNEL_USE_SEMAPHORE"
+    #endif
+    #define KERNEL_WAITSET_MAX_OBJECTS   (4)    //!< Maximum number of objects in a wait-set
+#endif
+
 /*!
     Do you want to be able to set threads to sleep for a specified time?
     This enables the Thread::Sleep() API.
@@ -196,6 +363,46 @@ See license.txt for more information
     #define KERNEL_USE_SLEEP             (0)
 #endif
 
+/*!
+    Enable the timer service thread.  Timers can then be individually flagged
+    as "deferred" (Timer::SetDeferred()), in which case their callbacks are
+    not called from the timer interrupt.  Instead, the interrupt simply queues
+    the expired timers, and a high-priority kernel thread runs the callbacks
+    with interrupts enabled.  This keeps interrupt latency low in systems with
+    long-running timer callbacks, and allows those callbacks to block.
+
+    Timers that aren't flagged as deferred - including all of the kernel's
+    own timeout, sleep, and round-robin timers - are still run directly from
+    the timer interrupt.  Costs one thread (and its stack).
+*/
+#define KERNEL_USE_TIMER_THREAD          (0)
+
+#if KERNEL_USE_TIMER_THREAD
+    #if !KERNEL_USE_TIMERS || !KERNEL_USE_SEMAPHORE
+        #error "The timer service thread requires KERNEL_USE_TIMERS and KERNEL_USE_SEMAPHORE"
+    #endif
+    #define KERNEL_TIMER_THREAD_PRIORITY     (KERNEL_NUM_PRIORITIES - 1)  //!< Priority of the timer service thread
+    #define KERNEL_TIMER_THREAD_STACK_SIZE   (192)                        //!< Stack size (in bytes)
+#endif
+
+/*!
+    Maintain a 64-bit monotonic time base (TimerScheduler::GetTime()), in
+    timer ticks, which doesn't wrap with the kernel timer's counter.  This
+    enables the absolute-time Thread::SleepUntil() API, and the
+    PeriodicTimer object for drift-free periodic threads.
+
+    Using tick-less timers, the time base starts counting when the first
+    timer is started.  From then on, the kernel timer is kept running (and
+    wakes up once per counter period) even when no timers are active.
+*/
+#define KERNEL_USE_MONOTONIC_TIME        (0)
+
+#if KERNEL_USE_MONOTONIC_TIME
+    #if !KERNEL_USE_TIMERS || !KERNEL_USE_SEMAPHORE
+        #error "The monotonic time base requires KERNEL_USE_TIMERS and KERNEL_USE_SEMAPHORE"
+    #endif
+#endif
+
 /*!
     Enabling device drivers provides a posix-like filesystem interface for 
     peripheral device drivers.
@@ -223,6 +430,33 @@ See license.txt for more information
 */
 #define KERNEL_USE_PROFILER              (1)
 
+/*!
+    Keep CPU usage statistics for each thread:  cumulative run time, the
+    number of times the thread has been switched in, and a decaying load
+    average.  The time spent idle (in the idle function, or in priority-0
+    threads) is tracked in the same way.  The statistics can be read at any
+    time using the ThreadStats class.
+
+    Time is sampled from the profiling timer on every context switch, so
+    this requires KERNEL_USE_PROFILER, and the profiling timer is left
+    running from Kernel::Init() onwards.  All times are reported in profiling
+    timer ticks.  Costs a few 32-bit adds per context switch, and 18 bytes
+    of RAM per thread.
+
+    The load average is updated once per window of
+    (1 << THREAD_STATS_WINDOW_SHIFT) profiling timer ticks, with each new
+    window contributing 1/(1 << THREAD_STATS_LOAD_SHIFT) of the average.
+*/
+#define KERNEL_USE_THREAD_STATS          (0)
+
+#if KERNEL_USE_THREAD_STATS
+    #if !KERNEL_USE_PROFILER
+        #error "Thread statistics require KERNEL_USE_PROFILER"
+    #endif
+    #define THREAD_STATS_WINDOW_SHIFT    (16)   //!< log2 of the load window length, in profiling timer ticks
+    #define THREAD_STATS_LOAD_SHIFT      (2)    //!< log2 of the load average's decay factor
+#endif
+
 /*!
     Provides extra logic for kernel debugging, and instruments the kernel 
     with extra asserts, and kernel trace functionality.
@@ -287,16 +521,78 @@ See license.txt for more information
     #define KERNEL_USE_IDLE_FUNC         (0) // Not currently supported on ARM
 #endif
 
+/*!
+    Enable the kernel-managed tickless idle mode (see TicklessIdle).  The
+    application registers a table of CPU sleep states, and each time the
+    system goes idle, the kernel enters the deepest state whose wakeup
+    latency fits before the next timer expiry.  Sleep states that halt the
+    kernel timer report the time spent asleep, which is credited back to the
+    timer scheduler on wakeup.  The depth of sleep can be limited at runtime
+    by a governor function (i.e. PowerMan, from libs/powerman).
+
+    With the threadless idle function, the kernel enters the idle mode
+    whenever no idle function has been set with Kernel::SetIdleFunc().
+    Otherwise, TicklessIdle::Enter() must be called in a loop from the idle
+    thread.  Requires tick-less kernel timers.
+*/
+#define KERNEL_USE_TICKLESS_IDLE         (0)
+
+#if KERNEL_USE_TICKLESS_IDLE
+    #if !KERNEL_USE_TIMERS || !KERNEL_TIMERS_TICKLESS
+        #error "Tickless idle requires KERNEL_USE_TIMERS and KERNEL_TIMERS_TICKLESS"
+    #endif
+#endif
+
 /*!
     This feature enables an additional set of APIs that allow for objects
     to be created on-the-fly out of a special heap, without having to
-    explicitly allocate them (from stack, heap, or static memory). Note
-    that auto-alloc memory cannot be reclaimed.
+    explicitly allocate them (from stack, heap, or static memory). Kernel
+    objects created with the AutoAlloc::New*() APIs can be returned with
+    the matching AutoAlloc::Destroy*() call, and are recycled by the next
+    request for an object of the same type.  Memory obtained directly from
+    AutoAlloc::Allocate() cannot be reclaimed.
 */
 #define KERNEL_USE_AUTO_ALLOC            (0)
 
 #if KERNEL_USE_AUTO_ALLOC
     #define AUTO_ALLOC_SIZE              (512)
+
+/*!
+    Number of objects of each type to reserve in AutoAlloc's typed object
+    pools, in addition to the AUTO_ALLOC_SIZE heap.  Once all of a type's 
+    reserved objects are in use, further objects of that type are carved 
+    from the heap - and are recycled the same way once destroyed, so that 
+    a type only ever takes as much memory as its peak number of objects.
+    The pool usage reported by AutoAlloc::GetPoolStats() can be used to 
+    size these values.
+*/
+    #define AUTO_ALLOC_SEMAPHORES        (0)
+    #define AUTO_ALLOC_MUTEXES           (0)
+    #define AUTO_ALLOC_EVENTFLAGS        (0)
+    #define AUTO_ALLOC_MESSAGES          (0)
+    #define AUTO_ALLOC_MESSAGEQUEUES     (0)
+    #define AUTO_ALLOC_NOTIFIES          (0)
+    #define AUTO_ALLOC_MAILBOXES         (0)
+    #define AUTO_ALLOC_THREADS           (0)
+    #define AUTO_ALLOC_TIMERS            (0)
+
+/*!
+    Stacks for threads created with Thread::Init(u16StackSize_, ...) are 
+    kept in AUTO_ALLOC_STACK_CLASSES pools of power-of-two sizes, the 
+    smallest of which holds AUTO_ALLOC_STACK_MIN bytes.  Requests are 
+    rounded up to the size of their class, and the stack (along with its 
+    thread object) is returned to the pool when the thread exits.  Larger 
+    stacks are taken from the heap, and are never reclaimed.
+*/
+    #define AUTO_ALLOC_STACK_MIN         (64)
+    #define AUTO_ALLOC_STACK_CLASSES     (6)
+
+    #if (AUTO_ALLOC_STACK_MIN & (AUTO_ALLOC_STACK_MIN - 1)) || (AUTO_ALLOC_STACK_MIN < 16)
+        #error "AUTO_ALLOC_STACK_MIN must be a power of two, of at least 16 bytes"
+    #endif
+    #if (AUTO_ALLOC_STACK_CLASSES < 1) || ((AUTO_ALLOC_STACK_MIN << (AUTO_ALLOC_STACK_CLASSES - 1)) > 32768)
+        #error "AUTO_ALLOC_STACK_CLASSES must be at least 1, and limit stacks to 32KB"
+    #endif
 #endif
 
 /*!
@@ -107,7 +107,11 @@ public:
      *
      *  Initialize the data and code in the message.
      */
+#if KERNEL_USE_MESSAGE_PRIORITY
+    void Init() { ClearNode(); m_pvData = NULL; m_u16Code = 0; m_u8Priority = 0; }
+#else
     void Init() { ClearNode(); m_pvData = NULL; m_u16Code = 0; }
+#endif
     
     /*!
      *  \brief SetData
@@ -144,6 +148,29 @@ public:
      *  \return user code set in the object
      */
     uint16_t GetCode() { return m_u16Code; }
+
+#if KERNEL_USE_MESSAGE_PRIORITY
+    /*!
+     *  \brief SetPriority
+     *
+     *  Set the priority class of the message before transmission.  Higher
+     *  classes are received before lower ones; messages within a class are
+     *  received in the order they were sent.
+     *
+     *  \param u8Priority_ Priority class, 0 to
+     *         (KERNEL_MESSAGE_PRIORITY_CLASSES - 1)
+     */
+    void SetPriority( uint8_t u8Priority_ ) { m_u8Priority = u8Priority_; }
+
+    /*!
+     *  \brief GetPriority
+     *
+     *  Return the priority class set in the message
+     *
+     *  \return priority class of the message
+     */
+    uint8_t GetPriority() { return m_u8Priority; }
+#endif
 private:
 
     //! Pointer to the message data
@@ -151,6 +178,11 @@ private:
     
     //! Message code, providing context for the message
     uint16_t m_u16Code;
+
+#if KERNEL_USE_MESSAGE_PRIORITY
+    //! Priority class of the message
+    uint8_t m_u8Priority;
+#endif
 };
 
 
@@ -189,6 +221,30 @@ public:
      */
     Message *Pop();
 
+    /*!
+     *  \brief PushN
+     *
+     *  Return a group of message objects back to the pool within a single
+     *  critical section.
+     *
+     *  \param apclMessages_ Array of Message object pointers to return
+     *  \param u16Count_ Number of messages in the array
+     */
+    void PushN( Message **apclMessages_, uint16_t u16Count_ );
+
+    /*!
+     *  \brief PopN
+     *
+     *  Pop up to u16Max_ messages from the pool within a single critical
+     *  section.
+     *
+     *  \param apclMessages_ Array to receive the Message object pointers
+     *  \param u16Max_ Maximum number of messages to pop
+     *  \return Number of messages popped, which may be less than u16Max_
+     *          if the pool runs out.
+     */
+    uint16_t PopN( Message **apclMessages_, uint16_t u16Max_ );
+
     /*!
      * \brief GetHead
      *
@@ -239,6 +295,29 @@ public:
      */
     static Message *Pop();
 
+    /*!
+     *  \brief PushN
+     *
+     *  Return a group of message objects back to the global queue within a
+     *  single critical section.
+     *
+     *  \param apclMessages_ Array of Message object pointers to return
+     *  \param u16Count_ Number of messages in the array
+     */
+    static void PushN( Message **apclMessages_, uint16_t u16Count_ );
+
+    /*!
+     *  \brief PopN
+     *
+     *  Pop up to u16Max_ messages from the global queue within a single
+     *  critical section.
+     *
+     *  \param apclMessages_ Array to receive the Message object pointers
+     *  \param u16Max_ Maximum number of messages to pop
+     *  \return Number of messages popped
+     */
+    static uint16_t PopN( Message **apclMessages_, uint16_t u16Max_ );
+
     /*!
      * \brief GetHead
      *
@@ -309,6 +388,40 @@ public:
      */
     Message *Receive( uint32_t u32TimeWaitMS_ );
 #endif  
+
+    /*!
+     *  \brief ReceiveBatch
+     *
+     *  Receive up to u16Max_ messages from the queue at once.  If the queue
+     *  is empty, the thread will block until a message is available; all
+     *  messages available at that point (up to u16Max_) are then removed
+     *  from the queue within a single critical section.
+     *
+     *  \param apclDst_ Array to receive the Message object pointers, in the
+     *         order they were sent
+     *  \param u16Max_ Maximum number of messages to receive (nonzero)
+     *
+     *  \return Number of messages received
+     */
+    uint16_t ReceiveBatch( Message **apclDst_, uint16_t u16Max_ );
+
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     *  \brief ReceiveBatch
+     *
+     *  Receive up to u16Max_ messages from the queue at once, blocking for
+     *  at most u32TimeWaitMS_ for the first one to arrive.
+     *
+     *  \param apclDst_ Array to receive the Message object pointers, in the
+     *         order they were sent
+     *  \param u16Max_ Maximum number of messages to receive (nonzero)
+     *  \param u32TimeWaitMS_ The amount of time in ms to wait for a
+     *          message before timing out and unblocking the waiting thread.
+     *
+     *  \return Number of messages received, 0 on timeout
+     */
+    uint16_t ReceiveBatch( Message **apclDst_, uint16_t u16Max_, uint32_t u32TimeWaitMS_ );
+#endif
     
     /*!
      *  \brief Send
@@ -319,6 +432,19 @@ public:
      *  \param pclSrc_ Pointer to the message object to add to the queue
      */
     void Send( Message *pclSrc_ );
+
+    /*!
+     *  \brief SendBatch
+     *
+     *  Send a group of message objects into this message queue, in array
+     *  order.  The messages are queued and the queue's semaphore adjusted
+     *  once, within a single critical section; blocked receivers are woken
+     *  highest-priority first, one per message.
+     *
+     *  \param apclSrc_ Array of Message object pointers to send
+     *  \param u16Count_ Number of messages in the array
+     */
+    void SendBatch( Message **apclSrc_, uint16_t u16Count_ );
     
     /*!
      *  \brief GetCount
@@ -352,11 +478,71 @@ private:
     Message *Receive_i( void );
 #endif
 
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     * \brief ReceiveBatch_i
+     *
+     * Internal function used to abstract timed and un-timed ReceiveBatch calls.
+     *
+     * \param apclDst_ Array to receive the Message object pointers
+     * \param u16Max_ Maximum number of messages to receive
+     * \param u32TimeWaitMS_ Time (in ms) to block, 0 for un-timed call.
+     *
+     * \return Number of messages received, 0 on timeout.
+     */
+    uint16_t ReceiveBatch_i( Message **apclDst_, uint16_t u16Max_, uint32_t u32TimeWaitMS_ );
+#else
+    /*!
+     * \brief ReceiveBatch_i
+     *
+     * Internal function used to abstract ReceiveBatch calls.
+     *
+     * \param apclDst_ Array to receive the Message object pointers
+     * \param u16Max_ Maximum number of messages to receive
+     *
+     * \return Number of messages received.
+     */
+    uint16_t ReceiveBatch_i( Message **apclDst_, uint16_t u16Max_ );
+#endif
+
+    /*!
+     * \brief Enqueue_i
+     *
+     * Add a message to the tail of the queue (of its priority class).  Must
+     * be called from within a critical section.
+     *
+     * \param pclMessage_ Message to add
+     */
+    void Enqueue_i( Message *pclMessage_ );
+
+    /*!
+     * \brief Dequeue_i
+     *
+     * Remove the message at the head of the queue (of the highest non-empty
+     * priority class).  Must be called from within a critical section, and
+     * only once a message has been claimed from the semaphore.
+     *
+     * \return Pointer to the message removed from the queue
+     */
+    Message *Dequeue_i();
+
+#if KERNEL_USE_WAITSET
+    friend class WaitSet;
+#endif
+
     //! Counting semaphore used to manage thread blocking
     Semaphore m_clSemaphore;
     
+#if KERNEL_USE_MESSAGE_PRIORITY
+    //! List objects used to store messages, one per priority class
+    DoubleLinkList m_aclLinkLists[KERNEL_MESSAGE_PRIORITY_CLASSES];
+
+    //! Bitmap of the priority classes with messages queued
+    uint8_t m_u8ClassMap;
+#else
     //! List object used to store messages
     DoubleLinkList m_clLinkList;
+#endif
 };
 
 #endif //KERNEL_USE_MESSAGE
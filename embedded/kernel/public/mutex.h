@@ -46,6 +46,29 @@ See license.txt for more information
     clMutex.Release();
     \endcode
 
+    \section MInherit Priority inheritance
+
+    A thread blocking on a mutex raises the owner to its own priority, if
+    higher.  Inheritance is transitive: if the owner is itself blocked on
+    another mutex, that mutex's owner is raised too, and so on - for up to
+    KERNEL_MUTEX_INHERIT_DEPTH links in the chain.  When a mutex is released,
+    the owner drops to the highest priority it is still entitled to from any
+    other mutexes it holds, rather than straight back to its base priority.
+
+    \section MCeiling Priority ceiling
+
+    With KERNEL_USE_MUTEX_CEILING enabled, a mutex can instead be initialized
+    with a ceiling priority:
+
+    \code
+    clMutex.Init(5);
+    \endcode
+
+    A thread claiming the mutex is raised to the ceiling immediately (the
+    "immediate priority ceiling" protocol), so no thread that shares the
+    mutex can preempt it while it is held, and claims never need to walk
+    the block list.  The ceiling must be at least the priority of the
+    highest-priority thread that uses the mutex.
  */
 #ifndef __MUTEX_H_
 #define __MUTEX_H_
@@ -81,6 +104,20 @@ public:
      */
     void Init();
 
+#if KERNEL_USE_MUTEX_CEILING
+    /*!
+     *  \brief Init
+     *
+     *  Initialize a mutex object that uses the immediate priority-ceiling
+     *  protocol instead of priority inheritence.
+     *
+     *  \param uXCeiling_ Ceiling priority - threads holding the mutex run
+     *                    at this priority.  Must be no lower than the
+     *                    priority of any thread that claims the mutex.
+     */
+    void Init( PRIO_TYPE uXCeiling_ );
+#endif
+
     /*!
      *  \brief Claim
      *
@@ -143,7 +180,7 @@ public:
      *
      *  If the calling Thread's priority was boosted as a result of priority
      *  inheritence, the Thread's previous priority will also be restored at this
-     *  time.
+     *  time - or the priority it still inherits through other mutexes it holds.
      *
      *  Note that if a Mutex is held recursively, it must be Release'd the same
      *  number of times that it was Claim'd before it will be availabel for use
@@ -151,6 +188,18 @@ public:
      *
      */
     void Release();
+
+    /*!
+     *  \brief InheritedPriority
+     *
+     *  Get the priority a thread is entitled to, given the mutexes (and
+     *  reader-writer locks) it currently holds - its base priority, or the
+     *  highest priority inherited through any of those locks.  Must be called from a critical section.
+     *
+     *  \param pclThread_ Thread to check
+     *  \return Effective priority of the thread
+     */
+    static PRIO_TYPE InheritedPriority( Thread *pclThread_ );
     
 private:
 
@@ -160,6 +209,69 @@ private:
      *  Wake the next thread waiting on the Mutex.
      */
     uint8_t WakeNext();
+
+    /*!
+     *  \brief RecalcMax_i
+     *
+     *  Recompute the priority the mutex passes on to its owner - that of the
+     *  highest-priority waiter, or the ceiling.
+     */
+    void RecalcMax_i();
+
+    /*!
+     *  \brief Own_i
+     *
+     *  Make a running or ready thread the owner of a free mutex, raising its
+     *  priority as required.
+     *
+     *  \param pclThread_ New owner of the mutex
+     */
+    void Own_i( Thread *pclThread_ );
+
+    /*!
+     *  \brief Disown_i
+     *
+     *  Remove the mutex from its owner's list of held mutexes.
+     */
+    void Disown_i();
+
+    /*!
+     *  \brief Update_i
+     *
+     *  Propagate a change in the mutex's waiters to the priority of its
+     *  owner - and on through the chain of owners blocked on other mutexes,
+     *  for up to KERNEL_MUTEX_INHERIT_DEPTH mutexes.
+     */
+    void Update_i();
+
+    /*!
+     *  \brief Unlock_i
+     *
+     *  Restore the owner's priority, and pass ownership of the mutex to its
+     *  highest-priority waiter, or mark the mutex as free if there are none.
+     *  Must be called from a critical section.
+     *
+     *  \return true if the scheduler needs to run
+     */
+    bool Unlock_i();
+
+#if KERNEL_USE_CONDVAR
+    friend class ConditionVariable;
+
+    /*!
+     *  \brief Handoff_i
+     *
+     *  Give the mutex to a thread blocked on another object - immediately if
+     *  the mutex is free, otherwise by moving the thread onto this mutex's
+     *  block list.  Used by ConditionVariable to wake a waiter without it
+     *  having to contend for the mutex.  Must be called from a critical
+     *  section.
+     *
+     *  \param pclThread_ Blocked thread to hand the mutex to
+     *  \return true if the thread was woken, and should be scheduled
+     */
+    bool Handoff_i( Thread *pclThread_ );
+#endif
     
 
 #if KERNEL_USE_TIMEOUTS
@@ -184,8 +296,12 @@ private:
 
     uint8_t m_u8Recurse;    //!< The recursive lock-count when a mutex is claimed multiple times by the same owner
     bool m_bReady;          //!< State of the mutex - true = ready, false = claimed
-    uint8_t m_u8MaxPri;     //!< Maximum priority of thread in queue, used for priority inheritence
+    PRIO_TYPE m_uXMaxPri;   //!< Maximum priority of thread in queue, used for priority inheritence
+#if KERNEL_USE_MUTEX_CEILING
+    PRIO_TYPE m_uXCeiling;  //!< Ceiling priority, 0 when using priority inheritence
+#endif
     Thread *m_pclOwner;     //!< Pointer to the thread that owns the mutex (when claimed)
+    Mutex *m_pclNextHeld;   //!< Next mutex held by the same owner
     
 };
 
@@ -33,6 +33,9 @@ See license.txt for more information
 #define PANIC_ACTIVE_NOTIFY_DESCOPED    (11)
 #define PANIC_ACTIVE_MAILBOX_DESCOPED   (12)
 #define PANIC_ACTIVE_TIMER_DESCOPED     (13)
+#define PANIC_ACTIVE_WAITSET_DESCOPED   (14)
+#define PANIC_ACTIVE_RWLOCK_DESCOPED    (15)
+#define PANIC_ACTIVE_CONDVAR_DESCOPED   (16)
 
 #endif // __PANIC_CODES_H
 
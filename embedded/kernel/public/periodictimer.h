@@ -0,0 +1,137 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   periodictimer.h
+
+    \brief  Drift-free periodic wakeup object for thread control loops
+*/
+
+#ifndef __PERIODICTIMER_H__
+#define __PERIODICTIMER_H__
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#include "timer.h"
+#include "ksemaphore.h"
+
+#if KERNEL_USE_MONOTONIC_TIME
+
+//---------------------------------------------------------------------------
+/*!
+ *  Periodic wakeup source for control loops.
+ *
+ *  Rather than calling Thread::Sleep() once per iteration (which builds a
+ *  new timer each time, and lets the iteration's run time accumulate as
+ *  drift), a PeriodicTimer keeps a single repeating kernel timer armed for
+ *  as long as it runs.  The timer is re-armed in-place from its previous
+ *  expiry on each cycle, so wakeups land on exact multiples of the period
+ *  regardless of how long the owner takes to call Wait().
+ *
+ *  Expiries that occur while the owner is still busy are counted rather than
+ *  lost; Wait() reports how many periods have elapsed since the previous
+ *  call, allowing the owner to detect and handle overruns.
+ */
+class PeriodicTimer
+{
+public:
+    void* operator new (size_t sz, void* pv) { return (PeriodicTimer*)pv; };
+
+    /*!
+     *  \brief Init
+     *
+     *  Initialize the object before use.  Must be called before any other
+     *  method.
+     */
+    void Init();
+
+    /*!
+     *  \brief Start
+     *
+     *  Start the periodic wakeup source.  The first period ends
+     *  u32PeriodMs_ milliseconds from the time of the call.
+     *
+     *  \param u32PeriodMs_ Period, in milliseconds
+     */
+    void Start(uint32_t u32PeriodMs_);
+
+    /*!
+     *  \brief StartTicks
+     *
+     *  Start the periodic wakeup source, with the period specified in
+     *  kernel timer ticks rather than milliseconds.
+     *
+     *  \param u32Ticks_ Period, in timer ticks
+     */
+    void StartTicks(uint32_t u32Ticks_);
+
+    /*!
+     *  \brief Stop
+     *
+     *  Stop the periodic wakeup source.  Any periods counted but not yet
+     *  consumed by Wait() are discarded.
+     */
+    void Stop();
+
+    /*!
+     *  \brief Wait
+     *
+     *  Block the calling thread until the end of the current period.  If one
+     *  or more periods have already elapsed since the previous call, returns
+     *  immediately.
+     *
+     *  \return Number of periods elapsed since the previous call to Wait().
+     *          A value greater than 1 indicates the caller overran its
+     *          period.
+     */
+    uint32_t Wait();
+
+    /*!
+     *  \brief GetExpiredCount
+     *
+     *  Return the total number of periods elapsed since the timer was
+     *  started.  Safe to call from interrupt context.
+     *
+     *  \return Total period count
+     */
+    uint32_t GetExpiredCount() { return m_u32Total; }
+
+private:
+    /*!
+     *  \brief TimerCallback
+     *
+     *  Timer expiry handler, run from the timer interrupt context.
+     *
+     *  \param pclOwner_ Unused
+     *  \param pvData_ Pointer to the PeriodicTimer object that expired
+     */
+    static void TimerCallback(Thread *pclOwner_, void *pvData_);
+
+    //! Repeating kernel timer providing the period
+    Timer     m_clTimer;
+
+    //! Semaphore used to block the owner between periods
+    Semaphore m_clSemaphore;
+
+    //! Periods elapsed and not yet consumed by Wait()
+    volatile uint32_t m_u32Pending;
+
+    //! Total periods elapsed since Start()
+    volatile uint32_t m_u32Total;
+};
+
+#endif // KERNEL_USE_MONOTONIC_TIME
+
+#endif // __PERIODICTIMER_H__
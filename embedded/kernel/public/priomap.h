@@ -24,23 +24,36 @@ See license.txt for more information
 
 //---------------------------------------------------------------------------
 // Define the type used to store the priority map based on the word size of
-// the underlying host architecture.
-#if (K_WORD == uint8_t)
-# define PRIO_MAP_WORD_SIZE  (1)
-#elif (K_WORD == uint16_t)
-# define PRIO_MAP_WORD_SIZE  (2)
-#elif (K_WORD == uint32_t)
-# define PRIO_MAP_WORD_SIZE  (4)
+// the underlying host architecture.  The map word is widened as necessary
+// so that the second-level map (one bit per map word) fits in a single word.
+#if defined(__AVR__)
+# define PRIO_MAP_NATIVE_SIZE        (1)
+#elif defined(__MSP430__)
+# define PRIO_MAP_NATIVE_SIZE        (2)
+#else
+# define PRIO_MAP_NATIVE_SIZE        (4)
+#endif
+
+#if (PRIO_MAP_NATIVE_SIZE == 1) && (KERNEL_NUM_PRIORITIES <= 64)
+# define PRIO_MAP_WORD_SIZE          (1)
+# define PRIO_MAP_WORD_TYPE          uint8_t
+# define PRIO_MAP_WORD_SHIFT         (3)
+#elif (PRIO_MAP_NATIVE_SIZE <= 2) && (KERNEL_NUM_PRIORITIES <= 256)
+# define PRIO_MAP_WORD_SIZE          (2)
+# define PRIO_MAP_WORD_TYPE          uint16_t
+# define PRIO_MAP_WORD_SHIFT         (4)
+#else
+# define PRIO_MAP_WORD_SIZE          (4)
+# define PRIO_MAP_WORD_TYPE          uint32_t
+# define PRIO_MAP_WORD_SHIFT         (5)
 #endif
-#define PRIO_MAP_WORD_TYPE  K_WORD
 
 // Size of the map index type in bits
 #define PRIO_MAP_BITS                (8 * PRIO_MAP_WORD_SIZE)
 
-// # of bits in an integer used to represent the number of bits in the map.
-// Used for bitshifting the bit index away from the map index.
-// i.e. 3 == 8 bits, 4 == 16 bits, 5 == 32 bits, etc...
-#define PRIO_MAP_WORD_SHIFT          (2 + PRIO_MAP_WORD_SIZE)
+// PRIO_MAP_WORD_SHIFT is the # of bits in an integer used to represent the
+// number of bits in the map. Used for bitshifting the bit index away from the
+// map index. i.e. 3 == 8 bits, 4 == 16 bits, 5 == 32 bits, etc...
 
 // Bitmask used to separate out the priorities first-level bitmap from its
 // second-level map index for a given priority
@@ -0,0 +1,314 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   rwlock.h
+
+    \brief  Reader-writer lock, based on BlockingObject
+
+    A reader-writer lock protects a resource that is read often and written
+    rarely.  Any number of threads (up to KERNEL_RWLOCK_MAX_READERS) can hold
+    the lock for reading at once, while a thread holding the lock for writing
+    has exclusive access.
+
+    \section RWPref Writer preference
+
+    Once a writer is waiting on the lock, new readers queue up behind it, so
+    that a steady stream of readers cannot starve the writers.  When a writer
+    releases the lock, waiting writers are served before waiting readers; if
+    no writers are waiting, all waiting readers are admitted at once.
+
+    \section RWPrio Priority inheritance
+
+    As with Mutex, a thread blocking on the lock raises the priority of the
+    thread(s) holding it - the writer, or every active reader - to its own
+    priority, if higher.  Owners return to their original priority when they
+    release the lock.
+
+    \section RWUsage Example
+
+    \code
+    clLock.ReadLock();
+    ...
+    <read-only access to the resource>
+    ...
+    clLock.ReadUnlock();
+
+    clLock.WriteLock();
+    ...
+    <exclusive access to the resource>
+    ...
+    clLock.WriteUnlock();
+    \endcode
+
+    Locks are not recursive - a thread must not claim the lock again (in
+    either mode) while it holds it.
+*/
+
+#ifndef __RWLOCK_H__
+#define __RWLOCK_H__
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#include "blocking.h"
+#include "threadlist.h"
+
+#if KERNEL_USE_RWLOCK
+
+#if KERNEL_USE_TIMEOUTS
+#include "timerlist.h"
+#endif
+
+class Thread;
+class RWLock;
+
+//---------------------------------------------------------------------------
+/*!
+ *  Record of a thread holding a reader-writer lock.  Each of a lock's
+ *  holder slots has one, which is linked into the holding thread's list of
+ *  held locks while the slot is in use.
+ */
+typedef struct RWLockHold
+{
+    //! Lock being held
+    RWLock *pclLock;
+
+    //! Next lock held by the same thread
+    struct RWLockHold *pstNext;
+} RWLockHold_t;
+
+//---------------------------------------------------------------------------
+/*!
+ *  Reader-writer locks, based on BlockingObject.  Blocked writers wait on
+ *  the BlockingObject's list, and blocked readers on a list of their own.
+ */
+class RWLock : public BlockingObject
+{
+public:
+    void* operator new (size_t sz, void* pv) { return (RWLock*)pv; };
+
+    ~RWLock();
+
+    /*!
+     *  \brief Init
+     *
+     *  Initialize the lock prior to use.  The lock is initially free.
+     */
+    void Init();
+
+    /*!
+     *  \brief ReadLock
+     *
+     *  Claim the lock for reading.  Blocks while a writer holds the lock or
+     *  is waiting for it, or while the maximum number of readers hold it.
+     */
+    void ReadLock();
+
+    /*!
+     *  \brief WriteLock
+     *
+     *  Claim the lock for writing.  Blocks while any other thread holds the
+     *  lock.
+     */
+    void WriteLock();
+
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     *  \brief ReadLock
+     *
+     *  Claim the lock for reading, with timeout.
+     *
+     *  \param u32WaitTimeMS_ Time in ms to wait for the lock
+     *  \return true - lock was claimed within the time period specified
+     *          false - the operation timed-out before the lock was claimed
+     */
+    bool ReadLock( uint32_t u32WaitTimeMS_ );
+
+    /*!
+     *  \brief WriteLock
+     *
+     *  Claim the lock for writing, with timeout.
+     *
+     *  \param u32WaitTimeMS_ Time in ms to wait for the lock
+     *  \return true - lock was claimed within the time period specified
+     *          false - the operation timed-out before the lock was claimed
+     */
+    bool WriteLock( uint32_t u32WaitTimeMS_ );
+
+    /*!
+     *  \brief WakeMe
+     *
+     *  Wake a thread blocked on the lock.  This is an internal function used
+     *  for implementing timed locks relying on timer callbacks.  Since these
+     *  do not have access to the private data of the lock and its base
+     *  classes, we have to wrap this as a public method - do not use this
+     *  for any other purposes.
+     *
+     *  \param pclOwner_ Thread to unblock from this object
+     *  \return true if a thread was woken that should preempt the current
+     *          thread
+     */
+    bool WakeMe( Thread *pclOwner_ );
+#endif
+
+    /*!
+     *  \brief ReadUnlock
+     *
+     *  Release a lock held for reading.  If this was the last reader, a
+     *  waiting writer is given the lock.
+     */
+    void ReadUnlock();
+
+    /*!
+     *  \brief WriteUnlock
+     *
+     *  Release a lock held for writing.  The lock is given to the highest
+     *  priority waiting writer if there is one, or to all waiting readers
+     *  otherwise.
+     */
+    void WriteUnlock();
+
+    /*!
+     *  \brief GetReaders
+     *
+     *  \return The number of threads holding the lock for reading
+     */
+    uint8_t GetReaders() { return m_u8Readers; }
+
+    /*!
+     *  \brief GetWriter
+     *
+     *  \return The thread holding the lock for writing, or NULL
+     */
+    Thread *GetWriter() { return m_pclWriter; }
+
+    /*!
+     *  \brief InheritedPriority
+     *
+     *  Get the priority a thread is entitled to through the reader-writer
+     *  locks it currently holds.  Used by Mutex::InheritedPriority(), so that
+     *  a thread holding both kinds of lock keeps the highest priority either
+     *  gives it.  Must be called from a critical section.
+     *
+     *  \param pclThread_ Thread to check
+     *  \param uXPriority_ Priority the thread is entitled to otherwise
+     *  \return Effective priority of the thread
+     */
+    static PRIO_TYPE InheritedPriority( Thread *pclThread_, PRIO_TYPE uXPriority_ );
+
+private:
+
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     * \brief Lock_i
+     *
+     * Abstracts out timed/non-timed, read/write lock operations.
+     *
+     * \param bWrite_ true to claim the lock for writing, false for reading
+     * \param u32WaitTimeMS_ Time in MS to wait, 0 for infinite
+     * \return true on successful claim, false otherwise
+     */
+    bool Lock_i( bool bWrite_, uint32_t u32WaitTimeMS_ );
+#else
+    /*!
+     * \brief Lock_i
+     *
+     * Abstracts out read/write lock operations.
+     *
+     * \param bWrite_ true to claim the lock for writing, false for reading
+     */
+    void Lock_i( bool bWrite_ );
+#endif
+
+    /*!
+     * \brief Grant_i
+     *
+     * Hand the lock to the waiting thread(s) that can now hold it - the
+     * highest-priority writer if any are waiting, otherwise as many readers
+     * as possible.  Must be called from within a critical section.
+     *
+     * \return true if a thread was woken that should preempt the current
+     *         thread
+     */
+    bool Grant_i();
+
+    /*!
+     * \brief Release_i
+     *
+     * Common tail of the unlock operations - restore the current thread's
+     * priority, hand the lock on and reschedule if required.  Must be called
+     * from within a critical section.
+     *
+     * \return true if a context switch is required
+     */
+    bool Release_i();
+
+    /*!
+     * \brief Own_i
+     *
+     * Make a thread a holder of the lock, and add the lock to the thread's
+     * list of held locks.
+     *
+     * \param pclThread_ Thread taking the lock
+     * \param bWrite_ true if the thread is taking the lock for writing
+     */
+    void Own_i( Thread *pclThread_, bool bWrite_ );
+
+    /*!
+     * \brief Disown_i
+     *
+     * Remove the current thread from the lock's holders, and remove the lock
+     * from the thread's list of held locks.
+     *
+     * \param pstHold_ Holder slot being released
+     */
+    void Disown_i( RWLockHold_t *pstHold_ );
+
+    /*!
+     * \brief Update_i
+     *
+     * Recompute the highest priority of the threads waiting on the lock,
+     * and bring the priority of each of the lock's holders into line with
+     * it.  Waiting threads aren't boosted.
+     *
+     * \return true if a holder's priority was changed
+     */
+    bool Update_i();
+
+    //! Threads blocked waiting to read (writers use m_clBlockList)
+    ThreadList m_clReaderList;
+
+    //! Threads holding the lock for reading - NULL marks a free slot
+    Thread *m_apclReaders[KERNEL_RWLOCK_MAX_READERS];
+
+    //! Holder records for each of the reader slots
+    RWLockHold_t m_astReaderHold[KERNEL_RWLOCK_MAX_READERS];
+
+    //! Thread holding the lock for writing, NULL if none
+    Thread *m_pclWriter;
+
+    //! Holder record for the writer
+    RWLockHold_t m_stWriterHold;
+
+    //! Number of threads holding the lock for reading
+    uint8_t m_u8Readers;
+
+    //! Maximum priority of the threads waiting on the lock
+    PRIO_TYPE m_uXMaxPri;
+};
+
+#endif // KERNEL_USE_RWLOCK
+
+#endif
@@ -0,0 +1,230 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   streambuffer.h
+
+    \brief  Single-producer/single-consumer byte stream buffer
+*/
+
+#ifndef __STREAMBUFFER_H__
+#define __STREAMBUFFER_H__
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#include "ksemaphore.h"
+
+#if KERNEL_USE_STREAMBUFFER
+
+//---------------------------------------------------------------------------
+/*!
+ *  Byte stream buffer, used to pass a stream of data (typically received by
+ *  a driver's interrupt) from a single producer to a single consumer thread.
+ *
+ *  The buffer is a circular byte buffer supplied by the user.  The producer
+ *  only ever updates the head index, and the consumer the tail index, so
+ *  Write() requires no critical section and is safe to call from an
+ *  interrupt.  On targets without atomic 16-bit loads and stores (i.e. AVR),
+ *  Write() must be called from an interrupt or with interrupts disabled.
+ *
+ *  Rather than waking the reader on every byte, a blocked reader is only
+ *  woken once a trigger level of data is buffered (see SetTriggerLevel()),
+ *  or - with an idle timeout set - once data has stopped arriving (see
+ *  SetIdleTimeout()).  This allows a whole frame to be received with a
+ *  single context switch.
+ *
+ *  A buffer of N bytes holds at most N-1 bytes of data.
+ */
+class StreamBuffer
+{
+public:
+    void* operator new (size_t sz, void* pv) { return (StreamBuffer*)pv; };
+
+    /*!
+     *  \brief Init
+     *
+     *  Initialize the stream buffer prior to use.  The buffer is initially
+     *  empty, with a trigger level of 1 and no idle timeout.
+     *
+     *  \param pau8Buffer_ Blob of memory to use as the circular buffer
+     *  \param u16Size_ Size of the supplied buffer in bytes
+     */
+    void Init( uint8_t *pau8Buffer_, uint16_t u16Size_ );
+
+    /*!
+     *  \brief SetTriggerLevel
+     *
+     *  Set the number of bytes that must be buffered before a blocked reader
+     *  is woken.  A reader asking for fewer bytes than this is woken as soon
+     *  as its request can be met.
+     *
+     *  \param u16Level_ Trigger level in bytes (nonzero)
+     */
+    void SetTriggerLevel( uint16_t u16Level_ );
+
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     *  \brief SetIdleTimeout
+     *
+     *  Set the idle timeout for the stream.  When nonzero, a blocked reader
+     *  is also woken once some data is buffered, and no further data has
+     *  arrived for this interval - i.e. at the end of a frame shorter than
+     *  the trigger level.
+     *
+     *  \param u32IdleMS_ Idle timeout in ms, 0 to disable
+     */
+    void SetIdleTimeout( uint32_t u32IdleMS_ );
+#endif
+
+    /*!
+     *  \brief Write
+     *
+     *  Write a block of data into the stream, waking the reader if the
+     *  trigger level has been reached.  Never blocks; data which does not
+     *  fit is discarded.  Must only be called by the stream's producer.
+     *
+     *  \param pau8Data_ Data to write into the stream
+     *  \param u16Len_ Length of the data in bytes
+     *  \return Number of bytes written
+     */
+    uint16_t Write( const uint8_t *pau8Data_, uint16_t u16Len_ );
+
+    /*!
+     *  \brief Read
+     *
+     *  Read up to u16Len_ bytes from the stream.  If fewer than the trigger
+     *  level (or u16Len_, if lower) are buffered, the calling thread blocks
+     *  until they are, or until the idle timeout expires with some data
+     *  buffered.  Must only be called by the stream's consumer.
+     *
+     *  \param pau8Data_ Buffer to read data into
+     *  \param u16Len_ Size of the buffer in bytes (nonzero)
+     *  \return Number of bytes read
+     */
+    uint16_t Read( uint8_t *pau8Data_, uint16_t u16Len_ );
+
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     *  \brief Read
+     *
+     *  Read up to u16Len_ bytes from the stream, blocking as in Read(), but
+     *  for no longer than the specified time.  Whatever data is buffered when
+     *  the time expires is returned.
+     *
+     *  \param pau8Data_ Buffer to read data into
+     *  \param u16Len_ Size of the buffer in bytes (nonzero)
+     *  \param u32TimeMS_ Time in ms to wait
+     *  \return Number of bytes read, which may be 0 on timeout
+     */
+    uint16_t Read( uint8_t *pau8Data_, uint16_t u16Len_, uint32_t u32TimeMS_ );
+#endif
+
+    /*!
+     *  \brief TryRead
+     *
+     *  Read up to u16Len_ bytes from the stream without blocking.  Must only
+     *  be called by the stream's consumer.
+     *
+     *  \param pau8Data_ Buffer to read data into
+     *  \param u16Len_ Size of the buffer in bytes
+     *  \return Number of bytes read
+     */
+    uint16_t TryRead( uint8_t *pau8Data_, uint16_t u16Len_ );
+
+    /*!
+     *  \brief GetAvailable
+     *
+     *  \return The number of bytes buffered, ready to be read
+     */
+    uint16_t GetAvailable();
+
+    /*!
+     *  \brief GetFree
+     *
+     *  \return The number of bytes that can be written before the buffer
+     *          is full
+     */
+    uint16_t GetFree();
+
+private:
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     * \brief Read_i
+     *
+     * Internal function used to abstract timed and un-timed reads.
+     *
+     * \param pau8Data_ Buffer to read data into
+     * \param u16Len_ Size of the buffer in bytes
+     * \param u32TimeMS_ Time in ms to wait, 0 to wait forever
+     * \return Number of bytes read
+     */
+    uint16_t Read_i( uint8_t *pau8Data_, uint16_t u16Len_, uint32_t u32TimeMS_ );
+#else
+    /*!
+     * \brief Read_i
+     *
+     * Internal function used to abstract reads.
+     *
+     * \param pau8Data_ Buffer to read data into
+     * \param u16Len_ Size of the buffer in bytes
+     * \return Number of bytes read
+     */
+    uint16_t Read_i( uint8_t *pau8Data_, uint16_t u16Len_ );
+#endif
+
+    /*!
+     * \brief Used_i
+     *
+     * Return the number of bytes buffered between the given indexes.
+     *
+     * \param u16Head_ Head (write) index
+     * \param u16Tail_ Tail (read) index
+     * \return Number of bytes buffered
+     */
+    uint16_t Used_i( uint16_t u16Head_, uint16_t u16Tail_ )
+    {
+        return (u16Head_ >= u16Tail_) ? (u16Head_ - u16Tail_) : (m_u16Size - u16Tail_ + u16Head_);
+    }
+
+    //! Pointer to the buffer managed by this object
+    volatile uint8_t *m_pau8Buffer;
+
+    //! Size of the buffer in bytes
+    uint16_t m_u16Size;
+
+    //! Head (write) index - only updated by the producer
+    volatile uint16_t m_u16Head;
+
+    //! Tail (read) index - only updated by the consumer
+    volatile uint16_t m_u16Tail;
+
+    //! Number of bytes that must be buffered before a blocked reader is woken
+    uint16_t m_u16Trigger;
+
+    //! Fill level at which to wake the blocked reader, 0 if not blocked
+    volatile uint16_t m_u16WakeLevel;
+
+#if KERNEL_USE_TIMEOUTS
+    //! Idle timeout in ms, 0 if disabled
+    uint32_t m_u32IdleMS;
+#endif
+
+    //! Binary semaphore used to block the reader
+    Semaphore m_clSemaphore;
+};
+
+#endif // KERNEL_USE_STREAMBUFFER
+
+#endif
@@ -45,8 +45,15 @@ See license.txt for more information
 #include "quantum.h"
 #include "autoalloc.h"
 #include "priomap.h"
+#include "threadstats.h"
 
 class Thread;
+#if KERNEL_USE_MUTEX
+class Mutex;
+#endif
+#if KERNEL_USE_RWLOCK
+struct RWLockHold;
+#endif
 
 //---------------------------------------------------------------------------
 typedef void (*ThreadCreateCallout_t)(Thread* pclThread_);
@@ -91,18 +98,24 @@ public:
     *
     * Create and initialize a new thread, using memory from the auto-allocated
     * heap region to supply both the thread object and its stack.  The thread
-    * returned can then be started using the Start() method directly.  Note that
-    * the memory used to create this thread cannot be reclaimed, and so this API
-    * is only suitable for threads that exist for the duration of runtime.
+    * returned can then be started using the Start() method directly.  The
+    * thread object and stack are taken from AutoAlloc's thread and stack
+    * pools, and are returned to them when the thread exits - so the thread
+    * mustn't be passed to AutoAlloc::DestroyThread(), or used after Exit().
+    * A stack recycled from an exited thread is only refilled with the stack
+    * check pattern as far down as its last thread used, which makes this
+    * cheap enough for spawning short-lived worker threads.
     *
-    * \param u16StackSize_  Size of the stack (in bytes)
+    * \param u16StackSize_  Size of the stack (in bytes), rounded up to the
+    *                       size of its pool (see AUTO_ALLOC_STACK_MIN)
     * \param uXPriority_    Priority of the thread (0 = idle, 7 = max)
     * \param pfEntryPoint_  This is the function that gets called when the
     *                       thread is started
     * \param pvArg_         Pointer to the argument passed into the thread's
      *                      entrypoint function.
      *
-    * \return Pointer to a newly-created thread.
+    * \return Pointer to a newly-created thread, or 0 if there was no room
+    *         for the thread or its stack.
     */
     static Thread* Init(uint16_t u16StackSize_,
                                 uint8_t uXPriority_,
@@ -285,6 +298,20 @@ public:
      *  \param u32TimeUs_ Time to sleep (in microseconds)
      */
     static void USleep(uint32_t u32TimeUs_);
+
+#if KERNEL_USE_MONOTONIC_TIME
+    /*!
+     *  \brief SleepUntil
+     *
+     *  Put the thread to sleep until the kernel's monotonic time base
+     *  (TimerScheduler::GetTime()) reaches the specified time.  Returns right
+     *  away if that time has already passed.  Since the wakeup time is
+     *  absolute, periodic loops built on this don't accumulate drift.
+     *
+     *  \param u64Time_ Time to wake up at, in timer ticks
+     */
+    static void SleepUntil(uint64_t u64Time_);
+#endif
 #endif
     
     /*!
@@ -337,13 +364,13 @@ public:
      *
      *  \return A copy of the thread's event flag mask
      */
-    uint16_t GetEventFlagMask() { return m_u16FlagMask; }
+    FLAG_TYPE GetEventFlagMask() { return m_uXFlagMask; }
 
     /*!
      *  \brief SetEventFlagMask Sets the active event flag bitfield mask
-     *  \param u16Mask_
+     *  \param uXMask_
      */
-    void SetEventFlagMask(uint16_t u16Mask_) { m_u16FlagMask = u16Mask_; }
+    void SetEventFlagMask(FLAG_TYPE uXMask_) { m_uXFlagMask = uXMask_; }
 
     /*!
      * \brief SetEventFlagMode Sets the active event flag operation mode
@@ -359,6 +386,57 @@ public:
     EventFlagOperation_t GetEventFlagMode() { return m_eFlagMode; }
 #endif
 
+#if KERNEL_USE_THREAD_NOTIFICATION
+    /*!
+     *  \brief SendNotification
+     *
+     *  Update this thread's notification word, and wake the thread if it is
+     *  waiting on any of the bits now set.  Safe to call from an interrupt.
+     *
+     *  \param u32Value_ Value to apply to the notification word
+     *  \param eAction_ How the value is applied - set bits, increment, or
+     *         overwrite.
+     */
+    void SendNotification( uint32_t u32Value_, NotifyAction_t eAction_ );
+
+    /*!
+     *  \brief GetNotification
+     *
+     *  Return the current value of this thread's notification word, without
+     *  consuming it.
+     *
+     *  \return The thread's notification word
+     */
+    uint32_t GetNotification();
+
+    /*!
+     *  \brief WaitNotification
+     *
+     *  Block the calling thread until any of the bits in the mask are set in
+     *  its notification word.  Those bits are then cleared from the word and
+     *  returned.  Passing a mask of all 1's consumes the whole word, which
+     *  suits the word being used as a counter.
+     *
+     *  \param u32Mask_ Bits to wait on (nonzero)
+     *  \return The bits from the mask that were set
+     */
+    static uint32_t WaitNotification( uint32_t u32Mask_ );
+
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     *  \brief WaitNotification
+     *
+     *  Block the calling thread until any of the bits in the mask are set in
+     *  its notification word, or until the timeout expires.
+     *
+     *  \param u32Mask_ Bits to wait on (nonzero)
+     *  \param u32TimeMS_ Time in ms to wait before giving up
+     *  \return The bits from the mask that were set, or 0 on timeout
+     */
+    static uint32_t WaitNotification( uint32_t u32Mask_, uint32_t u32TimeMS_ );
+#endif
+#endif
+
 #if KERNEL_USE_TIMEOUTS || KERNEL_USE_SLEEP
     /*!
      *  Return a pointer to the thread's timer object
@@ -383,6 +461,30 @@ public:
      * \return true - call expired, false - call did not expire
      */
     bool GetExpired();
+
+    /*!
+     * \brief StartTimeout
+     *
+     * Arm the thread's timer to end the blocking call it is about to make,
+     * and clear the expired flag.  All blocking objects share this timer,
+     * since a thread can only block on one thing at a time.  Must be
+     * called from within a critical section, before the thread blocks.
+     *
+     * \param u32TimeMS_ Time in ms before the call expires
+     * \param pfCallback_ Callback that unblocks the thread on expiry
+     * \param pvData_ Blocking object passed to the callback
+     */
+    void StartTimeout( uint32_t u32TimeMS_, TimerCallback_t pfCallback_, void *pvData_ );
+
+    /*!
+     * \brief StopTimeout
+     *
+     * Disarm the timeout started by StartTimeout(), once the thread has
+     * been woken.
+     *
+     * \return true - call completed in time, false - call expired
+     */
+    bool StopTimeout();
 #endif
 
 #if KERNEL_USE_IDLE_FUNC
@@ -412,6 +514,15 @@ public:
     void SetState( ThreadState_t eState_ )  { m_eState = eState_; }
 
     friend class ThreadPort;
+#if KERNEL_USE_THREAD_STATS
+    friend class ThreadStats;
+#endif
+#if KERNEL_USE_MUTEX
+    friend class Mutex;
+#endif
+#if KERNEL_USE_RWLOCK
+    friend class RWLock;
+#endif
     
 private:
     /*!
@@ -423,6 +534,41 @@ private:
      */
     static void ContextSwitchSWI(void);
 
+    /*!
+     *  \brief Init_i
+     *
+     *  Common implementation of the Init() methods.
+     *
+     *  \param u16StackClean_ Bytes at the bottom of the stack that already
+     *                        hold the stack check pattern, and needn't be
+     *                        filled by ThreadPort::InitStack()
+     *
+     *  See Init() for the remaining parameters.
+     */
+    void Init_i(K_WORD *pwStack_,
+                uint16_t u16StackSize_,
+                uint16_t u16StackClean_,
+                PRIO_TYPE uXPriority_,
+                ThreadEntry_t pfEntryPoint_,
+                void *pvArg_ );
+
+    /*!
+     *  \brief GetStackClean
+     *
+     *  Return the number of bytes at the bottom of the stack that
+     *  ThreadPort::InitStack() can skip when filling the stack.
+     *
+     *  \return Bytes already holding the stack check pattern
+     */
+    uint16_t GetStackClean()
+    {
+#if KERNEL_USE_AUTO_ALLOC
+        return m_u16StackClean;
+#else
+        return 0;
+#endif
+    }
+
     /*!
      *  \brief SetPriorityBase
      *
@@ -430,6 +576,52 @@ private:
      */
     void SetPriorityBase(PRIO_TYPE uXPriority_);
 
+#if KERNEL_USE_THREAD_NOTIFICATION
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     *  \brief WaitNotification_i
+     *
+     *  Internal function used to abstract timed and un-timed notification
+     *  waits.
+     *
+     *  \param u32Mask_ Bits to wait on
+     *  \param u32TimeMS_ Time in ms to wait, 0 to wait forever
+     *  \return The bits from the mask that were set, 0 on timeout
+     */
+    static uint32_t WaitNotification_i( uint32_t u32Mask_, uint32_t u32TimeMS_ );
+
+    /*!
+     *  \brief NotificationTimeout
+     *
+     *  Timer callback used to end a timed notification wait.
+     *
+     *  \param pclOwner_ Thread that started the timer
+     *  \param pvData_ Pointer to the waiting thread
+     */
+    static void NotificationTimeout( Thread *pclOwner_, void *pvData_ );
+#else
+    /*!
+     *  \brief WaitNotification_i
+     *
+     *  Internal function used to abstract notification waits.
+     *
+     *  \param u32Mask_ Bits to wait on
+     *  \return The bits from the mask that were set
+     */
+    static uint32_t WaitNotification_i( uint32_t u32Mask_ );
+#endif
+
+    /*!
+     *  \brief WakeNotification_i
+     *
+     *  Return a thread waiting on its notification word to the ready list.
+     *  Must be called from within a critical section.
+     *
+     *  \return true if the woken thread should preempt the current thread
+     */
+    bool WakeNotification_i();
+#endif
+
     //! Pointer to the top of the thread's stack
     K_WORD *m_pwStackTop;
     
@@ -475,12 +667,20 @@ private:
 
 #if KERNEL_USE_EVENTFLAG
     //! Event-flag mask
-    uint16_t m_u16FlagMask;
+    FLAG_TYPE m_uXFlagMask;
 
     //! Event-flag mode
     EventFlagOperation_t m_eFlagMode;
 #endif
 
+#if KERNEL_USE_THREAD_NOTIFICATION
+    //! Notification word
+    uint32_t m_u32NotifyValue;
+
+    //! Bits being waited on in the notification word, 0 when not waiting
+    uint32_t m_u32NotifyMask;
+#endif
+
 #if KERNEL_USE_TIMEOUTS || KERNEL_USE_SLEEP
     //! Timer used for blocking-object timeouts
     Timer   m_clTimer;
@@ -489,6 +689,38 @@ private:
     //! Indicate whether or not a blocking-object timeout has occurred
     bool    m_bExpired;
 #endif
+
+#if KERNEL_USE_MUTEX
+    //! Head of the list of mutexes currently held by the thread
+    Mutex *m_pclHeldMutex;
+
+    //! Mutex the thread is blocked on, if any (transitive inheritance)
+    Mutex *m_pclWaitMutex;
+#endif
+
+#if KERNEL_USE_RWLOCK
+    //! Head of the list of reader-writer locks currently held by the thread
+    struct RWLockHold *m_pstHeldRWLock;
+#endif
+
+#if KERNEL_USE_THREAD_STATS
+    //! Cumulative run time, in profiling timer ticks
+    uint32_t m_u32RunTime;
+
+    //! Number of times the thread has been switched in
+    uint32_t m_u32Switches;
+
+    //! Decaying load average
+    LoadAverage m_clLoad;
+#endif
+
+#if KERNEL_USE_AUTO_ALLOC
+    //! Bytes at the bottom of the stack already filled, while initializing
+    uint16_t m_u16StackClean;
+
+    //! Whether the thread's object and stack go back to AutoAlloc on exit
+    bool m_bAutoPooled;
+#endif
     
 };
 
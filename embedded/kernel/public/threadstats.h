@@ -0,0 +1,191 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   threadstats.h
+
+    \brief  Per-thread CPU time accounting and load statistics
+*/
+
+#ifndef __THREADSTATS_H__
+#define __THREADSTATS_H__
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#if KERNEL_USE_THREAD_STATS
+
+class Thread;
+
+//---------------------------------------------------------------------------
+#define THREAD_LOAD_SCALE       (1024)      //!< Load average representing 100% CPU
+
+//---------------------------------------------------------------------------
+/*!
+ *  Snapshot of the CPU usage of a single thread, or of the idle context, as
+ *  returned by ThreadStats::GetThread() and ThreadStats::GetIdle().
+ */
+typedef struct
+{
+    uint32_t u32RunTime;    //!< Cumulative run time, in profiling timer ticks
+    uint32_t u32Switches;   //!< Number of times switched in
+    uint16_t u16Load;       //!< Load average, THREAD_LOAD_SCALE == 100%
+} CpuUsage_t;
+
+//---------------------------------------------------------------------------
+/*!
+ *  Decaying average of the fraction of the CPU used by a thread.
+ *
+ *  Run time is accumulated into fixed windows of profiling timer ticks.  At
+ *  the end of each window, the fraction of the window spent running is
+ *  folded into an exponential moving average.  Windows are closed lazily,
+ *  the next time the object is touched, so threads that aren't running cost
+ *  nothing.
+ */
+class LoadAverage
+{
+public:
+    /*!
+     *  \brief Init
+     *
+     *  Reset the load average to zero.
+     */
+    void Init(void);
+
+    /*!
+     *  \brief Add
+     *
+     *  Account for a period of run time.
+     *
+     *  \param u32Start_ Timestamp at which the period started
+     *  \param u32End_   Timestamp at which the period ended
+     */
+    void Add(uint32_t u32Start_, uint32_t u32End_);
+
+    /*!
+     *  \brief Get
+     *
+     *  Return the load average, as of the last complete window.
+     *
+     *  \param u32Now_ Current timestamp
+     *  \return Load average, where THREAD_LOAD_SCALE == 100%
+     */
+    uint16_t Get(uint32_t u32Now_);
+
+private:
+    /*!
+     *  \brief Advance
+     *
+     *  Close out all windows before the given one, folding them into the
+     *  average.
+     *
+     *  \param u32Window_ Index of the current window
+     */
+    void Advance(uint32_t u32Window_);
+
+    uint32_t m_u32Window;   //!< Index of the window being accumulated
+    uint32_t m_u32Time;     //!< Run time accumulated in the current window
+    uint16_t m_u16Load;     //!< Load average, as of the end of the last window
+};
+
+//---------------------------------------------------------------------------
+/*!
+ *  Static-class implementing per-thread CPU time accounting.
+ *
+ *  The CPU port calls Switch() every time it switches threads, which charges
+ *  the time since the previous switch to the outgoing thread.  Time spent in
+ *  interrupts is charged to whichever thread was interrupted.  Counters are
+ *  32-bits wide and wrap; compute differences between two snapshots to get
+ *  usage over an interval.
+ */
+class ThreadStats
+{
+public:
+    /*!
+     *  \brief Init
+     *
+     *  Reset the global statistics and start the profiling timer.  Called
+     *  from Kernel::Init().
+     */
+    static void Init(void);
+
+    /*!
+     *  \brief Switch
+     *
+     *  Charge the time elapsed since the last switch to the current thread,
+     *  and count a switch to the next thread.  Called by the CPU port, with
+     *  interrupts disabled, immediately before g_pclCurrent is updated.
+     *
+     *  \param pclNext_ Thread about to be switched in
+     */
+    static void Switch(Thread *pclNext_);
+
+    /*!
+     *  \brief GetThread
+     *
+     *  Take a snapshot of a thread's CPU usage, including the time it has
+     *  spent running since it was last switched in.
+     *
+     *  \param pclThread_ Thread to query
+     *  \param pstUsage_  Snapshot to fill in
+     */
+    static void GetThread(Thread *pclThread_, CpuUsage_t *pstUsage_);
+
+    /*!
+     *  \brief GetIdle
+     *
+     *  Take a snapshot of the time spent idle - either in the kernel's idle
+     *  function, or in threads running at priority 0.
+     *
+     *  \param pstUsage_ Snapshot to fill in
+     */
+    static void GetIdle(CpuUsage_t *pstUsage_);
+
+    /*!
+     *  \brief GetTotalTime
+     *
+     *  \return Profiling timer ticks elapsed since Init()
+     */
+    static uint32_t GetTotalTime(void);
+
+    /*!
+     *  \brief GetTotalSwitches
+     *
+     *  \return Total number of context switches since Init()
+     */
+    static uint32_t GetTotalSwitches(void);
+
+private:
+    /*!
+     *  \brief Sample
+     *
+     *  Read the profiling timer, and charge the time elapsed since the last
+     *  sample to the current thread.  Must be called with interrupts
+     *  disabled.
+     *
+     *  \return Current timestamp
+     */
+    static uint32_t Sample(void);
+
+    static uint32_t     m_u32StartTime;     //!< Timestamp of Init()
+    static uint32_t     m_u32LastSample;    //!< Timestamp of the last sample
+    static uint32_t     m_u32Switches;      //!< Total number of context switches
+    static uint32_t     m_u32IdleTime;      //!< Total time spent idle
+    static uint32_t     m_u32IdleSwitches;  //!< Number of times the CPU went idle
+    static LoadAverage  m_clIdleLoad;       //!< Idle load average
+};
+
+#endif // KERNEL_USE_THREAD_STATS
+
+#endif
@@ -0,0 +1,151 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   ticklessidle.h
+
+    \brief  Kernel-managed tickless idle, with deadline-aware sleep states
+*/
+
+#ifndef __TICKLESSIDLE_H__
+#define __TICKLESSIDLE_H__
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#if KERNEL_USE_TICKLESS_IDLE
+
+//---------------------------------------------------------------------------
+/*!
+ *  Function used to enter a sleep state.  Called with interrupts disabled,
+ *  and must return once the CPU has been woken by an interrupt.  The state
+ *  may enable interrupts to sleep (as required on AVR) if it disables them
+ *  again before returning.
+ *
+ *  \param u32MaxTicks_ Longest time (in kernel timer ticks) the CPU may stay
+ *                      asleep before the next timer expires, accounting for
+ *                      the state's wakeup latency.
+ *  \return Number of kernel timer ticks the kernel timer was halted for while
+ *          asleep, or 0 if it kept running.
+ */
+typedef uint32_t (*sleep_func_t)(uint32_t u32MaxTicks_);
+
+//---------------------------------------------------------------------------
+/*!
+ *  Function used to limit the sleep states available to the idle mode,
+ *  i.e. based on the state of peripherals that can't run in deep sleep.
+ *
+ *  \return Number of states (from the shallowest) that may currently be used
+ */
+typedef uint8_t (*idle_governor_t)(void);
+
+//---------------------------------------------------------------------------
+/*!
+ *  Description of a single CPU sleep state.
+ */
+typedef struct
+{
+    sleep_func_t pfEnter;       //!< Function used to enter the state
+    uint32_t u32WakeLatency;    //!< Time to enter and leave the state, in kernel timer ticks
+} SleepState_t;
+
+//---------------------------------------------------------------------------
+/*!
+ *  Static-class implementing the kernel's tickless idle mode.
+ *
+ *  The application (or board support code) registers a table of sleep
+ *  states, ordered from the shallowest to the deepest.  Each time the CPU
+ *  goes idle, the time remaining until the next kernel timer expiry is
+ *  computed, and the deepest state whose wakeup latency fits within it is
+ *  entered.  Since the kernel timers are tick-less, the CPU isn't woken up
+ *  again until there's timer work to be done.
+ *
+ *  States that keep the kernel timer running are woken by its expiry
+ *  interrupt.  States that halt the kernel timer must arrange their own
+ *  wakeup no later than the time they are given, and report how long the
+ *  kernel timer was halted for, which is then credited to the timer
+ *  scheduler.
+ */
+class TicklessIdle
+{
+public:
+    /*!
+     *  \brief Init
+     *
+     *  Clear the sleep state table and statistics.  Called from
+     *  Kernel::Init().
+     */
+    static void Init(void);
+
+    /*!
+     *  \brief SetStates
+     *
+     *  Set the table of sleep states available to the idle mode.
+     *
+     *  \param pastStates_  Array of states, from the shallowest to the deepest.
+     *                      Must remain valid while in use.
+     *  \param u8NumStates_ Number of states in the array
+     */
+    static void SetStates(const SleepState_t *pastStates_, uint8_t u8NumStates_);
+
+    /*!
+     *  \brief SetGovernor
+     *
+     *  Set a function used to limit the depth of sleep, or NULL to allow all
+     *  states to be used.
+     *
+     *  \param pfGovernor_ Governor function
+     */
+    static void SetGovernor(idle_governor_t pfGovernor_)
+        { m_pfGovernor = pfGovernor_; }
+
+    /*!
+     *  \brief Enter
+     *
+     *  Sleep until the next interrupt, in the deepest state that's both
+     *  permitted, and able to wake up before the next timer expiry.  Returns
+     *  right away if a thread is ready to run, or if no state fits.
+     *
+     *  Called by the kernel when using the threadless idle function and no
+     *  idle function has been set.  Otherwise, call this in a loop from the
+     *  idle thread.
+     */
+    static void Enter(void);
+
+    /*!
+     *  \brief GetWakeups
+     *
+     *  \return Number of times the CPU has woken up from a sleep state
+     */
+    static uint32_t GetWakeups(void) { return m_u32Wakeups; }
+
+    /*!
+     *  \brief GetHaltedTicks
+     *
+     *  \return Total number of ticks credited to the timer scheduler for
+     *          time spent asleep with the kernel timer halted
+     */
+    static uint32_t GetHaltedTicks(void) { return m_u32HaltedTicks; }
+
+private:
+    static const SleepState_t  *m_pastStates;     //!< Table of sleep states
+    static uint8_t              m_u8NumStates;    //!< Number of entries in the table
+    static idle_governor_t      m_pfGovernor;     //!< Sleep depth governor
+    static uint32_t             m_u32Wakeups;     //!< Number of wakeups from sleep
+    static uint32_t             m_u32HaltedTicks; //!< Ticks credited for halted sleep
+};
+
+#endif // KERNEL_USE_TICKLESS_IDLE
+
+#endif
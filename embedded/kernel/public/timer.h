@@ -34,6 +34,9 @@ class Thread;
 #define TIMERLIST_FLAG_ACTIVE           (0x02)    //!< Timer is currently active
 #define TIMERLIST_FLAG_CALLBACK         (0x04)    //!< Timer is pending a callback
 #define TIMERLIST_FLAG_EXPIRED          (0x08)    //!< Timer is actually expired.
+#define TIMERLIST_FLAG_DEFERRED         (0x10)    //!< Timer callback runs from the timer thread
+#define TIMERLIST_FLAG_QUEUED           (0x20)    //!< Timer callback is pending in the timer thread
+#define TIMERLIST_FLAG_COALESCED        (0x40)    //!< Timer expiry was deferred to coincide with other timers
 
 //---------------------------------------------------------------------------
 #define MAX_TIMER_TICKS                 (0x7FFFFFFF)    //!< Maximum value to set
@@ -93,6 +96,7 @@ typedef void (*TimerCallback_t)(Thread *pclOwner_, void *pvData_);
 //---------------------------------------------------------------------------
 class TimerList;
 class TimerScheduler;
+class TimerThread;
 class Quantum;
 
 class Timer : public LinkListNode
@@ -114,9 +118,10 @@ public:
     /*!
      *  \brief Init
      *
-     * Re-initialize the Timer to default values.
+     * Re-initialize the Timer to default values.  A deferred callback still
+     * pending in the timer thread is cancelled.
      */
-    void Init() { ClearNode(); m_u32Interval = 0; m_u32TimerTolerance = 0; m_u32TimeLeft = 0; m_u8Flags = 0; }
+    void Init();
 
     /*!
      *  \brief Start
@@ -164,16 +169,28 @@ public:
      */
     void Stop();
 
+    /*!
+     *  \brief IsActive
+     *
+     *  \return true if the timer is running, or has expired with its callback
+     *          still pending
+     */
+    bool IsActive() { return (m_u8Flags & (TIMERLIST_FLAG_ACTIVE | TIMERLIST_FLAG_CALLBACK)) != 0; }
+
     /*!
      *  \brief SetFlags
      *
-     * Set the timer's flags based on the bits in the u8Flags_ argument
+     * Set the timer's flags based on the bits in the u8Flags_ argument.  The
+     * timer thread's TIMERLIST_FLAG_QUEUED bit is kernel-owned, and left as-is.
      *
      * \param u8Flags_ Flags to assign to the timer object.
      *             TIMERLIST_FLAG_ONE_SHOT for a one-shot timer,
      *             0 for a continuous timer.
      */
-    void SetFlags (uint8_t u8Flags_) { m_u8Flags = u8Flags_; }
+    void SetFlags (uint8_t u8Flags_)
+    {
+        m_u8Flags = (u8Flags_ & ~TIMERLIST_FLAG_QUEUED) | (m_u8Flags & TIMERLIST_FLAG_QUEUED);
+    }
 
     /*!
      *  \brief SetCallback
@@ -252,26 +269,58 @@ public:
      *  \brief SetTolerance
      *
      *  Set the timer's maximum tolerance in order to synchronize timer
-     *  processing with other timers in the system.
+     *  processing with other timers in the system.  Using tickless timers,
+     *  the timer may expire up to this much later than its interval, so
+     *  that it can share a wakeup with other timers.  Takes effect the
+     *  next time the timer is started with Start().
      *
      *  \param u32Ticks_ Maximum tolerance in ticks
      */
     void SetTolerance(uint32_t u32Ticks_);
 
+#if KERNEL_USE_TIMER_THREAD
+    /*!
+     *  \brief SetDeferred
+     *
+     *  Select whether the timer's callback is run directly from the timer
+     *  interrupt (the default), or deferred to the timer service thread,
+     *  where it runs with interrupts enabled.
+     *
+     *  \param bDeferred_ true to run the callback from the timer thread
+     */
+    void SetDeferred(bool bDeferred_)
+    {
+        if (bDeferred_)
+        {
+            m_u8Flags |= TIMERLIST_FLAG_DEFERRED;
+        }
+        else
+        {
+            m_u8Flags &= ~TIMERLIST_FLAG_DEFERRED;
+        }
+    }
+#endif
+
 private:
 
     friend class TimerList;
+    friend class TimerThread;
 
     //! Flags for the timer, defining if the timer is one-shot or repeated
     uint8_t m_u8Flags;
 
+#if KERNEL_TIMERS_WHEEL
+    //! Index of the timing-wheel slot the timer is currently linked into
+    uint8_t m_u8WheelSlot;
+#endif
+
     //! Pointer to the callback function
     TimerCallback_t m_pfCallback;
 
     //! Interval of the timer in timer ticks
     uint32_t m_u32Interval;
 
-    //! Time remaining on the timer
+    //! Time remaining on the timer (absolute expiry tick when using the timing wheel)
     uint32_t m_u32TimeLeft;
 
     //! Maximum tolerance (usedd for timer harmonization)
@@ -282,6 +331,11 @@ private:
 
     //! Pointer to the callback data
     void    *m_pvData;
+
+#if KERNEL_USE_TIMER_THREAD
+    //! Next timer in the timer thread's pending-callback queue
+    Timer   *m_pclDeferredNext;
+#endif
 };
 
 #endif // KERNEL_USE_TIMERS
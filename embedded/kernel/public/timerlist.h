@@ -19,6 +19,10 @@ See license.txt for more information
     
     These classes implements a linked list of timer objects attached to the 
     global kernel timer scheduler.
+
+    When KERNEL_TIMERS_WHEEL is enabled, the TimerList is instead implemented
+    as a hierarchical timing wheel, providing constant-time timer insertion
+    and removal, and an expiry handler that only visits expiring timers.
  */
 
 #ifndef __TIMERLIST_H__
@@ -30,11 +34,56 @@ See license.txt for more information
 #include "timer.h"
 #if KERNEL_USE_TIMERS
 
+#if KERNEL_TIMERS_WHEEL
+//---------------------------------------------------------------------------
+#define TIMER_WHEEL_SLOTS       (1 << KERNEL_TIMERS_WHEEL_BITS)     //!< Slots per wheel level
+#define TIMER_WHEEL_MASK        (TIMER_WHEEL_SLOTS - 1)             //!< Mask used to index a level
+#define TIMER_WHEEL_NUM_SLOTS   (TIMER_WHEEL_SLOTS * KERNEL_TIMERS_WHEEL_LEVELS)    //!< Total slots
+#define TIMER_WHEEL_RANGE       ((uint32_t)1 << (KERNEL_TIMERS_WHEEL_BITS * KERNEL_TIMERS_WHEEL_LEVELS))
+
+#if ((KERNEL_TIMERS_WHEEL_BITS * KERNEL_TIMERS_WHEEL_LEVELS) > 30)
+# error "Timing wheel range must not exceed 30 bits"
+#endif
+#if (TIMER_WHEEL_NUM_SLOTS > 255)
+# error "Timing wheel must not have more than 255 slots"
+#endif
+
+#if (KERNEL_TIMERS_WHEEL_BITS <= 3)
+# define WHEEL_MAP_TYPE         uint8_t
+#elif (KERNEL_TIMERS_WHEEL_BITS <= 4)
+# define WHEEL_MAP_TYPE         uint16_t
+#elif (KERNEL_TIMERS_WHEEL_BITS <= 5)
+# define WHEEL_MAP_TYPE         uint32_t
+#else
+# error "Timing wheel supports a maximum of 32 slots per level"
+#endif
+#endif
+
 //---------------------------------------------------------------------------
 /*!
  *   TimerList class - a doubly-linked-list of timer objects.
+ *
+ *   With KERNEL_TIMERS_WHEEL enabled, active timers are hashed into the slots
+ *   of a hierarchical timing wheel by their absolute expiry tick instead.
+ *   Level 0 holds timers expiring within the next TIMER_WHEEL_SLOTS ticks
+ *   (one tick per slot); each subsequent level covers a range
+ *   TIMER_WHEEL_SLOTS times larger than the previous one.  When the wheel
+ *   time reaches the start of a higher-level slot, the timers within are
+ *   "cascaded" down to lower levels, until they eventually land in a level 0
+ *   slot and expire.
+ *
+ *   With KERNEL_TIMERS_TICKLESS enabled, timers with a tolerance may expire
+ *   late (by up to that tolerance) in order to share a wakeup with other
+ *   timers.  The list picks each wakeup as late as the tolerance of every
+ *   pending timer allows, expiring all timers due by then together; the
+ *   wheel rounds each timer's expiry up to a tick boundary within its
+ *   tolerance window.
  */
+#if KERNEL_TIMERS_WHEEL
+class TimerList
+#else
 class TimerList : public DoubleLinkList
+#endif
 {
 public:
     /*!
@@ -71,12 +120,171 @@ public:
      */
     void Process();
 
+#if KERNEL_USE_TICKLESS_IDLE
+    /*!
+     *  \brief GetTimeToExpiry
+     *
+     *  \return Time until the next timer expiry in timer ticks, or
+     *          MAX_TIMER_TICKS if no timers are active
+     */
+    uint32_t GetTimeToExpiry();
+
+    /*!
+     *  \brief Compensate
+     *
+     *  Account for a period during which the kernel timer was halted.  Time
+     *  past the next expiry is not credited - those timers expire late
+     *  rather than early.
+     *
+     *  \param u32Ticks_ Number of timer ticks the kernel timer was halted for
+     */
+    void Compensate(uint32_t u32Ticks_);
+#endif
+
+#if KERNEL_TIMERS_TICKLESS
+    /*!
+     *  \brief GetWakeupsSaved
+     *
+     *  \return Number of timer wakeups avoided by deferring timers (within
+     *          their tolerance) to expire along with other timers
+     */
+    uint32_t GetWakeupsSaved() { return m_u32WakeupsSaved; }
+#endif
+
+#if KERNEL_USE_MONOTONIC_TIME
+    /*!
+     *  \brief GetTime
+     *
+     *  \return Time elapsed on the 64-bit monotonic time base, in timer ticks
+     */
+    uint64_t GetTime();
+#endif
+
 private:
+#if KERNEL_TIMERS_TICKLESS
+    /*!
+     *  \brief CountWakeupsSaved
+     *
+     *  Update the count of wakeups saved, based on the timers that expired
+     *  in a single wakeup.
+     *
+     *  \param u8Fired_    Number of timers that expired
+     *  \param u8Deferred_ Number of those deferred past their expiry time
+     *                     to share the wakeup
+     */
+    void CountWakeupsSaved(uint8_t u8Fired_, uint8_t u8Deferred_);
+#endif
+
+#if KERNEL_TIMERS_WHEEL
+    /*!
+     *  \brief Insert
+     *
+     *  Link a timer into the wheel slot corresponding to its absolute expiry
+     *  tick, relative to the current wheel time.
+     *
+     *  \param pclTimer_ Pointer to the timer to insert
+     */
+    void Insert(Timer *pclTimer_);
+
+    /*!
+     *  \brief Cascade
+     *
+     *  Re-insert all timers from a higher-level wheel slot, which moves them
+     *  to a lower (finer-resolution) level of the wheel.
+     *
+     *  \param u8Slot_ Index of the wheel slot to cascade
+     */
+    void Cascade(uint8_t u8Slot_);
+
+    /*!
+     *  \brief Advance
+     *
+     *  Advance the wheel time up to (and including) the specified tick,
+     *  cascading timers and moving expired timers into the expired list
+     *  along the way.
+     *
+     *  \param u32Now_ Absolute tick to advance the wheel to
+     */
+    void Advance(uint32_t u32Now_);
+
+    /*!
+     *  \brief RunCallbacks
+     *
+     *  Run the callbacks for all timers in the expired list, rescheduling
+     *  repeating timers, and deactivating one-shot timers.
+     */
+    void RunCallbacks();
+
+    /*!
+     *  \brief NextEvent
+     *
+     *  Compute the number of ticks from the current wheel position until the
+     *  next timer expiry or cascade event.
+     *
+     *  \return Ticks until the next wheel event, or MAX_TIMER_TICKS if the
+     *          wheel is empty
+     */
+    uint32_t NextEvent();
+
+    /*!
+     *  \brief IsEmpty
+     *
+     *  \return true if no timers are linked into the wheel
+     */
+    bool IsEmpty();
+
+#if KERNEL_TIMERS_TICKLESS
+    /*!
+     *  \brief Coalesce
+     *
+     *  Move a timer's expiry later, within its tolerance, to a tick that
+     *  other timers are likely to expire on as well.
+     *
+     *  \param pclTimer_ Pointer to the timer to adjust
+     */
+    void Coalesce(Timer *pclTimer_);
+#endif
+
+    //! Slots of the timing wheel, LEVELS x SLOTS, finest level first
+    DoubleLinkList m_aclWheel[TIMER_WHEEL_NUM_SLOTS];
+
+    //! Bitmap of non-empty slots, one word per level of the wheel
+    WHEEL_MAP_TYPE m_auXSlotMap[KERNEL_TIMERS_WHEEL_LEVELS];
+
+    //! Timers pending callback execution
+    DoubleLinkList m_clExpired;
+
+    //! Absolute time (in timer ticks) of the most recent timer event
+    uint32_t m_u32Now;
+
+    //! Next absolute tick to be processed by the wheel
+    uint32_t m_u32Base;
+#endif
+
+#if KERNEL_TIMERS_WHEEL || KERNEL_TIMERS_TICKLESS
+    //! Whether or not the expiry handler is currently running
+    bool m_bProcessing;
+#endif
+
+#if KERNEL_TIMERS_TICKLESS
+    //! Number of wakeups avoided by coalescing timer expiries
+    uint32_t m_u32WakeupsSaved;
+#endif
+
+#if KERNEL_USE_MONOTONIC_TIME
+    //! Monotonic time (in timer ticks) at the start of the current interval
+    uint64_t m_u64Time;
+#endif
+
     //! The time (in system clock ticks) of the next wakeup event
     uint32_t m_u32NextWakeup;
 
     //! Whether or not the timer is active
     bool m_bTimerActive;
+#if KERNEL_USE_TICKLESS_IDLE && !KERNEL_TIMERS_WHEEL
+    //! Ticks credited to the current interval while the kernel timer was halted
+    uint32_t m_u32Halted;
+#endif
 };
 
 #endif // KERNEL_USE_TIMERS
@@ -77,6 +77,56 @@ public:
      *  next Timer object to expire.
      */
     static void Process() {m_clTimerList.Process();}
+
+#if KERNEL_USE_TICKLESS_IDLE
+    /*!
+     *  \brief GetTimeToExpiry
+     *
+     *  Return the time remaining until the next timer expiry.  Must be
+     *  called with interrupts disabled.
+     *
+     *  \return Time to the next expiry in timer ticks, or MAX_TIMER_TICKS if
+     *          no timers are active
+     */
+    static uint32_t GetTimeToExpiry() {return m_clTimerList.GetTimeToExpiry();}
+
+    /*!
+     *  \brief Compensate
+     *
+     *  Credit the timers with time during which the kernel timer was halted
+     *  (i.e. while the CPU was in a deep sleep state).  Must be called with
+     *  interrupts disabled.
+     *
+     *  \param u32Ticks_ Number of timer ticks the kernel timer was halted for
+     */
+    static void Compensate(uint32_t u32Ticks_) {m_clTimerList.Compensate(u32Ticks_);}
+#endif
+
+#if KERNEL_TIMERS_TICKLESS
+    /*!
+     *  \brief GetWakeupsSaved
+     *
+     *  Return the number of timer wakeups avoided by coalescing the expiry
+     *  of timers that have a tolerance (see Timer::SetTolerance()).
+     *
+     *  \return Number of wakeups saved since the kernel was initialized
+     */
+    static uint32_t GetWakeupsSaved() {return m_clTimerList.GetWakeupsSaved();}
+#endif
+
+#if KERNEL_USE_MONOTONIC_TIME
+    /*!
+     *  \brief GetTime
+     *
+     *  Return the current time on the kernel's 64-bit monotonic time base,
+     *  in timer ticks (see SECONDS_TO_TICKS() and friends).  Unlike the
+     *  kernel timer's counter, this never wraps.  May be called from
+     *  interrupts.
+     *
+     *  \return Current time, in timer ticks
+     */
+    static uint64_t GetTime() {return m_clTimerList.GetTime();}
+#endif
 private:
 
     //! TimerList object manipu32ated by the Timer Scheduler
@@ -0,0 +1,108 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   timerthread.h
+
+    \brief  Timer service thread, used to run deferred timer callbacks
+*/
+
+#ifndef __TIMERTHREAD_H__
+#define __TIMERTHREAD_H__
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#include "thread.h"
+#include "timer.h"
+#include "ksemaphore.h"
+
+#if KERNEL_USE_TIMER_THREAD
+
+//---------------------------------------------------------------------------
+/*!
+ *  Static-class implementing the kernel's timer service thread.
+ *
+ *  Timers flagged as deferred (see Timer::SetDeferred()) do not have their
+ *  callbacks run from the timer interrupt.  Instead, the timer scheduler
+ *  queues the expired timers here, and a single high-priority kernel thread
+ *  drains the queue with interrupts enabled.  This keeps the timer interrupt
+ *  short, and allows the callbacks to make use of blocking kernel APIs.
+ */
+class TimerThread
+{
+public:
+    /*!
+     *  \brief Init
+     *
+     *  Initialize the timer service thread and its work queue, and add the
+     *  thread to the scheduler.  Called from Kernel::Init().
+     */
+    static void Init(void);
+
+    /*!
+     *  \brief Enqueue
+     *
+     *  Queue an expired timer's callback to be run from the timer service
+     *  thread.  Called from the timer interrupt context.  If the timer's
+     *  callback is already pending (i.e. a repeating timer expiring faster
+     *  than its callback can be serviced), the expiry is coalesced into the
+     *  pending callback.
+     *
+     *  \param pclTimer_ Pointer to the expired timer
+     */
+    static void Enqueue(Timer *pclTimer_);
+
+    /*!
+     *  \brief Wake
+     *
+     *  Wake the timer service thread if any callbacks have been queued.
+     *  Called once by the timer scheduler at the end of each pass through
+     *  the expired timers, so that a batch of expiries costs a single wakeup.
+     */
+    static void Wake(void);
+
+    /*!
+     *  \brief Cancel
+     *
+     *  Remove a timer's pending callback from the work queue, if it has
+     *  one.  Called when a timer is stopped, so that no callback is run
+     *  for a timer that has been stopped.
+     *
+     *  \param pclTimer_ Pointer to the timer to cancel
+     */
+    static void Cancel(Timer *pclTimer_);
+
+private:
+    /*!
+     *  \brief Main
+     *
+     *  Entrypoint for the timer service thread.
+     *
+     *  \param unused_ Unused argument
+     */
+    static void Main(void *unused_);
+
+    static Thread    m_clThread;    //!< The timer service thread
+    static Semaphore m_clSemaphore; //!< Posted when callbacks are queued
+    static Timer    *m_pclHead;     //!< Head of the pending-callback queue
+    static Timer    *m_pclTail;     //!< Tail of the pending-callback queue
+
+    //! Stack for the timer service thread
+    static K_WORD    m_awStack[(KERNEL_TIMER_THREAD_STACK_SIZE + sizeof(K_WORD) - 1) / sizeof(K_WORD)];
+};
+
+#endif // KERNEL_USE_TIMER_THREAD
+
+#endif
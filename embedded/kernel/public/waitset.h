@@ -0,0 +1,288 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   waitset.h
+
+    \brief  Wait-set object, used to block on multiple objects at once
+*/
+
+#ifndef __WAITSET_H__
+#define __WAITSET_H__
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#include "blocking.h"
+#include "ksemaphore.h"
+#include "eventflag.h"
+#include "notify.h"
+#include "message.h"
+
+#if KERNEL_USE_WAITSET
+
+//---------------------------------------------------------------------------
+/*!
+ *  Types of objects which can be added to a wait-set
+ */
+typedef enum
+{
+    WAITSET_TYPE_SEMAPHORE,     //!< Semaphore - a count is taken on wakeup
+    WAITSET_TYPE_EVENTFLAG,     //!< Event flag - waits on a mask/mode
+    WAITSET_TYPE_NOTIFY,        //!< Notification object
+    WAITSET_TYPE_MESSAGE,       //!< Message queue - a message is received on wakeup
+//---
+    WAITSET_TYPES
+} WaitSetType_t;
+
+//---------------------------------------------------------------------------
+/*!
+ *  Wait-set blocking object.
+ *
+ *  A wait-set allows a single thread to block on several objects at once,
+ *  waking as soon as any one of them can be acquired.  Objects are added to
+ *  the set once, after which Wait() can be called repeatedly.  Each call
+ *  acquires exactly one object - in the same manner as that object's own
+ *  blocking call would - and returns the index of the object acquired.
+ *
+ *  Where several objects are ready at once, the object added to the set
+ *  first takes precedence.
+ *
+ *  Checking the objects and blocking the thread are performed within a
+ *  single critical section, and the objects signal the set when they
+ *  become ready, so no wakeups are lost between the two.
+ *
+ *  An object can belong to at most one wait-set at a time.  Only one thread
+ *  should wait on a given wait-set.
+ */
+class WaitSet : public BlockingObject
+{
+public:
+    void* operator new (size_t sz, void* pv) { return (WaitSet*)pv; };
+
+    ~WaitSet();
+
+    /*!
+     *  \brief Init
+     *
+     *  Initialize the wait-set prior to use.  The set is initially empty.
+     */
+    void Init();
+
+    /*!
+     *  \brief AddSemaphore
+     *
+     *  Add a semaphore to the set.  When this object is returned from
+     *  Wait(), the semaphore has been pended.
+     *
+     *  \param pclSemaphore_ Semaphore to add
+     *  \return Index of the object within the set, or -1 if the set is full
+     *          or the object already belongs to a set.
+     */
+    int8_t AddSemaphore(Semaphore *pclSemaphore_);
+
+#if KERNEL_USE_EVENTFLAG
+    /*!
+     *  \brief AddEventFlag
+     *
+     *  Add an event flag object to the set, with the mask and mode to wait
+     *  on (see EventFlag::Wait()).  When this object is returned from Wait(),
+     *  the matching flags can be read using GetEventFlagMask().
+     *
+     *  \param pclEventFlag_ Event flag object to add
+     *  \param uXMask_ Bitmask of flags to wait on
+     *  \param eMode_ Event flag operation to perform
+     *  \return Index of the object within the set, or -1 if the set is full
+     *          or the object already belongs to a set.
+     */
+    int8_t AddEventFlag(EventFlag *pclEventFlag_, FLAG_TYPE uXMask_, EventFlagOperation_t eMode_);
+#endif
+
+#if KERNEL_USE_NOTIFY
+    /*!
+     *  \brief AddNotify
+     *
+     *  Add a notification object to the set.  Unlike a thread blocked on the
+     *  object directly, signals that arrive while the waiting thread is busy
+     *  are latched by the set, and reported by the next call to Wait().
+     *
+     *  \param pclNotify_ Notification object to add
+     *  \return Index of the object within the set, or -1 if the set is full
+     *          or the object already belongs to a set.
+     */
+    int8_t AddNotify(Notify *pclNotify_);
+#endif
+
+#if KERNEL_USE_MESSAGE
+    /*!
+     *  \brief AddMessageQueue
+     *
+     *  Add a message queue to the set.  When this object is returned from
+     *  Wait(), a message has been received from the queue, and can be read
+     *  using GetMessage().
+     *
+     *  \param pclMessageQueue_ Message queue to add
+     *  \return Index of the object within the set, or -1 if the set is full
+     *          or the object already belongs to a set.
+     */
+    int8_t AddMessageQueue(MessageQueue *pclMessageQueue_);
+#endif
+
+    /*!
+     *  \brief Clear
+     *
+     *  Remove all objects from the set, allowing them to be used normally
+     *  (or added to another set).
+     */
+    void Clear();
+
+    /*!
+     *  \brief Wait
+     *
+     *  Block the current thread until one of the objects in the set can be
+     *  acquired, and acquire it.
+     *
+     *  \return Index of the object acquired
+     */
+    int8_t Wait();
+
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     *  \brief Wait
+     *
+     *  Block the current thread until one of the objects in the set can be
+     *  acquired, and acquire it, or until the timeout expires.
+     *
+     *  \param u32TimeMS_ Time to wait, in ms.  0 waits forever.
+     *  \return Index of the object acquired, or -1 on timeout
+     */
+    int8_t Wait(uint32_t u32TimeMS_);
+#endif
+
+    /*!
+     *  \brief GetEventFlagMask
+     *
+     *  Return the flags that matched, where the object acquired by the last
+     *  call to Wait() was an event flag object.
+     *
+     *  \return Matching event flags
+     */
+    FLAG_TYPE GetEventFlagMask() { return m_uXEventMask; }
+
+#if KERNEL_USE_MESSAGE
+    /*!
+     *  \brief GetMessage
+     *
+     *  Return the message received, where the object acquired by the last
+     *  call to Wait() was a message queue.
+     *
+     *  \return Pointer to the message received
+     */
+    Message *GetMessage() { return m_pclMessage; }
+#endif
+
+    /*!
+     *  \brief Signal
+     *
+     *  Called by an object in the set when it becomes signalled.  Wakes the
+     *  thread waiting on the set, so that it can attempt to acquire the
+     *  object.  Called from within a critical section.
+     *
+     *  \param pclObject_ Object that has been signalled
+     */
+    void Signal(BlockingObject *pclObject_);
+
+    /*!
+     *  \brief WakeMe
+     *
+     *  Wake the specified thread from its current blocking queue.  Note that
+     *  this is only public in order to be accessible from a timer callback.
+     *
+     *  \param pclChosenOne_ Thread to wake up
+     */
+    void WakeMe(Thread *pclChosenOne_);
+
+private:
+    //! Object registered in a wait-set
+    typedef struct
+    {
+        BlockingObject      *pclObject;     //!< Object in the set
+        void                *pvOwner;       //!< Owning queue, for message queues
+        FLAG_TYPE            uXMask;        //!< Event flag mask to wait on
+        uint8_t              u8Mode;        //!< Event flag operation
+        uint8_t              u8Type;        //!< Object type (WaitSetType_t)
+        volatile bool        bLatched;      //!< Signal latched, for notify objects
+    } WaitSetEntry_t;
+
+    /*!
+     *  \brief Add
+     *
+     *  Add an object to the set.
+     *
+     *  \param pclObject_ Object to add
+     *  \param eType_ Type of object
+     *  \return Index of the new entry, or -1 on failure
+     */
+    int8_t Add(BlockingObject *pclObject_, WaitSetType_t eType_);
+
+    /*!
+     *  \brief TryAcquire
+     *
+     *  Attempt to acquire the first available object in the set, without
+     *  blocking.  Must be called from within a critical section.
+     *
+     *  \return Index of the object acquired, or -1 if none are available
+     */
+    int8_t TryAcquire();
+
+#if KERNEL_USE_TIMEOUTS
+    /*!
+     *  \brief Wait_i
+     *
+     *  Internal wait implementation, shared by the timed and untimed
+     *  variants.
+     *
+     *  \param u32TimeMS_ Time to wait, in ms.  0 waits forever.
+     *  \return Index of the object acquired, or -1 on timeout
+     */
+    int8_t Wait_i(uint32_t u32TimeMS_);
+#else
+    /*!
+     *  \brief Wait_i
+     *
+     *  Internal wait implementation.
+     *
+     *  \return Index of the object acquired
+     */
+    int8_t Wait_i();
+#endif
+
+    //! Objects registered in the set
+    WaitSetEntry_t m_astEntries[KERNEL_WAITSET_MAX_OBJECTS];
+
+    //! Number of objects registered in the set
+    uint8_t m_u8Count;
+
+    //! Flags matched by the last event flag acquired
+    FLAG_TYPE m_uXEventMask;
+
+#if KERNEL_USE_MESSAGE
+    //! Message received from the last message queue acquired
+    Message *m_pclMessage;
+#endif
+};
+
+#endif // KERNEL_USE_WAITSET
+
+#endif // __WAITSET_H__
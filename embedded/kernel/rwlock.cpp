@@ -0,0 +1,502 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   rwlock.cpp
+
+    \brief  Reader-writer lock implementation
+
+*/
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#include "blocking.h"
+#include "kernel.h"
+#include "thread.h"
+#include "mutex.h"
+#include "rwlock.h"
+
+#define _CAN_HAS_DEBUG
+//--[Autogenerated - Do Not Modify]------------------------------------------
+#include "dbg_file_list.h"
+#include "buffalogger.h"
+#if defined(DBG_FILE)
+# error "Debug logging file token already defined!  Bailing."
+#else
+# define DBG_FILE _DBG___KERNEL_RWLOCK_CPP
+#endif
+//--[End Autogenerated content]----------------------------------------------
+#include "kerneldebug.h"
+
+#if KERNEL_USE_RWLOCK
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+/*!
+ * \brief TimedRWLock_Callback
+ *
+ * This function is called from the timer-expired context to trigger a timeout
+ * on this lock.  This results in the waking of the thread that generated
+ * the lock claim call that was not completed in time.
+ *
+ * \param pclOwner_ Pointer to the thread to wake
+ * \param pvData_   Pointer to the lock object that the thread is blocked on
+ */
+void TimedRWLock_Callback(Thread *pclOwner_, void *pvData_)
+{
+    RWLock *pclLock = static_cast<RWLock*>(pvData_);
+
+    if (pclLock->WakeMe(pclOwner_))
+    {
+        Thread::Yield();
+    }
+}
+
+//---------------------------------------------------------------------------
+bool RWLock::WakeMe(Thread *pclOwner_)
+{
+    bool bSchedule = false;
+
+    CS_ENTER();
+
+    // The thread may have been handed the lock just ahead of the timeout
+    if ((pclOwner_->GetCurrent() == &m_clBlockList) ||
+        (pclOwner_->GetCurrent() == &m_clReaderList))
+    {
+        pclOwner_->SetExpired(true);
+        UnBlock(pclOwner_);
+        if (pclOwner_->GetCurPriority() >= Scheduler::GetCurrentThread()->GetCurPriority())
+        {
+            bSchedule = true;
+        }
+
+        // The holders no longer inherit this thread's priority
+        if (Update_i())
+        {
+            bSchedule = true;
+        }
+
+        // A writer giving up may let the readers queued behind it in
+        if (Grant_i())
+        {
+            bSchedule = true;
+        }
+    }
+
+    CS_EXIT();
+
+    return bSchedule;
+}
+#endif
+
+//---------------------------------------------------------------------------
+RWLock::~RWLock()
+{
+    // If there are any threads waiting on this object when it goes out
+    // of scope, set a kernel panic.
+    if (m_clBlockList.GetHead() || m_clReaderList.GetHead())
+    {
+        Kernel::Panic(PANIC_ACTIVE_RWLOCK_DESCOPED);
+    }
+}
+
+//---------------------------------------------------------------------------
+void RWLock::Init()
+{
+    uint8_t i;
+
+    m_clBlockList.Init();
+    m_clReaderList.Init();
+#if KERNEL_USE_WAITSET
+    m_pclWaitSet = NULL;
+#endif
+    m_pclWriter = NULL;
+    m_stWriterHold.pclLock = this;
+    for (i = 0; i < KERNEL_RWLOCK_MAX_READERS; i++)
+    {
+        m_apclReaders[i] = NULL;
+        m_astReaderHold[i].pclLock = this;
+    }
+    m_u8Readers = 0;
+    m_uXMaxPri = 0;
+}
+
+//---------------------------------------------------------------------------
+/*!
+ * \brief UpdateHolder
+ *
+ * Set a lock holder's priority to whatever it's entitled to through the
+ * locks it holds.
+ *
+ * \param pclHolder_ Thread holding the lock
+ * \return true if the thread's priority was changed
+ */
+static bool UpdateHolder(Thread *pclHolder_)
+{
+    PRIO_TYPE uXPriority = Mutex::InheritedPriority(pclHolder_);
+    if (uXPriority == pclHolder_->GetCurPriority())
+    {
+        return false;
+    }
+    pclHolder_->InheritPriority(uXPriority);
+    return true;
+}
+
+//---------------------------------------------------------------------------
+PRIO_TYPE RWLock::InheritedPriority( Thread *pclThread_, PRIO_TYPE uXPriority_ )
+{
+    RWLockHold_t *pstHold = pclThread_->m_pstHeldRWLock;
+
+    while (pstHold)
+    {
+        if (pstHold->pclLock->m_uXMaxPri > uXPriority_)
+        {
+            uXPriority_ = pstHold->pclLock->m_uXMaxPri;
+        }
+        pstHold = pstHold->pstNext;
+    }
+    return uXPriority_;
+}
+
+//---------------------------------------------------------------------------
+void RWLock::Own_i( Thread *pclThread_, bool bWrite_ )
+{
+    RWLockHold_t *pstHold;
+    uint8_t i;
+
+    if (bWrite_)
+    {
+        m_pclWriter = pclThread_;
+        pstHold = &m_stWriterHold;
+    }
+    else
+    {
+        // Take the first free reader slot
+        for (i = 0; i < KERNEL_RWLOCK_MAX_READERS; i++)
+        {
+            if (!m_apclReaders[i])
+            {
+                break;
+            }
+        }
+        KERNEL_ASSERT( i < KERNEL_RWLOCK_MAX_READERS );
+
+        m_apclReaders[i] = pclThread_;
+        m_u8Readers++;
+        pstHold = &m_astReaderHold[i];
+    }
+
+    pstHold->pstNext = pclThread_->m_pstHeldRWLock;
+    pclThread_->m_pstHeldRWLock = pstHold;
+}
+
+//---------------------------------------------------------------------------
+void RWLock::Disown_i( RWLockHold_t *pstHold_ )
+{
+    RWLockHold_t **ppstHold = &g_pclCurrent->m_pstHeldRWLock;
+
+    // As with mutexes, locks are usually released in the reverse order they
+    // were claimed, so this is normally the head of the list.
+    while (*ppstHold != pstHold_)
+    {
+        ppstHold = &(*ppstHold)->pstNext;
+    }
+    *ppstHold = pstHold_->pstNext;
+    pstHold_->pstNext = NULL;
+}
+
+//---------------------------------------------------------------------------
+bool RWLock::Update_i()
+{
+    Thread *pclWaiter;
+    bool bChanged = false;
+    uint8_t i;
+
+    // Both wait lists are kept in priority order - the heads are the highest
+    // priority waiters.
+    m_uXMaxPri = 0;
+    pclWaiter = m_clBlockList.HighestWaiter();
+    if (pclWaiter)
+    {
+        m_uXMaxPri = pclWaiter->GetCurPriority();
+    }
+    pclWaiter = m_clReaderList.HighestWaiter();
+    if (pclWaiter && (pclWaiter->GetCurPriority() > m_uXMaxPri))
+    {
+        m_uXMaxPri = pclWaiter->GetCurPriority();
+    }
+
+    // Only the holders inherit - raise or restore each of them as required,
+    // taking the other locks they hold into account.
+    if (m_pclWriter && UpdateHolder(m_pclWriter))
+    {
+        bChanged = true;
+    }
+    for (i = 0; i < KERNEL_RWLOCK_MAX_READERS; i++)
+    {
+        if (m_apclReaders[i] && UpdateHolder(m_apclReaders[i]))
+        {
+            bChanged = true;
+        }
+    }
+    return bChanged;
+}
+
+//---------------------------------------------------------------------------
+bool RWLock::Grant_i()
+{
+    Thread *pclChosenOne;
+    bool bSchedule = false;
+    bool bGranted = false;
+
+    if (m_pclWriter)
+    {
+        return false;
+    }
+
+    // Writers take precedence, once the active readers have drained.
+    if (m_clBlockList.GetHead())
+    {
+        if (!m_u8Readers)
+        {
+            pclChosenOne = m_clBlockList.HighestWaiter();
+            UnBlock(pclChosenOne);
+            Own_i(pclChosenOne, true);
+            bGranted = true;
+
+            if (pclChosenOne->GetCurPriority() >= Scheduler::GetCurrentThread()->GetCurPriority())
+            {
+                bSchedule = true;
+            }
+        }
+    }
+    else
+    {
+        // No writers waiting - let in as many readers as we can.
+        while (m_clReaderList.GetHead() && (m_u8Readers < KERNEL_RWLOCK_MAX_READERS))
+        {
+            pclChosenOne = m_clReaderList.HighestWaiter();
+            UnBlock(pclChosenOne);
+            Own_i(pclChosenOne, false);
+            bGranted = true;
+
+            if (pclChosenOne->GetCurPriority() >= Scheduler::GetCurrentThread()->GetCurPriority())
+            {
+                bSchedule = true;
+            }
+        }
+    }
+
+    // The new holders inherit the priority of the threads still waiting.
+    if (bGranted && Update_i() &&
+        (m_uXMaxPri >= Scheduler::GetCurrentThread()->GetCurPriority()))
+    {
+        bSchedule = true;
+    }
+    return bSchedule;
+}
+
+//---------------------------------------------------------------------------
+#if KERNEL_USE_TIMEOUTS
+bool RWLock::Lock_i( bool bWrite_, uint32_t u32WaitTimeMS_ )
+#else
+void RWLock::Lock_i( bool bWrite_ )
+#endif
+{
+    KERNEL_TRACE_1( "Claiming RWLock, Thread %d", (uint16_t)g_pclCurrent->GetID() );
+
+    Thread *pclThis = g_pclCurrent;
+    bool bBlock;
+#if KERNEL_USE_TIMEOUTS
+    bool bUseTimer = false;
+#endif
+
+    CS_ENTER();
+
+    if (bWrite_)
+    {
+        bBlock = (m_pclWriter || m_u8Readers);
+    }
+    else
+    {
+        // Queue up behind any waiting writers
+        bBlock = (m_pclWriter || m_clBlockList.GetHead() ||
+                  (m_u8Readers >= KERNEL_RWLOCK_MAX_READERS));
+    }
+
+    if (!bBlock)
+    {
+        // Nobody's waiting if the lock can be taken, so there's no priority
+        // to inherit.
+        Own_i(pclThis, bWrite_);
+    }
+    else
+    {
+        // Locks aren't recursive
+        KERNEL_ASSERT( pclThis != m_pclWriter );
+
+#if KERNEL_USE_TIMEOUTS
+        if (u32WaitTimeMS_)
+        {
+            pclThis->StartTimeout(u32WaitTimeMS_, (TimerCallback_t)TimedRWLock_Callback, (void*)this);
+            bUseTimer = true;
+        }
+#endif
+        if (bWrite_)
+        {
+            BlockPriority(pclThis);
+        }
+        else
+        {
+            Scheduler::Remove(pclThis);
+            m_clReaderList.AddPriority(pclThis);
+            pclThis->SetCurrent(&m_clReaderList);
+            pclThis->SetState(THREAD_STATE_BLOCKED);
+        }
+
+        // The holders inherit our priority if it's higher than theirs, as
+        // in Mutex::Claim_i()
+        Update_i();
+
+        // The lock is handed to us (or the timeout expires) while we're
+        // blocked.
+        Thread::Yield();
+    }
+
+    CS_EXIT();
+
+#if KERNEL_USE_TIMEOUTS
+    if (bUseTimer)
+    {
+        return pclThis->StopTimeout();
+    }
+    return true;
+#endif
+}
+
+//---------------------------------------------------------------------------
+void RWLock::ReadLock()
+{
+#if KERNEL_USE_TIMEOUTS
+    Lock_i(false, 0);
+#else
+    Lock_i(false);
+#endif
+}
+
+//---------------------------------------------------------------------------
+void RWLock::WriteLock()
+{
+#if KERNEL_USE_TIMEOUTS
+    Lock_i(true, 0);
+#else
+    Lock_i(true);
+#endif
+}
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+bool RWLock::ReadLock( uint32_t u32WaitTimeMS_ )
+{
+    return Lock_i(false, u32WaitTimeMS_);
+}
+
+//---------------------------------------------------------------------------
+bool RWLock::WriteLock( uint32_t u32WaitTimeMS_ )
+{
+    return Lock_i(true, u32WaitTimeMS_);
+}
+#endif
+
+//---------------------------------------------------------------------------
+bool RWLock::Release_i()
+{
+    bool bSchedule = false;
+
+    // Restore the thread's original priority - or whatever it's still
+    // entitled to through any other locks it holds.
+    PRIO_TYPE uXPriority = Mutex::InheritedPriority(g_pclCurrent);
+    if (g_pclCurrent->GetCurPriority() != uXPriority)
+    {
+        g_pclCurrent->InheritPriority(uXPriority);
+        bSchedule = true;
+    }
+
+    if (Grant_i())
+    {
+        bSchedule = true;
+    }
+    return bSchedule;
+}
+
+//---------------------------------------------------------------------------
+void RWLock::ReadUnlock()
+{
+    KERNEL_TRACE_1( "Releasing RWLock (read), Thread %d", (uint16_t)g_pclCurrent->GetID() );
+
+    bool bSchedule;
+    uint8_t i;
+
+    CS_ENTER();
+
+    // Find this thread in the reader table, and remove it.
+    for (i = 0; i < KERNEL_RWLOCK_MAX_READERS; i++)
+    {
+        if (m_apclReaders[i] == g_pclCurrent)
+        {
+            break;
+        }
+    }
+    KERNEL_ASSERT( i < KERNEL_RWLOCK_MAX_READERS );
+
+    m_apclReaders[i] = NULL;
+    m_u8Readers--;
+    Disown_i(&m_astReaderHold[i]);
+
+    bSchedule = Release_i();
+
+    CS_EXIT();
+
+    if (bSchedule)
+    {
+        Thread::Yield();
+    }
+}
+
+//---------------------------------------------------------------------------
+void RWLock::WriteUnlock()
+{
+    KERNEL_TRACE_1( "Releasing RWLock (write), Thread %d", (uint16_t)g_pclCurrent->GetID() );
+
+    bool bSchedule;
+
+    CS_ENTER();
+
+    // This thread had better be the one that owns the lock currently...
+    KERNEL_ASSERT( (g_pclCurrent == m_pclWriter) );
+    m_pclWriter = NULL;
+    Disown_i(&m_stWriterHold);
+
+    bSchedule = Release_i();
+
+    CS_EXIT();
+
+    if (bSchedule)
+    {
+        Thread::Yield();
+    }
+}
+
+#endif // KERNEL_USE_RWLOCK
@@ -93,13 +93,13 @@ void Scheduler::Schedule()
 //---------------------------------------------------------------------------
 void Scheduler::Add(Thread *pclThread_)
 {
-    m_aclPriorities[pclThread_->GetPriority()].Add(pclThread_);
+    m_aclPriorities[pclThread_->GetCurPriority()].Add(pclThread_);
 }
 
 //---------------------------------------------------------------------------
 void Scheduler::Remove(Thread *pclThread_)
 {
-    m_aclPriorities[pclThread_->GetPriority()].Remove(pclThread_);
+    m_aclPriorities[pclThread_->GetCurPriority()].Remove(pclThread_);
 }
 
 //---------------------------------------------------------------------------
@@ -0,0 +1,312 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   streambuffer.cpp
+
+    \brief  Single-producer/single-consumer byte stream buffer implementation
+*/
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#include "kernel.h"
+#include "streambuffer.h"
+
+#define _CAN_HAS_DEBUG
+//--[Autogenerated - Do Not Modify]------------------------------------------
+#include "dbg_file_list.h"
+#include "buffalogger.h"
+#if defined(DBG_FILE)
+# error "Debug logging file token already defined!  Bailing."
+#else
+# define DBG_FILE _DBG___KERNEL_STREAMBUFFER_CPP
+#endif
+//--[End Autogenerated content]----------------------------------------------
+#include "kerneldebug.h"
+
+#if KERNEL_USE_STREAMBUFFER
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+/*!
+ * Overall deadline of a timed read, which may span several waits on the
+ * stream's semaphore.
+ */
+typedef struct
+{
+    Semaphore       *pclSemaphore;  //!< Semaphore the reader waits on
+    volatile bool   bExpired;       //!< Set once the read's time is up
+} ReadDeadline_t;
+
+//---------------------------------------------------------------------------
+/*!
+ * \brief ReadDeadline_Callback
+ *
+ * This function is called from the timer-expired context once a timed read
+ * has run out of time.  Flags the deadline, and wakes the reader from
+ * whichever wait it is in.
+ *
+ * \param pclOwner_ Pointer to the reading thread
+ * \param pvData_   Pointer to the read's deadline object
+ */
+static void ReadDeadline_Callback(Thread *pclOwner_, void *pvData_)
+{
+    ReadDeadline_t *pstDeadline = static_cast<ReadDeadline_t*>(pvData_);
+
+    pstDeadline->bExpired = true;
+    pstDeadline->pclSemaphore->Post();
+}
+#endif
+
+//---------------------------------------------------------------------------
+void StreamBuffer::Init( uint8_t *pau8Buffer_, uint16_t u16Size_ )
+{
+    KERNEL_ASSERT( pau8Buffer_ );
+    KERNEL_ASSERT( u16Size_ > 1 );
+
+    m_pau8Buffer = pau8Buffer_;
+    m_u16Size = u16Size_;
+    m_u16Head = 0;
+    m_u16Tail = 0;
+    m_u16Trigger = 1;
+    m_u16WakeLevel = 0;
+#if KERNEL_USE_TIMEOUTS
+    m_u32IdleMS = 0;
+#endif
+    m_clSemaphore.Init(0, 1);
+}
+
+//---------------------------------------------------------------------------
+void StreamBuffer::SetTriggerLevel( uint16_t u16Level_ )
+{
+    KERNEL_ASSERT( u16Level_ );
+    m_u16Trigger = u16Level_;
+}
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+void StreamBuffer::SetIdleTimeout( uint32_t u32IdleMS_ )
+{
+    m_u32IdleMS = u32IdleMS_;
+}
+#endif
+
+//---------------------------------------------------------------------------
+uint16_t StreamBuffer::Write( const uint8_t *pau8Data_, uint16_t u16Len_ )
+{
+    volatile uint8_t *pau8Buffer = m_pau8Buffer;
+    uint16_t u16Head = m_u16Head;
+    uint16_t u16Free = m_u16Size - 1 - Used_i(u16Head, m_u16Tail);
+    uint16_t u16Level;
+    uint16_t i;
+
+    if (u16Len_ > u16Free)
+    {
+        u16Len_ = u16Free;
+    }
+
+    // Copy the data in, ahead of the reader's view of the buffer
+    for (i = 0; i < u16Len_; i++)
+    {
+        pau8Buffer[u16Head++] = pau8Data_[i];
+        if (u16Head == m_u16Size)
+        {
+            u16Head = 0;
+        }
+    }
+
+    // Publish the data to the reader in a single store
+    m_u16Head = u16Head;
+
+    // Only wake the reader once it has enough data to work with.  The reader
+    // sets its wake level after sampling the head index, so either it has
+    // seen the data written above, or the level check here sees it waiting.
+    u16Level = m_u16WakeLevel;
+    if (u16Level && (Used_i(u16Head, m_u16Tail) >= u16Level))
+    {
+        m_u16WakeLevel = 0;
+        m_clSemaphore.Post();
+    }
+
+    return u16Len_;
+}
+
+//---------------------------------------------------------------------------
+uint16_t StreamBuffer::TryRead( uint8_t *pau8Data_, uint16_t u16Len_ )
+{
+    volatile uint8_t *pau8Buffer = m_pau8Buffer;
+    uint16_t u16Head;
+    uint16_t u16Tail;
+    uint16_t u16Used;
+    uint16_t i;
+
+    KERNEL_ASSERT( pau8Data_ );
+
+    // Index loads/stores aren't atomic on all targets, so sample the
+    // producer's index (and publish our own) with interrupts disabled.
+    CS_ENTER();
+    u16Head = m_u16Head;
+    CS_EXIT();
+
+    u16Tail = m_u16Tail;
+    u16Used = Used_i(u16Head, u16Tail);
+    if (u16Len_ > u16Used)
+    {
+        u16Len_ = u16Used;
+    }
+
+    for (i = 0; i < u16Len_; i++)
+    {
+        pau8Data_[i] = pau8Buffer[u16Tail++];
+        if (u16Tail == m_u16Size)
+        {
+            u16Tail = 0;
+        }
+    }
+
+    CS_ENTER();
+    m_u16Tail = u16Tail;
+    CS_EXIT();
+
+    return u16Len_;
+}
+
+//---------------------------------------------------------------------------
+#if KERNEL_USE_TIMEOUTS
+uint16_t StreamBuffer::Read_i( uint8_t *pau8Data_, uint16_t u16Len_, uint32_t u32TimeMS_ )
+#else
+uint16_t StreamBuffer::Read_i( uint8_t *pau8Data_, uint16_t u16Len_ )
+#endif
+{
+    uint16_t u16Level = (u16Len_ < m_u16Trigger) ? u16Len_ : m_u16Trigger;
+    uint16_t u16Used;
+    bool bBlock;
+#if KERNEL_USE_TIMEOUTS
+    Timer clDeadline;
+    ReadDeadline_t stDeadline;
+#endif
+
+    KERNEL_ASSERT( u16Len_ );
+
+#if KERNEL_USE_TIMEOUTS
+    // The reader can be woken several times before its request is met (i.e.
+    // on each byte of a frame, with an idle timeout), so the time limit is
+    // tracked by a timer of its own, rather than restarted on every wait.
+    stDeadline.pclSemaphore = &m_clSemaphore;
+    stDeadline.bExpired = false;
+    if (u32TimeMS_)
+    {
+        clDeadline.Init();
+        clDeadline.Start(false, u32TimeMS_, ReadDeadline_Callback, (void*)&stDeadline);
+    }
+#endif
+
+    while (1)
+    {
+        CS_ENTER();
+        u16Used = Used_i(m_u16Head, m_u16Tail);
+        bBlock = (u16Used < u16Level);
+        if (bBlock)
+        {
+#if KERNEL_USE_TIMEOUTS
+            // With an idle timeout, wake on the first byte of a frame too,
+            // so that we can tell when data stops arriving.
+            if (m_u32IdleMS && !u16Used)
+            {
+                m_u16WakeLevel = 1;
+            }
+            else
+#endif
+            {
+                m_u16WakeLevel = u16Level;
+            }
+        }
+        CS_EXIT();
+
+        if (!bBlock)
+        {
+            break;
+        }
+
+#if KERNEL_USE_TIMEOUTS
+        if (m_u32IdleMS && u16Used)
+        {
+            // Nothing new within the idle interval - the frame is complete
+            if (!m_clSemaphore.Pend(m_u32IdleMS) && (GetAvailable() == u16Used))
+            {
+                m_u16WakeLevel = 0;
+                break;
+            }
+        }
+        else
+        {
+            m_clSemaphore.Pend();
+        }
+
+        // Out of time - return whatever we have
+        if (stDeadline.bExpired)
+        {
+            m_u16WakeLevel = 0;
+            break;
+        }
+#else
+        m_clSemaphore.Pend();
+#endif
+    }
+
+#if KERNEL_USE_TIMEOUTS
+    if (u32TimeMS_)
+    {
+        clDeadline.Stop();
+    }
+#endif
+    return TryRead(pau8Data_, u16Len_);
+}
+
+//---------------------------------------------------------------------------
+uint16_t StreamBuffer::Read( uint8_t *pau8Data_, uint16_t u16Len_ )
+{
+#if KERNEL_USE_TIMEOUTS
+    return Read_i( pau8Data_, u16Len_, 0 );
+#else
+    return Read_i( pau8Data_, u16Len_ );
+#endif
+}
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+uint16_t StreamBuffer::Read( uint8_t *pau8Data_, uint16_t u16Len_, uint32_t u32TimeMS_ )
+{
+    return Read_i( pau8Data_, u16Len_, u32TimeMS_ );
+}
+#endif
+
+//---------------------------------------------------------------------------
+uint16_t StreamBuffer::GetAvailable()
+{
+    uint16_t u16Ret;
+    CS_ENTER();
+    u16Ret = Used_i(m_u16Head, m_u16Tail);
+    CS_EXIT();
+    return u16Ret;
+}
+
+//---------------------------------------------------------------------------
+uint16_t StreamBuffer::GetFree()
+{
+    return m_u16Size - 1 - GetAvailable();
+}
+
+#endif // KERNEL_USE_STREAMBUFFER
@@ -75,6 +75,17 @@ void Thread::Init(  K_WORD *pwStack_,
                 PRIO_TYPE uXPriority_,                
                 ThreadEntry_t pfEntryPoint_,
                 void *pvArg_ )
+{
+    Init_i(pwStack_, u16StackSize_, 0, uXPriority_, pfEntryPoint_, pvArg_);
+}
+
+//---------------------------------------------------------------------------
+void Thread::Init_i(  K_WORD *pwStack_,
+                uint16_t u16StackSize_,
+                uint16_t u16StackClean_,
+                PRIO_TYPE uXPriority_,
+                ThreadEntry_t pfEntryPoint_,
+                void *pvArg_ )
 {
     static uint8_t u8ThreadID = 0;
 
@@ -112,13 +123,39 @@ void Thread::Init(  K_WORD *pwStack_,
     m_pfEntryPoint = pfEntryPoint_;
     m_pvArg = pvArg_;
     m_eState = THREAD_STATE_STOP;
+#if KERNEL_USE_MUTEX
+    m_pclHeldMutex = NULL;
+    m_pclWaitMutex = NULL;
+#endif
+#if KERNEL_USE_RWLOCK
+    m_pstHeldRWLock = NULL;
+#endif
     
 #if KERNEL_USE_THREADNAME    
     m_szName = NULL;
 #endif
 #if KERNEL_USE_TIMERS
+    // The thread may be re-initialized while still blocked on a timeout - get
+    // its timer out of the timer-scheduler before resetting it.
+    if (m_clTimer.IsActive())
+    {
+        TimerScheduler::Remove(&m_clTimer);
+    }
     m_clTimer.Init();
 #endif
+#if KERNEL_USE_THREAD_NOTIFICATION
+    m_u32NotifyValue = 0;
+    m_u32NotifyMask = 0;
+#endif
+#if KERNEL_USE_THREAD_STATS
+    m_u32RunTime = 0;
+    m_u32Switches = 0;
+    m_clLoad.Init();
+#endif
+#if KERNEL_USE_AUTO_ALLOC
+    m_u16StackClean = u16StackClean_;
+    m_bAutoPooled = false;
+#endif
 
     // Call CPU-specific stack initialization
     ThreadPort::InitStack(this);
@@ -146,9 +183,22 @@ Thread* Thread::Init(uint16_t u16StackSize_,
                             ThreadEntry_t pfEntryPoint_,
                             void *pvArg_)
 {
-    Thread *pclNew    = (Thread*)AutoAlloc::Allocate(sizeof(Thread));
-    K_WORD *pwStack   = (K_WORD*)AutoAlloc::Allocate(u16StackSize_);
-    pclNew->Init(pwStack, u16StackSize_, uXPriority_, pfEntryPoint_, pvArg_ );
+    uint16_t u16Clean;
+    Thread *pclNew    = AutoAlloc::NewThread();
+    if (!pclNew)
+    {
+        return 0;
+    }
+
+    K_WORD *pwStack   = AutoAlloc::NewStack(&u16StackSize_, &u16Clean);
+    if (!pwStack)
+    {
+        AutoAlloc::DestroyThread(pclNew);
+        return 0;
+    }
+
+    pclNew->Init_i(pwStack, u16StackSize_, u16Clean, uXPriority_, pfEntryPoint_, pvArg_ );
+    pclNew->m_bAutoPooled = true;
     return pclNew;
 }
 #endif
@@ -209,8 +259,15 @@ void Thread::Stop()
     }
     else if (m_eState == THREAD_STATE_BLOCKED)
     {
-        m_pclCurrent->Remove(this);
+        // Threads waiting on their notification word aren't on any list
+        if (m_pclCurrent)
+        {
+            m_pclCurrent->Remove(this);
+        }
     }
+#if KERNEL_USE_THREAD_NOTIFICATION
+    m_u32NotifyMask = 0;
+#endif
 
     m_pclOwner = Scheduler::GetStopList();
     m_pclCurrent = m_pclOwner;
@@ -264,8 +321,15 @@ void Thread::Exit()
     else if ((m_eState == THREAD_STATE_BLOCKED) ||
              (m_eState == THREAD_STATE_STOP))
     {
-        m_pclCurrent->Remove(this);
+        // Threads waiting on their notification word aren't on any list
+        if (m_pclCurrent)
+        {
+            m_pclCurrent->Remove(this);
+        }
     }
+#if KERNEL_USE_THREAD_NOTIFICATION
+    m_u32NotifyMask = 0;
+#endif
 
     m_pclCurrent = 0;
     m_pclOwner = 0;
@@ -286,6 +350,19 @@ void Thread::Exit()
     TimerScheduler::Remove(&m_clTimer);
 #endif
 
+#if KERNEL_USE_AUTO_ALLOC
+    // Hand a pooled thread's stack and object back to AutoAlloc.  If this
+    // is the running thread, it carries on using both until the Yield()
+    // below switches it out - but they can only be handed out again by
+    // another thread creating a new one, which can't happen before then.
+    if (m_bAutoPooled)
+    {
+        m_bAutoPooled = false;
+        AutoAlloc::DestroyStack(m_pwStack, m_u16StackSize);
+        AutoAlloc::DestroyThread(this);
+    }
+#endif
+
     CS_EXIT();
     
     if (bReschedule) 
@@ -349,8 +426,210 @@ void Thread::USleep(uint32_t u32TimeUs_)
     TimerScheduler::Add(pclTimer);
     clSemaphore.Pend();
 }
+
+#if KERNEL_USE_MONOTONIC_TIME
+//---------------------------------------------------------------------------
+void Thread::SleepUntil(uint64_t u64Time_)
+{
+    Semaphore clSemaphore;
+    Timer *pclTimer = g_pclCurrent->GetTimer();
+    bool bDone = false;
+
+    clSemaphore.Init(0, 1);
+
+    // Sleeps longer than the timers' range take several steps.
+    while (!bDone)
+    {
+        // Read the time and start the timer in the same critical section,
+        // so that the timer expires exactly at the requested time.
+        CS_ENTER();
+        uint64_t u64Now = TimerScheduler::GetTime();
+        if (u64Now < u64Time_)
+        {
+            uint64_t u64Interval = u64Time_ - u64Now;
+            if (u64Interval > MAX_TIMER_TICKS)
+            {
+                u64Interval = MAX_TIMER_TICKS;
+            }
+
+            pclTimer->Init();
+            pclTimer->SetIntervalTicks((uint32_t)u64Interval);
+            pclTimer->SetCallback(ThreadSleepCallback);
+            pclTimer->SetData((void*)&clSemaphore);
+            pclTimer->SetFlags(TIMERLIST_FLAG_ONE_SHOT);
+            TimerScheduler::Add(pclTimer);
+        }
+        else
+        {
+            bDone = true;
+        }
+        CS_EXIT();
+
+        if (!bDone)
+        {
+            clSemaphore.Pend();
+        }
+    }
+}
+#endif
 #endif // KERNEL_USE_SLEEP
 
+#if KERNEL_USE_THREAD_NOTIFICATION
+//---------------------------------------------------------------------------
+bool Thread::WakeNotification_i()
+{
+    // Put the thread straight back in its ready list - it isn't on any
+    // other list while it waits.
+    m_u32NotifyMask = 0;
+    Scheduler::Add(this);
+    m_pclCurrent = m_pclOwner;
+    m_eState = THREAD_STATE_READY;
+
+    return (GetCurPriority() >= Scheduler::GetCurrentThread()->GetCurPriority());
+}
+
+//---------------------------------------------------------------------------
+void Thread::SendNotification( uint32_t u32Value_, NotifyAction_t eAction_ )
+{
+    bool bReschedule = false;
+
+    CS_ENTER();
+
+    switch (eAction_)
+    {
+        case NOTIFY_SET_BITS:
+            m_u32NotifyValue |= u32Value_;
+            break;
+        case NOTIFY_INCREMENT:
+            m_u32NotifyValue++;
+            break;
+        case NOTIFY_OVERWRITE:
+            m_u32NotifyValue = u32Value_;
+            break;
+        default:
+            break;
+    }
+
+    // Wake the thread if it's waiting on any of the bits now set
+    if (m_u32NotifyValue & m_u32NotifyMask)
+    {
+        bReschedule = WakeNotification_i();
+    }
+
+    CS_EXIT();
+
+    if (bReschedule)
+    {
+        Thread::Yield();
+    }
+}
+
+//---------------------------------------------------------------------------
+uint32_t Thread::GetNotification()
+{
+    uint32_t u32Ret;
+    CS_ENTER();
+    u32Ret = m_u32NotifyValue;
+    CS_EXIT();
+    return u32Ret;
+}
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+void Thread::NotificationTimeout( Thread *pclOwner_, void *pvData_ )
+{
+    Thread *pclThread = static_cast<Thread*>(pvData_);
+    bool bReschedule = false;
+
+    CS_ENTER();
+    // The notification may have arrived just ahead of the timeout
+    if (pclThread->m_u32NotifyMask)
+    {
+        pclThread->SetExpired(true);
+        bReschedule = pclThread->WakeNotification_i();
+    }
+    CS_EXIT();
+
+    if (bReschedule)
+    {
+        Thread::Yield();
+    }
+}
+#endif
+
+//---------------------------------------------------------------------------
+#if KERNEL_USE_TIMEOUTS
+uint32_t Thread::WaitNotification_i( uint32_t u32Mask_, uint32_t u32TimeMS_ )
+#else
+uint32_t Thread::WaitNotification_i( uint32_t u32Mask_ )
+#endif
+{
+    Thread *pclThis = g_pclCurrent;
+    uint32_t u32Ret;
+#if KERNEL_USE_TIMEOUTS
+    bool bUseTimer = false;
+#endif
+
+    KERNEL_ASSERT( u32Mask_ );
+
+    CS_ENTER();
+
+    if (!(pclThis->m_u32NotifyValue & u32Mask_))
+    {
+#if KERNEL_USE_TIMEOUTS
+        if (u32TimeMS_)
+        {
+            pclThis->StartTimeout(u32TimeMS_, Thread::NotificationTimeout, (void*)pclThis);
+            bUseTimer = true;
+        }
+#endif
+        // Take the thread off the ready list - there's no block list to put
+        // it on, SendNotification() adds it straight back.
+        pclThis->m_u32NotifyMask = u32Mask_;
+        Scheduler::Remove(pclThis);
+        pclThis->m_pclCurrent = 0;
+        pclThis->m_eState = THREAD_STATE_BLOCKED;
+
+        Thread::Yield();
+    }
+
+    CS_EXIT();
+
+#if KERNEL_USE_TIMEOUTS
+    if (bUseTimer)
+    {
+        pclThis->StopTimeout();
+    }
+#endif
+
+    // Consume the bits we were waiting on
+    CS_ENTER();
+    u32Ret = pclThis->m_u32NotifyValue & u32Mask_;
+    pclThis->m_u32NotifyValue &= ~u32Mask_;
+    CS_EXIT();
+
+    return u32Ret;
+}
+
+//---------------------------------------------------------------------------
+uint32_t Thread::WaitNotification( uint32_t u32Mask_ )
+{
+#if KERNEL_USE_TIMEOUTS
+    return WaitNotification_i( u32Mask_, 0 );
+#else
+    return WaitNotification_i( u32Mask_ );
+#endif
+}
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+uint32_t Thread::WaitNotification( uint32_t u32Mask_, uint32_t u32TimeMS_ )
+{
+    return WaitNotification_i( u32Mask_, u32TimeMS_ );
+}
+#endif
+#endif // KERNEL_USE_THREAD_NOTIFICATION
+
 //---------------------------------------------------------------------------
 uint16_t Thread::GetStackSlack()
 {
@@ -471,6 +750,19 @@ void Thread::SetPriority(PRIO_TYPE uXPriority_)
 //---------------------------------------------------------------------------
 void Thread::InheritPriority(PRIO_TYPE uXPriority_)
 {    
+    // Ready threads are scheduled at their current priority - move the
+    // thread to the ready list for its new priority.  Blocked threads are
+    // put in the right list when they're woken.
+    if (m_eState == THREAD_STATE_READY)
+    {
+        Scheduler::Remove(this);
+        m_uXCurPriority = uXPriority_;
+        SetOwner(Scheduler::GetThreadList(uXPriority_));
+        Scheduler::Add(this);
+        SetCurrent(GetOwner());
+        return;
+    }
+
     SetOwner(Scheduler::GetThreadList(uXPriority_));
     m_uXCurPriority = uXPriority_;
 }
@@ -519,6 +811,22 @@ void Thread::SetExpired( bool bExpired_ )		{ m_bExpired = bExpired_; }
 
 //---------------------------------------------------------------------------
 bool Thread::GetExpired()						{ return m_bExpired; }
+
+//---------------------------------------------------------------------------
+void Thread::StartTimeout( uint32_t u32TimeMS_, TimerCallback_t pfCallback_, void *pvData_ )
+{
+    // The timer was initialized with the thread, and is always stopped
+    // before the thread can block again - no need to re-init it here.
+    m_bExpired = false;
+    m_clTimer.Start(0, u32TimeMS_, pfCallback_, pvData_);
+}
+
+//---------------------------------------------------------------------------
+bool Thread::StopTimeout()
+{
+    m_clTimer.Stop();
+    return !m_bExpired;
+}
 #endif
 
 #if KERNEL_USE_IDLE_FUNC
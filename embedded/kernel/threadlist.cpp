@@ -70,7 +70,7 @@ void ThreadList::AddPriority(LinkListNode *node_) {
     }
     PRIO_TYPE uXHeadPri = pclCurr->GetCurPriority();
 
-    Thread *pclTail = static_cast<Thread*>(GetTail());
+    Thread *pclHead = pclCurr;
     Thread *pclNode = static_cast<Thread*>(node_);
 
     // Set the threadlist's priority level, flag pointer, and then add the
@@ -83,9 +83,10 @@ void ThreadList::AddPriority(LinkListNode *node_) {
             break;
         }
         pclCurr = static_cast<Thread*>(pclCurr->GetNext());
-    } while (pclCurr != pclTail);
+    } while (pclCurr != pclHead);
 
-    // Insert pclNode before pclCurr in the linked list.
+    // Insert pclNode before pclCurr in the linked list.  If we wrapped back
+    // around to the head, this puts the node at the tail.
     InsertNodeBefore(pclNode, pclCurr);
 
     // If the priority is greater than current head, reset
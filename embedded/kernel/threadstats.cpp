@@ -0,0 +1,300 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+
+    \file   threadstats.cpp
+
+    \brief  Per-thread CPU time accounting and load statistics
+*/
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#include "kernel.h"
+#include "thread.h"
+#include "threadport.h"
+#include "kernelprofile.h"
+#include "threadstats.h"
+
+#define _CAN_HAS_DEBUG
+//--[Autogenerated - Do Not Modify]------------------------------------------
+#include "dbg_file_list.h"
+#include "buffalogger.h"
+#if defined(DBG_FILE)
+# error "Debug logging file token already defined!  Bailing."
+#else
+# define DBG_FILE _DBG___KERNEL_THREADSTATS_CPP
+#endif
+//--[End Autogenerated content]----------------------------------------------
+#include "kerneldebug.h"
+
+#if KERNEL_USE_THREAD_STATS
+
+//---------------------------------------------------------------------------
+// Window indexes are timestamps shifted down, so they wrap along with them.
+#define WINDOW_MASK             (0xFFFFFFFFUL >> THREAD_STATS_WINDOW_SHIFT)
+#define WINDOW_OF(x)            ((x) >> THREAD_STATS_WINDOW_SHIFT)
+#define WINDOW_START(x)         ((uint32_t)(x) << THREAD_STATS_WINDOW_SHIFT)
+#define WINDOW_TO_LOAD(x)       ((uint16_t)(((uint32_t)(x) * THREAD_LOAD_SCALE) >> THREAD_STATS_WINDOW_SHIFT))
+
+// After this many windows, any load average has fully decayed (or saturated)
+#define LOAD_WINDOW_LIMIT       ((uint32_t)16 << THREAD_STATS_LOAD_SHIFT)
+
+//---------------------------------------------------------------------------
+uint32_t    ThreadStats::m_u32StartTime;
+uint32_t    ThreadStats::m_u32LastSample;
+uint32_t    ThreadStats::m_u32Switches;
+uint32_t    ThreadStats::m_u32IdleTime;
+uint32_t    ThreadStats::m_u32IdleSwitches;
+LoadAverage ThreadStats::m_clIdleLoad;
+
+//---------------------------------------------------------------------------
+/*!
+ *  \brief LoadAverage_Fold
+ *
+ *  Fold one window's worth of load into a load average.  Always moves the
+ *  average by at least one step towards the new value, so that it settles
+ *  exactly at 0 or THREAD_LOAD_SCALE rather than a rounding error away.
+ *
+ *  \param u16Load_ Current load average
+ *  \param u16Window_ Load measured over the window
+ *  \return New load average
+ */
+static uint16_t LoadAverage_Fold(uint16_t u16Load_, uint16_t u16Window_)
+{
+    uint16_t u16Step;
+    if (u16Window_ > u16Load_)
+    {
+        u16Step = (u16Window_ - u16Load_ + (1 << THREAD_STATS_LOAD_SHIFT) - 1) >> THREAD_STATS_LOAD_SHIFT;
+        return u16Load_ + u16Step;
+    }
+    u16Step = (u16Load_ - u16Window_ + (1 << THREAD_STATS_LOAD_SHIFT) - 1) >> THREAD_STATS_LOAD_SHIFT;
+    return u16Load_ - u16Step;
+}
+
+//---------------------------------------------------------------------------
+void LoadAverage::Init(void)
+{
+    m_u32Window = 0;
+    m_u32Time = 0;
+    m_u16Load = 0;
+}
+
+//---------------------------------------------------------------------------
+void LoadAverage::Advance(uint32_t u32Window_)
+{
+    uint32_t u32Elapsed = (u32Window_ - m_u32Window) & WINDOW_MASK;
+    if (!u32Elapsed)
+    {
+        return;
+    }
+
+    // Close out the window we were accumulating into...
+    m_u16Load = LoadAverage_Fold(m_u16Load, WINDOW_TO_LOAD(m_u32Time));
+    u32Elapsed--;
+
+    // ... and any windows since then, which were spent not running.
+    if (u32Elapsed > LOAD_WINDOW_LIMIT)
+    {
+        m_u16Load = 0;
+    }
+    else
+    {
+        while (u32Elapsed-- && m_u16Load)
+        {
+            m_u16Load = LoadAverage_Fold(m_u16Load, 0);
+        }
+    }
+
+    m_u32Window = u32Window_;
+    m_u32Time = 0;
+}
+
+//---------------------------------------------------------------------------
+void LoadAverage::Add(uint32_t u32Start_, uint32_t u32End_)
+{
+    uint32_t u32Window = WINDOW_OF(u32Start_);
+    uint32_t u32Last = WINDOW_OF(u32End_);
+
+    Advance(u32Window);
+    if (u32Window != u32Last)
+    {
+        // Finish out the window the period started in
+        uint32_t u32Full = ((u32Last - u32Window) & WINDOW_MASK) - 1;
+        m_u32Time += WINDOW_START(u32Window + 1) - u32Start_;
+        Advance((u32Window + 1) & WINDOW_MASK);
+
+        // Every window spanned in its entirety was spent running
+        if (u32Full > LOAD_WINDOW_LIMIT)
+        {
+            m_u16Load = THREAD_LOAD_SCALE;
+        }
+        else
+        {
+            while (u32Full-- && (m_u16Load != THREAD_LOAD_SCALE))
+            {
+                m_u16Load = LoadAverage_Fold(m_u16Load, THREAD_LOAD_SCALE);
+            }
+        }
+        m_u32Window = u32Last;
+        u32Start_ = WINDOW_START(u32Last);
+    }
+    m_u32Time += u32End_ - u32Start_;
+}
+
+//---------------------------------------------------------------------------
+uint16_t LoadAverage::Get(uint32_t u32Now_)
+{
+    Advance(WINDOW_OF(u32Now_));
+    return m_u16Load;
+}
+
+//---------------------------------------------------------------------------
+void ThreadStats::Init(void)
+{
+    CS_ENTER();
+    Profiler::Start();
+    m_u32LastSample = 0;
+    m_u32StartTime = Sample();
+    m_u32Switches = 0;
+    m_u32IdleTime = 0;
+    m_u32IdleSwitches = 0;
+    m_clIdleLoad.Init();
+    CS_EXIT();
+}
+
+//---------------------------------------------------------------------------
+uint32_t ThreadStats::Sample(void)
+{
+    Thread *pclCurrent = g_pclCurrent;
+    uint32_t u32Now;
+    uint32_t u32Elapsed;
+
+    // Timestamp = epoch and count of the profiling timer.  The count must be
+    // read first - some ports derive the epoch from the last count read.
+    u32Now = (uint32_t)Profiler::Read();
+    u32Now += Profiler::GetEpoch() * TICKS_PER_OVERFLOW;
+
+    // With interrupts disabled, the counter can wrap before the epoch is
+    // updated.  Correct for that, and never let time run backwards.
+    if ((int32_t)(u32Now - m_u32LastSample) < 0)
+    {
+        u32Now += TICKS_PER_OVERFLOW;
+        if ((int32_t)(u32Now - m_u32LastSample) < 0)
+        {
+            u32Now = m_u32LastSample;
+        }
+    }
+
+    // Charge the elapsed time to whatever was running
+    if (pclCurrent)
+    {
+        u32Elapsed = u32Now - m_u32LastSample;
+        if (!pclCurrent->GetCurPriority())
+        {
+            m_u32IdleTime += u32Elapsed;
+            m_clIdleLoad.Add(m_u32LastSample, u32Now);
+        }
+#if KERNEL_USE_IDLE_FUNC
+        // The idle "thread" is only a placeholder, with no space for stats
+        if (pclCurrent != Kernel::GetIdleThread())
+#endif
+        {
+            pclCurrent->m_u32RunTime += u32Elapsed;
+            pclCurrent->m_clLoad.Add(m_u32LastSample, u32Now);
+        }
+    }
+
+    m_u32LastSample = u32Now;
+    return u32Now;
+}
+
+//---------------------------------------------------------------------------
+void ThreadStats::Switch(Thread *pclNext_)
+{
+    Sample();
+
+    if (pclNext_ != g_pclCurrent)
+    {
+        m_u32Switches++;
+        if (!pclNext_->GetCurPriority())
+        {
+            m_u32IdleSwitches++;
+        }
+#if KERNEL_USE_IDLE_FUNC
+        if (pclNext_ != Kernel::GetIdleThread())
+#endif
+        {
+            pclNext_->m_u32Switches++;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+void ThreadStats::GetThread(Thread *pclThread_, CpuUsage_t *pstUsage_)
+{
+    uint32_t u32Now;
+
+#if KERNEL_USE_IDLE_FUNC
+    if (pclThread_ == Kernel::GetIdleThread())
+    {
+        GetIdle(pstUsage_);
+        return;
+    }
+#endif
+
+    CS_ENTER();
+    u32Now = Sample();
+    pstUsage_->u32RunTime = pclThread_->m_u32RunTime;
+    pstUsage_->u32Switches = pclThread_->m_u32Switches;
+    pstUsage_->u16Load = pclThread_->m_clLoad.Get(u32Now);
+    CS_EXIT();
+}
+
+//---------------------------------------------------------------------------
+void ThreadStats::GetIdle(CpuUsage_t *pstUsage_)
+{
+    uint32_t u32Now;
+
+    CS_ENTER();
+    u32Now = Sample();
+    pstUsage_->u32RunTime = m_u32IdleTime;
+    pstUsage_->u32Switches = m_u32IdleSwitches;
+    pstUsage_->u16Load = m_clIdleLoad.Get(u32Now);
+    CS_EXIT();
+}
+
+//---------------------------------------------------------------------------
+uint32_t ThreadStats::GetTotalTime(void)
+{
+    uint32_t u32Ret;
+
+    CS_ENTER();
+    u32Ret = Sample() - m_u32StartTime;
+    CS_EXIT();
+    return u32Ret;
+}
+
+//---------------------------------------------------------------------------
+uint32_t ThreadStats::GetTotalSwitches(void)
+{
+    uint32_t u32Ret;
+
+    CS_ENTER();
+    u32Ret = m_u32Switches;
+    CS_EXIT();
+    return u32Ret;
+}
+
+#endif // KERNEL_USE_THREAD_STATS
@@ -0,0 +1,119 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+
+    \file   ticklessidle.cpp
+
+    \brief  Kernel-managed tickless idle, with deadline-aware sleep states
+*/
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#include "scheduler.h"
+#include "thread.h"
+#include "threadport.h"
+#include "timerscheduler.h"
+#include "ticklessidle.h"
+
+#define _CAN_HAS_DEBUG
+//--[Autogenerated - Do Not Modify]------------------------------------------
+#include "dbg_file_list.h"
+#include "buffalogger.h"
+#if defined(DBG_FILE)
+# error "Debug logging file token already defined!  Bailing."
+#else
+# define DBG_FILE _DBG___KERNEL_TICKLESSIDLE_CPP
+#endif
+//--[End Autogenerated content]----------------------------------------------
+#include "kerneldebug.h"
+
+#if KERNEL_USE_TICKLESS_IDLE
+
+//---------------------------------------------------------------------------
+const SleepState_t *TicklessIdle::m_pastStates;
+uint8_t             TicklessIdle::m_u8NumStates;
+idle_governor_t     TicklessIdle::m_pfGovernor;
+uint32_t            TicklessIdle::m_u32Wakeups;
+uint32_t            TicklessIdle::m_u32HaltedTicks;
+
+//---------------------------------------------------------------------------
+void TicklessIdle::Init(void)
+{
+    m_pastStates = 0;
+    m_u8NumStates = 0;
+    m_pfGovernor = 0;
+    m_u32Wakeups = 0;
+    m_u32HaltedTicks = 0;
+}
+
+//---------------------------------------------------------------------------
+void TicklessIdle::SetStates(const SleepState_t *pastStates_, uint8_t u8NumStates_)
+{
+    CS_ENTER();
+    m_pastStates = pastStates_;
+    m_u8NumStates = u8NumStates_;
+    CS_EXIT();
+}
+
+//---------------------------------------------------------------------------
+void TicklessIdle::Enter(void)
+{
+    uint32_t u32Deadline;
+    uint32_t u32Halted;
+    uint8_t u8State;
+
+    CS_ENTER();
+
+    // Don't go to sleep if an interrupt has made a thread ready since the
+    // scheduler last ran - there's work to do.
+    u8State = 0;
+    if (Scheduler::GetNextThread() == Scheduler::GetCurrentThread())
+    {
+        u8State = m_u8NumStates;
+        if (m_pfGovernor)
+        {
+            uint8_t u8Allowed = m_pfGovernor();
+            if (u8Allowed < u8State)
+            {
+                u8State = u8Allowed;
+            }
+        }
+    }
+
+    // Find the deepest state that can wake up before the next timer expires
+    u32Deadline = TimerScheduler::GetTimeToExpiry();
+    while (u8State && (m_pastStates[u8State - 1].u32WakeLatency > u32Deadline))
+    {
+        u8State--;
+    }
+
+    if (u8State)
+    {
+        const SleepState_t *pstState = &m_pastStates[u8State - 1];
+
+        u32Halted = pstState->pfEnter(u32Deadline - pstState->u32WakeLatency);
+        if (u32Halted)
+        {
+            // The kernel timer stood still while we slept - catch it up.
+            TimerScheduler::Compensate(u32Halted);
+            m_u32HaltedTicks += u32Halted;
+        }
+        m_u32Wakeups++;
+    }
+
+    CS_EXIT();
+}
+
+#endif // KERNEL_USE_TICKLESS_IDLE
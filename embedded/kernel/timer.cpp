@@ -28,6 +28,7 @@ See license.txt for more information
 #include "kerneltimer.h"
 #include "threadport.h"
 #include "quantum.h"
+#include "timerthread.h"
 
 #define _CAN_HAS_DEBUG
 //--[Autogenerated - Do Not Modify]------------------------------------------
@@ -44,41 +45,53 @@ See license.txt for more information
 
 #if KERNEL_USE_TIMERS
 
+//---------------------------------------------------------------------------
+void Timer::Init()
+{
+#if KERNEL_USE_TIMER_THREAD
+    // Unlink a pending deferred callback before its QUEUED flag is wiped -
+    // otherwise the timer thread's queue is cut short the next time the
+    // timer is queued.
+    if (m_u8Flags & TIMERLIST_FLAG_QUEUED)
+    {
+        TimerThread::Cancel(this);
+    }
+#endif
+    ClearNode();
+    m_u32Interval = 0;
+    m_u32TimerTolerance = 0;
+    m_u32TimeLeft = 0;
+    m_u8Flags = 0;
+}
+
 //---------------------------------------------------------------------------
 void Timer::Start( bool bRepeat_, uint32_t u32IntervalMs_, TimerCallback_t pfCallback_, void *pvData_ )
+{
+    Start(bRepeat_, u32IntervalMs_, 0, pfCallback_, pvData_);
+}
+
+//---------------------------------------------------------------------------
+void Timer::Start( bool bRepeat_, uint32_t u32IntervalMs_, uint32_t u32ToleranceMs_, TimerCallback_t pfCallback_, void *pvData_ )
 {
     if (m_u8Flags & TIMERLIST_FLAG_ACTIVE) {
         return;
     }
 
     SetIntervalMSeconds(u32IntervalMs_);
-    m_u32TimerTolerance = 0;
+    m_u32TimerTolerance = MSECONDS_TO_TICKS(u32ToleranceMs_);
     m_pfCallback = pfCallback_;
     m_pvData = pvData_;
 
+    // Preserve the timer-thread state across restarts
+    m_u8Flags &= (TIMERLIST_FLAG_DEFERRED | TIMERLIST_FLAG_QUEUED);
     if (!bRepeat_)
     {
-        m_u8Flags = TIMERLIST_FLAG_ONE_SHOT;
-    }
-    else
-    {
-        m_u8Flags = 0;
+        m_u8Flags |= TIMERLIST_FLAG_ONE_SHOT;
     }
 
     Start();
 }
 
-//---------------------------------------------------------------------------
-void Timer::Start( bool bRepeat_, uint32_t u32IntervalMs_, uint32_t u32ToleranceMs_, TimerCallback_t pfCallback_, void *pvData_ )
-{
-    if (m_u8Flags & TIMERLIST_FLAG_ACTIVE) {
-        return;
-    }
-
-    m_u32TimerTolerance = MSECONDS_TO_TICKS(u32ToleranceMs_);
-    Start(bRepeat_, u32IntervalMs_, pfCallback_, pvData_);
-}
-
 //---------------------------------------------------------------------------
 void Timer::Start()
 {
@@ -94,6 +107,10 @@ void Timer::Start()
 void Timer::Stop()
 {
     TimerScheduler::Remove(this);
+#if KERNEL_USE_TIMER_THREAD
+    // Don't run a deferred callback for a timer that's been stopped
+    TimerThread::Cancel(this);
+#endif
 }
 
 //---------------------------------------------------------------------------
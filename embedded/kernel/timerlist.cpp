@@ -18,6 +18,10 @@ See license.txt for more information
     \brief  Implements timer list processing algorithms, responsible for all
             timer tick and expiry logic.
 
+    Two implementations are provided - a simple unsorted list, which is
+    walked on every timer expiry, and a hierarchical timing wheel
+    (KERNEL_TIMERS_WHEEL), which only visits timers that are due.
+
 */
 
 #include "kerneltypes.h"
@@ -27,6 +31,7 @@ See license.txt for more information
 #include "kerneltimer.h"
 #include "threadport.h"
 #include "quantum.h"
+#include "timerthread.h"
 
 #define _CAN_HAS_DEBUG
 //--[Autogenerated - Do Not Modify]------------------------------------------
@@ -45,11 +50,562 @@ See license.txt for more information
 //---------------------------------------------------------------------------
 TimerList TimerScheduler::m_clTimerList;
 
+#if KERNEL_TIMERS_TICKLESS
+//---------------------------------------------------------------------------
+void TimerList::CountWakeupsSaved(uint8_t u8Fired_, uint8_t u8Deferred_)
+{
+    if (!u8Deferred_)
+    {
+        return;
+    }
+
+    // Each timer held back would otherwise have needed a wakeup of its own -
+    // unless no timer expired on time, in which case one of them would have
+    // been this wakeup.
+    if (u8Deferred_ == u8Fired_)
+    {
+        u8Deferred_--;
+    }
+    m_u32WakeupsSaved += u8Deferred_;
+}
+#endif
+
+#if KERNEL_USE_MONOTONIC_TIME
+//---------------------------------------------------------------------------
+uint64_t TimerList::GetTime(void)
+{
+    uint64_t u64Time;
+
+    CS_ENTER();
+    u64Time = m_u64Time;
+#if KERNEL_TIMERS_TICKLESS
+    // Add the time elapsed in the current interval
+    if (m_bTimerActive)
+    {
+        u64Time += KernelTimer::GetOvertime();
+#if KERNEL_USE_TICKLESS_IDLE && !KERNEL_TIMERS_WHEEL
+        u64Time += m_u32Halted;
+#endif
+    }
+#endif
+    CS_EXIT();
+
+    return u64Time;
+}
+#endif
+
+#if KERNEL_TIMERS_WHEEL
+//---------------------------------------------------------------------------
+void TimerList::Init(void)
+{
+    uint8_t i;
+    for (i = 0; i < TIMER_WHEEL_NUM_SLOTS; i++)
+    {
+        m_aclWheel[i].Init();
+    }
+    for (i = 0; i < KERNEL_TIMERS_WHEEL_LEVELS; i++)
+    {
+        m_auXSlotMap[i] = 0;
+    }
+    m_clExpired.Init();
+
+    m_u32Now = 0;
+    m_u32Base = 1;
+    m_bProcessing = 0;
+    m_bTimerActive = 0;
+    m_u32NextWakeup = 0;
+#if KERNEL_TIMERS_TICKLESS
+    m_u32WakeupsSaved = 0;
+#endif
+#if KERNEL_USE_MONOTONIC_TIME
+    m_u64Time = 0;
+#endif
+}
+
+//---------------------------------------------------------------------------
+void TimerList::Add(Timer *pclListNode_)
+{
+    CS_ENTER();
+
+#if KERNEL_TIMERS_TICKLESS
+    // The hardware timer counts up from the last expiry, so the current time
+    // is the wheel time of that expiry, plus the count.
+    uint32_t u32Elapsed = 0;
+    if (m_bTimerActive)
+    {
+        u32Elapsed = KernelTimer::GetOvertime();
+    }
+    pclListNode_->m_u32TimeLeft = m_u32Now + u32Elapsed + pclListNode_->m_u32Interval;
+    Coalesce(pclListNode_);
+#else
+    pclListNode_->m_u32TimeLeft = m_u32Now + pclListNode_->m_u32Interval;
+#endif
+
+    // Set the timer as active.
+    pclListNode_->m_u8Flags |= TIMERLIST_FLAG_ACTIVE;
+    Insert(pclListNode_);
+
+#if KERNEL_TIMERS_TICKLESS
+    // The expiry handler reprograms the timer itself once it's done, so
+    // only adjust the timer when adding from outside of it.
+    if (!m_bProcessing)
+    {
+        uint32_t u32Interval = pclListNode_->m_u32TimeLeft - m_u32Now;
+        if (!m_bTimerActive)
+        {
+            m_bTimerActive = 1;
+            m_u32NextWakeup = KernelTimer::SetExpiry(u32Interval);
+            KernelTimer::Start();
+        }
+        else if (u32Interval < m_u32NextWakeup)
+        {
+            // New timer expires before the next scheduled wakeup
+            m_u32NextWakeup = KernelTimer::SetExpiry(u32Interval);
+        }
+    }
+#endif
+
+    CS_EXIT();
+}
+
+//---------------------------------------------------------------------------
+void TimerList::Remove(Timer *pclLinkListNode_)
+{
+    CS_ENTER();
+
+    if (pclLinkListNode_->m_u8Flags & TIMERLIST_FLAG_CALLBACK)
+    {
+        // Expired, but callback not yet run
+        m_clExpired.Remove(pclLinkListNode_);
+    }
+    else if (pclLinkListNode_->m_u8Flags & TIMERLIST_FLAG_ACTIVE)
+    {
+        uint8_t u8Slot = pclLinkListNode_->m_u8WheelSlot;
+        m_aclWheel[u8Slot].Remove(pclLinkListNode_);
+        if (!m_aclWheel[u8Slot].GetHead())
+        {
+            m_auXSlotMap[u8Slot >> KERNEL_TIMERS_WHEEL_BITS] &=
+                ~((WHEEL_MAP_TYPE)1 << (u8Slot & TIMER_WHEEL_MASK));
+        }
+    }
+    pclLinkListNode_->m_u8Flags &= ~(TIMERLIST_FLAG_ACTIVE | TIMERLIST_FLAG_CALLBACK);
+
+#if KERNEL_TIMERS_TICKLESS && !KERNEL_USE_MONOTONIC_TIME
+    if (!m_bProcessing && m_bTimerActive && IsEmpty())
+    {
+        // Nothing left to time - account for the time elapsed in the current
+        // interval, and stop the timer.
+        m_u32Now += KernelTimer::GetOvertime();
+        m_u32Base = m_u32Now + 1;
+        m_bTimerActive = 0;
+        m_u32NextWakeup = 0;
+        KernelTimer::Stop();
+    }
+#endif
+
+    CS_EXIT();
+}
+
+//---------------------------------------------------------------------------
+void TimerList::Process(void)
+{
+#if KERNEL_TIMERS_TICKLESS
+    uint32_t u32NextEvent;
+    uint32_t u32Overtime;
+#endif
+
+#if KERNEL_USE_QUANTUM
+    Quantum::SetInTimer();
+#endif
+    m_bProcessing = 1;
+
+#if KERNEL_TIMERS_TICKLESS
+    // Clear the timer and its expiry time - keep it running though
+    KernelTimer::ClearExpiry();
+
+    // Wheel time of the expiry that triggered this interrupt
+    m_u32Now += m_u32NextWakeup;
+#if KERNEL_USE_MONOTONIC_TIME
+    m_u64Time += m_u32NextWakeup;
+#endif
+    u32Overtime = 0;
+
+    // If it takes longer to run the expired timers than it takes to get to
+    // the next wheel event, go around again.
+    do
+    {
+        Advance(m_u32Now + u32Overtime);
+        RunCallbacks();
+
+        u32Overtime = KernelTimer::GetOvertime();
+        u32NextEvent = NextEvent();
+    } while ((u32NextEvent != MAX_TIMER_TICKS) &&
+             ((int32_t)((m_u32Now + u32Overtime) - (m_u32Base + u32NextEvent)) >= 0));
+
+    if (u32NextEvent == MAX_TIMER_TICKS)
+    {
+#if KERNEL_USE_MONOTONIC_TIME
+        // Nothing more to do, but keep the timer running to keep track of
+        // the time.
+        m_u32NextWakeup = KernelTimer::SetExpiry(MAX_TIMER_TICKS);
+#else
+        // This timer elapsed, but there's nothing more to do...
+        // Turn the timer off.
+        m_u32Now += u32Overtime;
+        m_u32Base = m_u32Now + 1;
+        m_bTimerActive = 0;
+        m_u32NextWakeup = 0;
+        KernelTimer::Stop();
+#endif
+    }
+    else
+    {
+        // Program the next wakeup relative to the expiry that triggered
+        // this interrupt, which is where the hardware count started.
+        m_u32NextWakeup = KernelTimer::SetExpiry((m_u32Base + u32NextEvent) - m_u32Now);
+    }
+#else
+    m_u32Now++;
+#if KERNEL_USE_MONOTONIC_TIME
+    m_u64Time++;
+#endif
+    Advance(m_u32Now);
+    RunCallbacks();
+#endif
+
+    m_bProcessing = 0;
+#if KERNEL_USE_QUANTUM
+    Quantum::ClearInTimer();
+#endif
+}
+
+//---------------------------------------------------------------------------
+void TimerList::Insert(Timer *pclTimer_)
+{
+    uint32_t u32Expiry = pclTimer_->m_u32TimeLeft;
+    uint32_t u32Delta = u32Expiry - m_u32Base;
+    uint8_t u8Shift = 0;
+    uint8_t u8Level = 0;
+    uint8_t u8Index;
+    uint8_t u8Slot;
+
+    if ((int32_t)u32Delta < 0)
+    {
+        // Already due - expire on the next tick processed
+        u32Expiry = m_u32Base;
+        u32Delta = 0;
+    }
+    else if (u32Delta >= TIMER_WHEEL_RANGE)
+    {
+        // Out of range - park the timer in the outermost level, as far out
+        // as possible.  It's re-inserted when that slot is cascaded.
+        u32Expiry = m_u32Base + (TIMER_WHEEL_RANGE - 1);
+        u32Delta = TIMER_WHEEL_RANGE - 1;
+    }
+
+    // Pick the finest level of the wheel that can hold this interval
+    while (u32Delta >= TIMER_WHEEL_SLOTS)
+    {
+        u32Delta >>= KERNEL_TIMERS_WHEEL_BITS;
+        u8Shift += KERNEL_TIMERS_WHEEL_BITS;
+        u8Level++;
+    }
+
+    u8Index = (uint8_t)((u32Expiry >> u8Shift) & TIMER_WHEEL_MASK);
+    u8Slot = (uint8_t)((u8Level << KERNEL_TIMERS_WHEEL_BITS) + u8Index);
+
+    pclTimer_->m_u8WheelSlot = u8Slot;
+    m_aclWheel[u8Slot].Add(pclTimer_);
+    m_auXSlotMap[u8Level] |= ((WHEEL_MAP_TYPE)1 << u8Index);
+}
+
+//---------------------------------------------------------------------------
+void TimerList::Cascade(uint8_t u8Slot_)
+{
+    Timer *pclNode = static_cast<Timer*>(m_aclWheel[u8Slot_].GetHead());
+    Timer *pclNext;
+
+    m_aclWheel[u8Slot_].Init();
+    m_auXSlotMap[u8Slot_ >> KERNEL_TIMERS_WHEEL_BITS] &=
+        ~((WHEEL_MAP_TYPE)1 << (u8Slot_ & TIMER_WHEEL_MASK));
+
+    // Re-insert each timer relative to the current wheel time; they always
+    // land in a lower level than the one they came from.
+    while (pclNode)
+    {
+        pclNext = static_cast<Timer*>(pclNode->GetNext());
+        Insert(pclNode);
+        pclNode = pclNext;
+    }
+}
+
+//---------------------------------------------------------------------------
+void TimerList::Advance(uint32_t u32Now_)
+{
+    uint8_t u8Index;
+
+    while ((int32_t)(u32Now_ - m_u32Base) >= 0)
+    {
+#if KERNEL_TIMERS_TICKLESS
+        // Skip over ticks where there's nothing to do
+        uint32_t u32Delta = NextEvent();
+        if (u32Delta > (u32Now_ - m_u32Base))
+        {
+            m_u32Base = u32Now_ + 1;
+            break;
+        }
+        m_u32Base += u32Delta;
+#endif
+
+        u8Index = (uint8_t)(m_u32Base & TIMER_WHEEL_MASK);
+
+        // Level 0 wrapped - cascade the next slot of the level above it, and
+        // so on up the wheel for every level that also wrapped.
+        if (!u8Index)
+        {
+            uint8_t u8Shift = KERNEL_TIMERS_WHEEL_BITS;
+            uint8_t u8Level;
+            for (u8Level = 1; u8Level < KERNEL_TIMERS_WHEEL_LEVELS; u8Level++)
+            {
+                uint8_t u8LevelIndex = (uint8_t)((m_u32Base >> u8Shift) & TIMER_WHEEL_MASK);
+                if (m_auXSlotMap[u8Level] & ((WHEEL_MAP_TYPE)1 << u8LevelIndex))
+                {
+                    Cascade((uint8_t)((u8Level << KERNEL_TIMERS_WHEEL_BITS) + u8LevelIndex));
+                }
+                if (u8LevelIndex)
+                {
+                    break;
+                }
+                u8Shift += KERNEL_TIMERS_WHEEL_BITS;
+            }
+        }
+
+        // Every timer in the current level 0 slot expires on this tick -
+        // move them to the expired list, we'll execute the callbacks later.
+        if (m_auXSlotMap[0] & ((WHEEL_MAP_TYPE)1 << u8Index))
+        {
+            Timer *pclNode = static_cast<Timer*>(m_aclWheel[u8Index].GetHead());
+            Timer *pclNext;
+
+            m_aclWheel[u8Index].Init();
+            m_auXSlotMap[0] &= ~((WHEEL_MAP_TYPE)1 << u8Index);
+
+            while (pclNode)
+            {
+                pclNext = static_cast<Timer*>(pclNode->GetNext());
+                pclNode->m_u8Flags |= TIMERLIST_FLAG_CALLBACK;
+                m_clExpired.Add(pclNode);
+                pclNode = pclNext;
+            }
+        }
+        m_u32Base++;
+    }
+}
+
+//---------------------------------------------------------------------------
+void TimerList::RunCallbacks(void)
+{
+    Timer *pclNode;
+#if KERNEL_TIMERS_TICKLESS
+    uint8_t u8Fired = 0;
+    uint8_t u8Deferred = 0;
+#endif
+
+    while (m_clExpired.GetHead())
+    {
+        pclNode = static_cast<Timer*>(m_clExpired.GetHead());
+        m_clExpired.Remove(pclNode);
+        pclNode->m_u8Flags &= ~TIMERLIST_FLAG_CALLBACK;
+
+#if KERNEL_TIMERS_TICKLESS
+        u8Fired++;
+        if (pclNode->m_u8Flags & TIMERLIST_FLAG_COALESCED)
+        {
+            u8Deferred++;
+        }
+#endif
+
+        if (pclNode->m_u8Flags & TIMERLIST_FLAG_ONE_SHOT)
+        {
+            // If this was a one-shot timer, deactivate the timer.
+            pclNode->m_u8Flags |= TIMERLIST_FLAG_EXPIRED;
+            pclNode->m_u8Flags &= ~TIMERLIST_FLAG_ACTIVE;
+        }
+        else
+        {
+            // Reschedule relative to the previous expiry, so that repeating
+            // timers don't drift.
+            pclNode->m_u32TimeLeft += pclNode->m_u32Interval;
+#if KERNEL_TIMERS_TICKLESS
+            Coalesce(pclNode);
+#endif
+            Insert(pclNode);
+        }
+
+#if KERNEL_USE_TIMER_THREAD
+        if (pclNode->m_u8Flags & TIMERLIST_FLAG_DEFERRED)
+        {
+            // Hand the callback off to the timer service thread
+            TimerThread::Enqueue(pclNode);
+            continue;
+        }
+#endif
+        // Run the callback. these callbacks must be very fast...
+        pclNode->m_pfCallback( pclNode->m_pclOwner, pclNode->m_pvData );
+    }
+#if KERNEL_USE_TIMER_THREAD
+    TimerThread::Wake();
+#endif
+#if KERNEL_TIMERS_TICKLESS
+    CountWakeupsSaved(u8Fired, u8Deferred);
+#endif
+}
+
+#if KERNEL_TIMERS_TICKLESS
+//---------------------------------------------------------------------------
+void TimerList::Coalesce(Timer *pclTimer_)
+{
+    uint32_t u32Expiry = pclTimer_->m_u32TimeLeft;
+    uint32_t u32Latest = u32Expiry + pclTimer_->m_u32TimerTolerance;
+    uint32_t u32Mask = 0;
+
+    pclTimer_->m_u8Flags &= ~TIMERLIST_FLAG_COALESCED;
+    if (!pclTimer_->m_u32TimerTolerance)
+    {
+        return;
+    }
+
+    // Timers can only share a wakeup by landing on the same tick of the
+    // wheel.  Round the expiry up to the coarsest tick boundary (multiple of
+    // the largest power of two) within the tolerance window - timers whose
+    // windows overlap tend to pick the same one.
+    while (u32Mask < (TIMER_WHEEL_RANGE - 1))
+    {
+        uint32_t u32NextMask = (u32Mask << 1) | 1;
+        uint32_t u32Aligned = (u32Expiry + u32NextMask) & ~u32NextMask;
+        if ((int32_t)(u32Latest - u32Aligned) < 0)
+        {
+            break;
+        }
+        u32Mask = u32NextMask;
+    }
+
+    u32Expiry = (u32Expiry + u32Mask) & ~u32Mask;
+    if (u32Expiry != pclTimer_->m_u32TimeLeft)
+    {
+        pclTimer_->m_u32TimeLeft = u32Expiry;
+        pclTimer_->m_u8Flags |= TIMERLIST_FLAG_COALESCED;
+    }
+}
+#endif
+
+//---------------------------------------------------------------------------
+uint32_t TimerList::NextEvent(void)
+{
+    uint32_t u32Next = MAX_TIMER_TICKS;
+    uint8_t u8Shift = 0;
+    uint8_t u8Level;
+
+    for (u8Level = 0; u8Level < KERNEL_TIMERS_WHEEL_LEVELS; u8Level++)
+    {
+        WHEEL_MAP_TYPE uXMap = m_auXSlotMap[u8Level];
+        if (uXMap)
+        {
+            // Slots are processed (expired or cascaded) on the first tick
+            // of their period - find the first such tick at or after the
+            // current wheel time, then the first occupied slot from there.
+            uint32_t u32Epoch = (m_u32Base + (((uint32_t)1 << u8Shift) - 1)) >> u8Shift;
+            uint8_t u8Index = (uint8_t)(u32Epoch & TIMER_WHEEL_MASK);
+            uint8_t u8Offset = 0;
+            uint32_t u32Delta;
+
+            while (!(uXMap & ((WHEEL_MAP_TYPE)1 << ((u8Index + u8Offset) & TIMER_WHEEL_MASK))))
+            {
+                u8Offset++;
+            }
+
+            u32Delta = ((u32Epoch + u8Offset) << u8Shift) - m_u32Base;
+            if (u32Delta < u32Next)
+            {
+                u32Next = u32Delta;
+            }
+        }
+        u8Shift += KERNEL_TIMERS_WHEEL_BITS;
+    }
+    return u32Next;
+}
+
+//---------------------------------------------------------------------------
+bool TimerList::IsEmpty(void)
+{
+    uint8_t i;
+    for (i = 0; i < KERNEL_TIMERS_WHEEL_LEVELS; i++)
+    {
+        if (m_auXSlotMap[i])
+        {
+            return false;
+        }
+    }
+    return (m_clExpired.GetHead() == NULL);
+}
+
+#if KERNEL_USE_TICKLESS_IDLE
+//---------------------------------------------------------------------------
+uint32_t TimerList::GetTimeToExpiry(void)
+{
+    if (!m_bTimerActive)
+    {
+        return MAX_TIMER_TICKS;
+    }
+    return KernelTimer::TimeToExpiry();
+}
+
+//---------------------------------------------------------------------------
+void TimerList::Compensate(uint32_t u32Ticks_)
+{
+    uint32_t u32Remaining;
+
+    if (!m_bTimerActive)
+    {
+        return;
+    }
+
+    // Never move the expiry to (or behind) the current count
+    u32Remaining = KernelTimer::TimeToExpiry();
+    if (u32Ticks_ >= u32Remaining)
+    {
+        u32Ticks_ = (u32Remaining ? (u32Remaining - 1) : 0);
+    }
+
+    if (u32Ticks_)
+    {
+        // The hardware count stood still, so the current interval started
+        // that much earlier in wheel time, and ends that much sooner.
+        m_u32Now += u32Ticks_;
+#if KERNEL_USE_MONOTONIC_TIME
+        m_u64Time += u32Ticks_;
+#endif
+        m_u32NextWakeup = KernelTimer::SubtractExpiry(u32Ticks_);
+    }
+}
+#endif
+
+#else
 //---------------------------------------------------------------------------
 void TimerList::Init(void)
 {
     m_bTimerActive = 0;    
     m_u32NextWakeup = 0;    
+#if KERNEL_TIMERS_TICKLESS
+    m_bProcessing = 0;
+    m_u32WakeupsSaved = 0;
+#endif
+#if KERNEL_USE_TICKLESS_IDLE
+    m_u32Halted = 0;
+#endif
+#if KERNEL_USE_MONOTONIC_TIME
+    m_u64Time = 0;
+#endif
 }
 
 //---------------------------------------------------------------------------
@@ -57,42 +613,60 @@ void TimerList::Add(Timer *pclListNode_)
 {
 #if KERNEL_TIMERS_TICKLESS
     bool bStart = 0;
-    int32_t lDelta;
+    uint32_t u32Now = 0;
+    uint32_t u32Wakeup;
 #endif
 
     CS_ENTER();
 
 #if KERNEL_TIMERS_TICKLESS
-    if (GetHead() == NULL)
+    if (!m_bTimerActive && !m_bProcessing)
     {
         bStart = 1;
     }
+    else
+    {
+        // Timers count from the start of the current interval, which is
+        // where the hardware count started.
+        u32Now = KernelTimer::GetOvertime();
+#if KERNEL_USE_TICKLESS_IDLE
+        u32Now += m_u32Halted;
+#endif
+    }
 #endif
 
     pclListNode_->ClearNode();    
     DoubleLinkList::Add(pclListNode_);
     
     // Set the initial timer value
-    pclListNode_->m_u32TimeLeft = pclListNode_->m_u32Interval;    
-
 #if KERNEL_TIMERS_TICKLESS
-    if (!bStart)
+    pclListNode_->m_u32TimeLeft = u32Now + pclListNode_->m_u32Interval;
+
+    // The next wakeup only has to move if it's later than this timer can
+    // tolerate.  The expiry handler reprograms the timer itself once it's
+    // done, so leave the timer alone when adding from within it.
+    u32Wakeup = pclListNode_->m_u32TimeLeft + pclListNode_->m_u32TimerTolerance;
+    if (bStart)
     {
-        // If the new interval is less than the amount of time remaining...
-        lDelta = KernelTimer::TimeToExpiry() - pclListNode_->m_u32Interval;
-    
-        if (lDelta > 0)
-        {
-            // Set the new expiry time on the timer.
-            m_u32NextWakeup = KernelTimer::SubtractExpiry((uint32_t)lDelta);
-        }
+#if KERNEL_USE_TICKLESS_IDLE
+        m_u32Halted = 0;
+#endif
+        m_bTimerActive = 1;
+        m_u32NextWakeup = KernelTimer::SetExpiry(u32Wakeup);
+        KernelTimer::Start();        
     }
-    else    
+    else if (!m_bProcessing)
     {
-        m_u32NextWakeup = pclListNode_->m_u32Interval;
-        KernelTimer::SetExpiry(m_u32NextWakeup);
-        KernelTimer::Start();        
+#if KERNEL_USE_TICKLESS_IDLE
+        u32Wakeup -= m_u32Halted;
+#endif
+        if (u32Wakeup < m_u32NextWakeup)
+        {
+            m_u32NextWakeup = KernelTimer::SetExpiry(u32Wakeup);
+        }
     }
+#else
+    pclListNode_->m_u32TimeLeft = pclListNode_->m_u32Interval;    
 #endif
 
     // Set the timer as active.
@@ -108,9 +682,10 @@ void TimerList::Remove(Timer *pclLinkListNode_)
     DoubleLinkList::Remove(pclLinkListNode_);
     pclLinkListNode_->m_u8Flags &= ~TIMERLIST_FLAG_ACTIVE;
 
-#if KERNEL_TIMERS_TICKLESS
-    if (this->GetHead() == NULL)
+#if KERNEL_TIMERS_TICKLESS && !KERNEL_USE_MONOTONIC_TIME
+    if (!m_bProcessing && (this->GetHead() == NULL))
     {
+        m_bTimerActive = 0;
         KernelTimer::Stop();
     }
 #endif
@@ -122,9 +697,12 @@ void TimerList::Remove(Timer *pclLinkListNode_)
 void TimerList::Process(void)
 {
 #if KERNEL_TIMERS_TICKLESS
+    uint32_t u32Now;
+    uint32_t u32Shift;
     uint32_t u32NewExpiry;
-    uint32_t u32Overtime;
-    bool bContinue;
+    uint32_t u32Earliest;
+    uint8_t u8Fired;
+    uint8_t u8Deferred;
 #endif
     
     Timer *pclNode;
@@ -133,20 +711,37 @@ void TimerList::Process(void)
 #if KERNEL_USE_QUANTUM
     Quantum::SetInTimer();
 #endif
+#if KERNEL_USE_MONOTONIC_TIME && !KERNEL_TIMERS_TICKLESS
+    m_u64Time++;
+#endif
 #if KERNEL_TIMERS_TICKLESS
     // Clear the timer and its expiry time - keep it running though
     KernelTimer::ClearExpiry();  
+    m_bProcessing = 1;
+
+    // Timers count from the start of the interval that just elapsed, while
+    // the hardware now counts from its end.  Expire everything due by the
+    // end of the interval, and shift the rest over to the new time base.
+    u32Now = m_u32NextWakeup;
+#if KERNEL_USE_TICKLESS_IDLE
+    // Time credited while the kernel timer was halted is part of the
+    // interval that just elapsed.
+    u32Now += m_u32Halted;
+    m_u32Halted = 0;
+#endif
+#if KERNEL_USE_MONOTONIC_TIME
+    m_u64Time += u32Now;
+#endif
+    u32Shift = u32Now;
+    u8Fired = 0;
+    u8Deferred = 0;
+
     do 
     {        
 #endif
         pclNode = static_cast<Timer*>(GetHead());
         pclPrev = NULL;
 
-#if KERNEL_TIMERS_TICKLESS
-        bContinue = 0;
-        u32NewExpiry = MAX_TIMER_TICKS;
-#endif
-
         // Subtract the elapsed time interval from each active timer.
         while (pclNode)
         {        
@@ -155,7 +750,7 @@ void TimerList::Process(void)
             {
                 // Did the timer expire?
 #if KERNEL_TIMERS_TICKLESS
-                if (pclNode->m_u32TimeLeft <= m_u32NextWakeup)
+                if (pclNode->m_u32TimeLeft <= u32Now)
 #else
                 pclNode->m_u32TimeLeft--;
                 if (0 == pclNode->m_u32TimeLeft)
@@ -163,6 +758,20 @@ void TimerList::Process(void)
                 {
                     // Yes - set the "callback" flag - we'll execute the callbacks later
                     pclNode->m_u8Flags |= TIMERLIST_FLAG_CALLBACK;
+
+#if KERNEL_TIMERS_TICKLESS
+                    // Count the timers held back (within their tolerance) to
+                    // share this wakeup.  Only the first pass is the wakeup
+                    // we asked for - any others are down to overtime.
+                    if (u32Shift)
+                    {
+                        u8Fired++;
+                        if (pclNode->m_u32TimeLeft < u32Now)
+                        {
+                            u8Deferred++;
+                        }
+                    }
+#endif
                                 
                     if (pclNode->m_u8Flags & TIMERLIST_FLAG_ONE_SHOT)
                     {
@@ -172,32 +781,27 @@ void TimerList::Process(void)
                     }
                     else
                     {
-                        // Reset the interval timer.
-                        //!ToDo - figure out if we need to deal with any overtime here.
-                        // I think we're good though...                        
-                        pclNode->m_u32TimeLeft = pclNode->m_u32Interval;
-                        
 #if KERNEL_TIMERS_TICKLESS
-                        // If the time remaining (plus the length of the tolerance interval)
-                        // is less than the next expiry interval, set the next expiry interval.
-                        uint32_t u32Tmp = pclNode->m_u32TimeLeft + pclNode->m_u32TimerTolerance;
-
-                        if (u32Tmp < u32NewExpiry)
+                        // Reschedule relative to the previous expiry, so that
+                        // repeating timers don't drift.  If the timer's due
+                        // again already, it expires on the next pass.
+                        uint32_t u32Next = pclNode->m_u32TimeLeft + pclNode->m_u32Interval;
+                        if (u32Next < u32Now)
                         {
-                            u32NewExpiry = u32Tmp;
+                            u32Next = u32Now;
                         }
+                        pclNode->m_u32TimeLeft = u32Next - u32Shift;
+#else
+                        // Reset the interval timer.
+                        pclNode->m_u32TimeLeft = pclNode->m_u32Interval;
 #endif
                     }
                 }
 #if KERNEL_TIMERS_TICKLESS
                 else
                 {
-                    // Not expiring, but determine how int32_t to run the next timer interval for.
-                    pclNode->m_u32TimeLeft -= m_u32NextWakeup;
-                    if (pclNode->m_u32TimeLeft < u32NewExpiry)
-                    {
-                        u32NewExpiry = pclNode->m_u32TimeLeft;
-                    }
+                    // Not expiring - move it over to the new time base
+                    pclNode->m_u32TimeLeft -= u32Shift;
                 }
 #endif
             }
@@ -221,8 +825,18 @@ void TimerList::Process(void)
                     bRemove = true;
                 }
 
-                // Run the callback. these callbacks must be very fast...
-                pclPrev->m_pfCallback( pclPrev->m_pclOwner, pclPrev->m_pvData );
+#if KERNEL_USE_TIMER_THREAD
+                if (pclPrev->m_u8Flags & TIMERLIST_FLAG_DEFERRED)
+                {
+                    // Hand the callback off to the timer service thread
+                    TimerThread::Enqueue(pclPrev);
+                }
+                else
+#endif
+                {
+                    // Run the callback. these callbacks must be very fast...
+                    pclPrev->m_pfCallback( pclPrev->m_pclOwner, pclPrev->m_pvData );
+                }
                 pclPrev->m_u8Flags &= ~TIMERLIST_FLAG_CALLBACK;
 
                 // Remove one-shot-timers
@@ -232,34 +846,69 @@ void TimerList::Process(void)
                 }
             }
         }    
+#if KERNEL_USE_TIMER_THREAD
+        TimerThread::Wake();
+#endif
 
 #if KERNEL_TIMERS_TICKLESS
+        // Wake up again as late as possible without exceeding the tolerance
+        // of any timer (including those started by the callbacks) - every
+        // timer due by then expires together.
+        u32NewExpiry = MAX_TIMER_TICKS;
+        u32Earliest = MAX_TIMER_TICKS;
+        pclNode = static_cast<Timer*>(GetHead());
+        while (pclNode)
+        {
+            if (pclNode->m_u8Flags & TIMERLIST_FLAG_ACTIVE)
+            {
+                uint32_t u32Tmp = pclNode->m_u32TimeLeft + pclNode->m_u32TimerTolerance;
+                if (u32Tmp < u32NewExpiry)
+                {
+                    u32NewExpiry = u32Tmp;
+                }
+                if (pclNode->m_u32TimeLeft < u32Earliest)
+                {
+                    u32Earliest = pclNode->m_u32TimeLeft;
+                }
+            }
+            pclNode = static_cast<Timer*>(pclNode->GetNext());
+        }
+
         // Check to see how much time has elapsed since the time we 
         // acknowledged the interrupt... 
-        u32Overtime = KernelTimer::GetOvertime();
-        
-        if( u32Overtime >= u32NewExpiry ) {
-            m_u32NextWakeup = u32Overtime;
-            bContinue = 1;
-        }
+        u32Now = KernelTimer::GetOvertime();
+        u32Shift = 0;
         
-    // If it's taken longer to go through this loop than would take u16 to
+    // If it's taken longer to go through this loop than it takes to get to
     // the next expiry, re-run the timing loop
+    } while ((u32Earliest != MAX_TIMER_TICKS) && (u32Earliest <= u32Now));
 
-    } while (bContinue);
+    m_bProcessing = 0;
+    CountWakeupsSaved(u8Fired, u8Deferred);
 
-    // This timer elapsed, but there's nothing more to do...
-    // Turn the timer off.
-    if (u32NewExpiry >= MAX_TIMER_TICKS)
+    if (u32Earliest == MAX_TIMER_TICKS)
     {
-        KernelTimer::Stop();
+#if KERNEL_USE_MONOTONIC_TIME
+        if (m_bTimerActive)
+        {
+            // Nothing more to do, but keep the timer running to keep track
+            // of the time.
+            m_u32NextWakeup = KernelTimer::SetExpiry(MAX_TIMER_TICKS);
+        }
+        else
+#endif
+        {
+            // This timer elapsed, but there's nothing more to do...
+            // Turn the timer off.
+            m_bTimerActive = 0;
+            KernelTimer::Stop();
+        }
     }
     else 
     {
-        // Update the timer with the new "Next Wakeup" value, plus whatever
-        // overtime has accumulated since the last time we called this handler
-
-        m_u32NextWakeup = KernelTimer::SetExpiry(u32NewExpiry + u32Overtime);        
+        // Update the timer with the new "Next Wakeup" value - the hardware
+        // count started with this interval, same as the timers.
+        m_u32NextWakeup = KernelTimer::SetExpiry(u32NewExpiry);        
     }
 #endif
 #if KERNEL_USE_QUANTUM
@@ -267,5 +916,44 @@ void TimerList::Process(void)
 #endif
 }
 
+#if KERNEL_USE_TICKLESS_IDLE
+//---------------------------------------------------------------------------
+uint32_t TimerList::GetTimeToExpiry(void)
+{
+    if (!m_bTimerActive)
+    {
+        return MAX_TIMER_TICKS;
+    }
+    return KernelTimer::TimeToExpiry();
+}
+
+//---------------------------------------------------------------------------
+void TimerList::Compensate(uint32_t u32Ticks_)
+{
+    uint32_t u32Remaining;
+
+    if (!m_bTimerActive)
+    {
+        return;
+    }
+
+    // Never move the expiry to (or behind) the current count
+    u32Remaining = KernelTimer::TimeToExpiry();
+    if (u32Ticks_ >= u32Remaining)
+    {
+        u32Ticks_ = (u32Remaining ? (u32Remaining - 1) : 0);
+    }
+
+    if (u32Ticks_)
+    {
+        // Bring the expiry forward by the time lost, and remember to count
+        // that time against the timers when the interval ends.
+        m_u32Halted += u32Ticks_;
+        m_u32NextWakeup = KernelTimer::SubtractExpiry(u32Ticks_);
+    }
+}
+#endif
+
+#endif // KERNEL_TIMERS_WHEEL
 
 #endif //KERNEL_USE_TIMERS
@@ -0,0 +1,190 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+
+    \file   timerthread.cpp
+
+    \brief  Timer service thread implementation
+*/
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#include "thread.h"
+#include "timer.h"
+#include "timerthread.h"
+#include "ksemaphore.h"
+#include "threadport.h"
+
+#define _CAN_HAS_DEBUG
+//--[Autogenerated - Do Not Modify]------------------------------------------
+#include "dbg_file_list.h"
+#include "buffalogger.h"
+#if defined(DBG_FILE)
+# error "Debug logging file token already defined!  Bailing."
+#else
+# define DBG_FILE _DBG___KERNEL_TIMERTHREAD_CPP
+#endif
+//--[End Autogenerated content]----------------------------------------------
+#include "kerneldebug.h"
+
+#if KERNEL_USE_TIMER_THREAD
+
+//---------------------------------------------------------------------------
+Thread    TimerThread::m_clThread;
+Semaphore TimerThread::m_clSemaphore;
+Timer    *TimerThread::m_pclHead;
+Timer    *TimerThread::m_pclTail;
+K_WORD    TimerThread::m_awStack[(KERNEL_TIMER_THREAD_STACK_SIZE + sizeof(K_WORD) - 1) / sizeof(K_WORD)];
+
+//---------------------------------------------------------------------------
+void TimerThread::Init(void)
+{
+    m_pclHead = NULL;
+    m_pclTail = NULL;
+
+    // Binary semaphore - any number of wakeups requested before the thread
+    // gets to run are serviced in a single pass over the queue.
+    m_clSemaphore.Init(0, 1);
+
+    m_clThread.Init( m_awStack,
+                     sizeof(m_awStack),
+                     KERNEL_TIMER_THREAD_PRIORITY,
+                     (ThreadEntry_t)TimerThread::Main,
+                     NULL );
+    m_clThread.Start();
+}
+
+//---------------------------------------------------------------------------
+void TimerThread::Enqueue(Timer *pclTimer_)
+{
+    CS_ENTER();
+    // Only queue the timer once - subsequent expiries are coalesced into the
+    // callback that's already pending.
+    if (!(pclTimer_->m_u8Flags & TIMERLIST_FLAG_QUEUED))
+    {
+        pclTimer_->m_u8Flags |= TIMERLIST_FLAG_QUEUED;
+        pclTimer_->m_pclDeferredNext = NULL;
+
+        if (m_pclTail)
+        {
+            m_pclTail->m_pclDeferredNext = pclTimer_;
+        }
+        else
+        {
+            m_pclHead = pclTimer_;
+        }
+        m_pclTail = pclTimer_;
+    }
+    CS_EXIT();
+}
+
+//---------------------------------------------------------------------------
+void TimerThread::Wake(void)
+{
+    if (m_pclHead)
+    {
+        m_clSemaphore.Post();
+    }
+}
+
+//---------------------------------------------------------------------------
+void TimerThread::Cancel(Timer *pclTimer_)
+{
+    Timer *pclNode;
+    Timer *pclPrev;
+
+    CS_ENTER();
+    if (pclTimer_->m_u8Flags & TIMERLIST_FLAG_QUEUED)
+    {
+        pclTimer_->m_u8Flags &= ~TIMERLIST_FLAG_QUEUED;
+
+        // Walk the queue to find the timer's predecessor and unlink it.
+        pclPrev = NULL;
+        pclNode = m_pclHead;
+        while (pclNode && (pclNode != pclTimer_))
+        {
+            pclPrev = pclNode;
+            pclNode = pclNode->m_pclDeferredNext;
+        }
+
+        if (pclNode)
+        {
+            if (pclPrev)
+            {
+                pclPrev->m_pclDeferredNext = pclNode->m_pclDeferredNext;
+            }
+            else
+            {
+                m_pclHead = pclNode->m_pclDeferredNext;
+            }
+
+            if (m_pclTail == pclNode)
+            {
+                m_pclTail = pclPrev;
+            }
+            pclNode->m_pclDeferredNext = NULL;
+        }
+    }
+    CS_EXIT();
+}
+
+//---------------------------------------------------------------------------
+void TimerThread::Main(void *unused_)
+{
+    Timer *pclTimer;
+    TimerCallback_t pfCallback;
+    Thread *pclOwner;
+    void *pvData;
+
+    while(1)
+    {
+        m_clSemaphore.Pend();
+
+        // Drain the queue one timer at a time, so that the callbacks run
+        // with interrupts enabled, and timers stopped in the meantime are
+        // never called.
+        do
+        {
+            pfCallback = NULL;
+            pclOwner = NULL;
+            pvData = NULL;
+
+            CS_ENTER();
+            pclTimer = m_pclHead;
+            if (pclTimer)
+            {
+                m_pclHead = pclTimer->m_pclDeferredNext;
+                if (!m_pclHead)
+                {
+                    m_pclTail = NULL;
+                }
+                pclTimer->m_pclDeferredNext = NULL;
+                pclTimer->m_u8Flags &= ~TIMERLIST_FLAG_QUEUED;
+
+                pfCallback = pclTimer->m_pfCallback;
+                pclOwner = pclTimer->m_pclOwner;
+                pvData = pclTimer->m_pvData;
+            }
+            CS_EXIT();
+
+            if (pfCallback)
+            {
+                pfCallback(pclOwner, pvData);
+            }
+        } while (pclTimer);
+    }
+}
+
+#endif // KERNEL_USE_TIMER_THREAD
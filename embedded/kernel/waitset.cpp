@@ -0,0 +1,409 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+=========================================================================== */
+/*!
+
+    \file   waitset.cpp
+
+    \brief  Wait-set object implementation
+*/
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+#include "blocking.h"
+#include "kernel.h"
+#include "thread.h"
+#include "waitset.h"
+
+#define _CAN_HAS_DEBUG
+//--[Autogenerated - Do Not Modify]------------------------------------------
+#include "dbg_file_list.h"
+#include "buffalogger.h"
+#if defined(DBG_FILE)
+# error "Debug logging file token already defined!  Bailing."
+#else
+# define DBG_FILE _DBG___KERNEL_WAITSET_CPP
+#endif
+//--[End Autogenerated content]----------------------------------------------
+#include "kerneldebug.h"
+
+#if KERNEL_USE_WAITSET
+
+#if KERNEL_USE_TIMEOUTS
+#include "timerlist.h"
+
+//---------------------------------------------------------------------------
+/*!
+ * \brief TimedWaitSet_Callback
+ *
+ * This function is called from the timer-expired context to trigger a timeout
+ * on a wait-set.  This results in the waking of the thread that generated the
+ * wait call that was not completed in time.
+ *
+ * \param pclOwner_ Pointer to the thread to wake
+ * \param pvData_   Pointer to the wait-set object that the thread is blocked on
+ */
+void TimedWaitSet_Callback(Thread *pclOwner_, void *pvData_)
+{
+    WaitSet *pclWaitSet = static_cast<WaitSet*>(pvData_);
+
+    // Indicate that the wait has expired on the thread
+    pclOwner_->SetExpired(true);
+
+    // Wake up the thread that was blocked on this wait-set.
+    pclWaitSet->WakeMe(pclOwner_);
+
+    if (pclOwner_->GetCurPriority() >= Scheduler::GetCurrentThread()->GetCurPriority())
+    {
+        Thread::Yield();
+    }
+}
+#endif
+
+//---------------------------------------------------------------------------
+WaitSet::~WaitSet()
+{
+    // If there are any threads waiting on this object when it goes out
+    // of scope, set a kernel panic.
+    if (m_clBlockList.GetHead())
+    {
+        Kernel::Panic(PANIC_ACTIVE_WAITSET_DESCOPED);
+    }
+    Clear();
+}
+
+//---------------------------------------------------------------------------
+void WaitSet::Init()
+{
+    m_clBlockList.Init();
+    m_pclWaitSet = NULL;
+    m_u8Count = 0;
+    m_uXEventMask = 0;
+#if KERNEL_USE_MESSAGE
+    m_pclMessage = NULL;
+#endif
+}
+
+//---------------------------------------------------------------------------
+int8_t WaitSet::Add(BlockingObject *pclObject_, WaitSetType_t eType_)
+{
+    int8_t i8Ret = -1;
+
+    CS_ENTER();
+    if ((m_u8Count < KERNEL_WAITSET_MAX_OBJECTS) && !pclObject_->m_pclWaitSet)
+    {
+        WaitSetEntry_t *pstEntry = &m_astEntries[m_u8Count];
+        pstEntry->pclObject = pclObject_;
+        pstEntry->pvOwner = NULL;
+        pstEntry->uXMask = 0;
+        pstEntry->u8Mode = 0;
+        pstEntry->u8Type = (uint8_t)eType_;
+        pstEntry->bLatched = false;
+
+        pclObject_->m_pclWaitSet = this;
+        i8Ret = (int8_t)m_u8Count++;
+    }
+    CS_EXIT();
+
+    return i8Ret;
+}
+
+//---------------------------------------------------------------------------
+int8_t WaitSet::AddSemaphore(Semaphore *pclSemaphore_)
+{
+    KERNEL_ASSERT(pclSemaphore_);
+    return Add(pclSemaphore_, WAITSET_TYPE_SEMAPHORE);
+}
+
+#if KERNEL_USE_EVENTFLAG
+//---------------------------------------------------------------------------
+int8_t WaitSet::AddEventFlag(EventFlag *pclEventFlag_, FLAG_TYPE uXMask_, EventFlagOperation_t eMode_)
+{
+    KERNEL_ASSERT(pclEventFlag_);
+
+    int8_t i8Ret;
+
+    CS_ENTER();
+    i8Ret = Add(pclEventFlag_, WAITSET_TYPE_EVENTFLAG);
+    if (i8Ret >= 0)
+    {
+        m_astEntries[i8Ret].uXMask = uXMask_;
+        m_astEntries[i8Ret].u8Mode = (uint8_t)eMode_;
+    }
+    CS_EXIT();
+
+    return i8Ret;
+}
+#endif
+
+#if KERNEL_USE_NOTIFY
+//---------------------------------------------------------------------------
+int8_t WaitSet::AddNotify(Notify *pclNotify_)
+{
+    KERNEL_ASSERT(pclNotify_);
+    return Add(pclNotify_, WAITSET_TYPE_NOTIFY);
+}
+#endif
+
+#if KERNEL_USE_MESSAGE
+//---------------------------------------------------------------------------
+int8_t WaitSet::AddMessageQueue(MessageQueue *pclMessageQueue_)
+{
+    KERNEL_ASSERT(pclMessageQueue_);
+
+    int8_t i8Ret;
+
+    // The queue signals the set through its counting semaphore
+    CS_ENTER();
+    i8Ret = Add(&pclMessageQueue_->m_clSemaphore, WAITSET_TYPE_MESSAGE);
+    if (i8Ret >= 0)
+    {
+        m_astEntries[i8Ret].pvOwner = (void*)pclMessageQueue_;
+    }
+    CS_EXIT();
+
+    return i8Ret;
+}
+#endif
+
+//---------------------------------------------------------------------------
+void WaitSet::Clear()
+{
+    CS_ENTER();
+    for (uint8_t i = 0; i < m_u8Count; i++)
+    {
+        m_astEntries[i].pclObject->m_pclWaitSet = NULL;
+    }
+    m_u8Count = 0;
+    CS_EXIT();
+}
+
+//---------------------------------------------------------------------------
+int8_t WaitSet::TryAcquire()
+{
+    for (uint8_t i = 0; i < m_u8Count; i++)
+    {
+        WaitSetEntry_t *pstEntry = &m_astEntries[i];
+
+        switch (pstEntry->u8Type)
+        {
+            case WAITSET_TYPE_SEMAPHORE:
+            {
+                Semaphore *pclSemaphore = static_cast<Semaphore*>(pstEntry->pclObject);
+                if (pclSemaphore->m_u16Value)
+                {
+                    pclSemaphore->m_u16Value--;
+                    return (int8_t)i;
+                }
+            }
+                break;
+#if KERNEL_USE_EVENTFLAG
+            case WAITSET_TYPE_EVENTFLAG:
+            {
+                EventFlag *pclEventFlag = static_cast<EventFlag*>(pstEntry->pclObject);
+                EventFlagOperation_t eMode = (EventFlagOperation_t)pstEntry->u8Mode;
+                FLAG_TYPE uXMatch = pclEventFlag->m_uXSetMask & pstEntry->uXMask;
+
+                // Same matching rules as EventFlag::Wait()
+                if ((eMode == EVENT_FLAG_ALL) || (eMode == EVENT_FLAG_ALL_CLEAR))
+                {
+                    if (uXMatch != pstEntry->uXMask)
+                    {
+                        uXMatch = 0;
+                    }
+                }
+
+                if (uXMatch)
+                {
+                    // The "clear" variants consume the flags that matched
+                    if ((eMode == EVENT_FLAG_ALL_CLEAR) || (eMode == EVENT_FLAG_ANY_CLEAR))
+                    {
+                        pclEventFlag->m_uXSetMask &= ~uXMatch;
+                    }
+                    m_uXEventMask = uXMatch;
+                    return (int8_t)i;
+                }
+            }
+                break;
+#endif
+#if KERNEL_USE_NOTIFY
+            case WAITSET_TYPE_NOTIFY:
+            {
+                if (pstEntry->bLatched)
+                {
+                    pstEntry->bLatched = false;
+                    return (int8_t)i;
+                }
+            }
+                break;
+#endif
+#if KERNEL_USE_MESSAGE
+            case WAITSET_TYPE_MESSAGE:
+            {
+                MessageQueue *pclQueue = static_cast<MessageQueue*>(pstEntry->pvOwner);
+                if (pclQueue->m_clSemaphore.m_u16Value)
+                {
+                    // Same as MessageQueue::Receive(), without blocking
+                    pclQueue->m_clSemaphore.m_u16Value--;
+                    m_pclMessage = pclQueue->Dequeue_i();
+                    return (int8_t)i;
+                }
+            }
+                break;
+#endif
+            default:
+                break;
+        }
+    }
+    return -1;
+}
+
+//---------------------------------------------------------------------------
+#if KERNEL_USE_TIMEOUTS
+int8_t WaitSet::Wait_i(uint32_t u32TimeMS_)
+#else
+int8_t WaitSet::Wait_i()
+#endif
+{
+    int8_t i8Ret = -1;
+    bool bDone = false;
+
+#if KERNEL_USE_TIMEOUTS
+    bool bUseTimer = false;
+
+    g_pclCurrent->SetExpired(false);
+#endif
+
+    // Objects can be acquired by other threads between our being woken and
+    // running, so keep going until we've acquired one (or timed out).  The
+    // check and the block are performed within the same critical section,
+    // so a signal can't slip in between them.
+    while (!bDone)
+    {
+        CS_ENTER();
+
+        i8Ret = TryAcquire();
+        if (i8Ret >= 0)
+        {
+            bDone = true;
+        }
+#if KERNEL_USE_TIMEOUTS
+        else if (g_pclCurrent->GetExpired())
+        {
+            bDone = true;
+        }
+#endif
+        else
+        {
+#if KERNEL_USE_TIMEOUTS
+            // The timeout covers the whole call, not each individual block
+            if (u32TimeMS_ && !bUseTimer)
+            {
+                g_pclCurrent->StartTimeout(u32TimeMS_, TimedWaitSet_Callback, (void*)this);
+                bUseTimer = true;
+            }
+#endif
+            BlockPriority(g_pclCurrent);
+
+            // Switch Threads immediately
+            Thread::Yield();
+        }
+
+        CS_EXIT();
+    }
+
+#if KERNEL_USE_TIMEOUTS
+    if (bUseTimer)
+    {
+        g_pclCurrent->StopTimeout();
+    }
+#endif
+
+    return i8Ret;
+}
+
+//---------------------------------------------------------------------------
+int8_t WaitSet::Wait()
+{
+#if KERNEL_USE_TIMEOUTS
+    return Wait_i(0);
+#else
+    return Wait_i();
+#endif
+}
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+int8_t WaitSet::Wait(uint32_t u32TimeMS_)
+{
+    return Wait_i(u32TimeMS_);
+}
+#endif
+
+//---------------------------------------------------------------------------
+void WaitSet::Signal(BlockingObject *pclObject_)
+{
+    bool bReschedule = false;
+
+    CS_ENTER();
+
+#if KERNEL_USE_NOTIFY
+    // Notification objects don't hold any state of their own, so the set
+    // latches the signal on their behalf.
+    for (uint8_t i = 0; i < m_u8Count; i++)
+    {
+        if (m_astEntries[i].pclObject == pclObject_)
+        {
+            if (m_astEntries[i].u8Type == WAITSET_TYPE_NOTIFY)
+            {
+                m_astEntries[i].bLatched = true;
+            }
+            break;
+        }
+    }
+#endif
+
+    // Wake the waiting thread, so it can attempt to acquire the object
+    Thread *pclCurrent = static_cast<Thread*>(m_clBlockList.GetHead());
+    while (pclCurrent != NULL)
+    {
+        UnBlock(pclCurrent);
+        if (pclCurrent->GetCurPriority() >= Scheduler::GetCurrentThread()->GetCurPriority())
+        {
+            bReschedule = true;
+        }
+        pclCurrent = static_cast<Thread*>(m_clBlockList.GetHead());
+    }
+
+    if (bReschedule)
+    {
+        Thread::Yield();
+    }
+
+    CS_EXIT();
+}
+
+//---------------------------------------------------------------------------
+void WaitSet::WakeMe(Thread *pclChosenOne_)
+{
+    // Only unblock the thread if it's still blocked on this object - it may
+    // have been woken by a signal before the timeout was processed.
+    if ((pclChosenOne_->GetState() == THREAD_STATE_BLOCKED) &&
+        (pclChosenOne_->GetCurrent() == &m_clBlockList))
+    {
+        UnBlock(pclChosenOne_);
+    }
+}
+
+#endif // KERNEL_USE_WAITSET
@@ -51,11 +51,23 @@ void Arena::Init( void *pvBuffer_, K_ADDR u32Size_, K_ADDR *au32Sizes_, uint8_t
     uint32_t u32MetaSize;
     u32MetaSize = (sizeof(ArenaList) * (uint32_t)(u8NumSizes_));
 
+#if HEAP_USE_STATS
+    // The usage counters follow the lists at the start of the buffer
+    m_paclStats = (HeapClassStats*)((K_ADDR)pvBuffer_ + u32MetaSize);
+    for (uint8_t i = 0; i < u8NumSizes_; i++)
+    {
+        m_paclStats[i].Init( au32Sizes_[i] );
+    }
+    u32MetaSize += (sizeof(HeapClassStats) * (uint32_t)(u8NumSizes_));
+    m_uUsedBytes = 0;
+    m_uPeakBytes = 0;
+#endif
+
     // Pre-populate the block-list with the largest-size blocks
     // possible, until the whole contiguous buffer is completely
     // accounted for.
     uint32_t u32SizeRemain = u32Size_ - u32MetaSize;
-    K_ADDR uPtr = (K_ADDR)((uint32_t)pvBuffer_ + u32MetaSize);
+    K_ADDR uPtr = (K_ADDR)pvBuffer_ + u32MetaSize;
     while (u32SizeRemain >= (sizeof(HeapBlock) + au32Sizes_[0]))
     {
         HeapBlock *pclBlock = new ((void*)uPtr) HeapBlock();
@@ -102,6 +114,12 @@ void *Arena::Allocate( K_ADDR usize_ )
 
     CS_ENTER(); 
     uList = ListToSatisfy( usize_ );
+#if HEAP_USE_STATS
+    if ((uList == ARENA_EXHAUSTED) || (uList == ARENA_FULL))
+    {
+        StatsForSize( usize_ )->CountFail();
+    }
+#endif
     CS_EXIT();
 
     if ((uList == ARENA_EXHAUSTED) || (uList == ARENA_FULL))
@@ -143,6 +161,15 @@ void *Arena::Allocate( K_ADDR usize_ )
     // pointer.
     pclRet->SetCookie(HEAP_COOKIE_ALLOCATED);
 
+#if HEAP_USE_STATS
+    StatsForSize( pclRet->GetDataSize() )->CountAlloc();
+    m_uUsedBytes += pclRet->GetDataSize();
+    if (m_uUsedBytes > m_uPeakBytes)
+    {
+        m_uPeakBytes = m_uUsedBytes;
+    }
+#endif
+
     CS_EXIT();
     return pclRet->GetDataPointer();
 }
@@ -164,6 +191,10 @@ void Arena::Free( void *pvBlock_ )
     pclTemp = pclRight;
     DEBUG_PRINT(" Data Pointer: 0x%X, Object 0x%X, Cookie %08X\n",
                     pvBlock_, pclBlock, pclBlock->GetCookie() );
+#if HEAP_USE_STATS
+    StatsForSize( pclBlock->GetDataSize() )->CountFree();
+    m_uUsedBytes -= pclBlock->GetDataSize();
+#endif
     while (pclTemp && (pclTemp->GetCookie() == HEAP_COOKIE_FREE))
     {
         // Remove this free block from its currently allocated arena
@@ -221,9 +252,11 @@ uint8_t Arena::ListForSize( K_ADDR usize_ )
         return ARENA_EXHAUSTED;
     }
 
-    for (uint8_t i = 0; i <= m_u8LargestList ; i++)
+    // Blocks go in the largest list whose minimum size they meet.  The
+    // checks above guarantee a match for list 0, so start from list 1.
+    for (uint8_t i = 1; i <= m_u8LargestList ; i++)
     {
-        if (usize_ <= m_aclBlockList[i].GetBlockSize())
+        if (usize_ < m_aclBlockList[i].GetBlockSize())
         {
             DEBUG_PRINT("   Size %d goes in List: %d\n", usize_, i - 1);
             return (i -  1);
@@ -248,6 +281,72 @@ uint8_t Arena::ListToSatisfy( K_ADDR usize_ )
     return ARENA_EXHAUSTED;
 }
 
+#if HEAP_USE_STATS
+//---------------------------------------------------------------------------
+HeapClassStats *Arena::StatsForSize( K_ADDR usize_ )
+{
+    uint8_t uList = ListForSize( usize_ );
+    if (uList == ARENA_FULL)
+    {
+        uList = 0;
+    }
+    else if (uList == ARENA_EXHAUSTED)
+    {
+        uList = m_u8LargestList;
+    }
+    return &m_paclStats[uList];
+}
+
+//---------------------------------------------------------------------------
+void Arena::GetStats( HeapStats *pclStats_ )
+{
+    uint8_t i;
+
+    pclStats_->m_uFreeBytes = 0;
+    pclStats_->m_uLargestFree = 0;
+    pclStats_->m_u32Allocs = 0;
+    pclStats_->m_u32Frees = 0;
+    pclStats_->m_u32Fails = 0;
+    pclStats_->m_u8Classes = m_u8LargestList + 1;
+
+    CS_ENTER();
+    pclStats_->m_uUsedBytes = m_uUsedBytes;
+    pclStats_->m_uPeakBytes = m_uPeakBytes;
+    for (i = 0; i <= m_u8LargestList; i++)
+    {
+        pclStats_->m_u32Allocs += m_paclStats[i].m_u32Allocs;
+        pclStats_->m_u32Frees += m_paclStats[i].m_u32Frees;
+        pclStats_->m_u32Fails += m_paclStats[i].m_u32Fails;
+    }
+    CS_EXIT();
+
+    // Walk the free lists one at a time, to keep each critical section
+    // short.
+    for (i = 0; i <= m_u8LargestList; i++)
+    {
+        CS_ENTER();
+        pclStats_->m_uFreeBytes += m_aclBlockList[i].GetFreeBytes( &pclStats_->m_uLargestFree );
+        CS_EXIT();
+    }
+
+    pclStats_->m_u8Fragmentation = HeapStats::Fragmentation( pclStats_->m_uFreeBytes, pclStats_->m_uLargestFree );
+}
+
+//---------------------------------------------------------------------------
+bool Arena::GetClassStats( uint8_t u8Class_, HeapClassStats *pclStats_ )
+{
+    if (u8Class_ > m_u8LargestList)
+    {
+        return false;
+    }
+
+    CS_ENTER();
+    *pclStats_ = m_paclStats[u8Class_];
+    CS_EXIT();
+    return true;
+}
+#endif
+
 //---------------------------------------------------------------------------
 void Arena::Print( void )
 {
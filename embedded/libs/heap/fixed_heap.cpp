@@ -18,14 +18,17 @@ See license.txt for more information
     containing multiple lists, each list containing a linked-list of blocks
     that are each the same size.  As a result of the linked-list format, 
     these heaps are very fast - requiring only a linked list pop/push to 
-    allocated/free memory.  Array traversal is required to allow for the optimal
-    heap to be used.  Blocks are chosen from the first heap with free blocks
-    large enough to fulfill the request.
+    allocated/free memory.  Blocks are chosen from the first heap with free blocks
+    large enough to fulfill the request - found using a size lookup table and
+    a bitmap of the heaps with free blocks, rather than by traversing the
+    heaps in turn.
     
     Only simple malloc/free functionlality is supported in this implementation,
     no complex vector-allocate or reallocation functions are supported.
     
-    Heaps are protected by critical section, and are thus thread-safe.
+    Heaps are protected by critical section, and are thus thread-safe.  On
+    targets with exclusive-access instructions (HW_LDREX), the heaps are
+    updated lock-free instead, and never disable interrupts.
     
     When creating a heap, a user supplies an array of heap configuration objects,
     which determines how many objects of what size are available.
@@ -43,6 +46,7 @@ See license.txt for more information
 #include "kerneltypes.h"
 #include "fixed_heap.h"
 #include "threadport.h"
+#include "bitscan.h"
 
 //---------------------------------------------------------------------------
 class BlockHeapNode : public LinkListNode
@@ -53,6 +57,51 @@ protected:
     BlockHeap *m_clHeap;
 };
 
+//---------------------------------------------------------------------------
+/*!
+ * \brief heap_lsb
+ *
+ * Return the index of the least-significant bit set in a non-zero bitmap,
+ * using the kernel's shared bit-scan helper.
+ *
+ * \param u32Map_ Bitmap to scan
+ * \return Index of the lowest set bit
+ */
+static inline uint8_t heap_lsb( uint32_t u32Map_ )
+{
+    return bitscan_lsb( u32Map_ ) - 1;
+}
+
+#if defined(HW_LDREX) && HW_LDREX
+//---------------------------------------------------------------------------
+/*
+    Exclusive-access updates.  A context switch or interrupt between an
+    LDREX() and its STREX() clears the exclusive monitor and fails the
+    store, so each update is retried until it runs uninterrupted - there's
+    no need to disable interrupts.  That also means a stack head can't be
+    popped and pushed back behind our back between the two (the ABA
+    problem), as that would take an interrupt or context switch.
+*/
+static inline void heap_map_set( uint32_t *pu32Map_, uint32_t u32Bit_ )
+{
+    uint32_t u32Map;
+    do
+    {
+        u32Map = LDREX(pu32Map_);
+    } while (STREX(u32Map | u32Bit_, pu32Map_));
+}
+
+//---------------------------------------------------------------------------
+static inline void heap_map_clear( uint32_t *pu32Map_, uint32_t u32Bit_ )
+{
+    uint32_t u32Map;
+    do
+    {
+        u32Map = LDREX(pu32Map_);
+    } while (STREX(u32Map & ~u32Bit_, pu32Map_));
+}
+#endif
+
 //---------------------------------------------------------------------------
 void *BlockHeap::Create( void *pvHeap_, uint16_t u16Size_, uint16_t u16BlockSize_ )
 {
@@ -60,7 +109,12 @@ void *BlockHeap::Create( void *pvHeap_, uint16_t u16Size_, uint16_t u16BlockSize
 
     K_ADDR adNode = (K_ADDR)pvHeap_;
     K_ADDR adMaxNode = (K_ADDR)((K_ADDR)pvHeap_ + (K_ADDR)u16Size_);
-    m_clList.Init();
+    m_pclHead = 0;
+    m_pu32FreeMap = 0;
+    m_u32FreeBit = 0;
+#if HEAP_USE_STATS
+    m_clStats.Init( u16BlockSize_ );
+#endif
     
     // Create a heap (linked-list nodes + byte pool) in the middle of
     // the data blob
@@ -70,8 +124,9 @@ void *BlockHeap::Create( void *pvHeap_, uint16_t u16Size_, uint16_t u16BlockSize
         BlockHeapNode *pclTemp = (BlockHeapNode*)adNode;
         pclTemp->m_clHeap = this;
 
-        // Add the node to the block list
-        m_clList.Add( (LinkListNode*)pclTemp);
+        // Add the node to the free stack
+        pclTemp->next = m_pclHead;
+        m_pclHead = pclTemp;
         
         // Move the pointer in the pool to point to the next block to allocate
         adNode += (sizeof(BlockHeapNode) + u16BlockSize_);
@@ -82,7 +137,6 @@ void *BlockHeap::Create( void *pvHeap_, uint16_t u16Size_, uint16_t u16BlockSize
             break;
         }
     }
-    m_u16BlocksFree = u16NodeCount;
     
     // Return pointer to end of heap (usedd for heap-chaining)
     return (void*)adNode;
@@ -91,76 +145,229 @@ void *BlockHeap::Create( void *pvHeap_, uint16_t u16Size_, uint16_t u16BlockSize
 //---------------------------------------------------------------------------
 void *BlockHeap::Alloc()
 {
-    LinkListNode *pclNode = m_clList.GetHead();
+    BlockHeapNode *pclNode;
 
-    // Return the first node from the head of the list
-    if (pclNode)
+#if defined(HW_LDREX) && HW_LDREX
+    do
     {
-        m_clList.Remove( pclNode );
-        m_u16BlocksFree--;
-        
-        // Account for block-management metadata
-        return (void*)((K_ADDR)pclNode + sizeof(BlockHeapNode));
+        pclNode = (BlockHeapNode*)LDREX((uint32_t*)&m_pclHead);
+        if (!pclNode)
+        {
+            CLREX();
+            return 0;
+        }
+    } while (STREX((uint32_t)pclNode->next, (uint32_t*)&m_pclHead));
+
+  #if HEAP_USE_STATS
+    CS_ENTER();
+    m_clStats.CountAlloc();
+    CS_EXIT();
+  #endif
+#else
+    // Pop the node from the top of the stack - called from within a
+    // critical section.
+    pclNode = (BlockHeapNode*)m_pclHead;
+    if (!pclNode)
+    {
+        return 0;
     }
-    
-    // Or null, if the heap is empty.
-    return 0;
+    m_pclHead = pclNode->next;
+
+    // Keep the owner's bitmap exact.
+    if (!m_pclHead && m_pu32FreeMap)
+    {
+        *m_pu32FreeMap &= ~m_u32FreeBit;
+    }
+
+  #if HEAP_USE_STATS
+    m_clStats.CountAlloc();
+  #endif
+#endif
+
+    // Account for block-management metadata
+    return (void*)((K_ADDR)pclNode + sizeof(BlockHeapNode));
 }
 
 //---------------------------------------------------------------------------
 void BlockHeap::Free( void* pvData_ )
 {
     // Compute the address of the original object (class metadata included)
-    LinkListNode *pclNode = (LinkListNode*)((K_ADDR)pvData_ - sizeof(BlockHeapNode));
+    BlockHeapNode *pclNode = (BlockHeapNode*)((K_ADDR)pvData_ - sizeof(BlockHeapNode));
     
-    // Add the object back to the block data pool
-    m_clList.Add(pclNode);
-    m_u16BlocksFree++;
+    // Push the object back onto the free stack, then flag the block size as
+    // having free blocks.
+#if defined(HW_LDREX) && HW_LDREX
+    do
+    {
+        pclNode->next = (LinkListNode*)LDREX((uint32_t*)&m_pclHead);
+    } while (STREX((uint32_t)pclNode, (uint32_t*)&m_pclHead));
+
+    if (m_pu32FreeMap)
+    {
+        heap_map_set( m_pu32FreeMap, m_u32FreeBit );
+    }
+
+  #if HEAP_USE_STATS
+    CS_ENTER();
+    m_clStats.CountFree();
+    CS_EXIT();
+  #endif
+#else
+    pclNode->next = m_pclHead;
+    m_pclHead = pclNode;
+
+    if (m_pu32FreeMap)
+    {
+        *m_pu32FreeMap |= m_u32FreeBit;
+    }
+
+  #if HEAP_USE_STATS
+    m_clStats.CountFree();
+  #endif
+#endif
 }
 
 //---------------------------------------------------------------------------
 void FixedHeap::Create( void *pvHeap_, HeapConfig *pclHeapConfig_ )
 {
-    uint16_t i = 0;
+    uint8_t i = 0;
+    uint8_t j = 0;
     void *pvTemp = pvHeap_;
-    while( pclHeapConfig_[i].m_u16BlockSize != 0)
+
+    m_u32FreeMap = 0;
+    while( (i < FIXED_HEAP_MAX_SIZES) && (pclHeapConfig_[i].m_u16BlockSize != 0) )
     {
         pvTemp = pclHeapConfig_[i].m_clHeap.Create( pvTemp,
                     ((pclHeapConfig_[i].m_u16BlockSize + sizeof(BlockHeapNode))
                      * pclHeapConfig_[i].m_u16BlockCount),
                      pclHeapConfig_[i].m_u16BlockSize );
+
+        pclHeapConfig_[i].m_clHeap.m_pu32FreeMap = &m_u32FreeMap;
+        pclHeapConfig_[i].m_clHeap.m_u32FreeBit = ((uint32_t)1 << i);
+        if (pclHeapConfig_[i].m_clHeap.IsFree())
+        {
+            m_u32FreeMap |= ((uint32_t)1 << i);
+        }
         i++;
     }
     m_paclHeaps = pclHeapConfig_;
+    if (i)
+    {
+        m_u8LargestSize = i - 1;
+    }
+    else
+    {
+        // No block sizes configured - the end-of-configuration entry stands
+        // in as the only (0-byte, 0-block) size, which every Alloc() fails.
+        m_u8LargestSize = 0;
+#if HEAP_USE_STATS
+        pclHeapConfig_[0].m_clHeap.m_clStats.Init( 0 );
+#endif
+    }
+
+    // Build the size lookup table.  Each entry covers an equal range of
+    // request sizes, just wide enough for the table to reach the largest
+    // block size, and holds the smallest block size that fits the bottom of
+    // that range.
+    m_u8LUTShift = 0;
+    while (((uint16_t)(m_paclHeaps[m_u8LargestSize].m_u16BlockSize - 1) >> m_u8LUTShift) >= FIXED_HEAP_LUT_SIZE)
+    {
+        m_u8LUTShift++;
+    }
+    for (i = 0; i < FIXED_HEAP_LUT_SIZE; i++)
+    {
+        uint16_t u16Min = ((uint16_t)i << m_u8LUTShift) + 1;
+        while ((j < m_u8LargestSize) && (m_paclHeaps[j].m_u16BlockSize < u16Min))
+        {
+            j++;
+        }
+        m_au8SizeLUT[i] = j;
+    }
 }
 
 //---------------------------------------------------------------------------
 void *FixedHeap::Alloc( uint16_t u16Size_ )
 {
     void *pvRet = 0;
-    uint16_t i = 0;
-    
-    // Go through all heaps, trying to find the smallest one that 
-    // has a free item to satisfy the allocation
-    while (m_paclHeaps[i].m_u16BlockSize != 0)
+    uint8_t u8Index;
+    uint32_t u32Map;
+
+    if (!u16Size_)
+    {
+        u16Size_ = 1;
+    }
+    if (u16Size_ > m_paclHeaps[m_u8LargestSize].m_u16BlockSize)
+    {
+#if HEAP_USE_STATS
+        CS_ENTER();
+        m_paclHeaps[m_u8LargestSize].m_clHeap.m_clStats.CountFail();
+        CS_EXIT();
+#endif
+        return 0;
+    }
+
+    // Find the smallest block size that fits - the table gets us to within
+    // a block size or two (or exactly there, for evenly-spaced sizes).
+    u8Index = m_au8SizeLUT[ (uint16_t)(u16Size_ - 1) >> m_u8LUTShift ];
+    while (m_paclHeaps[u8Index].m_u16BlockSize < u16Size_)
     {
-        CS_ENTER();        
-        if ((m_paclHeaps[i].m_u16BlockSize >= u16Size_) && m_paclHeaps[i].m_clHeap.IsFree() )
+        u8Index++;
+    }
+
+#if defined(HW_LDREX) && HW_LDREX
+    // Bits are only cleared here, after failing to pop a block, so a set bit
+    // means "may have free blocks".  Each failed attempt clears a bit,
+    // unless a block was freed to that size in the meantime.
+    while (1)
+    {
+        u32Map = m_u32FreeMap & ((uint32_t)0xFFFFFFFF << u8Index);
+        if (!u32Map)
         {
-            // Found a match            
-            pvRet = m_paclHeaps[i].m_clHeap.Alloc();        
+            break;
         }
-        CS_EXIT();
+        uint8_t u8Heap = heap_lsb(u32Map);
+        BlockHeap *pclHeap = &m_paclHeaps[u8Heap].m_clHeap;
 
-        // Return an object if found
+        pvRet = pclHeap->Alloc();
         if (pvRet)
         {
-            return pvRet;
+            break;
         }
-        i++;
+
+        // A Free() sets the bit after its push, so re-check after clearing
+        heap_map_clear( &m_u32FreeMap, pclHeap->m_u32FreeBit );
+        if (pclHeap->IsFree())
+        {
+            heap_map_set( &m_u32FreeMap, pclHeap->m_u32FreeBit );
+        }
+    }
+
+  #if HEAP_USE_STATS
+    if (!pvRet)
+    {
+        CS_ENTER();
+        m_paclHeaps[u8Index].m_clHeap.m_clStats.CountFail();
+        CS_EXIT();
+    }
+  #endif
+#else
+    // Take a block from the smallest block size at least as large as the
+    // request that has free blocks.
+    CS_ENTER();
+    u32Map = m_u32FreeMap & ((uint32_t)0xFFFFFFFF << u8Index);
+    if (u32Map)
+    {
+        pvRet = m_paclHeaps[heap_lsb(u32Map)].m_clHeap.Alloc();
     }
+  #if HEAP_USE_STATS
+    else
+    {
+        m_paclHeaps[u8Index].m_clHeap.m_clStats.CountFail();
+    }
+  #endif
+    CS_EXIT();
+#endif
     
-    // Or null on no-match
     return pvRet;
 }
 
@@ -169,10 +376,64 @@ void FixedHeap::Free( void *pvNode_ )
 {
     // Compute the pointer to the block-heap this block belongs to, and
     // return it.
-    CS_ENTER();
     BlockHeapNode *pclNode = (BlockHeapNode*)((K_ADDR)pvNode_ - sizeof(BlockHeapNode));
+#if defined(HW_LDREX) && HW_LDREX
+    pclNode->m_clHeap->Free( pvNode_ );
+#else
+    CS_ENTER();
     pclNode->m_clHeap->Free( pvNode_ );
     CS_EXIT();
+#endif
+}
+
+#if HEAP_USE_STATS
+//---------------------------------------------------------------------------
+void FixedHeap::GetStats( HeapStats *pclStats_ )
+{
+    HeapClassStats clClass;
+
+    pclStats_->m_uUsedBytes = 0;
+    pclStats_->m_uPeakBytes = 0;
+    pclStats_->m_uFreeBytes = 0;
+    pclStats_->m_uLargestFree = 0;
+    pclStats_->m_u32Allocs = 0;
+    pclStats_->m_u32Frees = 0;
+    pclStats_->m_u32Fails = 0;
+    pclStats_->m_u8Classes = m_u8LargestSize + 1;
+
+    for (uint8_t i = 0; i <= m_u8LargestSize; i++)
+    {
+        uint16_t u16Free;
+
+        GetClassStats( i, &clClass );
+        u16Free = m_paclHeaps[i].m_u16BlockCount - clClass.m_u16Current;
+
+        pclStats_->m_uUsedBytes += (K_ADDR)clClass.m_u16Current * clClass.m_uBlockSize;
+        pclStats_->m_uPeakBytes += (K_ADDR)clClass.m_u16Peak * clClass.m_uBlockSize;
+        pclStats_->m_uFreeBytes += (K_ADDR)u16Free * clClass.m_uBlockSize;
+        if (u16Free)
+        {
+            pclStats_->m_uLargestFree = clClass.m_uBlockSize;
+        }
+        pclStats_->m_u32Allocs += clClass.m_u32Allocs;
+        pclStats_->m_u32Frees += clClass.m_u32Frees;
+        pclStats_->m_u32Fails += clClass.m_u32Fails;
+    }
+
+    pclStats_->m_u8Fragmentation = HeapStats::Fragmentation( pclStats_->m_uFreeBytes, pclStats_->m_uLargestFree );
 }
 
+//---------------------------------------------------------------------------
+bool FixedHeap::GetClassStats( uint8_t u8Class_, HeapClassStats *pclStats_ )
+{
+    if (u8Class_ > m_u8LargestSize)
+    {
+        return false;
+    }
 
+    CS_ENTER();
+    *pclStats_ = m_paclHeaps[u8Class_].m_clHeap.m_clStats;
+    CS_EXIT();
+    return true;
+}
+#endif
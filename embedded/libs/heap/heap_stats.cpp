@@ -0,0 +1,118 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+
+    \file   heap_stats.cpp
+
+    \brief  Text dumps of heap allocator statistics.
+*/
+
+#include "kerneltypes.h"
+#include "heap_stats.h"
+#include "fixed_heap.h"
+#include "arena.h"
+#include "tlsf_heap.h"
+#include "memutil.h"
+
+#if HEAP_USE_STATS
+
+//---------------------------------------------------------------------------
+void HeapDump::Print( const char *szName_, FixedHeap *pclHeap_, HeapPrint_t pfPrint_ )
+{
+    HeapStats clStats;
+    HeapClassStats clClass;
+
+    pclHeap_->GetStats( &clStats );
+    PrintHeap( szName_, &clStats, pfPrint_ );
+    for (uint8_t i = 0; i < clStats.m_u8Classes; i++)
+    {
+        pclHeap_->GetClassStats( i, &clClass );
+        PrintClass( i, &clClass, pfPrint_ );
+    }
+}
+
+//---------------------------------------------------------------------------
+void HeapDump::Print( const char *szName_, Arena *pclHeap_, HeapPrint_t pfPrint_ )
+{
+    HeapStats clStats;
+    HeapClassStats clClass;
+
+    pclHeap_->GetStats( &clStats );
+    PrintHeap( szName_, &clStats, pfPrint_ );
+    for (uint8_t i = 0; i < clStats.m_u8Classes; i++)
+    {
+        pclHeap_->GetClassStats( i, &clClass );
+        PrintClass( i, &clClass, pfPrint_ );
+    }
+}
+
+//---------------------------------------------------------------------------
+void HeapDump::Print( const char *szName_, TlsfHeap *pclHeap_, HeapPrint_t pfPrint_ )
+{
+    HeapStats clStats;
+    HeapClassStats clClass;
+
+    pclHeap_->GetStats( &clStats );
+    PrintHeap( szName_, &clStats, pfPrint_ );
+    for (uint8_t i = 0; i < clStats.m_u8Classes; i++)
+    {
+        pclHeap_->GetClassStats( i, &clClass );
+
+        // TLSF has a fixed set of classes - skip the ones never used.
+        if (clClass.m_u32Allocs || clClass.m_u32Fails)
+        {
+            PrintClass( i, &clClass, pfPrint_ );
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+void HeapDump::PrintHeap( const char *szName_, HeapStats *pclStats_, HeapPrint_t pfPrint_ )
+{
+    pfPrint_( szName_ );
+    PrintValue( ": used=", (uint32_t)pclStats_->m_uUsedBytes, pfPrint_ );
+    PrintValue( " peak=", (uint32_t)pclStats_->m_uPeakBytes, pfPrint_ );
+    PrintValue( " free=", (uint32_t)pclStats_->m_uFreeBytes, pfPrint_ );
+    PrintValue( " largest=", (uint32_t)pclStats_->m_uLargestFree, pfPrint_ );
+    PrintValue( " frag=", (uint32_t)pclStats_->m_u8Fragmentation, pfPrint_ );
+    PrintValue( "% allocs=", pclStats_->m_u32Allocs, pfPrint_ );
+    PrintValue( " frees=", pclStats_->m_u32Frees, pfPrint_ );
+    PrintValue( " fails=", pclStats_->m_u32Fails, pfPrint_ );
+    pfPrint_( "\n" );
+}
+
+//---------------------------------------------------------------------------
+void HeapDump::PrintClass( uint8_t u8Class_, HeapClassStats *pclStats_, HeapPrint_t pfPrint_ )
+{
+    PrintValue( "  [", (uint32_t)u8Class_, pfPrint_ );
+    PrintValue( "] size=", (uint32_t)pclStats_->m_uBlockSize, pfPrint_ );
+    PrintValue( " cur=", (uint32_t)pclStats_->m_u16Current, pfPrint_ );
+    PrintValue( " peak=", (uint32_t)pclStats_->m_u16Peak, pfPrint_ );
+    PrintValue( " allocs=", pclStats_->m_u32Allocs, pfPrint_ );
+    PrintValue( " frees=", pclStats_->m_u32Frees, pfPrint_ );
+    PrintValue( " fails=", pclStats_->m_u32Fails, pfPrint_ );
+    pfPrint_( "\n" );
+}
+
+//---------------------------------------------------------------------------
+void HeapDump::PrintValue( const char *szLabel_, uint32_t u32Value_, HeapPrint_t pfPrint_ )
+{
+    char acBuf[11];
+
+    MemUtil::DecimalToString( u32Value_, acBuf );
+    pfPrint_( szLabel_ );
+    pfPrint_( acBuf );
+}
+
+#endif // HEAP_USE_STATS
@@ -24,6 +24,7 @@ See license.txt for more information
 #include <stdint.h>
 #include "arenalist.h"
 #include "heapblock.h"
+#include "heap_stats.h"
 
 //---------------------------------------------------------------------------
 #define ARENA_EXHAUSTED         (255)
@@ -81,6 +82,30 @@ public:
      * Show details about the print via standard output.
      */
     void Print( void );
+
+#if HEAP_USE_STATS
+    /*!
+     * \brief GetStats
+     *
+     * Take a snapshot of the arena's usage.  Each size list is reported as
+     * a separate class.
+     *
+     * \param pclStats_ [out] Snapshot of the arena
+     */
+    void GetStats( HeapStats *pclStats_ );
+
+    /*!
+     * \brief GetClassStats
+     *
+     * Read the counters for a size list.
+     *
+     * \param u8Class_ Index of the list
+     * \param pclStats_ [out] Copy of the list's counters
+     * \return true on success, false if the list doesn't exist
+     */
+    bool GetClassStats( uint8_t u8Class_, HeapClassStats *pclStats_ );
+#endif
+
 private:
 
     /*!
@@ -105,6 +130,23 @@ private:
      */
     uint8_t ListToSatisfy( K_ADDR usize_ );
 
+#if HEAP_USE_STATS
+    /*!
+     * \brief StatsForSize
+     *
+     * Return the counters that allocations of a given size are accounted
+     * against.
+     *
+     * \param usize_ Data size of the block or request
+     * \return Pointer to the counters for the matching size list
+     */
+    HeapClassStats *StatsForSize( K_ADDR usize_ );
+
+    HeapClassStats *m_paclStats;   //!< Per-list usage counters, stored after the lists
+    K_ADDR     m_uUsedBytes;       //!< Data bytes currently allocated
+    K_ADDR     m_uPeakBytes;       //!< Peak value of m_uUsedBytes
+#endif
+
     uint8_t    m_u8LargestList;    //!< Index of the largest arena
     ArenaList  *m_aclBlockList;    //!< Arena linked-list data
     void       *m_pvData;          //!< Pointer to the raw memory blob managed by this object as a heap.
@@ -130,6 +130,33 @@ public:
         return m_u16Count;
     }
 
+    /*!
+     * \brief GetFreeBytes
+     *
+     * Walk the list, totalling the data size of the blocks in it.  Must be
+     * called from within a critical section.
+     *
+     * \param puLargest_ [in/out] Raised to the data size of the largest
+     *                   block in the list, if larger than its current value.
+     * \return Total data size of the blocks in the list
+     */
+    K_ADDR GetFreeBytes( K_ADDR *puLargest_ )
+    {
+        K_ADDR uTotal = 0;
+        HeapBlock *pclBlock = (HeapBlock*)GetHead();
+        while (pclBlock)
+        {
+            K_ADDR uSize = pclBlock->GetDataSize();
+            uTotal += uSize;
+            if (uSize > *puLargest_)
+            {
+                *puLargest_ = uSize;
+            }
+            pclBlock = (HeapBlock*)pclBlock->GetNext();
+        }
+        return uTotal;
+    }
+
 private:
     K_ADDR     m_uBlockSize;    //!< The minimum data-size for blocks held in this arena
     uint16_t   m_u16Count;      //!< Current number of available blocks in this list
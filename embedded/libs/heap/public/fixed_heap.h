@@ -21,6 +21,16 @@ See license.txt for more information
 
 #include "kerneltypes.h"
 #include "ll.h"
+#include "heap_stats.h"
+
+//---------------------------------------------------------------------------
+//! Maximum number of block sizes in a FixedHeap (width of its free bitmap)
+#define FIXED_HEAP_MAX_SIZES        (32)
+
+//! Number of entries in a FixedHeap's size-to-block-size lookup table
+#define FIXED_HEAP_LUT_SIZE         (16)
+
+class FixedHeap;
 
 //---------------------------------------------------------------------------
 /*!
@@ -70,17 +80,26 @@ public:
      *  
      *  \return true if the heap is not full, false if the heap is full
      */
-    bool IsFree() { return m_u16BlocksFree != 0; }
-    
-protected:
-    uint16_t m_u16BlocksFree;    //!< Number of blocks free in the heap
+    bool IsFree() { return m_pclHead != 0; }
     
+    friend class FixedHeap;
+
 private:    
-    DoubleLinkList m_clList;    //!< Linked list used to manage the blocks
-};
+    /*!
+     *  Free blocks are kept in a LIFO stack, so that a block can be pushed
+     *  or popped by updating a single pointer.  On targets with exclusive-
+     *  access instructions (HW_LDREX in threadport.h) that update is done
+     *  without a critical section.
+     */
+    LinkListNode * volatile m_pclHead;
 
+    uint32_t *m_pu32FreeMap;    //!< Owning FixedHeap's free bitmap, or 0 if none
+    uint32_t m_u32FreeBit;      //!< This heap's bit in the free bitmap
 
-class FixedHeap;
+#if HEAP_USE_STATS
+    HeapClassStats m_clStats;   //!< Usage counters for this block size
+#endif
+};
 
 //---------------------------------------------------------------------------
 /*!
@@ -116,7 +135,9 @@ public:
      *         blocks of what size are included.  The objects in the 
      *         array must be initialized, starting from smallest block-size
      *         to largest, with the final entry in the table have a 
-     *         0-block size, indicating end-of-configuration.
+     *         0-block size, indicating end-of-configuration.  At most
+     *         FIXED_HEAP_MAX_SIZES block sizes are used.  A heap created
+     *         with no block sizes fails every allocation.
      */
     void Create( void *pvHeap_, HeapConfig *pclHeapConfig_ );
 
@@ -126,6 +147,11 @@ public:
      *  Allocate a blob of memory from the heap.  If no appropriately-sized
      *  data block is available, will return NULL.  Note, this API is thread-
      *  safe, and interrupt safe.
+     *
+     *  The smallest suitable block size is found through a lookup table
+     *  built by Create(), and the smallest block size with free blocks from
+     *  a bitmap - the time taken doesn't depend on the number of block
+     *  sizes.
      *          
      *  \param u16Size_ Size (in bytes) to allocate from the heap
      *  
@@ -145,9 +171,46 @@ public:
      *  
      */
     static void Free( void *pvNode_ );
+
+#if HEAP_USE_STATS
+    /*!
+     *  \brief GetStats
+     *
+     *  Take a snapshot of the heap's usage.  Each block size is reported as
+     *  a separate class.  As the block sizes don't share memory, the peak
+     *  usage reported is the sum of each block size's peak - the memory 
+     *  needed to have satisfied every allocation made so far.
+     *
+     *  On targets with exclusive-access instructions (HW_LDREX), keeping
+     *  the counters requires a short critical section in each Alloc() and
+     *  Free() call.
+     *
+     *  \param pclStats_ [out] Snapshot of the heap
+     */
+    void GetStats( HeapStats *pclStats_ );
+
+    /*!
+     *  \brief GetClassStats
+     *
+     *  Read the counters for a block size.
+     *
+     *  \param u8Class_ Index of the block size in the heap's configuration
+     *  \param pclStats_ [out] Copy of the block size's counters
+     *  \return true on success, false if the block size doesn't exist
+     */
+    bool GetClassStats( uint8_t u8Class_, HeapClassStats *pclStats_ );
+#endif
     
 private:
     HeapConfig *m_paclHeaps;    //!< Pointer to the configuration data used by the heap
+
+    uint32_t m_u32FreeMap;      //!< Bitmap of block sizes that (may) have free blocks
+    uint8_t m_u8LUTShift;       //!< log2 of the request sizes covered by each LUT entry
+    uint8_t m_u8LargestSize;    //!< Index of the largest block size
+
+    //! Index of the smallest block size at least as large as each range of
+    //! request sizes
+    uint8_t m_au8SizeLUT[FIXED_HEAP_LUT_SIZE];
 };
 
 #endif
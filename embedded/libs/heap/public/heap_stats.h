@@ -0,0 +1,230 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+
+    \file   heap_stats.h
+
+    \brief  Usage statistics for the heap allocators.
+*/
+
+#ifndef __HEAP_STATS_H__
+#define __HEAP_STATS_H__
+
+#include "kerneltypes.h"
+#include "system_heap_config.h"
+
+#if HEAP_USE_STATS
+
+class FixedHeap;
+class Arena;
+class TlsfHeap;
+
+//---------------------------------------------------------------------------
+/*!
+ * \brief The HeapClassStats class
+ *
+ * Counters kept for a single size class of a heap - a block size in a
+ * FixedHeap, a size list in an Arena, or a first-level size class in a
+ * TlsfHeap.  Allocations are counted against the class of the block
+ * handed out, and failures against the class the request maps to, with
+ * requests too large for any class counted against the largest one.
+ *
+ * The counters are updated from within the allocators' critical sections,
+ * and are read using the allocators' GetClassStats() methods.
+ */
+class HeapClassStats
+{
+public:
+    /*!
+     * \brief Init
+     *
+     * Clear the counters, and tag them with the class' block size.
+     *
+     * \param uBlockSize_ Block size (or smallest block size) of the class
+     */
+    void Init( K_ADDR uBlockSize_ )
+    {
+        m_uBlockSize = uBlockSize_;
+        m_u16Current = 0;
+        m_u16Peak = 0;
+        m_u32Allocs = 0;
+        m_u32Frees = 0;
+        m_u32Fails = 0;
+    }
+
+    /*!
+     * \brief CountAlloc
+     *
+     * Account for a block allocated from this class.
+     */
+    void CountAlloc( void )
+    {
+        m_u32Allocs++;
+        m_u16Current++;
+        if (m_u16Current > m_u16Peak)
+        {
+            m_u16Peak = m_u16Current;
+        }
+    }
+
+    /*!
+     * \brief CountFree
+     *
+     * Account for a block returned to this class.
+     */
+    void CountFree( void )
+    {
+        m_u32Frees++;
+        m_u16Current--;
+    }
+
+    /*!
+     * \brief CountFail
+     *
+     * Account for a request that couldn't be satisfied.
+     */
+    void CountFail( void )
+    {
+        m_u32Fails++;
+    }
+
+    K_ADDR   m_uBlockSize;  //!< Block size (FixedHeap), or smallest block size held in the class
+    uint16_t m_u16Current;  //!< Number of blocks currently allocated
+    uint16_t m_u16Peak;     //!< Largest number of blocks allocated at once
+    uint32_t m_u32Allocs;   //!< Number of successful allocations
+    uint32_t m_u32Frees;    //!< Number of blocks freed
+    uint32_t m_u32Fails;    //!< Number of failed allocations
+};
+
+//---------------------------------------------------------------------------
+/*!
+ * \brief The HeapStats class
+ *
+ * A snapshot of the state of a whole heap, returned by the allocators'
+ * GetStats() methods.  The free-space figures are gathered by walking the
+ * heap's free lists one at a time, so that interrupts aren't held off for
+ * the length of the whole walk - on a busy heap the figures are a close
+ * approximation, rather than an exact instant.
+ */
+class HeapStats
+{
+public:
+    /*!
+     * \brief Fragmentation
+     *
+     * Compute a fragmentation index from the amount of free memory, and
+     * the size of the largest free block.
+     *
+     * \param uFreeBytes_ Total free data bytes
+     * \param uLargestFree_ Size of the largest free block
+     * \return 0 when all free memory is in one block, approaching 100 as
+     *         free memory is split into many small blocks.
+     */
+    static uint8_t Fragmentation( K_ADDR uFreeBytes_, K_ADDR uLargestFree_ )
+    {
+        if (!uFreeBytes_)
+        {
+            return 0;
+        }
+        return (uint8_t)(100 - (uint8_t)(((uint32_t)uLargestFree_ * 100) / (uint32_t)uFreeBytes_));
+    }
+
+    K_ADDR   m_uUsedBytes;      //!< Data bytes currently allocated
+    K_ADDR   m_uPeakBytes;      //!< Largest number of data bytes allocated at once (see each allocator's GetStats())
+    K_ADDR   m_uFreeBytes;      //!< Data bytes available for allocation
+    K_ADDR   m_uLargestFree;    //!< Largest block that can currently be allocated
+    uint32_t m_u32Allocs;       //!< Successful allocations, over all classes
+    uint32_t m_u32Frees;        //!< Blocks freed, over all classes
+    uint32_t m_u32Fails;        //!< Failed allocations, over all classes
+    uint8_t  m_u8Fragmentation; //!< Fragmentation index, 0-100 (see Fragmentation())
+    uint8_t  m_u8Classes;       //!< Number of size classes in the heap
+};
+
+//---------------------------------------------------------------------------
+/*!
+ *  Function used to write text for a heap statistics dump - typically the
+ *  same routine a shell's command handlers print their output through.
+ */
+typedef void (*HeapPrint_t)( const char *szText_ );
+
+//---------------------------------------------------------------------------
+/*!
+ * \brief The HeapDump class
+ *
+ * Formats a heap's statistics as text, one line for the heap, followed by
+ * one line per size class.  Intended to be called from a shell command's
+ * handler (see ShellCommand_t), e.g.
+ *
+ * \code
+ * static char cmd_heap( CommandLine_t *pstCommand_ )
+ * {
+ *     HeapDump::Print( "sysheap", SystemHeap::GetHeap(), PrintString );
+ *     return 0;
+ * }
+ * \endcode
+ */
+class HeapDump
+{
+public:
+    /*!
+     * \brief Print
+     *
+     * Dump the statistics of a heap.
+     *
+     * \param szName_ Name to label the heap with
+     * \param pclHeap_ Heap to dump
+     * \param pfPrint_ Function used to write the text
+     */
+    static void Print( const char *szName_, FixedHeap *pclHeap_, HeapPrint_t pfPrint_ );
+    static void Print( const char *szName_, Arena *pclHeap_, HeapPrint_t pfPrint_ );
+    static void Print( const char *szName_, TlsfHeap *pclHeap_, HeapPrint_t pfPrint_ );
+
+private:
+    /*!
+     * \brief PrintHeap
+     *
+     * Write the heap-wide line of a dump.
+     *
+     * \param szName_ Name to label the heap with
+     * \param pclStats_ Heap snapshot to write
+     * \param pfPrint_ Function used to write the text
+     */
+    static void PrintHeap( const char *szName_, HeapStats *pclStats_, HeapPrint_t pfPrint_ );
+
+    /*!
+     * \brief PrintClass
+     *
+     * Write the line for a single size class.
+     *
+     * \param u8Class_ Index of the class
+     * \param pclStats_ Class counters to write
+     * \param pfPrint_ Function used to write the text
+     */
+    static void PrintClass( uint8_t u8Class_, HeapClassStats *pclStats_, HeapPrint_t pfPrint_ );
+
+    /*!
+     * \brief PrintValue
+     *
+     * Write a label, followed by a decimal value.
+     *
+     * \param szLabel_ Label text
+     * \param u32Value_ Value to write
+     * \param pfPrint_ Function used to write the text
+     */
+    static void PrintValue( const char *szLabel_, uint32_t u32Value_, HeapPrint_t pfPrint_ );
+};
+
+#endif // HEAP_USE_STATS
+
+#endif // __HEAP_STATS_H__
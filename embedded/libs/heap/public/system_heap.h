@@ -218,6 +218,33 @@ public:
      */
     static FixedHeap *GetHeap() { return &m_clSystemHeap; }
 
+#if HEAP_USE_STATS
+    /*!
+     * \brief GetStats
+     *
+     * Take a snapshot of the system heap's usage - see FixedHeap::GetStats().
+     * Use this to size the HEAP_BLOCK_COUNT_n values in system_heap_config.h
+     * from each block size's peak usage and failed allocations.
+     *
+     * \param pclStats_ [out] Snapshot of the heap
+     */
+    static void GetStats( HeapStats *pclStats_ ) { m_clSystemHeap.GetStats( pclStats_ ); }
+
+    /*!
+     * \brief GetClassStats
+     *
+     * Read the counters for one of the system heap's block sizes.
+     *
+     * \param u8Class_ Index of the block size, from 0 to HEAP_NUM_SIZES - 1
+     * \param pclStats_ [out] Copy of the block size's counters
+     * \return true on success, false if the block size doesn't exist
+     */
+    static bool GetClassStats( uint8_t u8Class_, HeapClassStats *pclStats_ )
+    {
+        return m_clSystemHeap.GetClassStats( u8Class_, pclStats_ );
+    }
+#endif
+
 private:
     static uint8_t m_pu8RawHeap[ HEAP_RAW_SIZE ]; //!< Raw heap buffer
     static HeapConfig m_pclSystemHeapConfig[ HEAP_NUM_SIZES + 1 ]; //!< Heap configuration metadata
@@ -29,6 +29,17 @@ See license.txt for more information
 */
 #define USE_SYSTEM_HEAP        (1)
 
+//---------------------------------------------------------------------------
+/*!
+    Set this to "1" to keep usage statistics (current/peak usage, failed 
+    allocations, free space and fragmentation) in all of the heap allocators
+    in this library - FixedHeap (and thus the system heap), Arena, and 
+    TlsfHeap.  The counters are updated within the allocators' existing 
+    critical sections, and read using their GetStats()/GetClassStats() 
+    methods.  See heap_stats.h.
+*/
+#define HEAP_USE_STATS         (0)
+
 //---------------------------------------------------------------------------
 /*!
     Define the number of heap block sizes that we want to have attached to
@@ -0,0 +1,198 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+
+    \file   tlsf_heap.h
+
+    \brief  Two-level segregated fit (TLSF) heap memory allocator.
+*/
+
+#ifndef __TLSF_HEAP_H__
+#define __TLSF_HEAP_H__
+
+#include <stdint.h>
+#include "arenalist.h"
+#include "heapblock.h"
+#include "heap_stats.h"
+
+//---------------------------------------------------------------------------
+//! log2 of the number of second-level lists in each size class
+#define TLSF_SL_SHIFT           (2)
+#define TLSF_SL_COUNT           (1 << TLSF_SL_SHIFT)
+
+//! Number of first-level size classes - sets the largest block size
+#define TLSF_FL_COUNT           (12)
+
+#if (PTR_SIZE == 2)
+  #define TLSF_ALIGN_SHIFT      (1)
+#elif (PTR_SIZE == 4)
+  #define TLSF_ALIGN_SHIFT      (2)
+#else
+  #define TLSF_ALIGN_SHIFT      (3)
+#endif
+
+//! Blocks smaller than this are all kept in the first size class, with
+//! one second-level list per pointer-size step
+#define TLSF_FL_SHIFT           (TLSF_SL_SHIFT + TLSF_ALIGN_SHIFT)
+#define TLSF_SMALL_SIZE         (1 << TLSF_FL_SHIFT)
+
+//! Smallest data size handed out, or left behind when splitting a block
+#define TLSF_MIN_SIZE           (PTR_SIZE)
+
+//! Largest data size that can be held in a single block
+#define TLSF_MAX_SIZE           ((((K_ADDR)1) << (TLSF_FL_COUNT + TLSF_FL_SHIFT - 1)) - PTR_SIZE)
+
+#if (TLSF_FL_COUNT > 16) || ((TLSF_FL_COUNT * TLSF_SL_COUNT) > 255)
+  #error "TLSF size classes don't fit the bitmaps/block arena index"
+#endif
+
+//---------------------------------------------------------------------------
+/*!
+ * \brief The TlsfHeap class
+ *
+ * This implements a heap using the two-level segregated fit algorithm.
+ * Like Arena, free blocks are kept in a set of ArenaList objects, and each
+ * allocation carries a HeapBlock header with the same sibling links and
+ * state cookies.  Unlike Arena, finding a list that can satisfy a request
+ * and freeing a block are both constant-time operations:
+ *
+ * - Blocks are indexed by a first-level class (the power-of-two range of
+ *   the block's size) and a second-level list, which divides that range
+ *   into TLSF_SL_COUNT equal steps.
+ * - A bitmap of the non-empty first-level classes, and a bitmap of
+ *   non-empty lists within each class, allow the smallest suitable block
+ *   to be found with a pair of bit scans instead of a list walk.
+ * - Free blocks are merged with their free neighbors as soon as they're
+ *   freed, so there are never two adjacent free blocks, and merging takes
+ *   at most one step in each direction.
+ *
+ * Each Allocate()/Free() call runs in a single, bounded critical section,
+ * regardless of how fragmented the heap is.  The trade-off is that
+ * requests are rounded up to the next second-level step, so up to
+ * 1/TLSF_SL_COUNT of a large block can go unused.
+ */
+class TlsfHeap
+{
+public:
+    /*!
+     * \brief Init
+     *
+     * Initialize the heap prior to use.  The buffer is split into as many
+     * root blocks (of up to TLSF_MAX_SIZE bytes of data each) as are
+     * needed to cover it.
+     *
+     * \param pvBuffer_ Pointer to the memory blob to manage as a heap
+     *                  from this object.
+     * \param uSize_ Size of the heap memory blob in bytes
+     */
+    void Init( void *pvBuffer_, K_ADDR uSize_ );
+
+    /*!
+     * \brief Allocate
+     *
+     * Allocate a block of dynamic memory from the heap.
+     *
+     * \param uSize_ Size of object to allocate (in bytes)
+     * \return pointer to a chunk of dynamic memory, or 0 on exhaustion.
+     */
+    void *Allocate( K_ADDR uSize_ );
+
+    /*!
+     * \brief Free
+     *
+     * Free the block of memory, returning it back to the heap for use.
+     * Null pointers, and blocks that aren't tagged as allocated, are
+     * ignored.
+     *
+     * \param pvBlock_ Pointer to the beginning of the object to be freed.
+     */
+    void Free( void *pvBlock_ );
+
+#if HEAP_USE_STATS
+    /*!
+     * \brief GetStats
+     *
+     * Take a snapshot of the heap's usage.  Each first-level size class
+     * is reported as a separate class.
+     *
+     * \param pclStats_ [out] Snapshot of the heap
+     */
+    void GetStats( HeapStats *pclStats_ );
+
+    /*!
+     * \brief GetClassStats
+     *
+     * Read the counters for a first-level size class.
+     *
+     * \param u8Class_ Index of the class, from 0 to TLSF_FL_COUNT - 1
+     * \param pclStats_ [out] Copy of the class' counters
+     * \return true on success, false if the class doesn't exist
+     */
+    bool GetClassStats( uint8_t u8Class_, HeapClassStats *pclStats_ );
+#endif
+
+private:
+    /*!
+     * \brief ListForSize
+     *
+     * Return the index of the list a free block of the given size is
+     * kept in.
+     *
+     * \param uSize_ Data size of the block
+     * \return Index of the list holding blocks of this size
+     */
+    static uint8_t ListForSize( K_ADDR uSize_ );
+
+    /*!
+     * \brief FindBlock_i
+     *
+     * Find, and remove from its list, the smallest free block that is
+     * guaranteed to satisfy a request of the given size.
+     *
+     * \param uSize_ Size of the request
+     * \return Pointer to the free block, or 0 if none is large enough
+     */
+    HeapBlock *FindBlock_i( K_ADDR uSize_ );
+
+    /*!
+     * \brief InsertBlock_i
+     *
+     * Add a free block to the list matching its size.
+     *
+     * \param pclBlock_ Block to add
+     */
+    void InsertBlock_i( HeapBlock *pclBlock_ );
+
+    /*!
+     * \brief RemoveBlock_i
+     *
+     * Remove a free block from the list it's currently in.
+     *
+     * \param pclBlock_ Block to remove
+     */
+    void RemoveBlock_i( HeapBlock *pclBlock_ );
+
+    uint16_t   m_u16FLMap;                      //!< Bitmap of size classes with free blocks
+    uint8_t    m_au8SLMap[TLSF_FL_COUNT];       //!< Per-class bitmap of lists with free blocks
+    ArenaList  m_aclBlockList[TLSF_FL_COUNT * TLSF_SL_COUNT];   //!< Free-block lists
+
+#if HEAP_USE_STATS
+    HeapClassStats m_aclStats[TLSF_FL_COUNT];   //!< Per-class usage counters
+    K_ADDR     m_uUsedBytes;                    //!< Data bytes currently allocated
+    K_ADDR     m_uPeakBytes;                    //!< Peak value of m_uUsedBytes
+#endif
+};
+
+#endif
+
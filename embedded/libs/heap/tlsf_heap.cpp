@@ -0,0 +1,373 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+
+    \file   tlsf_heap.cpp
+
+    \brief  Two-level segregated fit (TLSF) heap memory allocator.
+*/
+
+#include <stdint.h>
+#include "mark3.h"
+#include "bitscan.h"
+#include "tlsf_heap.h"
+
+//---------------------------------------------------------------------------
+/*!
+ * \brief tlsf_msb
+ *
+ * Return the index of the most-significant bit set in a (non-zero) value.
+ * Block sizes never exceed 16 bits, so this scans a 16-bit word using the
+ * kernel's shared bit-scan helper.
+ *
+ * \param u16Val_ Value to scan
+ * \return Index of the highest set bit
+ */
+static inline uint8_t tlsf_msb( uint16_t u16Val_ )
+{
+    return bitscan_msb( u16Val_ ) - 1;
+}
+
+//---------------------------------------------------------------------------
+//! Index of the least-significant bit set in a (non-zero) value
+static inline uint8_t tlsf_lsb( uint16_t u16Val_ )
+{
+    return bitscan_lsb( u16Val_ ) - 1;
+}
+
+//---------------------------------------------------------------------------
+/*!
+ * \brief tlsf_mapping
+ *
+ * Compute the first-level class and second-level list for a block size.
+ * Sizes below TLSF_SMALL_SIZE all share the first class, with one list per
+ * pointer-sized step.  Above that, the class is the power-of-two range the
+ * size falls in, and the list is taken from the bits just below its MSB.
+ *
+ * \param uSize_ Size to map
+ * \param pu8FL_ [out] First-level class, may be >= TLSF_FL_COUNT for sizes
+ *               larger than any block
+ * \param pu8SL_ [out] Second-level list
+ */
+static inline void tlsf_mapping( K_ADDR uSize_, uint8_t *pu8FL_, uint8_t *pu8SL_ )
+{
+    if (uSize_ < TLSF_SMALL_SIZE)
+    {
+        *pu8FL_ = 0;
+        *pu8SL_ = (uint8_t)(uSize_ >> TLSF_ALIGN_SHIFT);
+    }
+    else
+    {
+        uint8_t u8Msb = tlsf_msb( (uint16_t)uSize_ );
+        *pu8SL_ = (uint8_t)((uSize_ >> (u8Msb - TLSF_SL_SHIFT)) & (TLSF_SL_COUNT - 1));
+        *pu8FL_ = u8Msb - TLSF_FL_SHIFT + 1;
+    }
+}
+
+//---------------------------------------------------------------------------
+void TlsfHeap::Init( void *pvBuffer_, K_ADDR uSize_ )
+{
+    uint8_t i;
+
+    m_u16FLMap = 0;
+    for (i = 0; i < TLSF_FL_COUNT; i++)
+    {
+        m_au8SLMap[i] = 0;
+    }
+
+    // Each list is tagged with the smallest block size it holds
+    for (i = 0; i < (TLSF_FL_COUNT * TLSF_SL_COUNT); i++)
+    {
+        uint8_t u8FL = i >> TLSF_SL_SHIFT;
+        uint8_t u8SL = i & (TLSF_SL_COUNT - 1);
+        K_ADDR uMin;
+        if (!u8FL)
+        {
+            uMin = (K_ADDR)u8SL << TLSF_ALIGN_SHIFT;
+        }
+        else
+        {
+            uMin = ((K_ADDR)(TLSF_SL_COUNT + u8SL)) << (u8FL + TLSF_FL_SHIFT - 1 - TLSF_SL_SHIFT);
+        }
+        m_aclBlockList[i].Init( uMin );
+#if HEAP_USE_STATS
+        if (!u8SL)
+        {
+            m_aclStats[u8FL].Init( uMin );
+        }
+#endif
+    }
+#if HEAP_USE_STATS
+    m_uUsedBytes = 0;
+    m_uPeakBytes = 0;
+#endif
+
+    // Carve the buffer up into root blocks, each as large as the size
+    // classes allow, until the whole buffer is accounted for.
+    K_ADDR uPtr = ROUND_UP(pvBuffer_);
+    K_ADDR uEnd = ROUND_DOWN((K_ADDR)pvBuffer_ + uSize_);
+
+    while ((uPtr + sizeof(HeapBlock) + TLSF_MIN_SIZE) <= uEnd)
+    {
+        HeapBlock *pclBlock = new ((void*)uPtr) HeapBlock();
+        K_ADDR uData = uEnd - uPtr - sizeof(HeapBlock);
+        if (uData > TLSF_MAX_SIZE)
+        {
+            uData = TLSF_MAX_SIZE;
+        }
+        pclBlock->RootInit( uData );
+        InsertBlock_i( pclBlock );
+
+        uPtr += pclBlock->GetBlockSize();
+    }
+}
+
+//---------------------------------------------------------------------------
+void *TlsfHeap::Allocate( K_ADDR uSize_ )
+{
+    HeapBlock *pclRet;
+
+    if (uSize_ > TLSF_MAX_SIZE)
+    {
+#if HEAP_USE_STATS
+        CS_ENTER();
+        m_aclStats[TLSF_FL_COUNT - 1].CountFail();
+        CS_EXIT();
+#endif
+        return 0;
+    }
+    uSize_ = ROUND_UP(uSize_);
+    if (uSize_ < TLSF_MIN_SIZE)
+    {
+        uSize_ = TLSF_MIN_SIZE;
+    }
+
+    CS_ENTER();
+    pclRet = FindBlock_i( uSize_ );
+    if (pclRet)
+    {
+        // Return any slack large enough to hold another block back to the
+        // heap.
+        if (pclRet->GetDataSize() >= (uSize_ + sizeof(HeapBlock) + TLSF_MIN_SIZE))
+        {
+            InsertBlock_i( pclRet->Split( uSize_ ) );
+        }
+        pclRet->SetCookie( HEAP_COOKIE_ALLOCATED );
+#if HEAP_USE_STATS
+        m_aclStats[ ListForSize( pclRet->GetDataSize() ) >> TLSF_SL_SHIFT ].CountAlloc();
+        m_uUsedBytes += pclRet->GetDataSize();
+        if (m_uUsedBytes > m_uPeakBytes)
+        {
+            m_uPeakBytes = m_uUsedBytes;
+        }
+#endif
+    }
+#if HEAP_USE_STATS
+    else
+    {
+        m_aclStats[ ListForSize( uSize_ ) >> TLSF_SL_SHIFT ].CountFail();
+    }
+#endif
+    CS_EXIT();
+
+    if (!pclRet)
+    {
+        return 0;
+    }
+    return pclRet->GetDataPointer();
+}
+
+//---------------------------------------------------------------------------
+void TlsfHeap::Free( void *pvBlock_ )
+{
+    HeapBlock *pclBlock = (HeapBlock*)((K_ADDR)pvBlock_ - sizeof(HeapBlock));
+    HeapBlock *pclTemp;
+
+    if (!pvBlock_)
+    {
+        return;
+    }
+
+    CS_ENTER();
+
+    if (pclBlock->GetCookie() == HEAP_COOKIE_ALLOCATED)
+    {
+#if HEAP_USE_STATS
+        m_aclStats[ ListForSize( pclBlock->GetDataSize() ) >> TLSF_SL_SHIFT ].CountFree();
+        m_uUsedBytes -= pclBlock->GetDataSize();
+#endif
+
+        // Free blocks are merged immediately, so each neighbor is either
+        // allocated, or a single free block - one merge per side at most.
+        pclTemp = pclBlock->GetRightSibling();
+        if (pclTemp && (pclTemp->GetCookie() == HEAP_COOKIE_FREE))
+        {
+            RemoveBlock_i( pclTemp );
+            pclBlock->Coalesce();
+        }
+
+        pclTemp = pclBlock->GetLeftSibling();
+        if (pclTemp && (pclTemp->GetCookie() == HEAP_COOKIE_FREE))
+        {
+            RemoveBlock_i( pclTemp );
+            pclTemp->Coalesce();
+            pclBlock = pclTemp;
+        }
+
+        pclBlock->SetCookie( HEAP_COOKIE_FREE );
+        InsertBlock_i( pclBlock );
+    }
+
+    CS_EXIT();
+}
+
+#if HEAP_USE_STATS
+//---------------------------------------------------------------------------
+void TlsfHeap::GetStats( HeapStats *pclStats_ )
+{
+    uint8_t i;
+
+    pclStats_->m_uFreeBytes = 0;
+    pclStats_->m_uLargestFree = 0;
+    pclStats_->m_u32Allocs = 0;
+    pclStats_->m_u32Frees = 0;
+    pclStats_->m_u32Fails = 0;
+    pclStats_->m_u8Classes = TLSF_FL_COUNT;
+
+    CS_ENTER();
+    pclStats_->m_uUsedBytes = m_uUsedBytes;
+    pclStats_->m_uPeakBytes = m_uPeakBytes;
+    for (i = 0; i < TLSF_FL_COUNT; i++)
+    {
+        pclStats_->m_u32Allocs += m_aclStats[i].m_u32Allocs;
+        pclStats_->m_u32Frees += m_aclStats[i].m_u32Frees;
+        pclStats_->m_u32Fails += m_aclStats[i].m_u32Fails;
+    }
+    CS_EXIT();
+
+    // Walk the free lists one at a time, to keep each critical section
+    // short.
+    for (i = 0; i < (TLSF_FL_COUNT * TLSF_SL_COUNT); i++)
+    {
+        CS_ENTER();
+        pclStats_->m_uFreeBytes += m_aclBlockList[i].GetFreeBytes( &pclStats_->m_uLargestFree );
+        CS_EXIT();
+    }
+
+    pclStats_->m_u8Fragmentation = HeapStats::Fragmentation( pclStats_->m_uFreeBytes, pclStats_->m_uLargestFree );
+}
+
+//---------------------------------------------------------------------------
+bool TlsfHeap::GetClassStats( uint8_t u8Class_, HeapClassStats *pclStats_ )
+{
+    if (u8Class_ >= TLSF_FL_COUNT)
+    {
+        return false;
+    }
+
+    CS_ENTER();
+    *pclStats_ = m_aclStats[u8Class_];
+    CS_EXIT();
+    return true;
+}
+#endif
+
+//---------------------------------------------------------------------------
+uint8_t TlsfHeap::ListForSize( K_ADDR uSize_ )
+{
+    uint8_t u8FL;
+    uint8_t u8SL;
+
+    tlsf_mapping( uSize_, &u8FL, &u8SL );
+    return (u8FL << TLSF_SL_SHIFT) + u8SL;
+}
+
+//---------------------------------------------------------------------------
+HeapBlock *TlsfHeap::FindBlock_i( K_ADDR uSize_ )
+{
+    uint8_t u8FL;
+    uint8_t u8SL;
+    uint8_t u8Map;
+    uint8_t u8List;
+    HeapBlock *pclBlock;
+
+    // Round the request up to the next list boundary, so that any block in
+    // the list we start searching from is large enough.
+    if (uSize_ >= TLSF_SMALL_SIZE)
+    {
+        uSize_ += (((K_ADDR)1) << (tlsf_msb( (uint16_t)uSize_ ) - TLSF_SL_SHIFT)) - 1;
+    }
+    tlsf_mapping( uSize_, &u8FL, &u8SL );
+    if (u8FL >= TLSF_FL_COUNT)
+    {
+        return 0;
+    }
+
+    // Look for a non-empty list in the same class first, then fall back to
+    // the smallest non-empty list in the next non-empty class.
+    u8Map = m_au8SLMap[u8FL] & (uint8_t)(0xFF << u8SL);
+    if (!u8Map)
+    {
+        uint16_t u16Map = m_u16FLMap & (uint16_t)(0xFFFF << (u8FL + 1));
+        if (!u16Map)
+        {
+            return 0;
+        }
+        u8FL = tlsf_lsb( u16Map );
+        u8Map = m_au8SLMap[u8FL];
+    }
+    u8SL = tlsf_lsb( u8Map );
+
+    u8List = (u8FL << TLSF_SL_SHIFT) + u8SL;
+    pclBlock = m_aclBlockList[u8List].PopBlock();
+    if (!m_aclBlockList[u8List].GetBlockCount())
+    {
+        m_au8SLMap[u8FL] &= ~(1 << u8SL);
+        if (!m_au8SLMap[u8FL])
+        {
+            m_u16FLMap &= ~(1 << u8FL);
+        }
+    }
+    return pclBlock;
+}
+
+//---------------------------------------------------------------------------
+void TlsfHeap::InsertBlock_i( HeapBlock *pclBlock_ )
+{
+    uint8_t u8List = ListForSize( pclBlock_->GetDataSize() );
+    uint8_t u8FL = u8List >> TLSF_SL_SHIFT;
+
+    pclBlock_->SetArenaIndex( u8List );
+    m_aclBlockList[u8List].PushBlock( pclBlock_ );
+
+    m_au8SLMap[u8FL] |= (1 << (u8List & (TLSF_SL_COUNT - 1)));
+    m_u16FLMap |= (1 << u8FL);
+}
+
+//---------------------------------------------------------------------------
+void TlsfHeap::RemoveBlock_i( HeapBlock *pclBlock_ )
+{
+    uint8_t u8List = pclBlock_->GetArenaIndex();
+    uint8_t u8FL = u8List >> TLSF_SL_SHIFT;
+
+    m_aclBlockList[u8List].RemoveBlock( pclBlock_ );
+    if (!m_aclBlockList[u8List].GetBlockCount())
+    {
+        m_au8SLMap[u8FL] &= ~(1 << (u8List & (TLSF_SL_COUNT - 1)));
+        if (!m_au8SLMap[u8FL])
+        {
+            m_u16FLMap &= ~(1 << u8FL);
+        }
+    }
+}
@@ -30,7 +30,7 @@ extern "C" {
 //---------------------------------------------------------------------------
 void *AutoAlloc( uint16_t u16Size_ )
 {
-    return AutoAlloc::Allocate(u16Size);
+    return AutoAlloc::Allocate(u16Size_);
 }
 
 # if KERNEL_USE_SEMAPHORE
@@ -40,6 +40,12 @@ Semaphore_t Alloc_Semaphore(void)
     return (Semaphore_t)AutoAlloc::NewSemaphore();
 }
 
+//---------------------------------------------------------------------------
+void Free_Semaphore(Semaphore_t handle)
+{
+    AutoAlloc::DestroySemaphore((Semaphore*)handle);
+}
+
 # endif
 # if KERNEL_USE_MUTEX
 //---------------------------------------------------------------------------
@@ -48,6 +54,12 @@ Mutex_t Alloc_Mutex(void)
     return (Mutex_t)AutoAlloc::NewMutex();
 }
 
+//---------------------------------------------------------------------------
+void Free_Mutex(Mutex_t handle)
+{
+    AutoAlloc::DestroyMutex((Mutex*)handle);
+}
+
 # endif
 # if KERNEL_USE_EVENTFLAG
 //---------------------------------------------------------------------------
@@ -56,6 +68,12 @@ EventFlag_t Alloc_EventFlag(void)
     return (EventFlag_t)AutoAlloc::NewEventFlag();
 }
 
+//---------------------------------------------------------------------------
+void Free_EventFlag(EventFlag_t handle)
+{
+    AutoAlloc::DestroyEventFlag((EventFlag*)handle);
+}
+
 # endif
 # if KERNEL_USE_MESSAGE
 //---------------------------------------------------------------------------
@@ -64,12 +82,24 @@ Message_t Alloc_Message(void)
     return (Message_t)AutoAlloc::NewMessage();
 }
 
+//---------------------------------------------------------------------------
+void Free_Message(Message_t handle)
+{
+    AutoAlloc::DestroyMessage((Message*)handle);
+}
+
 //---------------------------------------------------------------------------
 MessageQueue_t Alloc_MessageQueue(void)
 {
     return (MessageQueue_t)AutoAlloc::NewMessageQueue();
 }
 
+//---------------------------------------------------------------------------
+void Free_MessageQueue(MessageQueue_t handle)
+{
+    AutoAlloc::DestroyMessageQueue((MessageQueue*)handle);
+}
+
 # endif
 # if KERNEL_USE_NOTIFY
 //---------------------------------------------------------------------------
@@ -78,6 +108,12 @@ Notify_t Alloc_Notify(void)
     return (Notify_t)AutoAlloc::NewNotify();
 }
 
+//---------------------------------------------------------------------------
+void Free_Notify(Notify_t handle)
+{
+    AutoAlloc::DestroyNotify((Notify*)handle);
+}
+
 # endif
 # if KERNEL_USE_MAILBOX
 //---------------------------------------------------------------------------
@@ -86,6 +122,12 @@ Mailbox_t Alloc_Mailbox(void)
     return (Mailbox_t)AutoAlloc::NewMailbox();
 }
 
+//---------------------------------------------------------------------------
+void Free_Mailbox(Mailbox_t handle)
+{
+    AutoAlloc::DestroyMailbox((Mailbox*)handle);
+}
+
 # endif
 //---------------------------------------------------------------------------
 Thread_t Alloc_Thread(void)
@@ -93,11 +135,23 @@ Thread_t Alloc_Thread(void)
     return (Thread_t)AutoAlloc::NewThread();
 }
 
+//---------------------------------------------------------------------------
+void Free_Thread(Thread_t handle)
+{
+    AutoAlloc::DestroyThread((Thread*)handle);
+}
+
 # if KERNEL_USE_TIMERS
 //---------------------------------------------------------------------------
 Timer_t Alloc_Timer(void)
 {
-    return (Thread_t)AutoAlloc::NewTimer();
+    return (Timer_t)AutoAlloc::NewTimer();
+}
+
+//---------------------------------------------------------------------------
+void Free_Timer(Timer_t handle)
+{
+    AutoAlloc::DestroyTimer((Timer*)handle);
 }
 
 # endif
@@ -345,6 +399,36 @@ ThreadState_t Thread_GetState(Thread_t handle)
     Thread *pclThread = (Thread*)handle;
     return pclThread->GetState();
 }
+
+#if KERNEL_USE_THREAD_NOTIFICATION
+//---------------------------------------------------------------------------
+void Thread_SendNotification(Thread_t handle, uint32_t u32Value_, NotifyAction_t eAction_)
+{
+    Thread *pclThread = (Thread*)handle;
+    pclThread->SendNotification(u32Value_, eAction_);
+}
+
+//---------------------------------------------------------------------------
+uint32_t Thread_GetNotification(Thread_t handle)
+{
+    Thread *pclThread = (Thread*)handle;
+    return pclThread->GetNotification();
+}
+
+//---------------------------------------------------------------------------
+uint32_t Thread_WaitNotification(uint32_t u32Mask_)
+{
+    return Thread::WaitNotification(u32Mask_);
+}
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+uint32_t Thread_TimedWaitNotification(uint32_t u32Mask_, uint32_t u32TimeMS_)
+{
+    return Thread::WaitNotification(u32Mask_, u32TimeMS_);
+}
+#endif
+#endif
 //---------------------------------------------------------------------------
 // Timer APIs
 //---------------------------------------------------------------------------
@@ -424,6 +508,15 @@ void Mutex_Init(Mutex_t handle)
     pclMutex->Init();
 }
 
+# if KERNEL_USE_MUTEX_CEILING
+//---------------------------------------------------------------------------
+void Mutex_InitCeiling(Mutex_t handle, PRIO_TYPE uXCeiling_)
+{
+    Mutex *pclMutex = new ((void*)handle) Mutex();
+    pclMutex->Init(uXCeiling_);
+}
+# endif
+
 //---------------------------------------------------------------------------
 void Mutex_Claim(Mutex_t handle)
 {
@@ -460,38 +553,38 @@ void EventFlag_Init(EventFlag_t handle)
 }
 
 //---------------------------------------------------------------------------
-uint16_t EventFlag_Wait(EventFlag_t handle, uint16_t u16Mask_, EventFlagOperation_t eMode_)
+FLAG_TYPE EventFlag_Wait(EventFlag_t handle, FLAG_TYPE uXMask_, EventFlagOperation_t eMode_)
 {
     EventFlag *pclFlag = (EventFlag*)handle;
-    return pclFlag->Wait(u16Mask_, eMode_);
+    return pclFlag->Wait(uXMask_, eMode_);
 }
 
 # if KERNEL_USE_TIMEOUTS
 //---------------------------------------------------------------------------
-uint16_t EventFlag_TimedWait(EventFlag_t handle, uint16_t u16Mask_, EventFlagOperation_t eMode_, uint32_t u32TimeMS_)
+FLAG_TYPE EventFlag_TimedWait(EventFlag_t handle, FLAG_TYPE uXMask_, EventFlagOperation_t eMode_, uint32_t u32TimeMS_)
 {
     EventFlag *pclFlag = (EventFlag*)handle;
-    return pclFlag->Wait(u16Mask_, eMode_, u32TimeMS_);
+    return pclFlag->Wait(uXMask_, eMode_, u32TimeMS_);
 }
 
 # endif
 
 //---------------------------------------------------------------------------
-void EventFlag_Set(EventFlag_t handle, uint16_t u16Mask_)
+void EventFlag_Set(EventFlag_t handle, FLAG_TYPE uXMask_)
 {
     EventFlag *pclFlag = (EventFlag*)handle;
-    pclFlag->Set(u16Mask_);
+    pclFlag->Set(uXMask_);
 }
 
 //---------------------------------------------------------------------------
-void EventFlag_Clear(EventFlag_t handle, uint16_t u16Mask_)
+void EventFlag_Clear(EventFlag_t handle, FLAG_TYPE uXMask_)
 {
     EventFlag *pclFlag = (EventFlag*)handle;
-    pclFlag->Clear(u16Mask_);
+    pclFlag->Clear(uXMask_);
 }
 
 //---------------------------------------------------------------------------
-uint16_t EventFlag_GetMask(EventFlag_t handle)
+FLAG_TYPE EventFlag_GetMask(EventFlag_t handle)
 {
     EventFlag *pclFlag = (EventFlag*)handle;
     return pclFlag->GetMask();
@@ -637,6 +730,22 @@ uint16_t Message_GetCode(Message_t handle)
     return pclMessage->GetCode();
 }
 
+#if KERNEL_USE_MESSAGE_PRIORITY
+//---------------------------------------------------------------------------
+void Message_SetPriority(Message_t handle, uint8_t u8Priority_)
+{
+    Message *pclMessage = (Message*)handle;
+    pclMessage->SetPriority(u8Priority_);
+}
+
+//---------------------------------------------------------------------------
+uint8_t Message_GetPriority(Message_t handle)
+{
+    Message *pclMessage = (Message*)handle;
+    return pclMessage->GetPriority();
+}
+#endif
+
 //---------------------------------------------------------------------------
 void GlobalMessagePool_Push(Message_t handle)
 {
@@ -756,6 +865,83 @@ bool Mailbox_TimedReceiveTail(Mailbox_t handle, void *pvData_, uint32_t u32Timeo
     Mailbox *pclMBox=  (Mailbox*)handle;
     return pclMBox->ReceiveTail(pvData_, u32TimeoutMS_);
 }
+# endif
+
+//---------------------------------------------------------------------------
+void *Mailbox_ClaimSendSlot(Mailbox_t handle, MailboxSlot_t *pstSlot_)
+{
+    Mailbox *pclMBox=  (Mailbox*)handle;
+    return pclMBox->ClaimSendSlot(pstSlot_);
+}
+
+//---------------------------------------------------------------------------
+void *Mailbox_ClaimSendSlotTail(Mailbox_t handle, MailboxSlot_t *pstSlot_)
+{
+    Mailbox *pclMBox=  (Mailbox*)handle;
+    return pclMBox->ClaimSendSlotTail(pstSlot_);
+}
+
+# if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+void *Mailbox_TimedClaimSendSlot(Mailbox_t handle, MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_)
+{
+    Mailbox *pclMBox=  (Mailbox*)handle;
+    return pclMBox->ClaimSendSlot(pstSlot_, u32TimeoutMS_);
+}
+
+//---------------------------------------------------------------------------
+void *Mailbox_TimedClaimSendSlotTail(Mailbox_t handle, MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_)
+{
+    Mailbox *pclMBox=  (Mailbox*)handle;
+    return pclMBox->ClaimSendSlotTail(pstSlot_, u32TimeoutMS_);
+}
+# endif
+
+//---------------------------------------------------------------------------
+void Mailbox_CommitSend(Mailbox_t handle, MailboxSlot_t *pstSlot_)
+{
+    Mailbox *pclMBox=  (Mailbox*)handle;
+    pclMBox->CommitSend(pstSlot_);
+}
+
+//---------------------------------------------------------------------------
+void *Mailbox_PeekReceive(Mailbox_t handle, MailboxSlot_t *pstSlot_)
+{
+    Mailbox *pclMBox=  (Mailbox*)handle;
+    return pclMBox->PeekReceive(pstSlot_);
+}
+
+//---------------------------------------------------------------------------
+void *Mailbox_PeekReceiveTail(Mailbox_t handle, MailboxSlot_t *pstSlot_)
+{
+    Mailbox *pclMBox=  (Mailbox*)handle;
+    return pclMBox->PeekReceiveTail(pstSlot_);
+}
+
+# if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+void *Mailbox_TimedPeekReceive(Mailbox_t handle, MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_)
+{
+    Mailbox *pclMBox=  (Mailbox*)handle;
+    return pclMBox->PeekReceive(pstSlot_, u32TimeoutMS_);
+}
+
+//---------------------------------------------------------------------------
+void *Mailbox_TimedPeekReceiveTail(Mailbox_t handle, MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_)
+{
+    Mailbox *pclMBox=  (Mailbox*)handle;
+    return pclMBox->PeekReceiveTail(pstSlot_, u32TimeoutMS_);
+}
+# endif
+
+//---------------------------------------------------------------------------
+void Mailbox_ReleaseReceive(Mailbox_t handle, MailboxSlot_t *pstSlot_)
+{
+    Mailbox *pclMBox=  (Mailbox*)handle;
+    pclMBox->ReleaseReceive(pstSlot_);
+}
+
+# if KERNEL_USE_TIMEOUTS
 
 //---------------------------------------------------------------------------
 uint16_t Mailbox_GetFreeSlots(Mailbox_t handle)
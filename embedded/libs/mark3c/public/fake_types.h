@@ -61,12 +61,18 @@ typedef struct
 {
     Fake_LinkedListNode m_ll_node;
     uint8_t m_u8Flags;
+#if KERNEL_TIMERS_WHEEL
+    uint8_t m_u8WheelSlot;
+#endif
     void*   m_pfCallback;
     uint32_t m_u32Interval;
     uint32_t m_u32TimeLeft;
     uint32_t m_u32TimerTolerance;
     void  *m_pclOwner;
     void  *m_pvData;
+#if KERNEL_USE_TIMER_THREAD
+    void  *m_pclDeferredNext;
+#endif
 } Fake_Timer;
 
 //---------------------------------------------------------------------------
@@ -91,21 +97,45 @@ typedef struct
     uint16_t m_u16Quantum;
 #endif
 #if KERNEL_USE_EVENTFLAG
-    uint16_t m_u16FlagMask;
+    FLAG_TYPE m_uXFlagMask;
     uint8_t  m_eFlagMode;
 #endif
+#if KERNEL_USE_THREAD_NOTIFICATION
+    uint32_t m_u32NotifyValue;
+    uint32_t m_u32NotifyMask;
+#endif
 #if KERNEL_USE_TIMEOUTS || KERNEL_USE_SLEEP
     Fake_Timer   m_clTimer;
 #endif
 #if KERNEL_USE_TIMEOUTS
     bool    m_bExpired;
 #endif
+#if KERNEL_USE_MUTEX
+    void *m_pclHeldMutex;
+    void *m_pclWaitMutex;
+#endif
+#if KERNEL_USE_RWLOCK
+    void *m_pstHeldRWLock;
+#endif
+#if KERNEL_USE_THREAD_STATS
+    uint32_t m_u32RunTime;
+    uint32_t m_u32Switches;
+    struct
+    {
+        uint32_t m_u32Window;
+        uint32_t m_u32Time;
+        uint16_t m_u16Load;
+    } m_clLoad;
+#endif
 } Fake_Thread;
 
 //---------------------------------------------------------------------------
 typedef struct
 {
     Fake_ThreadList thread_list;
+#if KERNEL_USE_WAITSET
+    void *m_pclWaitSet;
+#endif
     uint16_t m_u16Value;
     uint16_t m_u16MaxValue;
 } Fake_Semaphore;
@@ -114,10 +144,17 @@ typedef struct
 typedef struct
 {
     Fake_ThreadList thread_list;
+#if KERNEL_USE_WAITSET
+    void *m_pclWaitSet;
+#endif
     uint8_t m_u8Recurse;
     bool m_bReady;
-    uint8_t m_u8MaxPri;
+    PRIO_TYPE m_uXMaxPri;
+#if KERNEL_USE_MUTEX_CEILING
+    PRIO_TYPE m_uXCeiling;
+#endif
     void *m_pclOwner;
+    void *m_pclNextHeld;
 } Fake_Mutex;
 
 //---------------------------------------------------------------------------
@@ -126,13 +163,21 @@ typedef struct
     Fake_LinkedListNode list_node;
     void *m_pvData;
     uint16_t m_u16Code;
+#if KERNEL_USE_MESSAGE_PRIORITY
+    uint8_t m_u8Priority;
+#endif
 } Fake_Message;
 
 //---------------------------------------------------------------------------
 typedef struct
 {
     Fake_Semaphore  m_clSemaphore;
+#if KERNEL_USE_MESSAGE_PRIORITY
+    Fake_LinkedList m_aclLinkLists[KERNEL_MESSAGE_PRIORITY_CLASSES];
+    uint8_t m_u8ClassMap;
+#else
     Fake_LinkedList m_clLinkList;
+#endif
 } Fake_MessageQueue;
 
 //---------------------------------------------------------------------------
@@ -154,13 +199,22 @@ typedef struct
 typedef struct
 {
     Fake_ThreadList thread_list;
+#if KERNEL_USE_WAITSET
+    void *m_pclWaitSet;
+#endif
 } Fake_Notify;
 
 //---------------------------------------------------------------------------
 typedef struct
 {
     Fake_ThreadList thread_list;
-    uint16_t        m_u16EventFlag;
+#if KERNEL_USE_WAITSET
+    void *m_pclWaitSet;
+#endif
+    FLAG_TYPE       m_uXEventFlag;
+#if KERNEL_USE_EVENTFLAG_INDEX
+    Fake_ThreadList m_aclWaitLists[FLAG_BITS];
+#endif
 } Fake_EventFlag;
 
 #if defined(__cplusplus)
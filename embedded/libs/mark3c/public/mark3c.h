@@ -128,6 +128,12 @@ void *AutoAlloc( uint16_t u16Size_ );
  * \return Handle to an allocated object, or NULL if heap exhausted
  */
 Semaphore_t Alloc_Semaphore(void);
+/*!
+ * \brief Free_Semaphore
+ * \sa void AutoAlloc::DestroySemaphore(Semaphore *pclSemaphore_)
+ * \param handle Handle of an object previously returned by Alloc_Semaphore()
+ */
+void Free_Semaphore(Semaphore_t handle);
 # endif
 # if KERNEL_USE_MUTEX
 /*!
@@ -136,6 +142,12 @@ Semaphore_t Alloc_Semaphore(void);
  * \return Handle to an allocated object, or NULL if heap exhausted
  */
 Mutex_t Alloc_Mutex(void);
+/*!
+ * \brief Free_Mutex
+ * \sa void AutoAlloc::DestroyMutex(Mutex *pclMutex_)
+ * \param handle Handle of an object previously returned by Alloc_Mutex()
+ */
+void Free_Mutex(Mutex_t handle);
 # endif
 # if KERNEL_USE_EVENTFLAG
 /*!
@@ -144,6 +156,12 @@ Mutex_t Alloc_Mutex(void);
  * \return Handle to an allocated object, or NULL if heap exhausted
  */
 EventFlag_t Alloc_EventFlag(void);
+/*!
+ * \brief Free_EventFlag
+ * \sa void AutoAlloc::DestroyEventFlag(EventFlag *pclEventFlag_)
+ * \param handle Handle of an object previously returned by Alloc_EventFlag()
+ */
+void Free_EventFlag(EventFlag_t handle);
 # endif
 # if KERNEL_USE_MESSAGE
 /*!
@@ -152,12 +170,24 @@ EventFlag_t Alloc_EventFlag(void);
  * \return Handle to an allocated object, or NULL if heap exhausted
  */
 Message_t Alloc_Message(void);
+/*!
+ * \brief Free_Message
+ * \sa void AutoAlloc::DestroyMessage(Message *pclMessage_)
+ * \param handle Handle of an object previously returned by Alloc_Message()
+ */
+void Free_Message(Message_t handle);
 /*!
  * \brief Alloc_MessageQueue
  * \sa MesageQueue* AutoAlloc::NewMessageQueue()
  * \return Handle to an allocated object, or NULL if heap exhausted
  */
 MessageQueue_t Alloc_MessageQueue(void);
+/*!
+ * \brief Free_MessageQueue
+ * \sa void AutoAlloc::DestroyMessageQueue(MessageQueue *pclMessageQueue_)
+ * \param handle Handle of an object previously returned by Alloc_MessageQueue()
+ */
+void Free_MessageQueue(MessageQueue_t handle);
 # endif
 # if KERNEL_USE_NOTIFY
 /*!
@@ -166,6 +196,12 @@ MessageQueue_t Alloc_MessageQueue(void);
  * \return Handle to an allocated object, or NULL if heap exhausted
  */
 Notify_t Alloc_Notify(void);
+/*!
+ * \brief Free_Notify
+ * \sa void AutoAlloc::DestroyNotify(Notify *pclNotify_)
+ * \param handle Handle of an object previously returned by Alloc_Notify()
+ */
+void Free_Notify(Notify_t handle);
 # endif
 # if KERNEL_USE_MAILBOX
 /*!
@@ -174,6 +210,12 @@ Notify_t Alloc_Notify(void);
  * \return Handle to an allocated object, or NULL if heap exhausted
  */
 Mailbox_t Alloc_Mailbox(void);
+/*!
+ * \brief Free_Mailbox
+ * \sa void AutoAlloc::DestroyMailbox(Mailbox *pclMailbox_)
+ * \param handle Handle of an object previously returned by Alloc_Mailbox()
+ */
+void Free_Mailbox(Mailbox_t handle);
 # endif
 /*!
  * \brief Alloc_Thread
@@ -181,6 +223,12 @@ Mailbox_t Alloc_Mailbox(void);
  * \return Handle to an allocated object, or NULL if heap exhausted
  */
 Thread_t Alloc_Thread(void);
+/*!
+ * \brief Free_Thread
+ * \sa void AutoAlloc::DestroyThread(Thread *pclThread_)
+ * \param handle Handle of an object previously returned by Alloc_Thread()
+ */
+void Free_Thread(Thread_t handle);
 # if KERNEL_USE_TIMERS
 /*!
  * \brief Alloc_Timer
@@ -188,6 +236,12 @@ Thread_t Alloc_Thread(void);
  * \return Handle to an allocated object, or NULL if heap exhausted
  */
 Timer_t Alloc_Timer(void);
+/*!
+ * \brief Free_Timer
+ * \sa void AutoAlloc::DestroyTimer(Timer *pclTimer_)
+ * \param handle Handle of an object previously returned by Alloc_Timer()
+ */
+void Free_Timer(Timer_t handle);
 # endif
 #endif
 
@@ -457,6 +511,40 @@ uint16_t Thread_GetStackSlack(Thread_t handle);
  * \return The thread's current execution state
  */
 ThreadState_t Thread_GetState(Thread_t handle);
+#if KERNEL_USE_THREAD_NOTIFICATION
+/*!
+ * \brief Thread_SendNotification
+ * \sa void Thread::SendNotification(uint32_t u32Value_, NotifyAction_t eAction_)
+ * \param handle Handle of the thread
+ * \param u32Value_ Value to apply to the notification word
+ * \param eAction_ How the value is applied
+ */
+void Thread_SendNotification(Thread_t handle, uint32_t u32Value_, NotifyAction_t eAction_);
+/*!
+ * \brief Thread_GetNotification
+ * \sa uint32_t Thread::GetNotification()
+ * \param handle Handle of the thread
+ * \return The thread's notification word
+ */
+uint32_t Thread_GetNotification(Thread_t handle);
+/*!
+ * \brief Thread_WaitNotification
+ * \sa uint32_t Thread::WaitNotification(uint32_t u32Mask_)
+ * \param u32Mask_ Bits to wait on
+ * \return The bits from the mask that were set
+ */
+uint32_t Thread_WaitNotification(uint32_t u32Mask_);
+#if KERNEL_USE_TIMEOUTS
+/*!
+ * \brief Thread_TimedWaitNotification
+ * \sa uint32_t Thread::WaitNotification(uint32_t u32Mask_, uint32_t u32TimeMS_)
+ * \param u32Mask_ Bits to wait on
+ * \param u32TimeMS_ Time in ms to wait before giving up
+ * \return The bits from the mask that were set, or 0 on timeout
+ */
+uint32_t Thread_TimedWaitNotification(uint32_t u32Mask_, uint32_t u32TimeMS_);
+#endif
+#endif
 
 //---------------------------------------------------------------------------
 // Timer APIs
@@ -539,6 +627,15 @@ bool Semaphore_TimedPend(Semaphore_t handle, uint32_t u32WaitTimeMS_);
  * \param handle Handle of the mutex
  */
 void Mutex_Init(Mutex_t handle);
+# if KERNEL_USE_MUTEX_CEILING
+/*!
+ * \brief Mutex_InitCeiling
+ * \sa void Mutex::Init(PRIO_TYPE uXCeiling_)
+ * \param handle Handle of the mutex
+ * \param uXCeiling_ Ceiling priority of the mutex
+ */
+void Mutex_InitCeiling(Mutex_t handle, PRIO_TYPE uXCeiling_);
+# endif
 /*!
  * \brief Mutex_Claim
  * \sa void Mutex::Claim()
@@ -574,46 +671,46 @@ bool Mutex_TimedClaim(Mutex_t handle, uint32_t u32WaitTimeMS_);
 void EventFlag_Init(EventFlag_t handle);
 /*!
  * \brief EventFlag_Wait
- * \sa uint16_t EventFlag::Wait(uint16_t u16Mask_, EventFlagOperation_t eMode_)
+ * \sa FLAG_TYPE EventFlag::Wait(FLAG_TYPE uXMask_, EventFlagOperation_t eMode_)
  * \param handle Handle of the event flag object
- * \param u16Mask_ condition flags to wait for
+ * \param uXMask_ condition flags to wait for
  * \param eMode_   Specify conditions under which the thread will be unblocked
  * \return bitfield contained in the eventflag on unblock
  */
-uint16_t EventFlag_Wait(EventFlag_t handle, uint16_t u16Mask_, EventFlagOperation_t eMode_);
+FLAG_TYPE EventFlag_Wait(EventFlag_t handle, FLAG_TYPE uXMask_, EventFlagOperation_t eMode_);
 # if KERNEL_USE_TIMEOUTS
 /*!
  * \brief EventFlag_TimedWait
- * \sa uint16_t EventFlag::Wait(uint16_t u16Mask_, EventFlagOperation_t eMode_, uint32_t u32TimeMS_)
+ * \sa FLAG_TYPE EventFlag::Wait(FLAG_TYPE uXMask_, EventFlagOperation_t eMode_, uint32_t u32TimeMS_)
  * \param handle Handle of the event flag object
- * \param u16Mask_  condition flags to wait for
+ * \param uXMask_  condition flags to wait for
  * \param eMode_    Specify conditions under which the thread will be unblocked
  * \param u32TimeMS_ Time in ms to wait before aborting the operation
  * \return bitfield contained in the eventflag on unblock, or 0 on expiry.
  */
-uint16_t EventFlag_TimedWait(EventFlag_t handle, uint16_t u16Mask_, EventFlagOperation_t eMode_, uint32_t u32TimeMS_);
+FLAG_TYPE EventFlag_TimedWait(EventFlag_t handle, FLAG_TYPE uXMask_, EventFlagOperation_t eMode_, uint32_t u32TimeMS_);
 # endif
 /*!
  * \brief EventFlag_Set
- * \sa void EventFlag::Set(uint16_t u16Mask_)
+ * \sa void EventFlag::Set(FLAG_TYPE uXMask_)
  * \param handle Handle of the event flag object
- * \param u16Mask_ Bits to set in the eventflag's internal condition register
+ * \param uXMask_ Bits to set in the eventflag's internal condition register
  */
-void EventFlag_Set(EventFlag_t handle, uint16_t u16Mask_);
+void EventFlag_Set(EventFlag_t handle, FLAG_TYPE uXMask_);
 /*!
  * \brief EventFlag_Clear
- * \sa void EventFlag::Clear(uint16_t u16Mask_)
+ * \sa void EventFlag::Clear(FLAG_TYPE uXMask_)
  * \param handle Handle of the event flag object
- * \param u16Mask_ Bits to clear in the eventflag's internal condition regster
+ * \param uXMask_ Bits to clear in the eventflag's internal condition regster
  */
-void EventFlag_Clear(EventFlag_t handle, uint16_t u16Mask_);
+void EventFlag_Clear(EventFlag_t handle, FLAG_TYPE uXMask_);
 /*!
  * \brief EventFlag_GetMask
  * \sa void EventFlag::GetMask()
  * \param handle Handle of the event flag object
  * \return Return the current bitmask
  */
-uint16_t EventFlag_GetMask(EventFlag_t handle);
+FLAG_TYPE EventFlag_GetMask(EventFlag_t handle);
 #endif
 
 //---------------------------------------------------------------------------
@@ -774,6 +871,22 @@ void Message_SetCode(Message_t handle, uint16_t u16Code_);
  * \return user code set in the object
  */
 uint16_t Message_GetCode(Message_t handle);
+#if KERNEL_USE_MESSAGE_PRIORITY
+/*!
+ * \brief Message_SetPriority
+ * \sa void Message::SetPriority(uint8_t u8Priority_)
+ * \param handle Handle of the message object
+ * \param u8Priority_ Priority class to set in the object
+ */
+void Message_SetPriority(Message_t handle, uint8_t u8Priority_);
+/*!
+ * \brief Message_GetPriority
+ * \sa uint8_t Message::GetPriority()
+ * \param handle Handle of the message object
+ * \return priority class set in the object
+ */
+uint8_t Message_GetPriority(Message_t handle);
+#endif
 /*!
  * \brief GlobalMessagePool_Push
  * \sa void GlobalMessagePool::Push()
@@ -921,6 +1034,105 @@ bool Mailbox_TimedReceive(Mailbox_t handle, void *pvData_, uint32_t u32TimeoutMS
  * \return true - envelope was delivered, false - delivery timed out.
  */
 bool Mailbox_TimedReceiveTail(Mailbox_t handle, void *pvData_, uint32_t u32TimeoutMS_ );
+# endif
+
+/*!
+ * \brief Mailbox_ClaimSendSlot
+ * \sa void *Mailbox::ClaimSendSlot(MailboxSlot_t *pstSlot_)
+ * \param handle Handle of the mailbox object
+ * \param pstSlot_ [out] Handle to the envelope
+ * \return Pointer to the claimed envelope, or NULL if the mailbox is full.
+ */
+void *Mailbox_ClaimSendSlot(Mailbox_t handle, MailboxSlot_t *pstSlot_);
+
+/*!
+ * \brief Mailbox_ClaimSendSlotTail
+ * \sa void *Mailbox::ClaimSendSlotTail(MailboxSlot_t *pstSlot_)
+ * \param handle Handle of the mailbox object
+ * \param pstSlot_ [out] Handle to the envelope
+ * \return Pointer to the claimed envelope, or NULL if the mailbox is full.
+ */
+void *Mailbox_ClaimSendSlotTail(Mailbox_t handle, MailboxSlot_t *pstSlot_);
+
+# if KERNEL_USE_TIMEOUTS
+/*!
+ * \brief Mailbox_TimedClaimSendSlot
+ * \sa void *Mailbox::ClaimSendSlot(MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_)
+ * \param handle Handle of the mailbox object
+ * \param pstSlot_ [out] Handle to the envelope
+ * \param u32TimeoutMS_     Maximum time to wait for a free transmit slot
+ * \return Pointer to the claimed envelope, or NULL on timeout.
+ */
+void *Mailbox_TimedClaimSendSlot(Mailbox_t handle, MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_);
+
+/*!
+ * \brief Mailbox_TimedClaimSendSlotTail
+ * \sa void *Mailbox::ClaimSendSlotTail(MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_)
+ * \param handle Handle of the mailbox object
+ * \param pstSlot_ [out] Handle to the envelope
+ * \param u32TimeoutMS_     Maximum time to wait for a free transmit slot
+ * \return Pointer to the claimed envelope, or NULL on timeout.
+ */
+void *Mailbox_TimedClaimSendSlotTail(Mailbox_t handle, MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_);
+# endif
+
+/*!
+ * \brief Mailbox_CommitSend
+ * \sa void Mailbox::CommitSend(MailboxSlot_t *pstSlot_)
+ * \param handle Handle of the mailbox object
+ * \param pstSlot_ Handle returned by the claim
+ */
+void Mailbox_CommitSend(Mailbox_t handle, MailboxSlot_t *pstSlot_);
+
+/*!
+ * \brief Mailbox_PeekReceive
+ * \sa void *Mailbox::PeekReceive(MailboxSlot_t *pstSlot_)
+ * \param handle Handle of the mailbox object
+ * \param pstSlot_ [out] Handle to the envelope
+ * \return Pointer to the received envelope.
+ */
+void *Mailbox_PeekReceive(Mailbox_t handle, MailboxSlot_t *pstSlot_);
+
+/*!
+ * \brief Mailbox_PeekReceiveTail
+ * \sa void *Mailbox::PeekReceiveTail(MailboxSlot_t *pstSlot_)
+ * \param handle Handle of the mailbox object
+ * \param pstSlot_ [out] Handle to the envelope
+ * \return Pointer to the received envelope.
+ */
+void *Mailbox_PeekReceiveTail(Mailbox_t handle, MailboxSlot_t *pstSlot_);
+
+# if KERNEL_USE_TIMEOUTS
+/*!
+ * \brief Mailbox_TimedPeekReceive
+ * \sa void *Mailbox::PeekReceive(MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_)
+ * \param handle Handle of the mailbox object
+ * \param pstSlot_ [out] Handle to the envelope
+ * \param u32TimeoutMS_ Maximum time to wait for delivery.
+ * \return Pointer to the received envelope, or NULL on timeout.
+ */
+void *Mailbox_TimedPeekReceive(Mailbox_t handle, MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_);
+
+/*!
+ * \brief Mailbox_TimedPeekReceiveTail
+ * \sa void *Mailbox::PeekReceiveTail(MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_)
+ * \param handle Handle of the mailbox object
+ * \param pstSlot_ [out] Handle to the envelope
+ * \param u32TimeoutMS_ Maximum time to wait for delivery.
+ * \return Pointer to the received envelope, or NULL on timeout.
+ */
+void *Mailbox_TimedPeekReceiveTail(Mailbox_t handle, MailboxSlot_t *pstSlot_, uint32_t u32TimeoutMS_);
+# endif
+
+/*!
+ * \brief Mailbox_ReleaseReceive
+ * \sa void Mailbox::ReleaseReceive(MailboxSlot_t *pstSlot_)
+ * \param handle Handle of the mailbox object
+ * \param pstSlot_ Handle returned by the peek
+ */
+void Mailbox_ReleaseReceive(Mailbox_t handle, MailboxSlot_t *pstSlot_);
+
+# if KERNEL_USE_TIMEOUTS
 
 /*!
  * \brief Mailbox_GetFreeSlots
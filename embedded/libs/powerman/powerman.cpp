@@ -47,7 +47,7 @@ bool PowerMan::CountBallots(void)
         {
             bCanSleep = true;
         }
-        else if (m_au8WakeBallots[i])
+        if (m_au8WakeBallots[i])
         {
             bMustWake = true;
             break;
@@ -77,11 +77,11 @@ void PowerMan::ChangeVote(uint8_t u8Index_, power_vote_t eVote_)
     m_au8WakeBallots[u8Byte]  &= ~u8BitMask;
     if (eVote_ == POWER_VOTE_SLEEP)
     {
-        m_au8SleepBallots[u8Byte] &= ~u8BitMask;
+        m_au8SleepBallots[u8Byte] |= u8BitMask;
     }
     else if (eVote_ == POWER_VOTE_WAKE)
     {
-        m_au8WakeBallots[u8Byte] &= ~u8BitMask;
+        m_au8WakeBallots[u8Byte] |= u8BitMask;
     }
     CS_EXIT();
 }
@@ -95,3 +95,29 @@ uint8_t PowerMan::GetNextID()
     }
     return m_u8ID++;
 }
+
+#if KERNEL_USE_TICKLESS_IDLE
+//---------------------------------------------------------------------------
+PowerMan* PowerMan::m_pclIdleManager;
+uint8_t   PowerMan::m_u8AwakeStates;
+
+//---------------------------------------------------------------------------
+void PowerMan::SetIdleGovernor(uint8_t u8AwakeStates_)
+{
+    CS_ENTER();
+    m_pclIdleManager = this;
+    m_u8AwakeStates  = u8AwakeStates_;
+    CS_EXIT();
+    TicklessIdle::SetGovernor(PowerMan::IdleGovernor);
+}
+
+//---------------------------------------------------------------------------
+uint8_t PowerMan::IdleGovernor(void)
+{
+    if (m_pclIdleManager->CountBallots())
+    {
+        return 0xFF;
+    }
+    return m_u8AwakeStates;
+}
+#endif
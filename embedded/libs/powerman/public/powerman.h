@@ -77,6 +77,20 @@ public:
      */
     bool CountBallots(void);
 
+#if KERNEL_USE_TICKLESS_IDLE
+    /*!
+     * \brief SetIdleGovernor
+     *
+     * Use this manager's ballots to govern the depth of the kernel's
+     * tickless idle.  When the ballots allow sleep, all registered sleep
+     * states may be used; otherwise only the first u8AwakeStates_ states
+     * (i.e. the shallow ones that keep the peripherals alive) are eligible.
+     *
+     * \param u8AwakeStates_ Number of sleep states usable while awake
+     */
+    void SetIdleGovernor(uint8_t u8AwakeStates_);
+#endif
+
 protected:
 
     friend class PowerBallot;
@@ -104,6 +118,20 @@ protected:
     uint8_t GetNextID();
 
 private:
+#if KERNEL_USE_TICKLESS_IDLE
+    /*!
+     * \brief IdleGovernor
+     *
+     * Governor callback registered with the TicklessIdle module.
+     *
+     * \return Number of sleep states the idle thread may select from
+     */
+    static uint8_t IdleGovernor(void);
+
+    static PowerMan* m_pclIdleManager;  //!< Manager whose ballots govern the idle depth
+    static uint8_t   m_u8AwakeStates;   //!< Sleep states usable while a wake vote is held
+#endif
+
     uint8_t m_au8SleepBallots[MAX_BALLOTS / 8];   //!< Bitmap indicating "sleep" votes
     uint8_t m_au8WakeBallots[MAX_BALLOTS / 8];    //!< Bitmap indication "wake" votes
     uint8_t m_u8ID;                               //!< Auto-incrementing ID, used to identify ballots
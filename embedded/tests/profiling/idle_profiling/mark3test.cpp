@@ -0,0 +1,277 @@
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+#include "kernel.h"
+#include "thread.h"
+#include "driver.h"
+#include "drvUART.h"
+#include "timer.h"
+#include "ticklessidle.h"
+#include "threadport.h"
+#if KERNEL_USE_TICKLESS_IDLE
+#include "powerman.h"
+#endif
+#include "../prof_platform.h"
+
+//---------------------------------------------------------------------------
+/*
+    Idle wakeup profiling - measures how often the CPU is woken from sleep
+    while running a light periodic workload, to compare the kernel's
+    tickless idle mode against a plain "sleep until the next interrupt" idle
+    thread.
+
+    The workload is a set of threads that wake up every 20, 50, and 250ms
+    to do a trivial amount of work.  Every MEASURE_WINDOW_MS, the main
+    thread prints a line over the UART:
+
+        WK <wakeups per second>/s HT <ticks spent with the kernel timer halted>
+
+    With KERNEL_USE_TICKLESS_IDLE disabled, the idle thread sleeps in the
+    AVR's idle mode and counts each time it's woken.  With it enabled, the
+    idle thread hands over to TicklessIdle, which is given two states:
+
+        0 - AVR idle mode.  The kernel timer keeps running, and wakes the
+            CPU when the next timer expires.
+        1 - AVR power-down mode, woken by the watchdog interrupt.  The
+            longest watchdog period (16ms * 2^k) that fits before the next
+            timer expiry is used, and reported to the kernel as the time the
+            kernel timer was halted.  Note that the watchdog oscillator is
+            only accurate to ~10%, so timers may drift while in this state.
+
+    A PowerMan ballot votes to stay awake while the UART is in use, limiting
+    the idle mode to state 0 at those times.
+
+    Note that the UART transmit interrupts raised while printing results are
+    counted as wakeups too.
+
+    On the POSIX host port, both states wait for the kernel timer's signal
+    (the host has no power-down mode), and the app exits after printing the
+    first line.
+*/
+
+//---------------------------------------------------------------------------
+static uint8_t aucTxBuf[32];
+
+//---------------------------------------------------------------------------
+#define MAIN_STACK_SIZE            (384)
+#define IDLE_STACK_SIZE            (384)
+#define WORKER_STACK_SIZE          (192)
+
+#define NUM_WORKERS                (3)
+#define MEASURE_WINDOW_MS          (5000)
+
+//---------------------------------------------------------------------------
+static const uint16_t au16WorkerPeriod[NUM_WORKERS] = { 20, 50, 250 };
+static volatile uint32_t au32WorkerCount[NUM_WORKERS];
+
+//---------------------------------------------------------------------------
+static Thread clMainThread;
+static Thread clIdleThread;
+static Thread aclWorker[NUM_WORKERS];
+
+//---------------------------------------------------------------------------
+static K_WORD awMainStack[MAIN_STACK_SIZE / sizeof(K_WORD)];
+static K_WORD awIdleStack[IDLE_STACK_SIZE / sizeof(K_WORD)];
+static K_WORD awWorkerStack[NUM_WORKERS][WORKER_STACK_SIZE / sizeof(K_WORD)];
+
+//---------------------------------------------------------------------------
+static void AppMain( void *unused );
+static void IdleMain( void *unused );
+static void WorkerMain( void *param );
+
+#if KERNEL_USE_TICKLESS_IDLE
+//---------------------------------------------------------------------------
+static PowerMan clPowerMan;
+static PowerBallot clUARTBallot;
+
+static const SleepState_t astSleepStates[2] =
+{
+    { ProfilePlatform::SleepIdle,   0 },
+    { ProfilePlatform::SleepDeep,   MSECONDS_TO_TICKS(1) }
+};
+#else
+//---------------------------------------------------------------------------
+static volatile uint32_t u32IdleWakeups;
+#endif
+
+//---------------------------------------------------------------------------
+int main(void)
+{
+    uint8_t i;
+
+    Kernel::Init();
+
+    clMainThread.Init(  awMainStack,
+                        MAIN_STACK_SIZE,
+                        2,
+                        (ThreadEntry_t)AppMain,
+                        NULL );
+
+    clIdleThread.Init(  awIdleStack,
+                        IDLE_STACK_SIZE,
+                        0,
+                        (ThreadEntry_t)IdleMain,
+                        NULL );
+
+    for (i = 0; i < NUM_WORKERS; i++)
+    {
+        aclWorker[i].Init(  awWorkerStack[i],
+                            WORKER_STACK_SIZE,
+                            1,
+                            (ThreadEntry_t)WorkerMain,
+                            (void*)(K_ADDR)i );
+        aclWorker[i].Start();
+    }
+
+    clMainThread.Start();
+    clIdleThread.Start();
+
+    ProfilePlatform::Init();
+
+#if KERNEL_USE_TICKLESS_IDLE
+    clUARTBallot.Register( &clPowerMan );
+    clPowerMan.SetIdleGovernor(1);
+    TicklessIdle::SetStates( astSleepStates, 2 );
+#endif
+
+    Kernel::Start();
+}
+
+//---------------------------------------------------------------------------
+static void IdleMain( void *unused )
+{
+    while(1)
+    {
+#if KERNEL_USE_TICKLESS_IDLE
+        TicklessIdle::Enter();
+#else
+        ProfilePlatform::Idle();
+        u32IdleWakeups++;
+#endif
+    }
+}
+
+//---------------------------------------------------------------------------
+static void WorkerMain( void *param )
+{
+    uint8_t u8Idx = (uint8_t)(K_ADDR)param;
+
+    while(1)
+    {
+        Thread::Sleep( au16WorkerPeriod[u8Idx] );
+        au32WorkerCount[u8Idx]++;
+    }
+}
+
+//---------------------------------------------------------------------------
+static void PrintWait( Driver *pclDriver_, uint16_t u16Size_, const char *data )
+{
+    uint16_t u16Written = 0;
+
+    while (u16Written < u16Size_)
+    {
+        u16Written += pclDriver_->Write((u16Size_ - u16Written), (uint8_t*)(&data[u16Written]));
+        if (u16Written != u16Size_)
+        {
+            Thread::Sleep(5);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+static void PrintString( const char *szStr_ )
+{
+    Driver *pclUART = DriverList::FindByPath("/dev/tty");
+    uint16_t u16Len = 0;
+
+    while (szStr_[u16Len])
+    {
+        u16Len++;
+    }
+    PrintWait( pclUART, u16Len, szStr_ );
+}
+
+//---------------------------------------------------------------------------
+static void PrintNumber( uint32_t u32Val_ )
+{
+    char szBuf[11];
+    uint8_t u8Idx = sizeof(szBuf) - 1;
+
+    szBuf[u8Idx] = 0;
+    do
+    {
+        szBuf[--u8Idx] = '0' + (u32Val_ % 10);
+        u32Val_ /= 10;
+    } while (u32Val_);
+
+    PrintString( &szBuf[u8Idx] );
+}
+
+//---------------------------------------------------------------------------
+static uint32_t GetWakeups()
+{
+#if KERNEL_USE_TICKLESS_IDLE
+    return TicklessIdle::GetWakeups();
+#else
+    uint32_t u32Ret;
+    CS_ENTER();
+    u32Ret = u32IdleWakeups;
+    CS_EXIT();
+    return u32Ret;
+#endif
+}
+
+//---------------------------------------------------------------------------
+static uint32_t GetHaltedTicks()
+{
+#if KERNEL_USE_TICKLESS_IDLE
+    return TicklessIdle::GetHaltedTicks();
+#else
+    return 0;
+#endif
+}
+
+//---------------------------------------------------------------------------
+static void AppMain( void *unused )
+{
+    Driver *pclUART = DriverList::FindByPath("/dev/tty");
+    uint32_t u32Wakeups;
+    uint32_t u32Halted;
+
+    pclUART->Control(CMD_SET_BUFFERS, NULL, 0, aucTxBuf, 32);
+    {
+        uint32_t u32BaudRate = 57600;
+        pclUART->Control(CMD_SET_BAUDRATE, &u32BaudRate, 0, 0, 0 );
+        pclUART->Control(CMD_SET_RX_DISABLE, 0, 0, 0, 0);
+    }
+
+    pclUART->Open();
+
+    while(1)
+    {
+        u32Wakeups = GetWakeups();
+        u32Halted = GetHaltedTicks();
+
+#if KERNEL_USE_TICKLESS_IDLE
+        clUARTBallot.Cast(POWER_VOTE_SLEEP);
+#endif
+        Thread::Sleep(MEASURE_WINDOW_MS);
+#if KERNEL_USE_TICKLESS_IDLE
+        clUARTBallot.Cast(POWER_VOTE_WAKE);
+#endif
+
+        u32Wakeups = GetWakeups() - u32Wakeups;
+        u32Halted = GetHaltedTicks() - u32Halted;
+
+        PrintString( "WK " );
+        PrintNumber( (u32Wakeups * 1000) / MEASURE_WINDOW_MS );
+        PrintString( "/s HT " );
+        PrintNumber( u32Halted );
+        PrintString( "\n" );
+
+        ProfilePlatform::PassDone();
+
+        // Let the last of the output drain before voting to sleep again
+        Thread::Sleep(10);
+    }
+}
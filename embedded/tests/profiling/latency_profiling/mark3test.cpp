@@ -0,0 +1,976 @@
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+#include "kernel.h"
+#include "thread.h"
+#include "driver.h"
+#include "drvUART.h"
+#include "profile.h"
+#include "kernelprofile.h"
+#include "ksemaphore.h"
+#include "mutex.h"
+#include "rwlock.h"
+#include "eventflag.h"
+#include "message.h"
+#include "mailbox.h"
+#include "timer.h"
+#include "timerscheduler.h"
+#include "threadport.h"
+#include "arena.h"
+#include "fixed_heap.h"
+#include "tlsf_heap.h"
+#include "../prof_platform.h"
+
+//---------------------------------------------------------------------------
+/*
+    Latency benchmark suite - measures the distribution of latencies for the
+    kernel's scheduling and IPC paths, rather than just the average.
+
+    Every benchmark collects BENCH_ITERATIONS samples, each converted to CPU
+    cycles with the cost of the profiling timer itself removed.  Results are
+    printed over the UART as one line per benchmark:
+
+        BM <name> n=<samples> min=<cycles> max=<cycles> mean=<cycles> hist=<h0>,...,<h15>
+
+    hist is a histogram with BENCH_HIST_BUCKETS log2-spaced buckets:  bucket
+    0 counts samples below 16 cycles, bucket k counts samples in the range
+    [2^(k+3), 2^(k+4)) cycles, and the last bucket also counts everything
+    above its range.  Each pass through the suite is framed by "START" and
+    "END" lines, so the output can be captured and diffed between releases
+    and ports.
+
+    The suite also runs on the POSIX host port, where a cycle is one count of
+    the port's nominal SYSTEM_FREQ (i.e. 10ns at 100MHz), measured from the
+    host's monotonic clock.  There, the app exits after a single pass:
+
+        stage/app/posix/linux/gcc/latency_profile.elf > latency.txt
+
+    Host results include the cost of the host's signal delivery and context
+    switches, and jitter with the host's load - compare them against other
+    host runs only.
+
+    Benchmarks:
+        ctx_switch      - Thread::Start() of a stopped higher-priority thread
+                          until it resumes - the shortest path through the
+                          scheduler and context switch.
+        sem_pingpong    - Semaphore round trip to a higher-priority thread.
+        mutex_handoff   - Release of a mutex to a higher-priority waiter,
+                          including undoing the owner's priority inheritance.
+        flag_broadcast  - EventFlag::Set() until the last of several waiting
+                          threads has been woken.
+        flag_set_<n>    - EventFlag::Set() of a flag nobody is waiting on,
+                          with <n> threads blocked on other flags - the cost
+                          of the waiter scan (see KERNEL_USE_EVENTFLAG_INDEX).
+        msgq_roundtrip  - Message round trip through a pair of queues.
+        mbox_roundtrip  - Mailbox round trip through a pair of mailboxes.
+        timer_isr_<n>   - TimerScheduler::Process() with <n> active timers.
+        thread_start    - Thread::Init() + Start() until the thread runs.
+        thread_exit     - Thread::Exit() until the creating thread resumes.
+
+    The lock throughput benchmarks are the exception - they report the number
+    of lock/unlock operations completed by NUM_WORKERS threads over a fixed
+    window, instead of a latency distribution:
+
+        BM <name> ops=<count> ms=<window>
+
+        lock_mutex      - Read-heavy load (1 write in LOCK_BENCH_WRITE_RATIO
+                          operations) serialized through a Mutex.
+        lock_rwlock     - The same load through an RWLock, where readers can
+                          hold the lock concurrently.
+
+    The heap benchmarks run the same pseudo-random script of HEAP_BENCH_STEPS
+    allocations and frees (of 1 to HEAP_BENCH_MAX_ALLOC bytes) through each
+    of the allocators in libs/heap, each managing HEAP_BENCH_SIZE bytes.
+    Each allocator reports the latency of its allocations and its frees, as
+    above (<name>_alloc, <name>_free), followed by a count of the
+    allocations it couldn't satisfy:
+
+        BM <name>_soak ops=<count> fails=<count>
+
+        heap_arena      - Arena, with power-of-two size lists.
+        heap_fixed      - FixedHeap, with three block sizes.
+        heap_tlsf       - TlsfHeap.
+*/
+
+//---------------------------------------------------------------------------
+static uint8_t aucTxBuf[32];
+
+//---------------------------------------------------------------------------
+#define MAIN_STACK_SIZE            (384)
+#define IDLE_STACK_SIZE            (384)
+#define WORKER_STACK_SIZE          (192)
+
+#define NUM_WORKERS                (3)
+#define FLAG_BENCH_WAITERS         (8)
+#define BENCH_ITERATIONS           (100)
+#define BENCH_HIST_BUCKETS         (16)
+#define BENCH_HIST_MIN_SHIFT       (4)
+#define LOCK_BENCH_WINDOW_MS       (100)
+#define LOCK_BENCH_WRITE_RATIO     (8)
+#define HEAP_BENCH_SIZE            (256 * sizeof(void*))
+#define HEAP_BENCH_SLOTS           (16)
+#define HEAP_BENCH_STEPS           (400)
+#define HEAP_BENCH_MAX_ALLOC       (48)
+
+//---------------------------------------------------------------------------
+/*
+    Latency statistics for a single benchmark.
+*/
+class BenchStats
+{
+public:
+    void Init()
+    {
+        uint8_t i;
+        m_u32Min = 0xFFFFFFFF;
+        m_u32Max = 0;
+        m_u32Sum = 0;
+        m_u16Count = 0;
+        for (i = 0; i < BENCH_HIST_BUCKETS; i++)
+        {
+            m_au16Hist[i] = 0;
+        }
+    }
+
+    void Add( uint32_t u32Cycles_ )
+    {
+        uint8_t u8Bucket = 0;
+        uint32_t u32Scaled = u32Cycles_ >> BENCH_HIST_MIN_SHIFT;
+
+        while (u32Scaled && (u8Bucket < (BENCH_HIST_BUCKETS - 1)))
+        {
+            u32Scaled >>= 1;
+            u8Bucket++;
+        }
+        m_au16Hist[u8Bucket]++;
+
+        if (u32Cycles_ < m_u32Min)
+        {
+            m_u32Min = u32Cycles_;
+        }
+        if (u32Cycles_ > m_u32Max)
+        {
+            m_u32Max = u32Cycles_;
+        }
+        m_u32Sum += u32Cycles_;
+        m_u16Count++;
+    }
+
+    uint32_t GetMin()   { return (m_u16Count ? m_u32Min : 0); }
+    uint32_t GetMax()   { return m_u32Max; }
+    uint32_t GetMean()  { return (m_u16Count ? (m_u32Sum / m_u16Count) : 0); }
+    uint16_t GetCount() { return m_u16Count; }
+    uint16_t GetBucket( uint8_t u8Bucket_ ) { return m_au16Hist[u8Bucket_]; }
+
+private:
+    uint32_t m_u32Min;
+    uint32_t m_u32Max;
+    uint32_t m_u32Sum;
+    uint16_t m_u16Count;
+    uint16_t m_au16Hist[BENCH_HIST_BUCKETS];
+};
+
+//---------------------------------------------------------------------------
+static ProfileTimer clBenchTimer;
+static BenchStats clStats;
+static BenchStats clStats2;
+static uint32_t u32OverheadTicks;
+
+//---------------------------------------------------------------------------
+static Semaphore clSemA;
+static Semaphore clSemB;
+static Mutex clMutex;
+static EventFlag clFlag;
+static MessageQueue clMsgQA;
+static MessageQueue clMsgQB;
+static Mailbox clMboxA;
+static Mailbox clMboxB;
+static uint16_t au16MboxBufA[4];
+static uint16_t au16MboxBufB[4];
+static volatile uint8_t u8Woken;
+#if KERNEL_USE_RWLOCK
+static RWLock clRWLock;
+#endif
+static volatile bool bLockBenchStop;
+static volatile uint16_t u16LockOps;
+
+typedef enum
+{
+    HEAP_BENCH_ARENA,
+    HEAP_BENCH_FIXED,
+    HEAP_BENCH_TLSF
+} HeapBench_t;
+
+static K_WORD awHeapBuf[HEAP_BENCH_SIZE / sizeof(K_WORD)];
+static void *apvHeapSlot[HEAP_BENCH_SLOTS];
+static uint16_t u16HeapSeed;
+static Arena clBenchArena;
+static K_ADDR auBenchArenaSizes[] = { 4, 8, 16, 32, 64, 128 };
+static FixedHeap clBenchFixed;
+static HeapConfig aclBenchFixedConfig[4];
+static TlsfHeap clBenchTlsf;
+
+#define TIMER_BENCH_MAX            (32)
+static Timer aclBenchTimers[TIMER_BENCH_MAX];
+
+//---------------------------------------------------------------------------
+static Thread clMainThread;
+static Thread clIdleThread;
+static Thread aclWorker[NUM_WORKERS];
+static Thread aclFlagWaiter[FLAG_BENCH_WAITERS];
+
+//---------------------------------------------------------------------------
+static K_WORD awMainStack[MAIN_STACK_SIZE / sizeof(K_WORD)];
+static K_WORD awIdleStack[IDLE_STACK_SIZE / sizeof(K_WORD)];
+static K_WORD awWorkerStack[NUM_WORKERS][WORKER_STACK_SIZE / sizeof(K_WORD)];
+static K_WORD awFlagWaiterStack[FLAG_BENCH_WAITERS][WORKER_STACK_SIZE / sizeof(K_WORD)];
+
+//---------------------------------------------------------------------------
+static void AppMain( void *unused );
+static void IdleMain( void *unused );
+
+//---------------------------------------------------------------------------
+int main(void)
+{
+    Kernel::Init();
+
+    clMainThread.Init(  awMainStack,
+                        MAIN_STACK_SIZE,
+                        1,
+                        (ThreadEntry_t)AppMain,
+                        NULL );
+
+    clIdleThread.Init(  awIdleStack,
+                        IDLE_STACK_SIZE,
+                        0,
+                        (ThreadEntry_t)IdleMain,
+                        NULL );
+
+    clMainThread.Start();
+    clIdleThread.Start();
+
+    ProfilePlatform::Init();
+
+    Kernel::Start();
+}
+
+//---------------------------------------------------------------------------
+static void IdleMain( void *unused )
+{
+    while(1)
+    {
+        ProfilePlatform::Idle();
+    }
+}
+
+//---------------------------------------------------------------------------
+static void PrintWait( Driver *pclDriver_, uint16_t u16Size_, const char *data )
+{
+    uint16_t u16Written = 0;
+
+    while (u16Written < u16Size_)
+    {
+        u16Written += pclDriver_->Write((u16Size_ - u16Written), (uint8_t*)(&data[u16Written]));
+        if (u16Written != u16Size_)
+        {
+            Thread::Sleep(5);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+static void PrintString( const char *szStr_ )
+{
+    Driver *pclUART = DriverList::FindByPath("/dev/tty");
+    uint16_t u16Len = 0;
+
+    while (szStr_[u16Len])
+    {
+        u16Len++;
+    }
+    PrintWait( pclUART, u16Len, szStr_ );
+}
+
+//---------------------------------------------------------------------------
+static void PrintNumber( uint32_t u32Val_ )
+{
+    char szBuf[11];
+    uint8_t u8Idx = sizeof(szBuf) - 1;
+
+    szBuf[u8Idx] = 0;
+    do
+    {
+        szBuf[--u8Idx] = '0' + (u32Val_ % 10);
+        u32Val_ /= 10;
+    } while (u32Val_);
+
+    PrintString( &szBuf[u8Idx] );
+}
+
+//---------------------------------------------------------------------------
+static void BenchPrint( BenchStats *pclStats_, const char *szName_ )
+{
+    uint8_t i;
+
+    PrintString( "BM " );
+    PrintString( szName_ );
+    PrintString( " n=" );
+    PrintNumber( pclStats_->GetCount() );
+    PrintString( " min=" );
+    PrintNumber( pclStats_->GetMin() );
+    PrintString( " max=" );
+    PrintNumber( pclStats_->GetMax() );
+    PrintString( " mean=" );
+    PrintNumber( pclStats_->GetMean() );
+    PrintString( " hist=" );
+    for (i = 0; i < BENCH_HIST_BUCKETS; i++)
+    {
+        if (i)
+        {
+            PrintString( "," );
+        }
+        PrintNumber( pclStats_->GetBucket(i) );
+    }
+    PrintString( "\n" );
+}
+
+//---------------------------------------------------------------------------
+/*
+    Add the last interval measured by clBenchTimer to a set of statistics,
+    net of the profiling overhead, in CPU cycles.
+*/
+static void BenchRecord( BenchStats *pclStats_ )
+{
+    uint32_t u32Ticks = clBenchTimer.GetCurrent();
+
+    if (u32Ticks > u32OverheadTicks)
+    {
+        u32Ticks -= u32OverheadTicks;
+    }
+    else
+    {
+        u32Ticks = 0;
+    }
+    pclStats_->Add( u32Ticks * CLOCK_DIVIDE );
+}
+
+//---------------------------------------------------------------------------
+static void BenchStartWorker( uint8_t u8Worker_, PRIO_TYPE uXPriority_, void (*pfEntry_)(void*), void *pvArg_ )
+{
+    aclWorker[u8Worker_].Init( awWorkerStack[u8Worker_],
+                               WORKER_STACK_SIZE,
+                               uXPriority_,
+                               (ThreadEntry_t)pfEntry_,
+                               pvArg_ );
+    aclWorker[u8Worker_].Start();
+}
+
+//---------------------------------------------------------------------------
+static void Bench_Overhead()
+{
+    uint16_t i;
+
+    // Use the cheapest observed start/stop pair, so that benchmark minimums
+    // never go negative.
+    u32OverheadTicks = 0xFFFFFFFF;
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        clBenchTimer.Start();
+        clBenchTimer.Stop();
+        if (clBenchTimer.GetCurrent() < u32OverheadTicks)
+        {
+            u32OverheadTicks = clBenchTimer.GetCurrent();
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+static void CtxSwitch_Worker( void *unused_ )
+{
+    uint16_t i;
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        // Stopping ourselves switches back to the main thread
+        Scheduler::GetCurrentThread()->Stop();
+        clBenchTimer.Stop();
+        BenchRecord( &clStats );
+    }
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//---------------------------------------------------------------------------
+static void Bench_CtxSwitch()
+{
+    uint16_t i;
+
+    clStats.Init();
+    BenchStartWorker( 0, 2, CtxSwitch_Worker, NULL );
+
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        clBenchTimer.Start();
+        aclWorker[0].Start();
+    }
+
+    BenchPrint( &clStats, "ctx_switch" );
+}
+
+//---------------------------------------------------------------------------
+static void SemPingPong_Worker( void *unused_ )
+{
+    uint16_t i;
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        clSemA.Pend();
+        clSemB.Post();
+    }
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//---------------------------------------------------------------------------
+static void Bench_SemPingPong()
+{
+    uint16_t i;
+
+    clStats.Init();
+    clSemA.Init(0, 1);
+    clSemB.Init(0, 1);
+    BenchStartWorker( 0, 2, SemPingPong_Worker, NULL );
+
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        clBenchTimer.Start();
+        clSemA.Post();
+        clSemB.Pend();
+        clBenchTimer.Stop();
+        BenchRecord( &clStats );
+    }
+
+    BenchPrint( &clStats, "sem_pingpong" );
+}
+
+//---------------------------------------------------------------------------
+static void MutexHandoff_Worker( void *unused_ )
+{
+    uint16_t i;
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        clSemA.Pend();
+
+        // Blocks - the main thread holds the mutex, and inherits our priority
+        clMutex.Claim();
+        clBenchTimer.Stop();
+        BenchRecord( &clStats );
+        clMutex.Release();
+    }
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//---------------------------------------------------------------------------
+static void Bench_MutexHandoff()
+{
+    uint16_t i;
+
+    clStats.Init();
+    clSemA.Init(0, 1);
+    clMutex.Init();
+    BenchStartWorker( 0, 3, MutexHandoff_Worker, NULL );
+
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        clMutex.Claim();
+        clSemA.Post();
+
+        // Worker is now blocked on the mutex, and we're running at its priority
+        clBenchTimer.Start();
+        clMutex.Release();
+    }
+
+    BenchPrint( &clStats, "mutex_handoff" );
+}
+
+//---------------------------------------------------------------------------
+static void FlagBroadcast_Worker( void *unused_ )
+{
+    uint16_t i;
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        clFlag.Wait(0x0001, EVENT_FLAG_ANY);
+        if (++u8Woken == NUM_WORKERS)
+        {
+            clBenchTimer.Stop();
+            BenchRecord( &clStats );
+        }
+
+        // Park until the main thread re-arms the flag
+        clSemA.Pend();
+    }
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//---------------------------------------------------------------------------
+static void Bench_FlagBroadcast()
+{
+    uint16_t i;
+    uint8_t j;
+
+    clStats.Init();
+    clSemA.Init(0, NUM_WORKERS);
+    clFlag.Init();
+    for (j = 0; j < NUM_WORKERS; j++)
+    {
+        BenchStartWorker( j, 2, FlagBroadcast_Worker, NULL );
+    }
+
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        u8Woken = 0;
+        clBenchTimer.Start();
+        clFlag.Set(0x0001);
+
+        // All waiters have run and parked by the time we get here
+        clFlag.Clear(0x0001);
+        for (j = 0; j < NUM_WORKERS; j++)
+        {
+            clSemA.Post();
+        }
+    }
+
+    BenchPrint( &clStats, "flag_broadcast" );
+}
+
+//---------------------------------------------------------------------------
+static void FlagSet_Waiter( void *pvFlag_ )
+{
+    clFlag.Wait( (uint16_t)(K_ADDR)pvFlag_, EVENT_FLAG_ANY );
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//---------------------------------------------------------------------------
+static void Bench_FlagSet( uint8_t u8Waiters_, const char *szName_ )
+{
+    uint16_t i;
+    uint8_t j;
+
+    clStats.Init();
+    clFlag.Init();
+
+    // Each waiter blocks on its own flag, in the range 0x0002-0x0100
+    for (j = 0; j < u8Waiters_; j++)
+    {
+        aclFlagWaiter[j].Init( awFlagWaiterStack[j],
+                               WORKER_STACK_SIZE,
+                               2,
+                               (ThreadEntry_t)FlagSet_Waiter,
+                               (void*)(K_ADDR)(0x0002 << j) );
+        aclFlagWaiter[j].Start();
+    }
+
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        clBenchTimer.Start();
+        clFlag.Set(0x8000);
+        clBenchTimer.Stop();
+        BenchRecord( &clStats );
+        clFlag.Clear(0x8000);
+    }
+
+    // Release the waiters
+    clFlag.Set(0x01FE);
+
+    BenchPrint( &clStats, szName_ );
+}
+
+//---------------------------------------------------------------------------
+static void MsgQ_Worker( void *unused_ )
+{
+    uint16_t i;
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        clMsgQB.Send( clMsgQA.Receive() );
+    }
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//---------------------------------------------------------------------------
+static void Bench_MsgQRoundTrip()
+{
+    uint16_t i;
+    Message *pclMsg = GlobalMessagePool::Pop();
+
+    if (!pclMsg)
+    {
+        return;
+    }
+
+    clStats.Init();
+    clMsgQA.Init();
+    clMsgQB.Init();
+    BenchStartWorker( 0, 2, MsgQ_Worker, NULL );
+
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        clBenchTimer.Start();
+        clMsgQA.Send( pclMsg );
+        pclMsg = clMsgQB.Receive();
+        clBenchTimer.Stop();
+        BenchRecord( &clStats );
+    }
+    GlobalMessagePool::Push( pclMsg );
+
+    BenchPrint( &clStats, "msgq_roundtrip" );
+}
+
+//---------------------------------------------------------------------------
+static void Mbox_Worker( void *unused_ )
+{
+    uint16_t i;
+    uint16_t u16Data;
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        clMboxA.Receive( &u16Data );
+        clMboxB.Send( &u16Data );
+    }
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//---------------------------------------------------------------------------
+static void Bench_MboxRoundTrip()
+{
+    uint16_t i;
+    uint16_t u16Data;
+
+    clStats.Init();
+    clMboxA.Init( au16MboxBufA, sizeof(au16MboxBufA), sizeof(uint16_t) );
+    clMboxB.Init( au16MboxBufB, sizeof(au16MboxBufB), sizeof(uint16_t) );
+    BenchStartWorker( 0, 2, Mbox_Worker, NULL );
+
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        u16Data = i;
+        clBenchTimer.Start();
+        clMboxA.Send( &u16Data );
+        clMboxB.Receive( &u16Data );
+        clBenchTimer.Stop();
+        BenchRecord( &clStats );
+    }
+
+    BenchPrint( &clStats, "mbox_roundtrip" );
+}
+
+//---------------------------------------------------------------------------
+static void TimerCallback( Thread *pclOwner_, void *pvData_ )
+{
+
+}
+
+//---------------------------------------------------------------------------
+static void Bench_TimerIsr( uint8_t u8Timers_, const char *szName_ )
+{
+    uint8_t i;
+    uint16_t j;
+
+    clStats.Init();
+
+    // Spread the intervals out, such that only a handful of timers expire
+    // on any given call to the handler.
+    for (i = 0; i < u8Timers_; i++)
+    {
+        aclBenchTimers[i].Init();
+        aclBenchTimers[i].Start(true, 5 + ((uint32_t)i * 7), TimerCallback, 0);
+    }
+
+    for (j = 0; j < BENCH_ITERATIONS; j++)
+    {
+        clBenchTimer.Start();
+        CS_ENTER();
+        TimerScheduler::Process();
+        CS_EXIT();
+        clBenchTimer.Stop();
+        BenchRecord( &clStats );
+    }
+
+    for (i = 0; i < u8Timers_; i++)
+    {
+        aclBenchTimers[i].Stop();
+    }
+
+    BenchPrint( &clStats, szName_ );
+}
+
+//---------------------------------------------------------------------------
+static void ThreadLife_Worker( void *unused_ )
+{
+    // Stopped here, started from the main thread before Init()
+    clBenchTimer.Stop();
+    BenchRecord( &clStats );
+
+    // Stopped in the main thread, once it's been switched back in
+    clBenchTimer.Start();
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//---------------------------------------------------------------------------
+static void Bench_ThreadLife()
+{
+    uint16_t i;
+
+    clStats.Init();
+    clStats2.Init();
+
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        clBenchTimer.Start();
+        BenchStartWorker( 0, 2, ThreadLife_Worker, NULL );
+        clBenchTimer.Stop();
+        BenchRecord( &clStats2 );
+    }
+
+    BenchPrint( &clStats, "thread_start" );
+    BenchPrint( &clStats2, "thread_exit" );
+}
+
+//---------------------------------------------------------------------------
+static void LockBench_Worker( void *pvRWLock_ )
+{
+#if KERNEL_USE_RWLOCK
+    bool bWrite;
+#endif
+
+    while (!bLockBenchStop)
+    {
+#if KERNEL_USE_RWLOCK
+        bWrite = ((u16LockOps % LOCK_BENCH_WRITE_RATIO) == 0);
+
+        if (pvRWLock_)
+        {
+            if (bWrite)
+            {
+                clRWLock.WriteLock();
+            }
+            else
+            {
+                clRWLock.ReadLock();
+            }
+        }
+        else
+#endif
+        {
+            clMutex.Claim();
+        }
+
+        // Hold the lock across a blocking call, as a reader going out to a
+        // slow peripheral would.
+        Thread::Sleep(1);
+
+#if KERNEL_USE_RWLOCK
+        if (pvRWLock_)
+        {
+            if (bWrite)
+            {
+                clRWLock.WriteUnlock();
+            }
+            else
+            {
+                clRWLock.ReadUnlock();
+            }
+        }
+        else
+#endif
+        {
+            clMutex.Release();
+        }
+        u16LockOps++;
+    }
+
+    clSemA.Post();
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//---------------------------------------------------------------------------
+static void Bench_LockThroughput( bool bRWLock_, const char *szName_ )
+{
+    uint8_t i;
+
+    clSemA.Init(0, NUM_WORKERS);
+    clMutex.Init();
+#if KERNEL_USE_RWLOCK
+    clRWLock.Init();
+#endif
+    bLockBenchStop = false;
+    u16LockOps = 0;
+
+    for (i = 0; i < NUM_WORKERS; i++)
+    {
+        BenchStartWorker( i, 2, LockBench_Worker, (void*)bRWLock_ );
+    }
+
+    Thread::Sleep(LOCK_BENCH_WINDOW_MS);
+    bLockBenchStop = true;
+
+    for (i = 0; i < NUM_WORKERS; i++)
+    {
+        clSemA.Pend();
+    }
+
+    PrintString( "BM " );
+    PrintString( szName_ );
+    PrintString( " ops=" );
+    PrintNumber( u16LockOps );
+    PrintString( " ms=" );
+    PrintNumber( LOCK_BENCH_WINDOW_MS );
+    PrintString( "\n" );
+}
+
+//---------------------------------------------------------------------------
+static uint16_t HeapBench_Rand()
+{
+    u16HeapSeed = (u16HeapSeed * 25173) + 13849;
+    return (u16HeapSeed >> 4);
+}
+
+//---------------------------------------------------------------------------
+static void Bench_Heap( HeapBench_t eHeap_, const char *szAlloc_, const char *szFree_, const char *szSoak_ )
+{
+    uint16_t i;
+    uint16_t u16Fails = 0;
+
+    switch (eHeap_)
+    {
+        case HEAP_BENCH_ARENA:
+            clBenchArena.Init( awHeapBuf, HEAP_BENCH_SIZE, auBenchArenaSizes,
+                               sizeof(auBenchArenaSizes) / sizeof(K_ADDR) );
+            break;
+        case HEAP_BENCH_FIXED:
+            // Fill the buffer with 8, 16 and 48-byte blocks, in roughly the
+            // proportions the script asks for them.
+            aclBenchFixedConfig[0].m_u16BlockSize = 8;
+            aclBenchFixedConfig[0].m_u16BlockCount = 10;
+            aclBenchFixedConfig[1].m_u16BlockSize = 16;
+            aclBenchFixedConfig[1].m_u16BlockCount = 6;
+            aclBenchFixedConfig[2].m_u16BlockSize = HEAP_BENCH_MAX_ALLOC;
+            aclBenchFixedConfig[2].m_u16BlockCount = 4;
+            aclBenchFixedConfig[3].m_u16BlockSize = 0;
+            aclBenchFixedConfig[3].m_u16BlockCount = 0;
+            clBenchFixed.Create( awHeapBuf, aclBenchFixedConfig );
+            break;
+        case HEAP_BENCH_TLSF:
+            clBenchTlsf.Init( awHeapBuf, HEAP_BENCH_SIZE );
+            break;
+    }
+
+    clStats.Init();
+    clStats2.Init();
+    u16HeapSeed = 1;
+    for (i = 0; i < HEAP_BENCH_SLOTS; i++)
+    {
+        apvHeapSlot[i] = 0;
+    }
+
+    // Allocation latencies go in clStats, frees in clStats2.
+    for (i = 0; i < HEAP_BENCH_STEPS; i++)
+    {
+        uint8_t u8Slot = HeapBench_Rand() % HEAP_BENCH_SLOTS;
+        BenchStats *pclStats;
+
+        if (apvHeapSlot[u8Slot])
+        {
+            clBenchTimer.Start();
+            switch (eHeap_)
+            {
+                case HEAP_BENCH_ARENA:  clBenchArena.Free( apvHeapSlot[u8Slot] );   break;
+                case HEAP_BENCH_FIXED:  FixedHeap::Free( apvHeapSlot[u8Slot] );     break;
+                case HEAP_BENCH_TLSF:   clBenchTlsf.Free( apvHeapSlot[u8Slot] );    break;
+            }
+            clBenchTimer.Stop();
+            apvHeapSlot[u8Slot] = 0;
+            pclStats = &clStats2;
+        }
+        else
+        {
+            uint16_t u16Size = 1 + (HeapBench_Rand() % HEAP_BENCH_MAX_ALLOC);
+            clBenchTimer.Start();
+            switch (eHeap_)
+            {
+                case HEAP_BENCH_ARENA:  apvHeapSlot[u8Slot] = clBenchArena.Allocate( u16Size );  break;
+                case HEAP_BENCH_FIXED:  apvHeapSlot[u8Slot] = clBenchFixed.Alloc( u16Size );     break;
+                case HEAP_BENCH_TLSF:   apvHeapSlot[u8Slot] = clBenchTlsf.Allocate( u16Size );   break;
+            }
+            clBenchTimer.Stop();
+            if (!apvHeapSlot[u8Slot])
+            {
+                u16Fails++;
+            }
+            pclStats = &clStats;
+        }
+
+        // Only BENCH_ITERATIONS samples fit in the histogram counters, but
+        // the whole script is run so the heap reaches a fragmented state.
+        if (pclStats->GetCount() < BENCH_ITERATIONS)
+        {
+            BenchRecord( pclStats );
+        }
+    }
+
+    BenchPrint( &clStats, szAlloc_ );
+    BenchPrint( &clStats2, szFree_ );
+
+    PrintString( "BM " );
+    PrintString( szSoak_ );
+    PrintString( " ops=" );
+    PrintNumber( HEAP_BENCH_STEPS );
+    PrintString( " fails=" );
+    PrintNumber( u16Fails );
+    PrintString( "\n" );
+}
+
+//---------------------------------------------------------------------------
+static void AppMain( void *unused )
+{
+    Driver *pclUART = DriverList::FindByPath("/dev/tty");
+
+    pclUART->Control(CMD_SET_BUFFERS, NULL, 0, aucTxBuf, 32);
+    {
+        uint32_t u32BaudRate = 57600;
+        pclUART->Control(CMD_SET_BAUDRATE, &u32BaudRate, 0, 0, 0 );
+        pclUART->Control(CMD_SET_RX_DISABLE, 0, 0, 0, 0);
+    }
+
+    pclUART->Open();
+
+    while(1)
+    {
+        PrintString( "START\n" );
+
+        Profiler::Start();
+        clBenchTimer.Init();
+        Bench_Overhead();
+
+        Bench_CtxSwitch();
+        Bench_SemPingPong();
+        Bench_MutexHandoff();
+        Bench_FlagBroadcast();
+        Bench_FlagSet( 1, "flag_set_1" );
+        Bench_FlagSet( 4, "flag_set_4" );
+        Bench_FlagSet( 8, "flag_set_8" );
+        Bench_MsgQRoundTrip();
+        Bench_MboxRoundTrip();
+        Bench_TimerIsr( 1, "timer_isr_1" );
+        Bench_TimerIsr( 8, "timer_isr_8" );
+        Bench_TimerIsr( 32, "timer_isr_32" );
+        Bench_ThreadLife();
+        Bench_Heap( HEAP_BENCH_ARENA, "heap_arena_alloc", "heap_arena_free", "heap_arena_soak" );
+        Bench_Heap( HEAP_BENCH_FIXED, "heap_fixed_alloc", "heap_fixed_free", "heap_fixed_soak" );
+        Bench_Heap( HEAP_BENCH_TLSF, "heap_tlsf_alloc", "heap_tlsf_free", "heap_tlsf_soak" );
+        Profiler::Stop();
+
+        Bench_LockThroughput( false, "lock_mutex" );
+#if KERNEL_USE_RWLOCK
+        Bench_LockThroughput( true, "lock_rwlock" );
+#endif
+
+        PrintString( "END\n" );
+        ProfilePlatform::PassDone();
+        Thread::Sleep(500);
+    }
+}
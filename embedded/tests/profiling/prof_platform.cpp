@@ -0,0 +1,161 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+
+    \file   prof_platform.cpp
+
+    \brief  Target-specific support shared by the profiling applications
+*/
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+#include "kernel.h"
+#include "driver.h"
+#include "drvUART.h"
+#include "threadport.h"
+#include "prof_platform.h"
+
+#if defined(AVR)
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#elif defined(POSIX)
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+extern "C" void __cxa_pure_virtual() { }
+
+//---------------------------------------------------------------------------
+#if defined(POSIX)
+static PosixUART clUART;            //!< UART device driver object (stdio)
+#else
+static ATMegaUART clUART;           //!< UART device driver object
+#endif
+
+//---------------------------------------------------------------------------
+void ProfilePlatform::Init()
+{
+    clUART.SetName("/dev/tty");
+    clUART.Init();
+
+    DriverList::Add( &clUART );
+}
+
+//---------------------------------------------------------------------------
+void ProfilePlatform::Idle()
+{
+#if defined(AVR)
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+    sei();
+#elif defined(POSIX)
+    ThreadPort::WaitForInterrupt();
+#endif
+}
+
+#if KERNEL_USE_TICKLESS_IDLE
+#if defined(AVR)
+//---------------------------------------------------------------------------
+ISR(WDT_vect)
+{
+    // Wakeup only - the watchdog is disabled once the CPU is running again.
+}
+#endif
+
+//---------------------------------------------------------------------------
+uint32_t ProfilePlatform::SleepIdle( uint32_t u32MaxTicks_ )
+{
+#if defined(AVR)
+    // Kernel timer keeps running, and wakes us up when it expires.
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    cli();
+    sleep_disable();
+#elif defined(POSIX)
+    // The timer signal wakes the process, and is serviced once the caller
+    // re-enables interrupts.
+    ThreadPort::WaitForInterrupt();
+#endif
+    return 0;
+}
+
+//---------------------------------------------------------------------------
+uint32_t ProfilePlatform::SleepDeep( uint32_t u32MaxTicks_ )
+{
+#if defined(AVR)
+    uint8_t u8Prescale = 0;
+    uint32_t u32Ticks = MSECONDS_TO_TICKS(16);
+
+    if (u32Ticks > u32MaxTicks_)
+    {
+        // Not even the shortest watchdog period fits
+        return SleepIdle( u32MaxTicks_ );
+    }
+
+    // Find the longest watchdog period (16ms * 2^k, up to 2s) that fits
+    while (u8Prescale < 7)
+    {
+        uint32_t u32Next = MSECONDS_TO_TICKS(16UL << (u8Prescale + 1));
+        if (u32Next > u32MaxTicks_)
+        {
+            break;
+        }
+        u32Ticks = u32Next;
+        u8Prescale++;
+    }
+
+    // Arm the watchdog in interrupt-only mode
+    wdt_reset();
+    WDTCSR = (1 << WDCE) | (1 << WDE);
+    WDTCSR = (1 << WDIE) | (u8Prescale & 0x07);
+
+    // The kernel timer is clocked from the I/O clock, which stops here.
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    cli();
+    sleep_disable();
+
+    wdt_reset();
+    MCUSR &= ~(1 << WDRF);
+    WDTCSR = (1 << WDCE) | (1 << WDE);
+    WDTCSR = 0;
+
+    return u32Ticks;
+#else
+    // No way to halt the host's kernel timer
+    return SleepIdle( u32MaxTicks_ );
+#endif
+}
+#endif
+
+//---------------------------------------------------------------------------
+void ProfilePlatform::PassDone()
+{
+#if defined(POSIX)
+    // Output is written straight to stdout, so there's nothing to drain.
+    // Static objects (i.e. the running thread) must not be destroyed, so skip
+    // the atexit() processing.
+    _exit(EXIT_SUCCESS);
+#endif
+}
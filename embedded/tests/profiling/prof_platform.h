@@ -0,0 +1,87 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+/*!
+
+    \file   prof_platform.h
+
+    \brief  Target-specific support shared by the profiling applications
+
+    The profiling apps are written against this interface instead of the
+    target's headers, so that the same app runs on hardware (AVR) and on the
+    POSIX host port.
+*/
+
+#ifndef __PROF_PLATFORM_H__
+#define __PROF_PLATFORM_H__
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+
+//---------------------------------------------------------------------------
+class ProfilePlatform
+{
+public:
+    /*!
+     *  \brief Init
+     *
+     *  Initialize the target's serial port driver, and add it to the driver
+     *  list as "/dev/tty".  Must be called before Kernel::Start().
+     */
+    static void Init();
+
+    /*!
+     *  \brief Idle
+     *
+     *  Sleep until the next interrupt.  Called in a loop from the app's idle
+     *  thread, with interrupts enabled.
+     */
+    static void Idle();
+
+#if KERNEL_USE_TICKLESS_IDLE
+    /*!
+     *  \brief SleepIdle
+     *
+     *  Tickless idle state - sleep until the next interrupt, leaving the
+     *  kernel timer running.  Called with interrupts disabled.
+     *
+     *  \param u32MaxTicks_ Ticks until the next timer expiry
+     *  \return Ticks spent with the kernel timer halted (always 0)
+     */
+    static uint32_t SleepIdle( uint32_t u32MaxTicks_ );
+
+    /*!
+     *  \brief SleepDeep
+     *
+     *  Tickless idle state - the target's deepest sleep mode, with the
+     *  kernel timer halted and the CPU woken by a separate wakeup timer.
+     *  Targets without such a mode fall back to SleepIdle().  Called with
+     *  interrupts disabled.
+     *
+     *  \param u32MaxTicks_ Ticks until the next timer expiry
+     *  \return Ticks spent with the kernel timer halted
+     */
+    static uint32_t SleepDeep( uint32_t u32MaxTicks_ );
+#endif
+
+    /*!
+     *  \brief PassDone
+     *
+     *  Called by the app at the end of each pass of its measurements.  On
+     *  hardware, the app runs forever; on the host, the process exits after
+     *  the first pass so that runs can be scripted.
+     */
+    static void PassDone();
+};
+
+#endif //__PROF_PLATFORM_H__
@@ -0,0 +1,243 @@
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+#include "kernel.h"
+#include "thread.h"
+#include "driver.h"
+#include "drvUART.h"
+#include "profile.h"
+#include "kernelprofile.h"
+#include "scheduler.h"
+#include "priomap.h"
+#include "../prof_platform.h"
+
+//---------------------------------------------------------------------------
+/*
+    Scheduler profiling - measures the cost of a single call to
+    Scheduler::Schedule(), which is dominated by the priority map lookup of
+    the highest-priority ready thread.
+
+    Two cases are measured:  one where the highest ready thread is at the
+    lowest application priority (1), and one where it is at the highest
+    priority supported by the kernel configuration.
+
+    Results are printed over the UART as "SC <priorities> <lo|hi>: <cycles>".
+    The number of priorities is fixed at compile time by
+    KERNEL_NUM_PRIORITIES in mark3cfg.h - rebuild the kernel and this test
+    with 8, 64 and 256 priorities to compare the lookup cost across
+    configurations (256 priorities requires a part with more RAM than the
+    atmega328p).
+*/
+
+//---------------------------------------------------------------------------
+static uint8_t aucTxBuf[32];
+
+//---------------------------------------------------------------------------
+#define MAIN_STACK_SIZE            (384)
+#define IDLE_STACK_SIZE            (384)
+
+#define SCHEDULE_ITERATIONS        (100)
+
+//---------------------------------------------------------------------------
+static ProfileTimer clProfileOverhead;
+static ProfileTimer clScheduleLowTimer;
+static ProfileTimer clScheduleHighTimer;
+
+//---------------------------------------------------------------------------
+static Thread clMainThread;
+static Thread clIdleThread;
+
+//---------------------------------------------------------------------------
+static K_WORD awMainStack[MAIN_STACK_SIZE / sizeof(K_WORD)];
+static K_WORD awIdleStack[IDLE_STACK_SIZE / sizeof(K_WORD)];
+
+//---------------------------------------------------------------------------
+static void AppMain( void *unused );
+static void IdleMain( void *unused );
+
+//---------------------------------------------------------------------------
+int main(void)
+{
+    Kernel::Init();
+
+    clMainThread.Init(  awMainStack,
+                        MAIN_STACK_SIZE,
+                        1,
+                        (ThreadEntry_t)AppMain,
+                        NULL );
+
+    clIdleThread.Init(  awIdleStack,
+                        IDLE_STACK_SIZE,
+                        0,
+                        (ThreadEntry_t)IdleMain,
+                        NULL );
+
+    clMainThread.Start();
+    clIdleThread.Start();
+
+    ProfilePlatform::Init();
+
+    Kernel::Start();
+}
+
+//---------------------------------------------------------------------------
+static void IdleMain( void *unused )
+{
+    while(1)
+    {
+        ProfilePlatform::Idle();
+    }
+}
+
+//---------------------------------------------------------------------------
+// Basic string routines
+uint16_t KUtil_Strlen( const char *szStr_ )
+{
+    char *pcData = (char*)szStr_;
+    uint16_t u16Len = 0;
+
+    while (*pcData++)
+    {
+        u16Len++;
+    }
+    return u16Len;
+}
+
+//---------------------------------------------------------------------------
+void KUtil_Ultoa( uint32_t u8Data_, char *szText_ )
+{
+    uint32_t u8Mul;
+    uint32_t u8Max;
+
+    // Find max index to print...
+    u8Mul = 10;
+    u8Max = 1;
+    while (( u8Mul <= u8Data_ ) && (u8Max < 15))
+    {
+        u8Max++;
+        u8Mul *= 10;
+    }
+
+    szText_[u8Max] = 0;
+    while (u8Max--)
+    {
+        szText_[u8Max] = '0' + (u8Data_ % 10);
+        u8Data_/=10;
+    }
+}
+
+//---------------------------------------------------------------------------
+static void PrintWait( Driver *pclDriver_, uint16_t u16Size_, const char *data )
+{
+    uint16_t u16Written = 0;
+
+    while (u16Written < u16Size_)
+    {
+        u16Written += pclDriver_->Write((u16Size_ - u16Written), (uint8_t*)(&data[u16Written]));
+        if (u16Written != u16Size_)
+        {
+            Thread::Sleep(5);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+static void ProfilePrint( ProfileTimer *pclProfile, const char *szCase_ )
+{
+    Driver *pclUART = DriverList::FindByPath("/dev/tty");
+    char szBuf[16];
+    uint32_t u32Val = pclProfile->GetAverage();
+    // Results within the measurement noise are reported as 0
+    if (u32Val > clProfileOverhead.GetAverage())
+    {
+        u32Val -= clProfileOverhead.GetAverage();
+    }
+    else
+    {
+        u32Val = 0;
+    }
+    u32Val *= CLOCK_DIVIDE;
+
+    PrintWait( pclUART, 3, "SC " );
+    KUtil_Ultoa(KERNEL_NUM_PRIORITIES, szBuf);
+    PrintWait( pclUART, KUtil_Strlen(szBuf), szBuf );
+    PrintWait( pclUART, 1, " " );
+    PrintWait( pclUART, KUtil_Strlen(szCase_), szCase_ );
+    PrintWait( pclUART, 2, ": " );
+    KUtil_Ultoa(u32Val, szBuf);
+    PrintWait( pclUART, KUtil_Strlen(szBuf), szBuf );
+    PrintWait( pclUART, 1, "\n" );
+}
+
+//---------------------------------------------------------------------------
+static void ProfileInit()
+{
+    clProfileOverhead.Init();
+    clScheduleLowTimer.Init();
+    clScheduleHighTimer.Init();
+}
+
+//---------------------------------------------------------------------------
+static void ProfileOverhead()
+{
+    uint16_t i;
+    for (i = 0; i < 100; i++)
+    {
+        clProfileOverhead.Start();
+        clProfileOverhead.Stop();
+    }
+}
+
+//---------------------------------------------------------------------------
+static void Scheduler_Profiling( ProfileTimer *pclProfile_ )
+{
+    uint16_t i;
+
+    for (i = 0; i < SCHEDULE_ITERATIONS; i++)
+    {
+        pclProfile_->Start();
+        Scheduler::Schedule();
+        pclProfile_->Stop();
+    }
+}
+
+//---------------------------------------------------------------------------
+static void AppMain( void *unused )
+{
+    Driver *pclUART = DriverList::FindByPath("/dev/tty");
+
+    ProfileInit();
+
+    pclUART->Control(CMD_SET_BUFFERS, NULL, 0, aucTxBuf, 32);
+    {
+        uint32_t u32BaudRate = 57600;
+        pclUART->Control(CMD_SET_BAUDRATE, &u32BaudRate, 0, 0, 0 );
+        pclUART->Control(CMD_SET_RX_DISABLE, 0, 0, 0, 0);
+    }
+
+    pclUART->Open();
+    pclUART->Write(6,(uint8_t*)"START\n");
+
+    while(1)
+    {
+        //---[ Scheduler Profiling ]-----------------------
+        Profiler::Start();
+        ProfileOverhead();
+
+        // Highest ready thread at the lowest application priority
+        Scheduler::GetCurrentThread()->SetPriority(1);
+        Scheduler_Profiling(&clScheduleLowTimer);
+
+        // Highest ready thread at the highest available priority
+        Scheduler::GetCurrentThread()->SetPriority(KERNEL_NUM_PRIORITIES - 1);
+        Scheduler_Profiling(&clScheduleHighTimer);
+
+        Scheduler::GetCurrentThread()->SetPriority(1);
+        Profiler::Stop();
+
+        ProfilePrint(&clScheduleLowTimer, "lo");
+        ProfilePrint(&clScheduleHighTimer, "hi");
+        ProfilePlatform::PassDone();
+        Thread::Sleep(500);
+    }
+}
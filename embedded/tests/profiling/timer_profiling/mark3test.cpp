@@ -0,0 +1,268 @@
+
+#include "kerneltypes.h"
+#include "mark3cfg.h"
+#include "kernel.h"
+#include "thread.h"
+#include "driver.h"
+#include "drvUART.h"
+#include "profile.h"
+#include "kernelprofile.h"
+#include "timer.h"
+#include "timerscheduler.h"
+#include "threadport.h"
+#include "../prof_platform.h"
+
+//---------------------------------------------------------------------------
+/*
+    Timer scheduler profiling - measures the cost of the timer interrupt
+    handler (TimerScheduler::Process()) against the number of active timers.
+
+    For each timer count, the timers are started as repeating timers with a
+    spread of intervals, and the handler is then invoked directly (with
+    interrupts disabled, as it would be from the timer ISR) a fixed number of
+    times.  In tick-based mode, each call is equivalent to one system tick;
+    in tickless mode, each call is equivalent to one timer expiry interrupt.
+
+    Results are printed over the UART as "TP <timers>: <cycles>", where
+    cycles is the average cost of a single call to the handler.
+*/
+
+//---------------------------------------------------------------------------
+static uint8_t aucTxBuf[32];
+
+//---------------------------------------------------------------------------
+#define MAIN_STACK_SIZE            (384)
+#define IDLE_STACK_SIZE            (384)
+
+#define MAX_TEST_TIMERS            (48)
+#define PROCESS_ITERATIONS         (100)
+
+//---------------------------------------------------------------------------
+static const uint8_t aucTimerCounts[] = { 1, 2, 4, 8, 16, 24, 32, 48 };
+#define NUM_TIMER_COUNTS           (sizeof(aucTimerCounts) / sizeof(uint8_t))
+
+//---------------------------------------------------------------------------
+static ProfileTimer clProfileOverhead;
+static ProfileTimer aclProcessTimer[NUM_TIMER_COUNTS];
+
+static Timer aclTestTimers[MAX_TEST_TIMERS];
+static volatile uint16_t u16Expired;
+
+//---------------------------------------------------------------------------
+static Thread clMainThread;
+static Thread clIdleThread;
+
+//---------------------------------------------------------------------------
+static K_WORD awMainStack[MAIN_STACK_SIZE / sizeof(K_WORD)];
+static K_WORD awIdleStack[IDLE_STACK_SIZE / sizeof(K_WORD)];
+
+//---------------------------------------------------------------------------
+static void AppMain( void *unused );
+static void IdleMain( void *unused );
+
+//---------------------------------------------------------------------------
+int main(void)
+{
+    Kernel::Init();
+
+    clMainThread.Init(  awMainStack,
+                        MAIN_STACK_SIZE,
+                        1,
+                        (ThreadEntry_t)AppMain,
+                        NULL );
+
+    clIdleThread.Init(  awIdleStack,
+                        IDLE_STACK_SIZE,
+                        0,
+                        (ThreadEntry_t)IdleMain,
+                        NULL );
+
+    clMainThread.Start();
+    clIdleThread.Start();
+
+    ProfilePlatform::Init();
+
+    Kernel::Start();
+}
+
+//---------------------------------------------------------------------------
+static void IdleMain( void *unused )
+{
+    while(1)
+    {
+        ProfilePlatform::Idle();
+    }
+}
+
+//---------------------------------------------------------------------------
+// Basic string routines
+uint16_t KUtil_Strlen( const char *szStr_ )
+{
+    char *pcData = (char*)szStr_;
+    uint16_t u16Len = 0;
+
+    while (*pcData++)
+    {
+        u16Len++;
+    }
+    return u16Len;
+}
+
+//---------------------------------------------------------------------------
+void KUtil_Ultoa( uint32_t u8Data_, char *szText_ )
+{
+    uint32_t u8Mul;
+    uint32_t u8Max;
+
+    // Find max index to print...
+    u8Mul = 10;
+    u8Max = 1;
+    while (( u8Mul <= u8Data_ ) && (u8Max < 15))
+    {
+        u8Max++;
+        u8Mul *= 10;
+    }
+
+    szText_[u8Max] = 0;
+    while (u8Max--)
+    {
+        szText_[u8Max] = '0' + (u8Data_ % 10);
+        u8Data_/=10;
+    }
+}
+
+//---------------------------------------------------------------------------
+static void PrintWait( Driver *pclDriver_, uint16_t u16Size_, const char *data )
+{
+    uint16_t u16Written = 0;
+
+    while (u16Written < u16Size_)
+    {
+        u16Written += pclDriver_->Write((u16Size_ - u16Written), (uint8_t*)(&data[u16Written]));
+        if (u16Written != u16Size_)
+        {
+            Thread::Sleep(5);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+static void ProfilePrint( ProfileTimer *pclProfile, uint8_t u8Timers_ )
+{
+    Driver *pclUART = DriverList::FindByPath("/dev/tty");
+    char szBuf[16];
+    uint32_t u32Val = pclProfile->GetAverage();
+    // Results within the measurement noise are reported as 0
+    if (u32Val > clProfileOverhead.GetAverage())
+    {
+        u32Val -= clProfileOverhead.GetAverage();
+    }
+    else
+    {
+        u32Val = 0;
+    }
+    u32Val *= CLOCK_DIVIDE;
+
+    PrintWait( pclUART, 3, "TP " );
+    KUtil_Ultoa(u8Timers_, szBuf);
+    PrintWait( pclUART, KUtil_Strlen(szBuf), szBuf );
+    PrintWait( pclUART, 2, ": " );
+    KUtil_Ultoa(u32Val, szBuf);
+    PrintWait( pclUART, KUtil_Strlen(szBuf), szBuf );
+    PrintWait( pclUART, 1, "\n" );
+}
+
+//---------------------------------------------------------------------------
+static void TimerCallback( Thread *pclOwner_, void *pvData_ )
+{
+    u16Expired++;
+}
+
+//---------------------------------------------------------------------------
+static void ProfileInit()
+{
+    uint8_t i;
+    clProfileOverhead.Init();
+    for (i = 0; i < NUM_TIMER_COUNTS; i++)
+    {
+        aclProcessTimer[i].Init();
+    }
+}
+
+//---------------------------------------------------------------------------
+static void ProfileOverhead()
+{
+    uint16_t i;
+    for (i = 0; i < 100; i++)
+    {
+        clProfileOverhead.Start();
+        clProfileOverhead.Stop();
+    }
+}
+
+//---------------------------------------------------------------------------
+static void Timer_Profiling( ProfileTimer *pclProfile_, uint8_t u8Timers_ )
+{
+    uint8_t i;
+    uint16_t j;
+
+    // Start the timers with a spread of intervals, such that only a handful
+    // of timers expire on any given call to the handler.
+    for (i = 0; i < u8Timers_; i++)
+    {
+        aclTestTimers[i].Init();
+        aclTestTimers[i].Start(true, 5 + ((uint32_t)i * 7), TimerCallback, 0);
+    }
+
+    for (j = 0; j < PROCESS_ITERATIONS; j++)
+    {
+        pclProfile_->Start();
+        CS_ENTER();
+        TimerScheduler::Process();
+        CS_EXIT();
+        pclProfile_->Stop();
+    }
+
+    for (i = 0; i < u8Timers_; i++)
+    {
+        aclTestTimers[i].Stop();
+    }
+}
+
+//---------------------------------------------------------------------------
+static void AppMain( void *unused )
+{
+    Driver *pclUART = DriverList::FindByPath("/dev/tty");
+    uint8_t i;
+
+    ProfileInit();
+
+    pclUART->Control(CMD_SET_BUFFERS, NULL, 0, aucTxBuf, 32);
+    {
+        uint32_t u32BaudRate = 57600;
+        pclUART->Control(CMD_SET_BAUDRATE, &u32BaudRate, 0, 0, 0 );
+        pclUART->Control(CMD_SET_RX_DISABLE, 0, 0, 0, 0);
+    }
+
+    pclUART->Open();
+    pclUART->Write(6,(uint8_t*)"START\n");
+
+    while(1)
+    {
+        //---[ Timer Scheduler Profiling ]-----------------
+        Profiler::Start();
+        ProfileOverhead();
+        for (i = 0; i < NUM_TIMER_COUNTS; i++)
+        {
+            Timer_Profiling(&aclProcessTimer[i], aucTimerCounts[i]);
+        }
+        Profiler::Stop();
+
+        for (i = 0; i < NUM_TIMER_COUNTS; i++)
+        {
+            ProfilePrint(&aclProcessTimer[i], aucTimerCounts[i]);
+        }
+        ProfilePlatform::PassDone();
+        Thread::Sleep(500);
+    }
+}
@@ -30,7 +30,9 @@ See license.txt for more information
 
 static volatile void *apvAllocs[MAX_ALLOCS]; // assuming we have < 128 system heap allocs...
 
-#define ARENA_SIZE (200)
+// Arena bookkeeping is pointer-sized - scale the arena to match (200 bytes
+// on 16-bit targets).
+#define ARENA_SIZE (100 * sizeof(void*))
 static uint8_t au8Arena[ARENA_SIZE];
 static Arena clArena;
 const static K_ADDR au16Sizes[] = { 4, 8, 12, 20, 32, 52, 84, 0 };
@@ -143,7 +145,7 @@ TEST_END
 //===========================================================================
 void HeapScriptTest(void *pvParam_)
 {
-    uint16_t u16Index = ((uint16_t)pvParam_);
+    uint16_t u16Index = ((uint16_t)(K_ADDR)pvParam_);
     uint16_t i;
 
     void *pvData;
@@ -210,6 +212,58 @@ void HeapScriptTest(void *pvParam_)
     }
 }
 
+#if HEAP_USE_STATS
+//===========================================================================
+// Check that the arena's counters track allocations, frees and failures.
+static K_ADDR auStatsSizes[] = { 4, 8, 12, 20, 32, 52, 84 };
+TEST(ut_arena_stats)
+{
+    HeapStats clStats;
+    HeapClassStats clClass;
+    uint16_t u16Current = 0;
+    uint8_t i;
+
+    clArena.Init(au8Arena, ARENA_SIZE, auStatsSizes, sizeof(auStatsSizes)/sizeof(K_ADDR));
+
+    clArena.GetStats( &clStats );
+    EXPECT_EQUALS( clStats.m_u8Classes, sizeof(auStatsSizes)/sizeof(K_ADDR) );
+    EXPECT_EQUALS( clStats.m_uUsedBytes, 0 );
+    EXPECT_TRUE( clStats.m_uFreeBytes > 0 );
+
+    for (i = 0; i < 4; i++)
+    {
+        apvAllocs[i] = clArena.Allocate( auStatsSizes[1] );
+        EXPECT_TRUE( apvAllocs[i] != 0 );
+    }
+    EXPECT_FALSE( clArena.Allocate( ARENA_SIZE ) );
+    clArena.Free( (void*)apvAllocs[1] );
+
+    clArena.GetStats( &clStats );
+    EXPECT_EQUALS( clStats.m_u32Allocs, 4 );
+    EXPECT_EQUALS( clStats.m_u32Frees, 1 );
+    EXPECT_EQUALS( clStats.m_u32Fails, 1 );
+    EXPECT_TRUE( clStats.m_uUsedBytes >= (3 * auStatsSizes[1]) );
+    EXPECT_TRUE( clStats.m_uPeakBytes >= (4 * auStatsSizes[1]) );
+    EXPECT_TRUE( clStats.m_uLargestFree <= clStats.m_uFreeBytes );
+
+    for (i = 0; i < clStats.m_u8Classes; i++)
+    {
+        EXPECT_TRUE( clArena.GetClassStats( i, &clClass ) );
+        u16Current += clClass.m_u16Current;
+    }
+    EXPECT_EQUALS( u16Current, 3 );
+    EXPECT_FALSE( clArena.GetClassStats( clStats.m_u8Classes, &clClass ) );
+
+    clArena.Free( (void*)apvAllocs[0] );
+    clArena.Free( (void*)apvAllocs[2] );
+    clArena.Free( (void*)apvAllocs[3] );
+    clArena.GetStats( &clStats );
+    EXPECT_EQUALS( clStats.m_uUsedBytes, 0 );
+    EXPECT_EQUALS( clStats.m_u32Frees, 4 );
+}
+TEST_END
+#endif
+
 //===========================================================================
 Thread clTestThread1;
 Thread clTestThread2;
@@ -260,4 +314,7 @@ TEST_END
 TEST_CASE_START
   TEST_CASE(ut_arena_alloc_free),
   TEST_CASE(ut_arena_multithread),
+#if HEAP_USE_STATS
+  TEST_CASE(ut_arena_stats),
+#endif
 TEST_CASE_END
@@ -0,0 +1,220 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+
+#include "kerneltypes.h"
+#include "kernel.h"
+#include "../ut_platform.h"
+#include "mark3.h"
+
+#if KERNEL_USE_AUTO_ALLOC
+//===========================================================================
+// Local Defines
+//===========================================================================
+#define CHURN_COUNT     (100)
+#define WORKER_STACK    (AUTO_ALLOC_STACK_MIN + 36)
+
+static K_WORD awStack[192];
+static volatile uint16_t u16Runs;
+
+//---------------------------------------------------------------------------
+static void ChurnThread(void *unused_)
+{
+    u16Runs++;
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+#if KERNEL_USE_TIMERS
+//---------------------------------------------------------------------------
+static void ChurnTimer(Thread *pclOwner_, void *pvData_)
+{
+}
+#endif
+
+//===========================================================================
+// Define Test Cases Here
+//===========================================================================
+#if KERNEL_USE_SEMAPHORE
+TEST(ut_autoalloc_recycle)
+{
+    // Test - verify that a destroyed object is handed out again by the next
+    // request for the same type, without using any more of the heap.
+    AutoAllocStats_t stStats;
+    Semaphore *pclSem1;
+    Semaphore *pclSem2;
+    uint16_t u16Free;
+
+    pclSem1 = AutoAlloc::NewSemaphore();
+    pclSem1->Init(0, 1);
+    u16Free = AutoAlloc::GetHeapFree();
+
+    AutoAlloc::DestroySemaphore(pclSem1);
+    pclSem2 = AutoAlloc::NewSemaphore();
+    EXPECT_TRUE( pclSem1 == pclSem2 );
+    EXPECT_EQUALS( AutoAlloc::GetHeapFree(), u16Free );
+
+    // The recycled object is constructed afresh, and usable
+    pclSem2->Init(0, 1);
+    pclSem2->Post();
+    EXPECT_TRUE( pclSem2->Pend(10) );
+
+    AutoAlloc::GetPoolStats(AUTO_ALLOC_TYPE_SEMAPHORE, &stStats);
+    EXPECT_EQUALS( stStats.u16Objects, stStats.u16Peak );
+    EXPECT_EQUALS( stStats.u16InUse, 1 );
+    EXPECT_EQUALS( stStats.u32Allocs, stStats.u32Frees + 1 );
+
+    AutoAlloc::DestroySemaphore(pclSem2);
+    AutoAlloc::GetPoolStats(AUTO_ALLOC_TYPE_SEMAPHORE, &stStats);
+    EXPECT_EQUALS( stStats.u16InUse, 0 );
+}
+TEST_END
+#endif
+
+//===========================================================================
+TEST(ut_autoalloc_churn)
+{
+    // Test - create and destroy threads and timers repeatedly, and verify
+    // that the heap isn't used up, and the pools never grow past one object.
+    AutoAllocStats_t stStats;
+    uint16_t u16Free = 0;
+    uint16_t i;
+
+    u16Runs = 0;
+    for (i = 0; i < CHURN_COUNT; i++)
+    {
+        Thread *pclThread = AutoAlloc::NewThread();
+        // Higher priority than this thread, so it's run to completion (and
+        // exits) as soon as it's started.
+        pclThread->Init(awStack, sizeof(awStack), Scheduler::GetCurrentThread()->GetPriority() + 1, ChurnThread, 0);
+        pclThread->Start();
+        AutoAlloc::DestroyThread(pclThread);
+
+#if KERNEL_USE_TIMERS
+        Timer *pclTimer = AutoAlloc::NewTimer();
+        pclTimer->Init();
+        pclTimer->Start(false, 100, ChurnTimer, 0);
+        AutoAlloc::DestroyTimer(pclTimer);
+#endif
+        if (!i)
+        {
+            u16Free = AutoAlloc::GetHeapFree();
+        }
+    }
+    EXPECT_EQUALS( u16Runs, CHURN_COUNT );
+    EXPECT_EQUALS( AutoAlloc::GetHeapFree(), u16Free );
+
+    AutoAlloc::GetPoolStats(AUTO_ALLOC_TYPE_THREAD, &stStats);
+    EXPECT_EQUALS( stStats.u16Peak, 1 );
+    EXPECT_EQUALS( stStats.u16InUse, 0 );
+    EXPECT_EQUALS( stStats.u32Frees, CHURN_COUNT );
+#if KERNEL_USE_TIMERS
+    AutoAlloc::GetPoolStats(AUTO_ALLOC_TYPE_TIMER, &stStats);
+    EXPECT_EQUALS( stStats.u16Peak, 1 );
+    EXPECT_EQUALS( stStats.u16InUse, 0 );
+#endif
+}
+TEST_END
+
+//===========================================================================
+TEST(ut_autoalloc_worker)
+{
+    // Test - spawn short-lived threads with Thread::Init(u16StackSize_, ...)
+    // and verify that each one's thread object and stack are recycled by the
+    // next, once it exits.
+    AutoAllocStats_t stStats;
+    Thread *pclFirst = 0;
+    uint16_t u16Free = 0;
+    uint16_t i;
+
+    u16Runs = 0;
+    for (i = 0; i < CHURN_COUNT; i++)
+    {
+        Thread *pclThread = Thread::Init(WORKER_STACK, Scheduler::GetCurrentThread()->GetPriority() + 1, ChurnThread, 0);
+        if (!i)
+        {
+            pclFirst = pclThread;
+            u16Free = AutoAlloc::GetHeapFree();
+        }
+        EXPECT_TRUE( pclThread == pclFirst );
+        pclThread->Start();
+    }
+    EXPECT_EQUALS( u16Runs, CHURN_COUNT );
+    EXPECT_EQUALS( AutoAlloc::GetHeapFree(), u16Free );
+
+    // The stack was rounded up to the next size class
+    EXPECT_FALSE( AutoAlloc::GetStackPoolStats(AUTO_ALLOC_STACK_CLASSES, &stStats) );
+    EXPECT_TRUE( AutoAlloc::GetStackPoolStats(1, &stStats) );
+    EXPECT_EQUALS( stStats.u16Objects, 1 );
+    EXPECT_EQUALS( stStats.u16InUse, 0 );
+    EXPECT_EQUALS( stStats.u32Frees, CHURN_COUNT );
+}
+TEST_END
+
+//===========================================================================
+TEST(ut_autoalloc_stack_clean)
+{
+    // Test - verify that a recycled stack is reported clean up to the
+    // deepest point its last user dirtied.
+    uint16_t u16Size = WORKER_STACK;
+    uint16_t u16Clean;
+    uint16_t u16Words;
+    K_WORD *pwStack;
+    K_WORD *pwStack2;
+
+    pwStack = AutoAlloc::NewStack(&u16Size, &u16Clean);
+    EXPECT_EQUALS( u16Size, AUTO_ALLOC_STACK_MIN * 2 );
+    u16Words = u16Size / sizeof(K_WORD);
+
+    // Fill the whole stack, then dirty the top few words, as a thread would
+    for (uint16_t j = 0; j < u16Words; j++)
+    {
+        pwStack[j] = (K_WORD)(-1);
+    }
+    pwStack[u16Words - 1] = 0;
+    pwStack[u16Words - 4] = 0;
+    AutoAlloc::DestroyStack(pwStack, u16Size);
+
+    pwStack2 = AutoAlloc::NewStack(&u16Size, &u16Clean);
+    EXPECT_TRUE( pwStack2 == pwStack );
+    EXPECT_EQUALS( u16Clean, (u16Words - 4) * sizeof(K_WORD) );
+
+    // The free-list link at the bottom of the stack has been refilled
+    EXPECT_TRUE( pwStack2[0] == (K_WORD)(-1) );
+
+    // A deep dirty word isn't hidden by the fill pattern above it
+    pwStack2[u16Words / 4] = 0;
+    AutoAlloc::DestroyStack(pwStack2, u16Size);
+
+    pwStack2 = AutoAlloc::NewStack(&u16Size, &u16Clean);
+    EXPECT_TRUE( pwStack2 == pwStack );
+    EXPECT_EQUALS( u16Clean, (u16Words / 4) * sizeof(K_WORD) );
+    AutoAlloc::DestroyStack(pwStack2, u16Size);
+}
+TEST_END
+#endif // KERNEL_USE_AUTO_ALLOC
+
+//===========================================================================
+// Test Whitelist Goes Here
+//===========================================================================
+TEST_CASE_START
+#if KERNEL_USE_AUTO_ALLOC
+#if KERNEL_USE_SEMAPHORE
+  TEST_CASE(ut_autoalloc_recycle),
+#endif
+  TEST_CASE(ut_autoalloc_churn),
+  TEST_CASE(ut_autoalloc_worker),
+  TEST_CASE(ut_autoalloc_stack_clean),
+#endif
+TEST_CASE_END
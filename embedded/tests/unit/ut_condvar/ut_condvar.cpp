@@ -0,0 +1,171 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+
+#include "kerneltypes.h"
+#include "kernel.h"
+#include "../ut_platform.h"
+#include "mark3.h"
+
+#if KERNEL_USE_CONDVAR
+//===========================================================================
+// Local Defines
+//===========================================================================
+static ConditionVariable clCondVar;
+static Mutex clMutex;
+static Thread aclThread[3];
+static K_WORD awStack[3][192];
+static volatile uint8_t u8Count;
+static volatile uint8_t u8Done;
+static volatile uint8_t au8Order[3];
+static volatile bool bResult;
+
+//---------------------------------------------------------------------------
+static void ConsumerThread(void *unused_)
+{
+    clMutex.Claim();
+    while (!u8Count)
+    {
+        clCondVar.Wait(&clMutex);
+    }
+    u8Count--;
+    au8Order[u8Done++] = Scheduler::GetCurrentThread()->GetPriority();
+    clMutex.Release();
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//===========================================================================
+// Define Test Cases Here
+//===========================================================================
+TEST(ut_condvar_signal)
+{
+    // Test - verify that a waiting thread releases the mutex, and that a
+    // signalled thread is queued on the mutex held by the signaller, rather
+    // than running straight away.
+    Thread *pclMe = Scheduler::GetCurrentThread();
+
+    clCondVar.Init();
+    clMutex.Init();
+    u8Count = 0;
+    u8Done = 0;
+
+    aclThread[0].Init(awStack[0], 192, 2, ConsumerThread, NULL);
+    aclThread[0].Start();
+    EXPECT_EQUALS( u8Done, 0 );
+
+    // The consumer is blocked in Wait() - the mutex is free again
+    clMutex.Claim();
+    u8Count++;
+    clCondVar.Signal();
+    EXPECT_EQUALS( u8Done, 0 );
+
+    // ... And we've inherited the priority of the thread waiting on it
+    EXPECT_EQUALS( pclMe->GetCurPriority(), 2 );
+
+    clMutex.Release();
+    EXPECT_EQUALS( u8Done, 1 );
+    EXPECT_EQUALS( u8Count, 0 );
+    EXPECT_EQUALS( pclMe->GetCurPriority(), 1 );
+
+    // Signalling with no waiters does nothing
+    clCondVar.Signal();
+}
+TEST_END
+
+//===========================================================================
+TEST(ut_condvar_broadcast)
+{
+    // Test - verify that a broadcast wakes every waiter, and that they are
+    // handed the mutex in priority order.
+    uint8_t i;
+
+    clCondVar.Init();
+    clMutex.Init();
+    u8Count = 0;
+    u8Done = 0;
+
+    for (i = 0; i < 3; i++)
+    {
+        aclThread[i].Init(awStack[i], 192, 2 + i, ConsumerThread, NULL);
+        aclThread[i].Start();
+    }
+    EXPECT_EQUALS( u8Done, 0 );
+
+    clMutex.Claim();
+    u8Count = 3;
+    clCondVar.Broadcast();
+    EXPECT_EQUALS( u8Done, 0 );
+    clMutex.Release();
+
+    EXPECT_EQUALS( u8Done, 3 );
+    EXPECT_EQUALS( au8Order[0], 4 );
+    EXPECT_EQUALS( au8Order[1], 3 );
+    EXPECT_EQUALS( au8Order[2], 2 );
+}
+TEST_END
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+static void TimedWaitThread(void *unused_)
+{
+    clMutex.Claim();
+    bResult = clCondVar.Wait(&clMutex, 100);
+    u8Done++;
+    clMutex.Release();
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//===========================================================================
+TEST(ut_condvar_timeout)
+{
+    // Test - verify that a timed wait expires with the mutex held again, and
+    // that a signal within the timeout is reported as such.
+    clCondVar.Init();
+    clMutex.Init();
+    u8Done = 0;
+    bResult = false;
+
+    clMutex.Claim();
+    EXPECT_FALSE( clCondVar.Wait(&clMutex, 10) );
+    clMutex.Release();
+
+    aclThread[0].Init(awStack[0], 192, 2, TimedWaitThread, NULL);
+    aclThread[0].Start();
+    EXPECT_EQUALS( u8Done, 0 );
+
+    clCondVar.Signal();
+    EXPECT_EQUALS( u8Done, 1 );
+    EXPECT_TRUE( bResult );
+
+    // Make sure the mutex was released again by the waiter
+    EXPECT_TRUE( clMutex.Claim(10) );
+    clMutex.Release();
+}
+TEST_END
+#endif
+#endif // KERNEL_USE_CONDVAR
+
+//===========================================================================
+// Test Whitelist Goes Here
+//===========================================================================
+TEST_CASE_START
+#if KERNEL_USE_CONDVAR
+  TEST_CASE(ut_condvar_signal),
+  TEST_CASE(ut_condvar_broadcast),
+#if KERNEL_USE_TIMEOUTS
+  TEST_CASE(ut_condvar_timeout),
+#endif
+#endif
+TEST_CASE_END
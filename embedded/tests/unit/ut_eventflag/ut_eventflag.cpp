@@ -64,6 +64,17 @@ void WaitOnMultiAll(void *unused_)
     Scheduler::GetCurrentThread()->Exit();
 }
 
+#if KERNEL_EVENTFLAG_32BIT
+//---------------------------------------------------------------------------
+void WaitOnHighAny(void *unused_)
+{
+    clFlagGroup.Wait(0x80000000, EVENT_FLAG_ANY);
+    u8FlagCount++;
+
+    Scheduler::GetCurrentThread()->Exit();
+}
+#endif
+
 //---------------------------------------------------------------------------
 void WaitOnAny(void *mask_)
 {
@@ -535,6 +546,62 @@ TEST(ut_timedwait)
 }
 TEST_END
 
+//===========================================================================
+TEST(ut_flag_mixedwait)
+{
+    // Test - threads waiting on different conditions on the same object are
+    // each woken only once their own condition is met, as the flags are set
+    // piecemeal.
+
+    // The previous test leaves clThread1 blocked in a timed wait - retire both
+    // threads before they're re-initialized.
+    clThread1.Exit();
+    clThread2.Exit();
+
+    clFlagGroup.Init();
+    u8FlagCount = 0;
+
+    clThread1.Init(aucThreadStack1, THREAD1_STACK_SIZE, 7, WaitOnMultiAll, 0);
+    clThread2.Init(aucThreadStack2, THREAD2_STACK_SIZE, 7, WaitOnFlag1Any, 0);
+
+    clThread1.Start();
+    clThread2.Start();
+
+    Thread::Sleep(10);
+
+    // Test point - part of the "all" pattern, and none of the "any" pattern
+    clFlagGroup.Set(0x4000);
+    Thread::Sleep(10);
+    EXPECT_EQUALS(u8FlagCount, 0);
+
+    // Test point - the "any" pattern only
+    clFlagGroup.Set(0x0001);
+    Thread::Sleep(10);
+    EXPECT_EQUALS(u8FlagCount, 1);
+
+    // Test point - the rest of the "all" pattern
+    clFlagGroup.Set(0x1554);
+    Thread::Sleep(10);
+    EXPECT_EQUALS(u8FlagCount, 2);
+
+#if KERNEL_EVENTFLAG_32BIT
+    // Test point - flags above the 16-bit range
+    clFlagGroup.Clear(0xFFFFFFFF);
+    clThread1.Init(aucThreadStack1, THREAD1_STACK_SIZE, 7, WaitOnHighAny, 0);
+    clThread1.Start();
+    Thread::Sleep(10);
+
+    clFlagGroup.Set(0x7FFFFFFF);
+    Thread::Sleep(10);
+    EXPECT_EQUALS(u8FlagCount, 2);
+
+    clFlagGroup.Set(0x80000000);
+    Thread::Sleep(10);
+    EXPECT_EQUALS(u8FlagCount, 3);
+#endif
+}
+TEST_END
+
 //===========================================================================
 // Test Whitelist Goes Here
 //===========================================================================
@@ -543,4 +610,5 @@ TEST_CASE_START
   TEST_CASE(ut_waitall),
   TEST_CASE(ut_flag_multiwait),
   TEST_CASE(ut_timedwait),
+  TEST_CASE(ut_flag_mixedwait),
 TEST_CASE_END
@@ -184,7 +184,7 @@ TEST_END
 //===========================================================================
 void HeapScriptTest(void *pvParam_)
 {
-    uint16_t u16Index = ((uint16_t)pvParam_);
+    uint16_t u16Index = ((uint16_t)(K_ADDR)pvParam_);
     uint16_t i;
 
     void *pvData;
@@ -289,6 +289,145 @@ TEST(ut_sysheap_multithread)
 }
 TEST_END
 
+//===========================================================================
+// Block sizes chosen so that several share a lookup-table entry, and others
+// are far apart.
+#define CLASS_NODE_SIZE     (sizeof(LinkListNode) + sizeof(void*))
+#define CLASS_HEAP_SIZE     (((4 + CLASS_NODE_SIZE) * 2) + ((6 + CLASS_NODE_SIZE) * 2) + \
+                             ((40 + CLASS_NODE_SIZE) * 2) + ((200 + CLASS_NODE_SIZE) * 1))
+static K_ADDR auClassHeap[(CLASS_HEAP_SIZE + sizeof(K_ADDR) - 1) / sizeof(K_ADDR)];
+static HeapConfig aclClassConfig[5];
+static FixedHeap clClassHeap;
+
+//===========================================================================
+// Check that allocations come from the smallest block size that fits and
+// has free blocks, falling back to larger sizes as the smaller ones run out.
+TEST(ut_fixedheap_size_class)
+{
+    static const uint16_t au16Sizes[] = { 4, 6, 40, 200, 0 };
+    static const uint16_t au16Counts[] = { 2, 2, 2, 1, 0 };
+    void *apvSmall[2];
+    void *pvData;
+    uint16_t i;
+
+    for (i = 0; i < 5; i++)
+    {
+        aclClassConfig[i].m_u16BlockSize = au16Sizes[i];
+        aclClassConfig[i].m_u16BlockCount = au16Counts[i];
+    }
+    clClassHeap.Create( auClassHeap, aclClassConfig );
+
+    // Too large for any block
+    EXPECT_FALSE( clClassHeap.Alloc( 201 ) );
+
+    // 5 bytes skips the 4-byte blocks, using up every other block
+    for (i = 0; i < 5; i++)
+    {
+        apvAllocs[i] = clClassHeap.Alloc( 5 );
+        EXPECT_TRUE( apvAllocs[i] != 0 );
+    }
+    EXPECT_FALSE( clClassHeap.Alloc( 5 ) );
+
+    // ...leaving the 4-byte blocks free
+    apvSmall[0] = clClassHeap.Alloc( 1 );
+    apvSmall[1] = clClassHeap.Alloc( 4 );
+    EXPECT_TRUE( apvSmall[0] && apvSmall[1] );
+    EXPECT_FALSE( clClassHeap.Alloc( 1 ) );
+
+    // A freed 6-byte block is reused
+    pvData = (void*)apvAllocs[0];
+    FixedHeap::Free( pvData );
+    EXPECT_TRUE( clClassHeap.Alloc( 6 ) == pvData );
+
+    // Free the 200-byte block (allocated last), and it's the only fit for
+    // anything over 40 bytes
+    FixedHeap::Free( (void*)apvAllocs[4] );
+    EXPECT_TRUE( clClassHeap.Alloc( 41 ) == apvAllocs[4] );
+
+    // A heap created with no block sizes fails every allocation
+    aclClassConfig[0].m_u16BlockSize = 0;
+    aclClassConfig[0].m_u16BlockCount = 0;
+    clClassHeap.Create( auClassHeap, aclClassConfig );
+    EXPECT_FALSE( clClassHeap.Alloc( 0 ) );
+    EXPECT_FALSE( clClassHeap.Alloc( 1 ) );
+    EXPECT_FALSE( clClassHeap.Alloc( 200 ) );
+}
+TEST_END
+
+#if HEAP_USE_STATS
+//===========================================================================
+static uint16_t u16DumpLines;
+static void DumpPrint( const char *szText_ )
+{
+    while (*szText_)
+    {
+        if (*szText_++ == '\n')
+        {
+            u16DumpLines++;
+        }
+    }
+}
+
+//===========================================================================
+// Check the per-block-size counters, and the heap-wide figures derived from
+// them.
+TEST(ut_fixedheap_stats)
+{
+    static const uint16_t au16Sizes[] = { 4, 6, 40, 200, 0 };
+    static const uint16_t au16Counts[] = { 2, 2, 2, 1, 0 };
+    HeapStats clStats;
+    HeapClassStats clClass;
+    uint16_t i;
+
+    for (i = 0; i < 5; i++)
+    {
+        aclClassConfig[i].m_u16BlockSize = au16Sizes[i];
+        aclClassConfig[i].m_u16BlockCount = au16Counts[i];
+    }
+    clClassHeap.Create( auClassHeap, aclClassConfig );
+
+    // Too large for any block - counted against the largest
+    EXPECT_FALSE( clClassHeap.Alloc( 201 ) );
+
+    // Two 6-byte blocks, one 40-byte block and one 4-byte block, then free
+    // one of the 6-byte blocks.
+    for (i = 0; i < 3; i++)
+    {
+        apvAllocs[i] = clClassHeap.Alloc( 5 );
+    }
+    apvAllocs[3] = clClassHeap.Alloc( 1 );
+    FixedHeap::Free( (void*)apvAllocs[0] );
+
+    EXPECT_TRUE( clClassHeap.GetClassStats( 1, &clClass ) );
+    EXPECT_EQUALS( clClass.m_uBlockSize, 6 );
+    EXPECT_EQUALS( clClass.m_u16Current, 1 );
+    EXPECT_EQUALS( clClass.m_u16Peak, 2 );
+    EXPECT_EQUALS( clClass.m_u32Allocs, 2 );
+    EXPECT_EQUALS( clClass.m_u32Frees, 1 );
+    EXPECT_TRUE( clClassHeap.GetClassStats( 3, &clClass ) );
+    EXPECT_EQUALS( clClass.m_u16Current, 0 );
+    EXPECT_EQUALS( clClass.m_u32Fails, 1 );
+    EXPECT_FALSE( clClassHeap.GetClassStats( 4, &clClass ) );
+
+    clClassHeap.GetStats( &clStats );
+    EXPECT_EQUALS( clStats.m_u8Classes, 4 );
+    EXPECT_EQUALS( clStats.m_u32Allocs, 4 );
+    EXPECT_EQUALS( clStats.m_u32Frees, 1 );
+    EXPECT_EQUALS( clStats.m_u32Fails, 1 );
+    EXPECT_EQUALS( clStats.m_uUsedBytes, 4 + 6 + 40 );
+    EXPECT_EQUALS( clStats.m_uPeakBytes, 4 + 12 + 40 );
+    EXPECT_EQUALS( clStats.m_uFreeBytes, 4 + 6 + 40 + 200 );
+    EXPECT_EQUALS( clStats.m_uLargestFree, 200 );
+    EXPECT_EQUALS( clStats.m_u8Fragmentation, 20 );
+
+    // One line for the heap, and one per block size
+    u16DumpLines = 0;
+    HeapDump::Print( "heap", &clClassHeap, DumpPrint );
+    EXPECT_EQUALS( u16DumpLines, 5 );
+}
+TEST_END
+#endif
+
 //===========================================================================
 // Test Whitelist Goes Here
 //===========================================================================
@@ -296,4 +435,8 @@ TEST_CASE_START
   TEST_CASE(ut_sysheap_calibrate),
   TEST_CASE(ut_sysheap_alloc_free),
   TEST_CASE(ut_sysheap_multithread),
+  TEST_CASE(ut_fixedheap_size_class),
+#if HEAP_USE_STATS
+  TEST_CASE(ut_fixedheap_stats),
+#endif
 TEST_CASE_END
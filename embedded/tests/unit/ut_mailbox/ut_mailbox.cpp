@@ -180,6 +180,109 @@ TEST(mailbox_send_blocking)
 }
 TEST_END
 
+TEST(mailbox_claim_peek)
+{
+    MailboxSlot_t stSlot;
+    uint8_t *pu8Slot;
+    clMbox.Init((void*)aucMBoxBuffer, 128, 16);
+
+    // Fill the mailbox in-place through claimed slots
+    for (int i = 0; i < 8; i++)
+    {
+        pu8Slot = (uint8_t*)clMbox.ClaimSendSlot(&stSlot);
+        EXPECT_TRUE(pu8Slot != 0);
+        for (int j = 0; j < 16; j++)
+        {
+            pu8Slot[j] = aucTxBuf[j] + i;
+        }
+        clMbox.CommitSend(&stSlot);
+    }
+    EXPECT_TRUE(clMbox.IsFull());
+    EXPECT_TRUE(clMbox.ClaimSendSlot(&stSlot) == 0);
+    EXPECT_TRUE(clMbox.ClaimSendSlot(&stSlot, 10) == 0);
+
+    // Read the envelopes back in-place, oldest first.
+    for (int i = 0; i < 8; i++)
+    {
+        pu8Slot = (uint8_t*)clMbox.PeekReceiveTail(&stSlot);
+        for (int j = 0; j < 16; j++)
+        {
+            aucRxBuf[j] = aucTxBuf[j] + i;
+        }
+        EXPECT_TRUE( MemUtil::CompareMemory((void*)aucRxBuf, (void*)pu8Slot, 16) );
+        clMbox.ReleaseReceive(&stSlot);
+    }
+    EXPECT_TRUE(clMbox.IsEmpty());
+    EXPECT_TRUE(clMbox.PeekReceive(&stSlot, 10) == 0);
+
+    // Claimed slots and copied envelopes are interchangeable
+    pu8Slot = (uint8_t*)clMbox.ClaimSendSlot(&stSlot);
+    for (int j = 0; j < 16; j++)
+    {
+        pu8Slot[j] = aucTxBuf[j];
+    }
+    clMbox.CommitSend(&stSlot);
+    clMbox.Receive((void*)aucRxBuf);
+    EXPECT_TRUE( MemUtil::CompareMemory((void*)aucRxBuf, (void*)aucTxBuf, 16) );
+}
+TEST_END
+
+static volatile bool bIsrSent;
+#if KERNEL_USE_TIMERS && !KERNEL_USE_TIMER_THREAD
+//---------------------------------------------------------------------------
+static void IsrSendCallback(Thread *pclOwner_, void *pvData_)
+{
+    // Runs from the timer interrupt
+    bIsrSent = clMbox.Send((void*)aucTxBuf);
+}
+#endif
+
+TEST(mailbox_claim_nested_isr)
+{
+    // Test - an ISR sending to the mailbox between a thread's claim and
+    // commit mustn't clobber the scheduler state the thread restores.
+    MailboxSlot_t stSlot;
+    uint8_t *pu8Slot;
+    clMbox.Init((void*)aucMBoxBuffer, 128, 16);
+
+    EXPECT_TRUE(Scheduler::IsEnabled());
+    pu8Slot = (uint8_t*)clMbox.ClaimSendSlot(&stSlot);
+    EXPECT_TRUE(pu8Slot != 0);
+    EXPECT_FALSE(Scheduler::IsEnabled());
+
+    bIsrSent = false;
+#if KERNEL_USE_TIMERS && !KERNEL_USE_TIMER_THREAD
+    // Nothing may block while the slot is claimed, so spin for the ISR
+    Timer clTimer;
+    clTimer.Init();
+    clTimer.Start(false, 5, IsrSendCallback, 0);
+    for (volatile uint32_t i = 0; !bIsrSent && (i < 0x40000000); i++) { }
+    clTimer.Stop();
+#else
+    // No interrupt-context timer callbacks - make the same calls inline
+    bIsrSent = clMbox.Send((void*)aucTxBuf);
+#endif
+    EXPECT_TRUE(bIsrSent);
+    EXPECT_FALSE(Scheduler::IsEnabled());
+
+    for (int j = 0; j < 16; j++)
+    {
+        pu8Slot[j] = aucTxBuf[j];
+    }
+    clMbox.CommitSend(&stSlot);
+    EXPECT_TRUE(Scheduler::IsEnabled());
+    EXPECT_EQUALS(clMbox.GetFreeSlots(), 6);
+
+    // Peeking from a thread while an ISR receives is just as independent
+    EXPECT_TRUE(clMbox.PeekReceive(&stSlot) != 0);
+    EXPECT_FALSE(Scheduler::IsEnabled());
+    clMbox.Receive((void*)aucRxBuf);
+    clMbox.ReleaseReceive(&stSlot);
+    EXPECT_TRUE(Scheduler::IsEnabled());
+    EXPECT_TRUE(clMbox.IsEmpty());
+}
+TEST_END
+
 //===========================================================================
 // Test Whitelist Goes Here
 //===========================================================================
@@ -188,4 +291,6 @@ TEST_CASE_START
   TEST_CASE(mailbox_blocking_receive),
   TEST_CASE(mailbox_blocking_timed),
   TEST_CASE(mailbox_send_blocking),
+  TEST_CASE(mailbox_claim_peek),
+  TEST_CASE(mailbox_claim_nested_isr),
 TEST_CASE_END
@@ -69,7 +69,7 @@ void MsgConsumer(void *unused_)
                 {
                     u8PassCount++;
                 }
-                if (7331 == (uint16_t)(pclMsg->GetData()))
+                if (7331 == (uint16_t)(K_ADDR)(pclMsg->GetData()))
                 {
                     u8PassCount++;
                 }
@@ -79,7 +79,7 @@ void MsgConsumer(void *unused_)
                 {
                     u8PassCount++;
                 }
-                if (0xC0C0 == (uint16_t)(pclMsg->GetData()))
+                if (0xC0C0 == (uint16_t)(K_ADDR)(pclMsg->GetData()))
                 {
                     u8PassCount++;
                 }
@@ -230,6 +230,134 @@ TEST(ut_message_timed_rx)
 }
 TEST_END
 
+#define BATCH_SIZE  (4)
+static Message *apclBatchRx[BATCH_SIZE];
+static volatile uint16_t u16BatchCount;
+//===========================================================================
+void MsgBatchConsumer(void *unused_)
+{
+    while(1)
+    {
+        u16BatchCount = clMsgQ.ReceiveBatch(apclBatchRx, BATCH_SIZE);
+        GlobalMessagePool::PushN(apclBatchRx, u16BatchCount);
+    }
+}
+
+//===========================================================================
+TEST(ut_message_batch)
+{
+    // Test - verify that a batch of messages can be popped from the global
+    // pool, sent in one call, and received in order in one or more calls.
+    Message *apclTx[BATCH_SIZE];
+    Message *apclRx[BATCH_SIZE];
+    uint16_t i;
+
+    GlobalMessagePool::Init();
+    clMsgQ.Init();
+
+    EXPECT_EQUALS( GlobalMessagePool::PopN(apclTx, BATCH_SIZE), BATCH_SIZE );
+    for (i = 0; i < BATCH_SIZE; i++)
+    {
+        apclTx[i]->SetCode(i);
+    }
+
+    clMsgQ.SendBatch(apclTx, BATCH_SIZE);
+    EXPECT_EQUALS( clMsgQ.GetCount(), BATCH_SIZE );
+
+    // Only take as many messages as the caller asks for...
+    EXPECT_EQUALS( clMsgQ.ReceiveBatch(apclRx, BATCH_SIZE - 1), BATCH_SIZE - 1 );
+    for (i = 0; i < BATCH_SIZE - 1; i++)
+    {
+        EXPECT_EQUALS( apclRx[i]->GetCode(), i );
+    }
+    EXPECT_EQUALS( clMsgQ.GetCount(), 1 );
+
+    // ...and only as many as are queued.
+    EXPECT_EQUALS( clMsgQ.ReceiveBatch(&apclRx[BATCH_SIZE - 1], BATCH_SIZE, 10), 1 );
+    EXPECT_EQUALS( apclRx[BATCH_SIZE - 1]->GetCode(), BATCH_SIZE - 1 );
+
+    // Empty queue - the batch receive should time out
+    EXPECT_EQUALS( clMsgQ.ReceiveBatch(apclRx, BATCH_SIZE, 10), 0 );
+
+    // Test - a receiver blocked on an empty queue gets the whole batch
+    // once it is woken.
+    u16BatchCount = 0;
+    clMsgThread.Init(aucMsgStack, MSG_STACK_SIZE, 7, MsgBatchConsumer, 0);
+    clMsgThread.Start();
+
+    clMsgQ.SendBatch(apclRx, BATCH_SIZE);
+    EXPECT_EQUALS( u16BatchCount, BATCH_SIZE );
+    EXPECT_EQUALS( clMsgQ.GetCount(), 0 );
+    for (i = 0; i < BATCH_SIZE; i++)
+    {
+        EXPECT_EQUALS( apclBatchRx[i]->GetCode(), i );
+    }
+
+    clMsgThread.Exit();
+
+    // Test - PopN stops when the pool runs dry.
+    for (i = 0; i < (GLOBAL_MESSAGE_POOL_SIZE / BATCH_SIZE); i++)
+    {
+        EXPECT_EQUALS( GlobalMessagePool::PopN(apclTx, BATCH_SIZE), BATCH_SIZE );
+    }
+    EXPECT_EQUALS( GlobalMessagePool::PopN(apclTx, BATCH_SIZE), (GLOBAL_MESSAGE_POOL_SIZE % BATCH_SIZE) );
+
+    // Test is over - re-init the pool..
+    GlobalMessagePool::Init();
+}
+TEST_END
+
+#if KERNEL_USE_MESSAGE_PRIORITY
+//===========================================================================
+TEST(ut_message_priority)
+{
+    // Test - verify that messages are received highest-class first, and in
+    // order of transmission within each class.
+    static const uint8_t au8Class[] = { 0, 1, 0, KERNEL_MESSAGE_PRIORITY_CLASSES - 1, 1 };
+    static const uint16_t au16Order[] = { 3, 1, 4, 0, 2 };
+    Message *apclMsg[5];
+    uint16_t i;
+
+    GlobalMessagePool::Init();
+    clMsgQ.Init();
+
+    EXPECT_EQUALS( GlobalMessagePool::PopN(apclMsg, 5), 5 );
+    for (i = 0; i < 5; i++)
+    {
+        apclMsg[i]->SetCode(i);
+        apclMsg[i]->SetPriority(au8Class[i]);
+        clMsgQ.Send(apclMsg[i]);
+    }
+    EXPECT_EQUALS( clMsgQ.GetCount(), 5 );
+
+    for (i = 0; i < 5; i++)
+    {
+        Message *pclMsg = clMsgQ.Receive();
+        EXPECT_EQUALS( pclMsg->GetCode(), au16Order[i] );
+    }
+
+    // Test - an urgent message sent after a batch is received first
+    for (i = 0; i < 4; i++)
+    {
+        apclMsg[i]->SetPriority(0);
+    }
+    apclMsg[4]->SetPriority(KERNEL_MESSAGE_PRIORITY_CLASSES - 1);
+    clMsgQ.SendBatch(apclMsg, 4);
+    clMsgQ.Send(apclMsg[4]);
+
+    EXPECT_EQUALS( clMsgQ.ReceiveBatch(apclMsg, 5), 5 );
+    EXPECT_EQUALS( apclMsg[0]->GetCode(), 4 );
+    for (i = 1; i < 5; i++)
+    {
+        EXPECT_EQUALS( apclMsg[i]->GetCode(), i - 1 );
+    }
+
+    // Test is over - re-init the pool..
+    GlobalMessagePool::Init();
+}
+TEST_END
+#endif
+
 //===========================================================================
 // Test Whitelist Goes Here
 //===========================================================================
@@ -237,4 +365,8 @@ TEST_CASE_START
   TEST_CASE(ut_message_tx_rx),
   TEST_CASE(ut_message_exhaust),
   TEST_CASE(ut_message_timed_rx),
+  TEST_CASE(ut_message_batch),
+#if KERNEL_USE_MESSAGE_PRIORITY
+  TEST_CASE(ut_message_priority),
+#endif
 TEST_CASE_END
@@ -19,6 +19,7 @@ See license.txt for more information
 #include "../ut_platform.h"
 #include "thread.h"
 #include "mutex.h"
+#include "ksemaphore.h"
 
 //===========================================================================
 // Local Defines
@@ -29,7 +30,15 @@ static Thread clMutexThread;
 
 static K_WORD aucTestStack2[MUTEX_STACK_SIZE];
 static Thread clTestThread2;
+
+static K_WORD aucTestStack3[MUTEX_STACK_SIZE];
+static Thread clTestThread3;
 static volatile uint8_t u8Token;
+static volatile PRIO_TYPE uXReleasePri;
+
+static Mutex clMutexA;
+static Mutex clMutexB;
+static Semaphore clHoldSem;
 
 //===========================================================================
 // Define Test Cases Here
@@ -196,6 +205,139 @@ TEST(ut_priority_mutex)
 TEST_END
 
 
+//===========================================================================
+void ChainLowThread(void *unused_)
+{
+    // Hold A until the test lets us go
+    clMutexA.Claim();
+    clHoldSem.Pend();
+    clMutexA.Release();
+    uXReleasePri = Scheduler::GetCurrentThread()->GetCurPriority();
+    u8Token++;
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//===========================================================================
+void ChainMidThread(void *unused_)
+{
+    // Hold B, and block on A
+    clMutexB.Claim();
+    clMutexA.Claim();
+    clMutexA.Release();
+    clMutexB.Release();
+    u8Token++;
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//===========================================================================
+void ClaimReleaseThread(void *mutex_)
+{
+    Mutex *pclMutex = (Mutex*)mutex_;
+
+    pclMutex->Claim();
+    pclMutex->Release();
+    u8Token++;
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//===========================================================================
+TEST(ut_transitive_mutex)
+{
+    // Test - Transitive priority inheritence.  A high-priority thread blocks
+    // on a mutex held by a thread that's itself blocked on a mutex held by a
+    // low-priority thread - both owners should be boosted.
+    Scheduler::GetCurrentThread()->SetPriority(1);
+    clMutexA.Init();
+    clMutexB.Init();
+    clHoldSem.Init(0, 1);
+    u8Token = 0;
+
+    clMutexThread.Init(aucTestStack, MUTEX_STACK_SIZE, 2, ChainLowThread, NULL);
+    clTestThread2.Init(aucTestStack2, MUTEX_STACK_SIZE, 3, ChainMidThread, NULL);
+    clTestThread3.Init(aucTestStack3, MUTEX_STACK_SIZE, 5, ClaimReleaseThread, (void*)&clMutexB);
+
+    clMutexThread.Start();
+    clTestThread2.Start();
+    EXPECT_EQUALS( clMutexThread.GetCurPriority(), 3 );
+
+    clTestThread3.Start();
+    EXPECT_EQUALS( clTestThread2.GetCurPriority(), 5 );
+    EXPECT_EQUALS( clMutexThread.GetCurPriority(), 5 );
+    EXPECT_EQUALS( u8Token, 0 );
+
+    // Let the chain unwind - everyone completes, and drops back down
+    clHoldSem.Post();
+    EXPECT_EQUALS( u8Token, 3 );
+    EXPECT_EQUALS( uXReleasePri, 2 );
+}
+TEST_END
+
+//===========================================================================
+TEST(ut_nested_mutex)
+{
+    // Test - Nested priority inheritence.  Releasing one of two boosted
+    // mutexes must only drop the owner to the priority still inherited
+    // through the other one.
+    Thread *pclMe = Scheduler::GetCurrentThread();
+
+    pclMe->SetPriority(1);
+    clMutexA.Init();
+    clMutexB.Init();
+    u8Token = 0;
+
+    clMutexA.Claim();
+    clMutexB.Claim();
+
+    clMutexThread.Init(aucTestStack, MUTEX_STACK_SIZE, 3, ClaimReleaseThread, (void*)&clMutexA);
+    clTestThread2.Init(aucTestStack2, MUTEX_STACK_SIZE, 2, ClaimReleaseThread, (void*)&clMutexB);
+    clMutexThread.Start();
+    clTestThread2.Start();
+    EXPECT_EQUALS( pclMe->GetCurPriority(), 3 );
+
+    clMutexA.Release();
+    EXPECT_EQUALS( u8Token, 1 );
+    EXPECT_EQUALS( pclMe->GetCurPriority(), 2 );
+
+    clMutexB.Release();
+    EXPECT_EQUALS( u8Token, 2 );
+    EXPECT_EQUALS( pclMe->GetCurPriority(), 1 );
+}
+TEST_END
+
+#if KERNEL_USE_MUTEX_CEILING
+//===========================================================================
+void CeilingTokenThread(void *unused_)
+{
+    u8Token++;
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//===========================================================================
+TEST(ut_ceiling_mutex)
+{
+    // Test - Immediate priority ceiling.  Claiming the mutex raises the
+    // owner to the ceiling straight away, so threads below the ceiling can't
+    // preempt it until it's released.
+    Thread *pclMe = Scheduler::GetCurrentThread();
+
+    pclMe->SetPriority(1);
+    clMutexA.Init(4);
+    u8Token = 0;
+
+    clMutexA.Claim();
+    EXPECT_EQUALS( pclMe->GetCurPriority(), 4 );
+
+    clMutexThread.Init(aucTestStack, MUTEX_STACK_SIZE, 3, CeilingTokenThread, NULL);
+    clMutexThread.Start();
+    EXPECT_EQUALS( u8Token, 0 );
+
+    clMutexA.Release();
+    EXPECT_EQUALS( u8Token, 1 );
+    EXPECT_EQUALS( pclMe->GetCurPriority(), 1 );
+}
+TEST_END
+#endif
+
 //===========================================================================
 // Test Whitelist Goes Here
 //===========================================================================
@@ -203,5 +345,10 @@ TEST_CASE_START
   TEST_CASE(ut_typical_mutex),
   TEST_CASE(ut_timed_mutex),
   TEST_CASE(ut_priority_mutex),
+  TEST_CASE(ut_transitive_mutex),
+  TEST_CASE(ut_nested_mutex),
+#if KERNEL_USE_MUTEX_CEILING
+  TEST_CASE(ut_ceiling_mutex),
+#endif
 TEST_CASE_END
 
@@ -81,10 +81,100 @@ TEST(ut_notify_timeout)
 }
 TEST_END
 
+#if KERNEL_USE_THREAD_NOTIFICATION
+static Thread clWaitThread;
+static K_WORD awWaitStack[192];
+static volatile uint32_t au32Bits[2];
+
+//---------------------------------------------------------------------------
+static void NotificationThread(void *unused_)
+{
+    while(1)
+    {
+        au32Bits[0] = Thread::WaitNotification(0x0F);
+        u8Count++;
+    }
+}
+
+//---------------------------------------------------------------------------
+static void NotificationTimedThread(void *unused_)
+{
+    au32Bits[0] = Thread::WaitNotification(0x01, 10);
+    u8Count++;
+    au32Bits[1] = Thread::WaitNotification(0x01, 1000);
+    u8Count++;
+    while(1)
+    {
+        Thread::WaitNotification(0x01);
+    }
+}
+
+//===========================================================================
+TEST(ut_thread_notification)
+{
+    u8Count = 0;
+    clWaitThread.Init(awWaitStack, 192, 7, NotificationThread, NULL);
+    clWaitThread.Start();
+    EXPECT_EQUALS(clWaitThread.GetState(), THREAD_STATE_BLOCKED);
+
+    // Bits outside the waiter's mask don't wake it
+    clWaitThread.SendNotification(0x10, NOTIFY_SET_BITS);
+    EXPECT_EQUALS(u8Count, 0);
+
+    // Bits inside the mask do, and only those bits are consumed
+    clWaitThread.SendNotification(0x03, NOTIFY_SET_BITS);
+    EXPECT_EQUALS(u8Count, 1);
+    EXPECT_EQUALS(au32Bits[0], 0x03);
+    EXPECT_EQUALS(clWaitThread.GetNotification(), 0x10);
+
+    clWaitThread.SendNotification(0x04, NOTIFY_OVERWRITE);
+    EXPECT_EQUALS(u8Count, 2);
+    EXPECT_EQUALS(au32Bits[0], 0x04);
+    EXPECT_EQUALS(clWaitThread.GetNotification(), 0);
+
+    clWaitThread.SendNotification(0, NOTIFY_INCREMENT);
+    EXPECT_EQUALS(u8Count, 3);
+    EXPECT_EQUALS(au32Bits[0], 1);
+
+    // Stopping a thread that's waiting on its notification word
+    clWaitThread.Stop();
+    EXPECT_EQUALS(clWaitThread.GetState(), THREAD_STATE_STOP);
+    clWaitThread.Exit();
+}
+TEST_END
+
+//===========================================================================
+TEST(ut_thread_notification_timeout)
+{
+    u8Count = 0;
+    au32Bits[0] = 0xFF;
+    au32Bits[1] = 0;
+    clWaitThread.Init(awWaitStack, 192, 7, NotificationTimedThread, NULL);
+    clWaitThread.Start();
+
+    // Let the first wait time out
+    Thread::Sleep(20);
+    EXPECT_EQUALS(u8Count, 1);
+    EXPECT_EQUALS(au32Bits[0], 0);
+
+    // The second wait is satisfied before its timeout
+    clWaitThread.SendNotification(0x01, NOTIFY_SET_BITS);
+    EXPECT_EQUALS(u8Count, 2);
+    EXPECT_EQUALS(au32Bits[1], 0x01);
+
+    clWaitThread.Exit();
+}
+TEST_END
+#endif
+
 //===========================================================================
 // Test Whitelist Goes Here
 //===========================================================================
 TEST_CASE_START
   TEST_CASE(ut_notify),
   TEST_CASE(ut_notify_timeout),
+#if KERNEL_USE_THREAD_NOTIFICATION
+  TEST_CASE(ut_thread_notification),
+  TEST_CASE(ut_thread_notification_timeout),
+#endif
 TEST_CASE_END
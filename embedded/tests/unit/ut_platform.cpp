@@ -23,6 +23,9 @@ See license.txt for more information
 #if defined(AVR)
 #include <avr/io.h>
 #include <avr/sleep.h>
+#elif defined(POSIX)
+#include <stdlib.h>
+#include <unistd.h>
 #endif
 
 extern "C"
@@ -35,12 +38,17 @@ void __cxa_pure_virtual(void) {}
 static Thread AppThread;			//!< Main "application" thread
 static K_WORD aucAppStack[STACK_SIZE_APP];
 
+#if defined(POSIX)
+static PosixUART clUART;			//!< UART device driver object (stdio)
+static bool bFailed;				//!< Set when any test fails
+#else
 static ATMegaUART clUART;			//!< UART device driver object
+#endif
 
 //---------------------------------------------------------------------------
 #if !KERNEL_USE_IDLE_FUNC
 static Thread IdleThread;			//!< Idle thread - runs when app can't
-static uint8_t aucIdleStack[STACK_SIZE_IDLE];
+static K_WORD aucIdleStack[STACK_SIZE_IDLE];
 #endif
 
 //---------------------------------------------------------------------------
@@ -76,6 +84,9 @@ void MyUnitTest::PrintTestResult()
     else
     {
         PrintString("(FAIL)[");
+#if defined(POSIX)
+        bFailed = true;
+#endif
     }
     MemUtil::DecimalToString(GetPassed(), (char*)acTemp);
     PrintString((const char*)acTemp);
@@ -100,8 +111,15 @@ void run_tests()
     PrintString("--DONE--\n");
     Thread::Sleep(100);
 
+#if defined(POSIX)
+    // Report the result to the host through the exit status.  Static objects
+    // (i.e. the running thread) must not be destroyed, so skip the atexit()
+    // processing.
+    _exit(bFailed ? EXIT_FAILURE : EXIT_SUCCESS);
+#else
     FuncPtr pfReset = 0;
     pfReset();
+#endif
 }
 
 //---------------------------------------------------------------------------
@@ -155,6 +173,11 @@ void IdleEntry(void)
     {
 #endif
 
+#if KERNEL_USE_TICKLESS_IDLE
+        // Use the tickless idle states registered by a test, if any
+        TicklessIdle::Enter();
+#endif
+
 #if defined(AVR)
         // LPM code;
         set_sleep_mode(SLEEP_MODE_IDLE);
@@ -164,6 +187,8 @@ void IdleEntry(void)
         sleep_cpu();
         sleep_disable();
         sei();
+#elif defined(POSIX)
+        ThreadPort::WaitForInterrupt();
 #endif
 
 #if !KERNEL_USE_IDLE_FUNC
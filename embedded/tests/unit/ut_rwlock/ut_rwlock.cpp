@@ -0,0 +1,309 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+
+#include "kerneltypes.h"
+#include "kernel.h"
+#include "../ut_platform.h"
+#include "mark3.h"
+
+#if KERNEL_USE_RWLOCK
+//===========================================================================
+// Local Defines
+//===========================================================================
+static RWLock clLock;
+static Mutex clMutex;
+static Semaphore clHold;
+static Thread clThread1;
+static Thread clThread2;
+static Thread clThread3;
+static K_WORD awStack1[192];
+static K_WORD awStack2[192];
+static K_WORD awStack3[192];
+static volatile uint8_t u8Readers;
+static volatile uint8_t u8Writers;
+static volatile uint8_t u8Count;
+static volatile bool bResult;
+
+//---------------------------------------------------------------------------
+static void ReaderThread(void *unused_)
+{
+    clLock.ReadLock();
+    u8Readers++;
+    clHold.Pend();
+    u8Readers--;
+    clLock.ReadUnlock();
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//---------------------------------------------------------------------------
+static void WriterThread(void *unused_)
+{
+    clLock.WriteLock();
+    u8Writers++;
+    clHold.Pend();
+    u8Writers--;
+    clLock.WriteUnlock();
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//===========================================================================
+// Define Test Cases Here
+//===========================================================================
+TEST(ut_rwlock_readers)
+{
+    // Test - verify that multiple readers can hold the lock at once, and
+    // that a writer is held off until the last of them has released it.
+    clLock.Init();
+    clHold.Init(0, 3);
+    u8Readers = 0;
+    u8Writers = 0;
+
+    clLock.ReadLock();
+
+    clThread1.Init(awStack1, 192, 2, ReaderThread, NULL);
+    clThread2.Init(awStack2, 192, 2, ReaderThread, NULL);
+    clThread3.Init(awStack3, 192, 2, WriterThread, NULL);
+    clThread1.Start();
+    clThread2.Start();
+    EXPECT_EQUALS( u8Readers, 2 );
+    EXPECT_EQUALS( clLock.GetReaders(), 3 );
+
+    clThread3.Start();
+    EXPECT_EQUALS( u8Writers, 0 );
+
+    clHold.Post();
+    clHold.Post();
+    EXPECT_EQUALS( u8Readers, 0 );
+    EXPECT_EQUALS( u8Writers, 0 );
+
+    // Last reader out - the writer gets the lock
+    clLock.ReadUnlock();
+    EXPECT_EQUALS( u8Writers, 1 );
+    EXPECT_TRUE( clLock.GetWriter() == &clThread3 );
+
+    clHold.Post();
+    EXPECT_EQUALS( u8Writers, 0 );
+    EXPECT_EQUALS( clLock.GetReaders(), 0 );
+    EXPECT_TRUE( clLock.GetWriter() == NULL );
+}
+TEST_END
+
+//===========================================================================
+TEST(ut_rwlock_writer_preference)
+{
+    // Test - verify that new readers queue up behind a waiting writer, and
+    // are let in once the writer is done.
+    clLock.Init();
+    clHold.Init(0, 3);
+    u8Readers = 0;
+    u8Writers = 0;
+
+    clLock.ReadLock();
+
+    clThread1.Init(awStack1, 192, 2, WriterThread, NULL);
+    clThread2.Init(awStack2, 192, 2, ReaderThread, NULL);
+    clThread1.Start();
+    clThread2.Start();
+    EXPECT_EQUALS( u8Writers, 0 );
+    EXPECT_EQUALS( u8Readers, 0 );
+
+    clLock.ReadUnlock();
+    EXPECT_EQUALS( u8Writers, 1 );
+    EXPECT_EQUALS( u8Readers, 0 );
+
+    clHold.Post();
+    EXPECT_EQUALS( u8Writers, 0 );
+    EXPECT_EQUALS( u8Readers, 1 );
+
+    clHold.Post();
+    EXPECT_EQUALS( u8Readers, 0 );
+    EXPECT_EQUALS( clLock.GetReaders(), 0 );
+}
+TEST_END
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+static void TimedReaderThread(void *unused_)
+{
+    bResult = clLock.ReadLock(10);
+    if (bResult)
+    {
+        clLock.ReadUnlock();
+    }
+    u8Count++;
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//===========================================================================
+TEST(ut_rwlock_timeout)
+{
+    // Test - verify that a timed lock gives up while a writer holds the
+    // lock, and that the timed variants succeed when it is free.
+    clLock.Init();
+    u8Count = 0;
+    bResult = true;
+
+    clLock.WriteLock();
+
+    clThread1.Init(awStack1, 192, 2, TimedReaderThread, NULL);
+    clThread1.Start();
+    EXPECT_EQUALS( u8Count, 0 );
+
+    Thread::Sleep(20);
+    EXPECT_EQUALS( u8Count, 1 );
+    EXPECT_FALSE( bResult );
+
+    clLock.WriteUnlock();
+
+    EXPECT_TRUE( clLock.WriteLock(10) );
+    clLock.WriteUnlock();
+    EXPECT_TRUE( clLock.ReadLock(10) );
+    clLock.ReadUnlock();
+}
+TEST_END
+#endif
+
+//===========================================================================
+TEST(ut_rwlock_inherit)
+{
+    // Test - verify that a reader holding the lock inherits the priority of
+    // a blocked writer, and drops back to its own when it releases the lock.
+    Thread *pclMe = Scheduler::GetCurrentThread();
+
+    clLock.Init();
+    clHold.Init(0, 1);
+    u8Writers = 0;
+
+    clLock.ReadLock();
+
+    clThread1.Init(awStack1, 192, 3, WriterThread, NULL);
+    clThread1.Start();
+    EXPECT_EQUALS( u8Writers, 0 );
+    EXPECT_EQUALS( pclMe->GetCurPriority(), 3 );
+
+    clLock.ReadUnlock();
+    EXPECT_EQUALS( u8Writers, 1 );
+    EXPECT_EQUALS( pclMe->GetCurPriority(), 1 );
+
+    clHold.Post();
+    EXPECT_EQUALS( u8Writers, 0 );
+}
+TEST_END
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+static void TimedWriterThread(void *unused_)
+{
+    bResult = clLock.WriteLock(10);
+    if (bResult)
+    {
+        clLock.WriteUnlock();
+    }
+    u8Count++;
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//===========================================================================
+TEST(ut_rwlock_inherit_timeout)
+{
+    // Test - verify that only the holder of the lock inherits a blocked
+    // writer's priority, and that it loses it again when the writer times
+    // out.
+    Thread *pclMe = Scheduler::GetCurrentThread();
+
+    clLock.Init();
+    clHold.Init(0, 1);
+    u8Count = 0;
+    u8Readers = 0;
+    bResult = true;
+
+    clLock.ReadLock();
+
+    // The reader queues up behind the writer
+    clThread1.Init(awStack1, 192, 3, TimedWriterThread, NULL);
+    clThread2.Init(awStack2, 192, 2, ReaderThread, NULL);
+    clThread1.Start();
+    clThread2.Start();
+    Thread::Sleep(5);
+    EXPECT_EQUALS( u8Readers, 0 );
+    EXPECT_EQUALS( pclMe->GetCurPriority(), 3 );
+    EXPECT_EQUALS( clThread2.GetCurPriority(), 2 );
+
+    // The writer gives up, letting the reader in
+    Thread::Sleep(20);
+    EXPECT_EQUALS( u8Count, 1 );
+    EXPECT_FALSE( bResult );
+    EXPECT_EQUALS( u8Readers, 1 );
+    EXPECT_EQUALS( pclMe->GetCurPriority(), 1 );
+    EXPECT_EQUALS( clThread2.GetCurPriority(), 2 );
+
+    clHold.Post();
+    EXPECT_EQUALS( u8Readers, 0 );
+    clLock.ReadUnlock();
+}
+TEST_END
+#endif
+
+//===========================================================================
+TEST(ut_rwlock_inherit_mutex)
+{
+    // Test - verify that releasing a mutex doesn't drop the priority a
+    // thread inherits through a reader-writer lock it still holds.
+    Thread *pclMe = Scheduler::GetCurrentThread();
+
+    clLock.Init();
+    clMutex.Init();
+    clHold.Init(0, 1);
+    u8Writers = 0;
+
+    clMutex.Claim();
+    clLock.ReadLock();
+
+    clThread1.Init(awStack1, 192, 3, WriterThread, NULL);
+    clThread1.Start();
+    EXPECT_EQUALS( pclMe->GetCurPriority(), 3 );
+
+    clMutex.Release();
+    EXPECT_EQUALS( pclMe->GetCurPriority(), 3 );
+    EXPECT_EQUALS( u8Writers, 0 );
+
+    clLock.ReadUnlock();
+    EXPECT_EQUALS( u8Writers, 1 );
+    EXPECT_EQUALS( pclMe->GetCurPriority(), 1 );
+
+    clHold.Post();
+    EXPECT_EQUALS( u8Writers, 0 );
+}
+TEST_END
+#endif // KERNEL_USE_RWLOCK
+
+//===========================================================================
+// Test Whitelist Goes Here
+//===========================================================================
+TEST_CASE_START
+#if KERNEL_USE_RWLOCK
+  TEST_CASE(ut_rwlock_readers),
+  TEST_CASE(ut_rwlock_writer_preference),
+#if KERNEL_USE_TIMEOUTS
+  TEST_CASE(ut_rwlock_timeout),
+#endif
+  TEST_CASE(ut_rwlock_inherit),
+#if KERNEL_USE_TIMEOUTS
+  TEST_CASE(ut_rwlock_inherit_timeout),
+#endif
+  TEST_CASE(ut_rwlock_inherit_mutex),
+#endif
+TEST_CASE_END
@@ -15,9 +15,11 @@
 #include "kernelaware.h"
 
 //---------------------------------------------------------------------------
+#if defined(AVR)
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <avr/sleep.h>
+#endif
 
 //---------------------------------------------------------------------------
 static volatile uint8_t u8TestVal;
@@ -157,6 +159,10 @@ TEST(ut_sanity_timed_sem)
         
     EXPECT_FALSE(clSem.Pend(15));
 
+    // Wait for the late post, so the thread is done with its timer before
+    // the thread object is reused by the next test.
+    clSem.Pend();
+
     Scheduler::GetCurrentThread()->SetPriority(1);
 }
 TEST_END
@@ -278,6 +284,11 @@ TEST(ut_sanity_mutex)
     clTestThread1.Start();
     
     EXPECT_FALSE(clMutex.Claim(15));
+
+    // Wait for the thread to release the mutex, so it's done with its timer
+    // before the thread object is reused by the next test.
+    clMutex.Claim();
+    clMutex.Release();
 }
 TEST_END
 
@@ -0,0 +1,205 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+
+#include "kerneltypes.h"
+#include "kernel.h"
+#include "../ut_platform.h"
+#include "mark3.h"
+
+#if KERNEL_USE_STREAMBUFFER
+//===========================================================================
+// Local Defines
+//===========================================================================
+#define STREAM_SIZE     (16)
+
+static StreamBuffer clStream;
+static uint8_t au8StreamBuf[STREAM_SIZE];
+static uint8_t au8RxBuf[STREAM_SIZE];
+static Thread clThread;
+static K_WORD awStack[192];
+static volatile uint8_t u8Count = 0;
+static volatile uint16_t u16RxLen = 0;
+
+//---------------------------------------------------------------------------
+static void ReaderThread(void *unused_)
+{
+    while(1)
+    {
+        u16RxLen = clStream.Read(au8RxBuf, STREAM_SIZE);
+        u8Count++;
+    }
+}
+
+#if KERNEL_USE_TIMEOUTS
+//---------------------------------------------------------------------------
+static void TrickleThread(void *unused_)
+{
+    uint8_t u8Byte = 0;
+
+    // Start part-way into the reader's time limit, then send one byte at a
+    // time, each well within the idle timeout
+    Thread::Sleep(20);
+    while(1)
+    {
+        Thread::Sleep(2);
+        clStream.Write(&u8Byte, 1);
+    }
+}
+#endif
+
+//===========================================================================
+// Define Test Cases Here
+//===========================================================================
+TEST(ut_streambuffer_rw)
+{
+    // Test - verify that data written into the stream is read back in
+    // order, including across the end of the buffer, and that writes are
+    // truncated when the buffer is full.
+    uint8_t au8Data[STREAM_SIZE];
+    uint8_t i;
+    bool bMatch;
+
+    for (i = 0; i < STREAM_SIZE; i++)
+    {
+        au8Data[i] = i;
+    }
+
+    clStream.Init(au8StreamBuf, STREAM_SIZE);
+    EXPECT_EQUALS( clStream.GetFree(), STREAM_SIZE - 1 );
+
+    EXPECT_EQUALS( clStream.Write(au8Data, 10), 10 );
+    EXPECT_EQUALS( clStream.GetAvailable(), 10 );
+    EXPECT_EQUALS( clStream.TryRead(au8RxBuf, 8), 8 );
+
+    bMatch = true;
+    for (i = 0; i < 8; i++)
+    {
+        if (au8RxBuf[i] != i)
+        {
+            bMatch = false;
+        }
+    }
+    EXPECT_TRUE( bMatch );
+
+    // 2 bytes buffered, 13 free - the write wraps, and is truncated
+    EXPECT_EQUALS( clStream.Write(au8Data, STREAM_SIZE), STREAM_SIZE - 3 );
+    EXPECT_EQUALS( clStream.GetFree(), 0 );
+    EXPECT_EQUALS( clStream.TryRead(au8RxBuf, STREAM_SIZE), STREAM_SIZE - 1 );
+
+    bMatch = (au8RxBuf[0] == 8) && (au8RxBuf[1] == 9);
+    for (i = 2; i < STREAM_SIZE - 1; i++)
+    {
+        if (au8RxBuf[i] != (i - 2))
+        {
+            bMatch = false;
+        }
+    }
+    EXPECT_TRUE( bMatch );
+    EXPECT_EQUALS( clStream.TryRead(au8RxBuf, STREAM_SIZE), 0 );
+}
+TEST_END
+
+//===========================================================================
+TEST(ut_streambuffer_trigger)
+{
+    // Test - verify that a blocked reader is only woken once the trigger
+    // level has been reached, and not on every byte written.
+    uint8_t u8Byte = 0;
+    uint8_t i;
+
+    clStream.Init(au8StreamBuf, STREAM_SIZE);
+    clStream.SetTriggerLevel(8);
+    u8Count = 0;
+
+    clThread.Init(awStack, 192, 7, ReaderThread, NULL);
+    clThread.Start();
+
+    for (i = 0; i < 7; i++)
+    {
+        clStream.Write(&u8Byte, 1);
+    }
+    EXPECT_EQUALS( u8Count, 0 );
+
+    clStream.Write(&u8Byte, 1);
+    EXPECT_EQUALS( u8Count, 1 );
+    EXPECT_EQUALS( u16RxLen, 8 );
+
+    clThread.Exit();
+}
+TEST_END
+
+#if KERNEL_USE_TIMEOUTS
+//===========================================================================
+TEST(ut_streambuffer_idle)
+{
+    // Test - verify that a frame shorter than the trigger level is delivered
+    // once data stops arriving for the idle timeout.
+    uint8_t au8Data[3] = { 1, 2, 3 };
+
+    clStream.Init(au8StreamBuf, STREAM_SIZE);
+    clStream.SetTriggerLevel(STREAM_SIZE - 1);
+    clStream.SetIdleTimeout(5);
+    u8Count = 0;
+
+    clThread.Init(awStack, 192, 7, ReaderThread, NULL);
+    clThread.Start();
+
+    clStream.Write(au8Data, 3);
+    EXPECT_EQUALS( u8Count, 0 );
+
+    Thread::Sleep(20);
+    EXPECT_EQUALS( u8Count, 1 );
+    EXPECT_EQUALS( u16RxLen, 3 );
+    EXPECT_EQUALS( au8RxBuf[2], 3 );
+
+    clThread.Exit();
+
+    // Test - a timed read on an empty stream returns nothing
+    clStream.SetIdleTimeout(0);
+    EXPECT_EQUALS( clStream.Read(au8RxBuf, STREAM_SIZE, 10), 0 );
+
+    // Test - a timed read honors its time limit, counting the time spent
+    // waiting for the first byte, even when data keeps trickling in before
+    // the idle timeout expires
+    clStream.Init(au8StreamBuf, STREAM_SIZE);
+    clStream.SetTriggerLevel(STREAM_SIZE - 1);
+    clStream.SetIdleTimeout(5);
+
+    clThread.Init(awStack, 192, 7, TrickleThread, NULL);
+    clThread.Start();
+
+    u16RxLen = clStream.Read(au8RxBuf, STREAM_SIZE, 25);
+    EXPECT_GT( u16RxLen, 0 );
+    EXPECT_LT( u16RxLen, 8 );
+
+    clThread.Exit();
+}
+TEST_END
+#endif
+#endif // KERNEL_USE_STREAMBUFFER
+
+//===========================================================================
+// Test Whitelist Goes Here
+//===========================================================================
+TEST_CASE_START
+#if KERNEL_USE_STREAMBUFFER
+  TEST_CASE(ut_streambuffer_rw),
+  TEST_CASE(ut_streambuffer_trigger),
+#if KERNEL_USE_TIMEOUTS
+  TEST_CASE(ut_streambuffer_idle),
+#endif
+#endif
+TEST_CASE_END
@@ -24,6 +24,7 @@ See license.txt for more information
 #include "kerneltimer.h"
 #include "driver.h"
 #include "memutil.h"
+#include "threadstats.h"
 //===========================================================================
 // Local Defines
 //===========================================================================
@@ -180,6 +181,48 @@ TEST(ut_threadsleep)
 }
 TEST_END
 
+//===========================================================================
+static volatile uint8_t u8Wakeups;
+static void ThreadNapEntryPoint(void *unused_)
+{
+    unused_ = unused_;
+
+    while(1)
+    {
+        Thread::Sleep(50);
+        u8Wakeups++;
+    }
+}
+
+//===========================================================================
+TEST(ut_threadreinit)
+{
+    // Test point - re-initialize a thread while it's blocked with a timer
+    // pending.  The timer must be taken out of the timer-scheduler before
+    // it's reset, or the timer list (or timing wheel) is left corrupt.
+    u8Wakeups = 0;
+    clThread1.Init(aucStack1, TEST_STACK_SIZE, 7, ThreadNapEntryPoint, NULL);
+    clThread1.Start();
+    Thread::Sleep(10);
+
+    EXPECT_TRUE(clThread1.GetTimer()->IsActive());
+
+    clThread1.Init(aucStack1, TEST_STACK_SIZE, 7, ThreadNapEntryPoint, NULL);
+    EXPECT_FALSE(clThread1.GetTimer()->IsActive());
+
+    // Test point - the old timeout never fires, and timers keep working for
+    // the re-initialized thread (and everyone else)
+    Thread::Sleep(60);
+    EXPECT_EQUALS(u8Wakeups, 0);
+
+    clThread1.Start();
+    Thread::Sleep(120);
+    EXPECT_EQUALS(u8Wakeups, 2);
+
+    clThread1.Exit();
+}
+TEST_END
+
 //===========================================================================
 void RR_EntryPoint(void *value_)
 {
@@ -252,10 +295,17 @@ TEST(ut_roundrobin)
         u32Min = u32RR3;
     }
     u32Range = u32Max - u32Min;
-    u32Avg = (u32RR1 + u32RR2 + u32RR3) / 3;
+    // (Divide first - the counters can reach billions on a fast host)
+    u32Avg = (u32RR1 / 3) + (u32RR2 / 3) + (u32RR3 / 3);
 
+#if defined(POSIX)
+    // The host can preempt the whole process at any time, and the time lost
+    // is charged to whichever thread was running - allow 12.5% for that.
+    EXPECT_LT( u32Range, u32Avg / 8);
+#else
     // Max-Min delta should not exceed 1% of average for this simple test
     EXPECT_LT( u32Range, u32Avg / 100);
+#endif
 
     // Make sure none of the component values are 0
     EXPECT_FAIL_EQUALS( u32RR1, 0 );
@@ -342,9 +392,15 @@ TEST(ut_quanta)
         u32Min = u32RR3;
     }
     u32Range = u32Max - u32Min;
-    u32Avg = (u32RR1 + u32RR2 + u32RR3) / 3;
-
-#if KERNEL_TIMERS_TICKLESS
+    // (Divide first - the counters can reach billions on a fast host)
+    u32Avg = (u32RR1 / 3) + (u32RR2 / 3) + (u32RR3 / 3);
+
+#if defined(POSIX)
+    // Host preemption adds noise, as in ut_roundrobin, and host timer
+    // signals can arrive a fraction of a millisecond late - a large error on
+    // a 3ms quantum.  Allow 25%.
+    EXPECT_LT( u32Range, u32Avg / 4);
+#elif KERNEL_TIMERS_TICKLESS
     // Max-Min delta should not exceed 5% of average for this test
     EXPECT_LT( u32Range, u32Avg / 20);
 #else
@@ -361,6 +417,69 @@ TEST(ut_quanta)
 }
 TEST_END
 
+#if KERNEL_USE_THREAD_STATS
+//===========================================================================
+// Each full load window closes at least 1/(1 << THREAD_STATS_LOAD_SHIFT) of
+// the gap to 100%, so this many windows take the load average from 0 to
+// over 75%.  Two more cover the partial windows at either end of the run.
+#define BUSY_FULL_WINDOWS       ((3UL << THREAD_STATS_LOAD_SHIFT) / 2)
+#define BUSY_RUN_TIME           ((BUSY_FULL_WINDOWS + 2) << THREAD_STATS_WINDOW_SHIFT)
+
+static CpuUsage_t stBusyUsage;
+
+//===========================================================================
+static void Busy_EntryPoint(void *unused_)
+{
+    unused_ = unused_;
+
+    // Hog the CPU until we've been charged with enough run time to saturate
+    // the load average, then snapshot our own usage
+    do
+    {
+        ThreadStats::GetThread(Scheduler::GetCurrentThread(), &stBusyUsage);
+    } while (stBusyUsage.u32RunTime < BUSY_RUN_TIME);
+
+    clSem1.Post();
+    Scheduler::GetCurrentThread()->Exit();
+}
+
+//===========================================================================
+TEST(ut_thread_stats)
+{
+    CpuUsage_t stSelf;
+    CpuUsage_t stIdle;
+    uint32_t u32Switches;
+    uint32_t u32Total;
+
+    // Test point - a thread that monopolizes the CPU for a while should
+    // accumulate run time, and its load average should approach 100%.
+    clSem1.Init(0, 1);
+
+    clThread1.Init(aucStack1, TEST_STACK_SIZE, 7, Busy_EntryPoint, NULL);
+    u32Switches = ThreadStats::GetTotalSwitches();
+
+    clThread1.Start();
+    clSem1.Pend();
+
+    EXPECT_GTE(stBusyUsage.u32RunTime, BUSY_RUN_TIME);
+    EXPECT_GTE(stBusyUsage.u32Switches, 1);
+    EXPECT_GTE(stBusyUsage.u16Load, (THREAD_LOAD_SCALE * 3) / 4);
+    EXPECT_LTE(stBusyUsage.u16Load, THREAD_LOAD_SCALE);
+
+    // Switching to the busy thread and back must have been counted
+    EXPECT_GTE(ThreadStats::GetTotalSwitches() - u32Switches, 2);
+
+    // Test point - time charged to threads and idle can't exceed the total
+    ThreadStats::GetThread(Scheduler::GetCurrentThread(), &stSelf);
+    ThreadStats::GetIdle(&stIdle);
+    u32Total = ThreadStats::GetTotalTime();
+
+    EXPECT_GTE(u32Total, stBusyUsage.u32RunTime + stSelf.u32RunTime + stIdle.u32RunTime);
+    EXPECT_LTE(stIdle.u16Load, THREAD_LOAD_SCALE);
+}
+TEST_END
+#endif
+
 //===========================================================================
 // Test Whitelist Goes Here
 //===========================================================================
@@ -369,6 +488,10 @@ TEST_CASE_START
   TEST_CASE(ut_threadstop),
   TEST_CASE(ut_threadexit),
   TEST_CASE(ut_threadsleep),
+  TEST_CASE(ut_threadreinit),
   TEST_CASE(ut_roundrobin),
   TEST_CASE(ut_quanta),
+#if KERNEL_USE_THREAD_STATS
+  TEST_CASE(ut_thread_stats),
+#endif
 TEST_CASE_END
@@ -18,6 +18,7 @@ See license.txt for more information
 #include "kernel.h"
 #include "../ut_platform.h"
 #include "timerlist.h"
+#include "timerscheduler.h"
 #include "thread.h"
 #include "kernelprofile.h"
 #include "profile.h"
@@ -26,6 +27,8 @@ See license.txt for more information
 #include "kerneltimer.h"
 #include "driver.h"
 #include "memutil.h"
+#include "scheduler.h"
+#include "periodictimer.h"
 
 //===========================================================================
 // Local Defines
@@ -47,6 +50,75 @@ static void TimerCallback( Thread *pclOwner_, void *pvVal_ )
     u32CallbackCount++;
 }
 
+#if KERNEL_USE_TIMER_THREAD
+static volatile PRIO_TYPE uXCallbackPrio;
+
+static void DeferredCallback( Thread *pclOwner_, void *pvVal_ )
+{
+    uXCallbackPrio = Scheduler::GetCurrentThread()->GetCurPriority();
+    clTimerSem.Post();
+    u32CallbackCount++;
+}
+#endif
+
+#if KERNEL_TIMERS_TICKLESS
+static volatile uint32_t au32Coalesce[2];
+
+static void CoalesceCallback( Thread *pclOwner_, void *pvVal_ )
+{
+    uint8_t u8Idx = (uint8_t)(K_ADDR)pvVal_;
+    au32Coalesce[u8Idx]++;
+    if (u8Idx)
+    {
+        clTimerSem.Post();
+    }
+}
+#endif
+
+#if KERNEL_USE_TICKLESS_IDLE
+static volatile uint32_t au32StateCount[3];
+static volatile uint32_t u32StateMaxTicks;
+static volatile uint32_t u32HaltTicks;
+
+static uint32_t IdleState0( uint32_t u32MaxTicks_ )
+{
+    au32StateCount[0]++;
+    return 0;
+}
+
+static uint32_t IdleState1( uint32_t u32MaxTicks_ )
+{
+    au32StateCount[1]++;
+    if (u32MaxTicks_ > u32StateMaxTicks)
+    {
+        u32StateMaxTicks = u32MaxTicks_;
+    }
+
+    // Pretend to have halted the kernel timer - once.
+    uint32_t u32Ret = u32HaltTicks;
+    u32HaltTicks = 0;
+    return u32Ret;
+}
+
+static uint32_t IdleState2( uint32_t u32MaxTicks_ )
+{
+    au32StateCount[2]++;
+    return 0;
+}
+
+static const SleepState_t astIdleStates[3] =
+{
+    { IdleState0, 0 },
+    { IdleState1, MSECONDS_TO_TICKS(10) },
+    { IdleState2, MSECONDS_TO_TICKS(1000000) }
+};
+
+static uint8_t IdleGovernor( void )
+{
+    return 1;
+}
+#endif
+
 //===========================================================================
 // Define Test Cases Here
 //===========================================================================
@@ -279,6 +351,268 @@ TEST(ut_timer_multi)
 }
 TEST_END
 
+#if KERNEL_USE_TIMER_THREAD
+TEST(ut_timer_deferred)
+{
+    clTimerSem.Init(0, 1);
+
+    // Test point - a deferred one-shot callback runs once, from the
+    // context of the timer service thread.
+    u32CallbackCount = 0;
+    uXCallbackPrio = 0;
+    clTimer1.Init();
+    clTimer1.SetDeferred(true);
+    clTimer1.Start( false, 10, DeferredCallback, 0 );
+    clTimerSem.Pend();
+
+    EXPECT_EQUALS(u32CallbackCount, 1);
+    EXPECT_EQUALS(uXCallbackPrio, KERNEL_TIMER_THREAD_PRIORITY);
+
+    // Test point - the deferred flag survives a restart as a repeating
+    // timer, and no further callbacks run once the timer is stopped.
+    u32CallbackCount = 0;
+    clTimer1.Start( true, 10, DeferredCallback, 0 );
+    while (u32CallbackCount < 10)
+    {
+        clTimerSem.Pend();
+    }
+    clTimer1.Stop();
+
+    u32TempTime = u32CallbackCount;
+    Thread::Sleep(50);
+    EXPECT_EQUALS(u32CallbackCount, u32TempTime);
+
+    clTimer1.SetDeferred(false);
+}
+TEST_END
+
+//===========================================================================
+static volatile bool bFlagTimer;
+static void FlagCallback( Thread *pclOwner_, void *pvVal_ )
+{
+    bFlagTimer = true;
+}
+
+//===========================================================================
+static void WaitFlagTimer( uint32_t u32IntervalMs_ )
+{
+    // Spin (with the scheduler disabled) until timers due before this one
+    // have expired
+    bFlagTimer = false;
+    clTimer3.Start( false, u32IntervalMs_, FlagCallback, 0 );
+    while (!bFlagTimer) { }
+}
+
+//===========================================================================
+TEST(ut_timer_deferred_reinit)
+{
+    // Test point - re-initializing a deferred timer whose callback is still
+    // pending removes it from the timer thread's queue, so that it can be
+    // queued again without cutting off the callbacks queued after it.
+    clTimerSem.Init(0, 2);
+    u32CallbackCount = 0;
+    clTimer1.Init();
+    clTimer2.Init();
+    clTimer3.Init();
+    clTimer1.SetDeferred(true);
+    clTimer2.SetDeferred(true);
+
+    // Keep the timer thread from running while its queue is set up
+    Scheduler::SetScheduler(false);
+
+    clTimer1.Start( false, 5, DeferredCallback, 0 );
+    clTimer2.Start( false, 10, DeferredCallback, 0 );
+    WaitFlagTimer(20);
+
+    // Timer 1 is now queued ahead of timer 2 - re-init it, and queue it again
+    clTimer1.Init();
+    clTimer1.SetDeferred(true);
+    clTimer1.Start( false, 5, DeferredCallback, 0 );
+    WaitFlagTimer(10);
+
+    Scheduler::SetScheduler(true);
+    Thread::Sleep(10);
+
+    // Test point - each callback ran exactly once
+    EXPECT_EQUALS(u32CallbackCount, 2);
+
+    clTimer1.SetDeferred(false);
+    clTimer2.SetDeferred(false);
+}
+TEST_END
+#endif
+
+#if KERNEL_TIMERS_TICKLESS
+TEST(ut_timer_coalesce)
+{
+    uint32_t u32Saved = TimerScheduler::GetWakeupsSaved();
+#if KERNEL_TIMERS_WHEEL
+    uint8_t i;
+#endif
+
+    clTimerSem.Init(0, 1);
+    au32Coalesce[0] = 0;
+    au32Coalesce[1] = 0;
+
+    // 50ms timer that can tolerate expiring up to 100ms late, and a 100ms
+    // timer that can't.
+    clTimer1.Init();
+    clTimer2.Init();
+    clTimer1.Start( false, 50, 100, CoalesceCallback, (void*)0 );
+    clTimer2.Start( false, 100, CoalesceCallback, (void*)1 );
+
+    // Test point - a timer with a tolerance doesn't expire early
+    Thread::Sleep(40);
+    EXPECT_EQUALS(au32Coalesce[0], 0);
+
+    clTimerSem.Pend();
+    EXPECT_EQUALS(au32Coalesce[1], 1);
+
+#if !KERNEL_TIMERS_WHEEL
+    // Test point - it's held back to share the later timer's wakeup...
+    EXPECT_EQUALS(au32Coalesce[0], 1);
+
+    // Test point - ...which is counted as a wakeup saved
+    EXPECT_EQUALS(TimerScheduler::GetWakeupsSaved() - u32Saved, 1);
+#endif
+
+    // Test point - but not beyond its tolerance
+    Thread::Sleep(60);
+    EXPECT_EQUALS(au32Coalesce[0], 1);
+
+#if KERNEL_TIMERS_WHEEL
+    // In wheel mode, a timer with a tolerance is rounded up to the coarsest
+    // wheel tick within its window, so whether it meets the fixed timer above
+    // depends on where the window falls.  Timers with the same window always
+    // pick the same tick, though - unless the window starts on that tick, in
+    // which case nothing was held back, and we try again.
+    for (i = 0; i < 4; i++)
+    {
+        u32Saved = TimerScheduler::GetWakeupsSaved();
+        au32Coalesce[0] = 0;
+        au32Coalesce[1] = 0;
+        clTimer1.Start( false, 50, 100, CoalesceCallback, (void*)0 );
+        clTimer2.Start( false, 50, 100, CoalesceCallback, (void*)1 );
+        clTimerSem.Pend();
+        if (TimerScheduler::GetWakeupsSaved() != u32Saved)
+        {
+            break;
+        }
+    }
+
+    // Test point - both timers fired in the same slot...
+    EXPECT_EQUALS(au32Coalesce[0], 1);
+    EXPECT_EQUALS(au32Coalesce[1], 1);
+
+    // Test point - ...which is counted as a wakeup saved
+    EXPECT_EQUALS(TimerScheduler::GetWakeupsSaved() - u32Saved, 1);
+#endif
+}
+TEST_END
+#endif
+
+#if KERNEL_USE_TICKLESS_IDLE
+TEST(ut_tickless_idle)
+{
+    au32StateCount[0] = 0;
+    au32StateCount[1] = 0;
+    au32StateCount[2] = 0;
+    u32StateMaxTicks = 0;
+    u32HaltTicks = 0;
+    TicklessIdle::SetStates(astIdleStates, 3);
+
+    // Test point - the deepest state that wakes up before the next timer
+    // expiry is used, and is given less time than remains until the expiry.
+    Thread::Sleep(100);
+    EXPECT_GT(au32StateCount[1], 0);
+    EXPECT_EQUALS(au32StateCount[2], 0);
+    EXPECT_LT(u32StateMaxTicks, MSECONDS_TO_TICKS(100) - MSECONDS_TO_TICKS(10) + 1);
+
+    // Test point - the governor limits the depth of sleep
+    au32StateCount[0] = 0;
+    au32StateCount[1] = 0;
+    TicklessIdle::SetGovernor(IdleGovernor);
+    Thread::Sleep(100);
+    EXPECT_GT(au32StateCount[0], 0);
+    EXPECT_EQUALS(au32StateCount[1], 0);
+    TicklessIdle::SetGovernor(0);
+
+    // Test point - time spent with the kernel timer halted is credited to
+    // the timers: reporting 100ms halted makes a 200ms sleep take ~100ms.
+    Profiler::Start();
+    u32TempTime = TicklessIdle::GetHaltedTicks();
+    u32HaltTicks = MSECONDS_TO_TICKS(100);
+    clProfileTimer.Init();
+    clProfileTimer.Start();
+    Thread::Sleep(200);
+    clProfileTimer.Stop();
+    Profiler::Stop();
+
+    EXPECT_EQUALS(TicklessIdle::GetHaltedTicks() - u32TempTime, MSECONDS_TO_TICKS(100));
+
+    u32TimeVal = clProfileTimer.GetCurrent() * CLOCK_DIVIDE;
+    EXPECT_GT(u32TimeVal, (SYSTEM_FREQ / 10) - (SYSTEM_FREQ / 100));
+    EXPECT_LT(u32TimeVal, (SYSTEM_FREQ / 10) + (SYSTEM_FREQ / 100));
+
+    TicklessIdle::SetStates(0, 0);
+}
+TEST_END
+#endif
+
+#if KERNEL_USE_MONOTONIC_TIME
+TEST(ut_timer_monotonic)
+{
+    uint64_t u64Start;
+    uint64_t u64Deadline;
+    uint32_t u32Elapsed;
+    PeriodicTimer clPeriodic;
+
+    // Test point - the monotonic time base advances with the kernel timer
+    u64Start = TimerScheduler::GetTime();
+    Thread::Sleep(100);
+    u32Elapsed = (uint32_t)(TimerScheduler::GetTime() - u64Start);
+    EXPECT_GT(u32Elapsed, MSECONDS_TO_TICKS(99));
+    EXPECT_LT(u32Elapsed, MSECONDS_TO_TICKS(110));
+
+    // Test point - sleeping until an absolute deadline wakes at the deadline,
+    // regardless of when the sleep was started.
+    u64Deadline = TimerScheduler::GetTime() + MSECONDS_TO_TICKS(50);
+    Thread::Sleep(10);
+    Thread::SleepUntil(u64Deadline);
+    u32Elapsed = (uint32_t)(TimerScheduler::GetTime() - u64Deadline);
+    EXPECT_LT(u32Elapsed, MSECONDS_TO_TICKS(5));
+
+    // Test point - a deadline in the past returns immediately
+    u64Start = TimerScheduler::GetTime();
+    Thread::SleepUntil(u64Start - 1);
+    u32Elapsed = (uint32_t)(TimerScheduler::GetTime() - u64Start);
+    EXPECT_LT(u32Elapsed, MSECONDS_TO_TICKS(2));
+
+    // Test point - a periodic loop doesn't accumulate its own run time as
+    // drift: 10 iterations of a 20ms period, each doing 5ms of work, take
+    // 10 periods.
+    clPeriodic.Init();
+    clPeriodic.Start(20);
+    u64Start = TimerScheduler::GetTime();
+    u32TempTime = 0;
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        Thread::Sleep(5);
+        u32TempTime += clPeriodic.Wait();
+    }
+    u32Elapsed = (uint32_t)(TimerScheduler::GetTime() - u64Start);
+    EXPECT_EQUALS(u32TempTime, 10);
+    EXPECT_EQUALS(clPeriodic.GetExpiredCount(), 10);
+    EXPECT_GT(u32Elapsed, (10 * MSECONDS_TO_TICKS(20)) - MSECONDS_TO_TICKS(5));
+    EXPECT_LT(u32Elapsed, (10 * MSECONDS_TO_TICKS(20)) + MSECONDS_TO_TICKS(5));
+
+    // Test point - overruns are reported by Wait()
+    Thread::Sleep(50);
+    EXPECT_EQUALS(clPeriodic.Wait(), 2);
+    clPeriodic.Stop();
+}
+TEST_END
+#endif
 
 //===========================================================================
 // Test Whitelist Goes Here
@@ -288,4 +622,17 @@ TEST_CASE_START
   TEST_CASE(ut_timer_longrun),
   TEST_CASE(ut_timer_repeat),
   TEST_CASE(ut_timer_multi),
+#if KERNEL_TIMERS_TICKLESS
+  TEST_CASE(ut_timer_coalesce),
+#endif
+#if KERNEL_USE_TIMER_THREAD
+  TEST_CASE(ut_timer_deferred),
+  TEST_CASE(ut_timer_deferred_reinit),
+#endif
+#if KERNEL_USE_TICKLESS_IDLE
+  TEST_CASE(ut_tickless_idle),
+#endif
+#if KERNEL_USE_MONOTONIC_TIME
+  TEST_CASE(ut_timer_monotonic),
+#endif
 TEST_CASE_END
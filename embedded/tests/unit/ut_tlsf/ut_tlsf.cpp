@@ -0,0 +1,413 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+
+#include "kerneltypes.h"
+#include "kernel.h"
+#include "thread.h"
+#include "../ut_platform.h"
+#include "tlsf_heap.h"
+#include "arena.h"
+#include "fixed_heap.h"
+
+//===========================================================================
+// Local Defines
+//===========================================================================
+#define MAX_ALLOCS          (16)
+#define TEST_STACK_SIZE     (192)
+
+// Scale the heaps with the pointer size, as heap bookkeeping is pointer-sized
+#define HEAP_SIZE           (128 * sizeof(void*))
+
+#define SOAK_STEPS          (2000)
+#define SOAK_MAX_SIZE       (64)
+
+static void *apvAllocs[MAX_ALLOCS];
+static uint8_t au8AllocSize[MAX_ALLOCS];
+
+static K_ADDR aau8Heap[HEAP_SIZE / sizeof(K_ADDR)];
+static TlsfHeap clTlsf;
+
+static Arena clArena;
+static K_ADDR auArenaSizes[] = { 8, 16, 32, 64, 128, 256 };
+
+#define FIXED_NODE_SIZE     (sizeof(LinkListNode) + sizeof(void*))
+#define FIXED_HEAP_SIZE     (((8 + FIXED_NODE_SIZE) * 8) + ((16 + FIXED_NODE_SIZE) * 8) + \
+                             ((32 + FIXED_NODE_SIZE) * 6) + ((64 + FIXED_NODE_SIZE) * 4))
+static K_ADDR aau8FixedHeap[FIXED_HEAP_SIZE / sizeof(K_ADDR)];
+static FixedHeap clFixedHeap;
+static HeapConfig aclFixedConfig[5];
+
+//===========================================================================
+// Soak-test helpers - run the same pseudo-random script of allocations and
+// frees through each allocator, checking that no allocation is corrupted
+// by another.
+//===========================================================================
+typedef enum
+{
+    SOAK_TLSF,
+    SOAK_ARENA,
+    SOAK_FIXED
+} SoakHeap_t;
+
+static uint16_t u16Seed;
+
+//---------------------------------------------------------------------------
+static uint16_t SoakRand()
+{
+    u16Seed = (u16Seed * 25173) + 13849;
+    return (u16Seed >> 4);
+}
+
+//---------------------------------------------------------------------------
+static void *SoakAlloc( SoakHeap_t eHeap_, uint8_t u8Size_ )
+{
+    switch (eHeap_)
+    {
+        case SOAK_TLSF:     return clTlsf.Allocate( u8Size_ );
+        case SOAK_ARENA:    return clArena.Allocate( u8Size_ );
+        case SOAK_FIXED:    return clFixedHeap.Alloc( u8Size_ );
+        default:            return 0;
+    }
+}
+
+//---------------------------------------------------------------------------
+static void SoakFree( SoakHeap_t eHeap_, void *pvData_ )
+{
+    switch (eHeap_)
+    {
+        case SOAK_TLSF:     clTlsf.Free( pvData_ );         break;
+        case SOAK_ARENA:    clArena.Free( pvData_ );        break;
+        case SOAK_FIXED:    FixedHeap::Free( pvData_ );     break;
+        default:            break;
+    }
+}
+
+//---------------------------------------------------------------------------
+static bool SoakCheckAndFree( SoakHeap_t eHeap_, uint8_t u8Slot_ )
+{
+    bool bOk = true;
+    uint8_t *pu8Data = (uint8_t*)apvAllocs[u8Slot_];
+
+    for (uint8_t i = 0; i < au8AllocSize[u8Slot_]; i++)
+    {
+        if (pu8Data[i] != (uint8_t)(u8Slot_ + au8AllocSize[u8Slot_]))
+        {
+            bOk = false;
+        }
+    }
+    SoakFree( eHeap_, apvAllocs[u8Slot_] );
+    apvAllocs[u8Slot_] = 0;
+    return bOk;
+}
+
+//---------------------------------------------------------------------------
+static bool Soak( SoakHeap_t eHeap_ )
+{
+    bool bOk = true;
+    uint16_t i;
+
+    u16Seed = 1;
+    for (i = 0; i < MAX_ALLOCS; i++)
+    {
+        apvAllocs[i] = 0;
+    }
+
+    for (i = 0; i < SOAK_STEPS; i++)
+    {
+        uint8_t u8Slot = SoakRand() % MAX_ALLOCS;
+        if (apvAllocs[u8Slot])
+        {
+            bOk &= SoakCheckAndFree( eHeap_, u8Slot );
+        }
+        else
+        {
+            uint8_t u8Size = 1 + (SoakRand() % SOAK_MAX_SIZE);
+            uint8_t *pu8Data = (uint8_t*)SoakAlloc( eHeap_, u8Size );
+            if (pu8Data)
+            {
+                for (uint8_t j = 0; j < u8Size; j++)
+                {
+                    pu8Data[j] = (uint8_t)(u8Slot + u8Size);
+                }
+                apvAllocs[u8Slot] = pu8Data;
+                au8AllocSize[u8Slot] = u8Size;
+            }
+        }
+    }
+
+    for (i = 0; i < MAX_ALLOCS; i++)
+    {
+        if (apvAllocs[i])
+        {
+            bOk &= SoakCheckAndFree( eHeap_, i );
+        }
+    }
+    return bOk;
+}
+
+//===========================================================================
+// Define Test Cases Here
+//===========================================================================
+TEST(ut_tlsf_alloc_free)
+{
+    uint16_t i, j;
+    clTlsf.Init( aau8Heap, HEAP_SIZE );
+
+    for (j = 0; j < 20; j++)
+    {
+        // Alloc until exhausted, then free all in a scrambled order
+        for (i = 0; i < MAX_ALLOCS; i++)
+        {
+            apvAllocs[i] = clTlsf.Allocate( (i & 3) * 8 + 1 );
+        }
+        for (i = 1; i < MAX_ALLOCS; i += 2)
+        {
+            clTlsf.Free( apvAllocs[i] );
+        }
+        for (i = 0; i < MAX_ALLOCS; i += 4)
+        {
+            clTlsf.Free( apvAllocs[i] );
+        }
+        for (i = 2; i < MAX_ALLOCS; i += 4)
+        {
+            clTlsf.Free( apvAllocs[i] );
+        }
+
+        // Every block has been merged back together - a single allocation
+        // using most of the heap will succeed.
+        apvAllocs[0] = clTlsf.Allocate( (HEAP_SIZE * 3) / 4 );
+        EXPECT_TRUE( apvAllocs[0] != 0 );
+        clTlsf.Free( apvAllocs[0] );
+    }
+
+    // Requests larger than the heap fail outright
+    EXPECT_FALSE( clTlsf.Allocate( HEAP_SIZE ) );
+}
+TEST_END
+
+//===========================================================================
+TEST(ut_tlsf_coalesce)
+{
+    void *pvA, *pvB, *pvC, *pvD;
+    clTlsf.Init( aau8Heap, HEAP_SIZE );
+
+    pvA = clTlsf.Allocate( HEAP_SIZE / 4 );
+    pvB = clTlsf.Allocate( HEAP_SIZE / 4 );
+    pvC = clTlsf.Allocate( HEAP_SIZE / 4 );
+    EXPECT_TRUE( pvA && pvB && pvC );
+
+    // No room for another block this size
+    EXPECT_FALSE( clTlsf.Allocate( HEAP_SIZE / 4 ) );
+
+    // Freeing both neighbors of B leaves two free blocks, neither large
+    // enough for half the heap...
+    clTlsf.Free( pvA );
+    clTlsf.Free( pvC );
+    EXPECT_FALSE( clTlsf.Allocate( HEAP_SIZE / 2 ) );
+
+    // ...until B is freed, and both neighbors are merged with it.
+    clTlsf.Free( pvB );
+    pvD = clTlsf.Allocate( HEAP_SIZE / 2 );
+    EXPECT_TRUE( pvD == pvA );
+
+    // Freeing a block twice has no effect
+    clTlsf.Free( pvD );
+    clTlsf.Free( pvD );
+    pvA = clTlsf.Allocate( (HEAP_SIZE * 3) / 4 );
+    EXPECT_TRUE( pvA != 0 );
+    EXPECT_FALSE( clTlsf.Allocate( HEAP_SIZE / 4 ) );
+}
+TEST_END
+
+#if HEAP_USE_STATS
+//===========================================================================
+TEST(ut_tlsf_stats)
+{
+    void *pvA, *pvB, *pvC;
+    HeapStats clStats;
+    HeapClassStats clClass;
+    K_ADDR uEmpty;
+    uint16_t u16Current = 0;
+    uint8_t i;
+
+    clTlsf.Init( aau8Heap, HEAP_SIZE );
+
+    // A fresh heap is a single free block
+    clTlsf.GetStats( &clStats );
+    EXPECT_EQUALS( clStats.m_uUsedBytes, 0 );
+    EXPECT_TRUE( clStats.m_uFreeBytes == clStats.m_uLargestFree );
+    EXPECT_EQUALS( clStats.m_u8Fragmentation, 0 );
+    uEmpty = clStats.m_uFreeBytes;
+
+    pvA = clTlsf.Allocate( HEAP_SIZE / 4 );
+    pvB = clTlsf.Allocate( HEAP_SIZE / 4 );
+    pvC = clTlsf.Allocate( HEAP_SIZE / 4 );
+    EXPECT_TRUE( pvA && pvB && pvC );
+    EXPECT_FALSE( clTlsf.Allocate( HEAP_SIZE ) );
+
+    // Freeing the middle block leaves free space on either side of C
+    clTlsf.Free( pvB );
+    clTlsf.GetStats( &clStats );
+    EXPECT_EQUALS( clStats.m_u32Allocs, 3 );
+    EXPECT_EQUALS( clStats.m_u32Frees, 1 );
+    EXPECT_EQUALS( clStats.m_u32Fails, 1 );
+    EXPECT_TRUE( clStats.m_uUsedBytes >= (HEAP_SIZE / 2) );
+    EXPECT_TRUE( clStats.m_uPeakBytes >= ((HEAP_SIZE * 3) / 4) );
+    EXPECT_TRUE( clStats.m_uLargestFree < clStats.m_uFreeBytes );
+    EXPECT_TRUE( clStats.m_u8Fragmentation > 0 );
+
+    // The per-class counts agree with the heap-wide ones
+    for (i = 0; i < clStats.m_u8Classes; i++)
+    {
+        EXPECT_TRUE( clTlsf.GetClassStats( i, &clClass ) );
+        u16Current += clClass.m_u16Current;
+    }
+    EXPECT_EQUALS( u16Current, 2 );
+    EXPECT_FALSE( clTlsf.GetClassStats( TLSF_FL_COUNT, &clClass ) );
+
+    // Once everything's freed, the heap is back to a single block
+    clTlsf.Free( pvA );
+    clTlsf.Free( pvC );
+    clTlsf.GetStats( &clStats );
+    EXPECT_EQUALS( clStats.m_uUsedBytes, 0 );
+    EXPECT_TRUE( clStats.m_uFreeBytes == uEmpty );
+    EXPECT_EQUALS( clStats.m_u8Fragmentation, 0 );
+}
+TEST_END
+#endif
+
+//===========================================================================
+TEST(ut_tlsf_soak)
+{
+    uint8_t i;
+
+    clTlsf.Init( aau8Heap, HEAP_SIZE );
+    EXPECT_TRUE( Soak( SOAK_TLSF ) );
+
+    // Nothing leaked or left unmerged
+    apvAllocs[0] = clTlsf.Allocate( (HEAP_SIZE * 3) / 4 );
+    EXPECT_TRUE( apvAllocs[0] != 0 );
+
+    // Same script through the other allocators, on the same buffer
+    clArena.Init( aau8Heap, HEAP_SIZE, auArenaSizes, sizeof(auArenaSizes) / sizeof(K_ADDR) );
+    EXPECT_TRUE( Soak( SOAK_ARENA ) );
+
+    for (i = 0; i < 4; i++)
+    {
+        aclFixedConfig[i].m_u16BlockSize = 8 << i;
+        aclFixedConfig[i].m_u16BlockCount = (i < 2) ? 8 : ((i == 2) ? 6 : 4);
+    }
+    aclFixedConfig[4].m_u16BlockSize = 0;
+    aclFixedConfig[4].m_u16BlockCount = 0;
+    clFixedHeap.Create( aau8FixedHeap, aclFixedConfig );
+    EXPECT_TRUE( Soak( SOAK_FIXED ) );
+}
+TEST_END
+
+//===========================================================================
+static volatile bool bThreadFail;
+
+//---------------------------------------------------------------------------
+static void HeapScriptTest(void *pvParam_)
+{
+    uint8_t u8Index = (uint8_t)(K_ADDR)pvParam_;
+    uint8_t i;
+
+    while (1)
+    {
+        // Each thread works on its own half of the slots, with block sizes
+        // that differ between the threads.
+        for (i = u8Index; i < MAX_ALLOCS; i += 2)
+        {
+            uint8_t u8Size = 4 + (i * 3);
+            uint8_t *pu8Data = (uint8_t*)clTlsf.Allocate( u8Size );
+            apvAllocs[i] = pu8Data;
+            if (pu8Data)
+            {
+                for (uint8_t j = 0; j < u8Size; j++)
+                {
+                    pu8Data[j] = i;
+                }
+            }
+        }
+        for (i = u8Index; i < MAX_ALLOCS; i += 2)
+        {
+            uint8_t *pu8Data = (uint8_t*)apvAllocs[i];
+            if (pu8Data)
+            {
+                for (uint8_t j = 0; j < (4 + (i * 3)); j++)
+                {
+                    if (pu8Data[j] != i)
+                    {
+                        bThreadFail = true;
+                    }
+                }
+                clTlsf.Free( pu8Data );
+                apvAllocs[i] = 0;
+            }
+        }
+    }
+}
+
+//===========================================================================
+static Thread clTestThread1;
+static Thread clTestThread2;
+
+static K_WORD aucTestStack1[TEST_STACK_SIZE];
+static K_WORD aucTestStack2[TEST_STACK_SIZE];
+
+//===========================================================================
+// Test out how the heap handles constant, multi-threaded access.
+TEST(ut_tlsf_multithread)
+{
+    clTlsf.Init( aau8Heap, HEAP_SIZE );
+    bThreadFail = false;
+
+    clTestThread1.Init( aucTestStack1, TEST_STACK_SIZE, 1, HeapScriptTest, (void*)0);
+    clTestThread2.Init( aucTestStack2, TEST_STACK_SIZE, 1, HeapScriptTest, (void*)1);
+
+    clTestThread1.SetQuantum(7);
+    clTestThread2.SetQuantum(13);
+
+    Scheduler::GetCurrentThread()->SetPriority(7);
+
+    clTestThread1.Start();
+    clTestThread2.Start();
+
+    for (int i = 0; i < 4; i++)
+    {
+        Thread::Sleep(500);
+        EXPECT_FALSE( bThreadFail );
+    }
+    Scheduler::GetCurrentThread()->SetPriority(1);
+
+    clTestThread1.Exit();
+    clTestThread2.Exit();
+}
+TEST_END
+
+//===========================================================================
+// Test Whitelist Goes Here
+//===========================================================================
+TEST_CASE_START
+  TEST_CASE(ut_tlsf_alloc_free),
+  TEST_CASE(ut_tlsf_coalesce),
+#if HEAP_USE_STATS
+  TEST_CASE(ut_tlsf_stats),
+#endif
+  TEST_CASE(ut_tlsf_soak),
+  TEST_CASE(ut_tlsf_multithread),
+TEST_CASE_END
@@ -0,0 +1,211 @@
+/*===========================================================================
+     _____        _____        _____        _____
+ ___|    _|__  __|_    |__  __|__   |__  __| __  |__  ______
+|    \  /  | ||    \      ||     |     ||  |/ /     ||___   |
+|     \/   | ||     \     ||     \     ||     \     ||___   |
+|__/\__/|__|_||__|\__\  __||__|\__\  __||__|\__\  __||______|
+    |_____|      |_____|      |_____|      |_____|
+
+--[Mark3 Realtime Platform]--------------------------------------------------
+
+Copyright (c) 2012-2016 Funkenstein Software Consulting, all rights reserved.
+See license.txt for more information
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+
+#include "kerneltypes.h"
+#include "kernel.h"
+#include "../ut_platform.h"
+#include "mark3.h"
+
+#if KERNEL_USE_WAITSET
+//===========================================================================
+// Local Defines
+//===========================================================================
+static WaitSet clWaitSet;
+static WaitSet clWaitSet2;
+static Semaphore clSemaphore;
+static EventFlag clEventFlag;
+static Notify clNotify;
+static MessageQueue clMessageQueue;
+static Thread clThread;
+static K_WORD awStack[192];
+static volatile uint8_t u8Count = 0;
+#if KERNEL_USE_TIMEOUTS
+static Timer clTimer;
+
+static void FlagCallback(Thread *pclOwner_, void *pvData_)
+{
+    clEventFlag.Set(0x0001);
+}
+#endif
+
+static void SignalThread(void *unused_)
+{
+    Message *pclMessage;
+
+    // Signal each of the objects in the set in turn
+    while(1)
+    {
+        Thread::Sleep(10);
+        switch (u8Count & 3)
+        {
+            case 0:
+                clSemaphore.Post();
+                break;
+            case 1:
+                clEventFlag.Set(0x0010);
+                break;
+            case 2:
+                clNotify.Signal();
+                break;
+            case 3:
+                pclMessage = GlobalMessagePool::Pop();
+                pclMessage->SetCode(u8Count);
+                clMessageQueue.Send(pclMessage);
+                break;
+        }
+        u8Count++;
+    }
+}
+
+static void InitObjects()
+{
+    clSemaphore.Init(0, 10);
+    clEventFlag.Init();
+    clNotify.Init();
+    clMessageQueue.Init();
+
+    clWaitSet.Init();
+    clWaitSet.AddSemaphore(&clSemaphore);
+    clWaitSet.AddEventFlag(&clEventFlag, 0x0030, EVENT_FLAG_ANY_CLEAR);
+    clWaitSet.AddNotify(&clNotify);
+    clWaitSet.AddMessageQueue(&clMessageQueue);
+}
+
+//===========================================================================
+// Define Test Cases Here
+//===========================================================================
+TEST(ut_waitset_acquire)
+{
+    Message *pclMessage;
+
+    InitObjects();
+
+    // Test point - objects that are already signalled are acquired without
+    // blocking, and the object that was acquired is returned.
+    clSemaphore.Post();
+    EXPECT_EQUALS(clWaitSet.Wait(), 0);
+    EXPECT_EQUALS(clSemaphore.GetCount(), 0);
+
+    clEventFlag.Set(0x0021);
+    EXPECT_EQUALS(clWaitSet.Wait(), 1);
+    EXPECT_EQUALS(clWaitSet.GetEventFlagMask(), 0x0020);
+    EXPECT_EQUALS(clEventFlag.GetMask(), 0x0001);
+
+    clNotify.Signal();
+    EXPECT_EQUALS(clWaitSet.Wait(), 2);
+
+    pclMessage = GlobalMessagePool::Pop();
+    clMessageQueue.Send(pclMessage);
+    EXPECT_EQUALS(clWaitSet.Wait(), 3);
+    EXPECT_EQUALS((K_ADDR)clWaitSet.GetMessage(), (K_ADDR)pclMessage);
+    EXPECT_EQUALS(clMessageQueue.GetCount(), 0);
+    GlobalMessagePool::Push(pclMessage);
+
+    // Test point - where several objects are ready, the first one added
+    // takes precedence, and each wait acquires only one object.
+    clNotify.Signal();
+    clSemaphore.Post();
+    EXPECT_EQUALS(clWaitSet.Wait(), 0);
+    EXPECT_EQUALS(clWaitSet.Wait(), 2);
+
+    // Test point - an object can only belong to one set at a time, and sets
+    // have a fixed capacity.
+    clWaitSet2.Init();
+    EXPECT_EQUALS(clWaitSet2.AddSemaphore(&clSemaphore), -1);
+    clWaitSet.Clear();
+    EXPECT_EQUALS(clWaitSet2.AddSemaphore(&clSemaphore), 0);
+    clWaitSet2.Clear();
+}
+TEST_END
+
+//===========================================================================
+TEST(ut_waitset_block)
+{
+    Message *pclMessage;
+    bool bInOrder = true;
+
+    InitObjects();
+    u8Count = 0;
+
+    // Test point - a single thread blocks on all of the objects at once,
+    // and is woken by each of them in turn, with no wakeups lost.
+    clThread.Init(awStack, 192, 2, SignalThread, NULL);
+    clThread.Start();
+
+    for (uint8_t i = 0; i < 20; i++)
+    {
+        int8_t i8Idx = clWaitSet.Wait();
+        if (i8Idx != (int8_t)(i & 3))
+        {
+            bInOrder = false;
+        }
+        if (i8Idx == 3)
+        {
+            pclMessage = clWaitSet.GetMessage();
+            if (pclMessage->GetCode() != i)
+            {
+                bInOrder = false;
+            }
+            GlobalMessagePool::Push(pclMessage);
+        }
+    }
+    clThread.Stop();
+
+    EXPECT_TRUE(bInOrder);
+    EXPECT_EQUALS(u8Count, 20);
+    clWaitSet.Clear();
+}
+TEST_END
+
+#if KERNEL_USE_TIMEOUTS
+//===========================================================================
+TEST(ut_waitset_timeout)
+{
+    InitObjects();
+    u8Count = 0;
+
+    // Test point - nothing signalled, the wait times out
+    EXPECT_EQUALS(clWaitSet.Wait(20), -1);
+
+    // Test point - an object signalled before the timeout is acquired
+    clThread.Start();
+    EXPECT_EQUALS(clWaitSet.Wait(100), 0);
+    clThread.Stop();
+
+    // Test point - a wakeup that doesn't make any object available (flags
+    // outside of the mask) doesn't end the wait, or restart the timeout.
+    clTimer.Init();
+    clTimer.Start(false, 5, FlagCallback, 0);
+    EXPECT_EQUALS(clWaitSet.Wait(20), -1);
+    EXPECT_EQUALS(clEventFlag.GetMask(), 0x0001);
+    clWaitSet.Clear();
+}
+TEST_END
+#endif
+#endif // KERNEL_USE_WAITSET
+
+//===========================================================================
+// Test Whitelist Goes Here
+//===========================================================================
+TEST_CASE_START
+#if KERNEL_USE_WAITSET
+  TEST_CASE(ut_waitset_acquire),
+  TEST_CASE(ut_waitset_block),
+#if KERNEL_USE_TIMEOUTS
+  TEST_CASE(ut_waitset_timeout),
+#endif
+#endif
+TEST_CASE_END